@@ -287,6 +287,7 @@
  * @item mapi_get_row_count()	@tab	Number of rows in cache or -1
  * @item mapi_get_last_id()	@tab	last inserted id of an auto_increment (or alike) column
  * @item mapi_get_from()	@tab	Get the stream 'from'
+ * @item mapi_get_request_id()	@tab	Sequence number of an asynchronous query
  * @item mapi_get_to()	@tab	Get the stream 'to'
  * @item mapi_get_trace()	@tab	Get trace flag
  * @item mapi_get_user()	@tab	Current user name
@@ -294,6 +295,7 @@
  * @item mapi_next_result()	@tab	Go to next result set
  * @item mapi_needmore()	@tab	Return whether more data is needed
  * @item mapi_ping()	@tab	Test server for accessibility
+ * @item mapi_poll()	@tab	Next answered asynchronous query
  * @item mapi_prepare()	@tab	Prepare a query for execution
  * @item mapi_query()	@tab	Send a query for execution
  * @item mapi_query_handle()	@tab	Send a query for execution
@@ -301,6 +303,7 @@
  * @item mapi_reconnect()	@tab Reconnect with a clean session context
  * @item mapi_rows_affected()	@tab Obtain number of rows changed
  * @item mapi_seek_row()	@tab	Move row reader to specific location in cache
+ * @item mapi_send_async()	@tab	Send a query without waiting for the answer
  * @item mapi_setAutocommit()	@tab	Set auto-commit flag
  * @item mapi_stream_query()	@tab Send query and prepare for reading tuple stream
  * @item mapi_table()	@tab	Get current table name
@@ -441,6 +444,29 @@
  * last query string kept around.  The command response is buffered for
  * consumption, e.g. @code{mapi_fetch_row()}.
  *
+ * @item MapiHdl mapi_send_async(Mapi mid, const char *Command)
+ *
+ * Send the Command to the database server without waiting for its
+ * answer, nor for the answers of earlier commands sent this way, so
+ * that many queries can be in flight on one connection.  The server
+ * executes them in the order in which they were sent.  Each handle gets
+ * a request id, see @code{mapi_get_request_id()}.  The answers are read
+ * as soon as they are needed: by @code{mapi_poll()}, by
+ * @code{mapi_read_response()} or when fetching from the handle, and
+ * before any other command is sent to the server.
+ *
+ * @item MapiHdl mapi_poll(Mapi mid)
+ *
+ * Return the handle of the oldest query sent with
+ * @code{mapi_send_async()} that was not returned yet, waiting for its
+ * answer if needed.  Returns NULL when there are no such queries.  An
+ * error in the query is available through @code{mapi_result_error()}.
+ *
+ * @item int64_t mapi_get_request_id(MapiHdl hdl)
+ *
+ * Return the sequence number, starting at 1, that
+ * @code{mapi_send_async()} gave to the query of the handle.
+ *
  * @item MapiHdl mapi_prepare(Mapi mid, const char *Command)
  *
  * Move the query to a newly allocated query handle (which is returned).
@@ -453,6 +479,17 @@
  * single answer is pre-fetched to detect any runtime error. MOK is
  * returned upon success.
  *
+ * @item MapiMsg mapi_execute_batch(MapiHdl hdl, int64_t nrows)
+ *
+ * Execute a previously prepared SQL INSERT INTO .. VALUES statement for
+ * nrows rows of parameter values at once.  The parameters point to
+ * arrays of nrows values of their type, for strings an array of
+ * pointers, where a NULL pointer denotes a NULL value (the sizeptr of
+ * mapi_param_string() points to an array of lengths).  The statement is
+ * prepared by the server on first use, and the rows are sent in a
+ * single EXECUTE .. FROM STDIN statement, which appends them to the
+ * table as with COPY INTO.
+ *
  * @item MapiMsg mapi_finish(MapiHdl hdl)
  *
  * Terminate a query.  This routine is used in the rare cases that
@@ -629,6 +666,11 @@
  * pointed to by val.  If sizeptr == NULL or *sizeptr == -1, the string
  * is NULL-terminated.
  *
+ * @item MapiMsg mapi_param_nulls(MapiHdl hdl, int fldnr, char *nulls)
+ *
+ * Mark the rows of a batch in which the parameter is NULL: nulls points
+ * to an array with a non-zero flag for each such row.
+ *
  * @item MapiMsg mapi_clear_params(MapiHdl hdl)
  *
  * Clear all parameter bindings.
@@ -789,6 +831,7 @@ struct MapiParam {
 	int outtype;		/* type of value */
 	int precision;
 	int scale;
+	char *nulls;		/* if not NULL, the NULL flags of a batch */
 };
 
 /*
@@ -854,6 +897,10 @@ struct MapiStruct {
 	int connected;
 	MapiHdl first;		/* start of doubly-linked list */
 	MapiHdl active;		/* set when not all rows have been received */
+	MapiHdl async_first;	/* queries sent with mapi_send_async, */
+	MapiHdl async_last;	/* in the order they were sent */
+	int64_t async_requests;	/* number of requests sent with mapi_send_async */
+	size_t async_bytes;	/* size of the queries whose answer is not read */
 
 	int cachelimit;		/* default maximum number of rows to cache */
 	int redircnt;		/* redirection count, used to cut of redirect loops */
@@ -898,9 +945,21 @@ struct MapiStatement {
 	int needmore;		/* need more input */
 	int *pending_close;
 	int npending_close;
+	int64_t request_id;	/* set by mapi_send_async */
+	int async;		/* ASYNC_SENT or ASYNC_DONE if in the async list */
+	MapiHdl async_next;
+	int batchid;		/* server side prepared template for batches */
 	MapiHdl prev, next;
 };
 
+#define ASYNC_SENT	1	/* query sent, answer not read yet */
+#define ASYNC_DONE	2	/* answer read, not yet returned by mapi_poll */
+
+/* Outstanding asynchronous queries are limited to this many bytes, so
+ * that the server never blocks on reading them while it is blocked on
+ * sending us an answer that we are not reading. */
+#define ASYNC_WINDOW	(64*1024)
+
 #ifdef DEBUG
 #define debugprint(fmt,arg)	printf(fmt,arg)
 #else
@@ -963,6 +1022,11 @@ static int mapi_extend_bindings(MapiHdl hdl, int minbindings);
 static int mapi_extend_params(MapiHdl hdl, int minparams);
 static void close_connection(Mapi mid);
 static MapiMsg read_into_cache(MapiHdl hdl, int lookahead);
+static MapiMsg read_async(Mapi mid, MapiHdl upto);
+static MapiMsg finish_pending(Mapi mid);
+static void async_remove(Mapi mid, MapiHdl hdl);
+static MapiMsg write_query(MapiHdl hdl);
+static MapiMsg mapi_Xcommand(Mapi mid, const char *cmdname, const char *cmdvalue);
 static int unquote(const char *msg, char **start, const char **next, int endchar, size_t *lenp);
 static int mapi_slice_row(struct MapiResultSet *result, int cr);
 static void mapi_store_bind(struct MapiResultSet *result, int cr);
@@ -1502,6 +1566,12 @@ close_result(MapiHdl hdl)
 				hdl->npending_close++;
 			}
 		} else if (mid->to != NULL) {
+			/* the answers to our X commands are only read
+			 * after those of the outstanding queries */
+			if ((hdl->npending_close > 0 ||
+			     result->tuple_count < result->row_count) &&
+			    read_async(mid, NULL) != MOK)
+				return MERROR;
 			/* first close saved up to-be-closed tables */
 			for (i = 0; i < hdl->npending_close; i++) {
 				char msg[256];
@@ -1724,6 +1794,10 @@ mapi_new_handle(Mapi mid)
 	hdl->needmore = 0;
 	hdl->pending_close = NULL;
 	hdl->npending_close = 0;
+	hdl->request_id = 0;
+	hdl->async = 0;
+	hdl->async_next = NULL;
+	hdl->batchid = -1;
 	/* add to doubly-linked list */
 	hdl->prev = NULL;
 	hdl->next = mid->first;
@@ -1746,6 +1820,8 @@ finish_handle(MapiHdl hdl)
 	if (mid->active == hdl && !hdl->needmore &&
 	    read_into_cache(hdl, 0) != MOK)
 		return MERROR;
+	if (hdl->async == ASYNC_SENT && read_async(mid, hdl) != MOK)
+		return MERROR;
 	if (mid->to) {
 		if (hdl->needmore) {
 			assert(mid->active == NULL || mid->active == hdl);
@@ -1755,6 +1831,8 @@ finish_handle(MapiHdl hdl)
 			check_stream(mid, mid->to, "write error on stream", "finish_handle", mid->error);
 			read_into_cache(hdl, 0);
 		}
+		if (hdl->npending_close > 0 && read_async(mid, NULL) != MOK)
+			return MERROR;
 		for (i = 0; i < hdl->npending_close; i++) {
 			char msg[256];
 
@@ -1789,6 +1867,20 @@ finish_handle(MapiHdl hdl)
 	return MOK;
 }
 
+/* Release the prepared statement that the server keeps for the batches
+ * of the handle. */
+static void
+release_batch(MapiHdl hdl)
+{
+	char buf[16];
+
+	if (hdl->batchid >= 0 && hdl->mid->connected) {
+		snprintf(buf, sizeof(buf), "%d", hdl->batchid);
+		mapi_Xcommand(hdl->mid, "release", buf);
+	}
+	hdl->batchid = -1;
+}
+
 /* Close a statement handle, discarding any unread output. */
 MapiMsg
 mapi_close_handle(MapiHdl hdl)
@@ -1800,10 +1892,13 @@ mapi_close_handle(MapiHdl hdl)
 
 	if (finish_handle(hdl) != MOK)
 		return MERROR;
+	release_batch(hdl);
 	hdl->npending_close = 0;
 	if (hdl->pending_close)
 		free(hdl->pending_close);
 	hdl->pending_close = NULL;
+	if (hdl->async)
+		async_remove(hdl->mid, hdl);
 	if (hdl->bindings)
 		free(hdl->bindings);
 	hdl->bindings = NULL;
@@ -2993,8 +3088,12 @@ close_connection(Mapi mid)
 
 	mid->connected = 0;
 	mid->active = NULL;
+	mid->async_first = mid->async_last = NULL;
+	mid->async_bytes = 0;
 	for (hdl = mid->first; hdl; hdl = hdl->next) {
 		hdl->active = NULL;
+		hdl->async = 0;
+		hdl->async_next = NULL;
 		for (result = hdl->result; result; result = result->next)
 			result->tableid = -1;
 	}
@@ -3105,6 +3204,7 @@ mapi_param_type(MapiHdl hdl, int fnr, int ctype, int sqltype, void *ptr)
 	hdl->params[fnr].outtype = sqltype;
 	hdl->params[fnr].scale = 0;
 	hdl->params[fnr].precision = 0;
+	hdl->params[fnr].nulls = NULL;
 	return MOK;
 }
 
@@ -3119,6 +3219,7 @@ mapi_param_string(MapiHdl hdl, int fnr, int sqltype, char *ptr, int *sizeptr)
 	hdl->params[fnr].outtype = sqltype;
 	hdl->params[fnr].scale = 0;
 	hdl->params[fnr].precision = 0;
+	hdl->params[fnr].nulls = NULL;
 	return MOK;
 }
 
@@ -3139,6 +3240,14 @@ mapi_param_numeric(MapiHdl hdl, int fnr, int scale, int prec, void *ptr)
 	return MOK;
 }
 
+MapiMsg
+mapi_param_nulls(MapiHdl hdl, int fnr, char *nulls)
+{
+	testParam(hdl, fnr, "mapi_param_nulls");
+	hdl->params[fnr].nulls = nulls;
+	return MOK;
+}
+
 MapiMsg
 mapi_clear_params(MapiHdl hdl)
 {
@@ -3182,7 +3291,7 @@ mapi_Xcommand(Mapi mid, const char *cmdname, const char *cmdvalue)
 	MapiHdl hdl;
 
 	mapi_check(mid, "mapi_Xcommand");
-	if (mid->active && read_into_cache(mid->active, 0) != MOK)
+	if (finish_pending(mid) != MOK)
 		return MERROR;
 	if (mnstr_printf(mid->to, "X" "%s %s\n", cmdname, cmdvalue) < 0 ||
 	    mnstr_flush(mid->to)) {
@@ -3210,6 +3319,7 @@ mapi_prepare_handle(MapiHdl hdl, const char *cmd)
 	mapi_hdl_check(hdl, "mapi_prepare_handle");
 	if (finish_handle(hdl) != MOK)
 		return MERROR;
+	release_batch(hdl);
 	prepareQuery(hdl, cmd);
 	hdl->template = strdup(hdl->query);
 	assert(hdl->template);
@@ -4020,7 +4130,7 @@ mapi_virtual_result(MapiHdl hdl, int columns, const char **columnnames, const ch
 	if (columns <= 0)
 		return MERROR;
 	mid = hdl->mid;
-	if (mid->active && read_into_cache(mid->active, 0) != MOK)
+	if (finish_pending(mid) != MOK)
 		return MERROR;
 	assert(mid->active == NULL);
 	finish_handle(hdl);
@@ -4067,16 +4177,28 @@ mapi_virtual_result(MapiHdl hdl, int columns, const char **columnnames, const ch
 static MapiMsg
 mapi_execute_internal(MapiHdl hdl)
 {
-	size_t size;
-	char *cmd;
 	Mapi mid;
 
 	mid = hdl->mid;
-	if (mid->active && read_into_cache(mid->active, 0) != MOK)
+	if (finish_pending(mid) != MOK)
 		return MERROR;
 	assert(mid->active == NULL);
 	finish_handle(hdl);
 	mapi_param_store(hdl);
+	return write_query(hdl);
+}
+
+/* send the query of the handle to the server; the answers to all
+ * earlier commands must have been read, except for those of the
+ * asynchronous queries if the query is small */
+static MapiMsg
+write_query(MapiHdl hdl)
+{
+	size_t size;
+	char *cmd;
+	Mapi mid;
+
+	mid = hdl->mid;
 	cmd = hdl->query;
 	if (cmd == NULL)
 		return MERROR;
@@ -4205,6 +4327,216 @@ mapi_execute(MapiHdl hdl)
 	return ret;
 }
 
+/*
+ * A batch sends the rows of parameter values after an EXECUTE .. FROM
+ * STDIN statement, in the format of COPY INTO with all strings quoted.
+ */
+#define batchSpace(len)						\
+	do {							\
+		if (k + (len) >= lim) {				\
+			char *q = hdl->query;			\
+			lim = k + (len) + MAPIBLKSIZE;		\
+			hdl->query = realloc(hdl->query, lim);	\
+			if (hdl->query == NULL) {		\
+				free(q);			\
+				return mapi_setError(hdl->mid, "Memory allocation failure", "mapi_execute_batch", MERROR); \
+			}					\
+		}						\
+	} while (0)
+
+static MapiMsg
+mapi_batch_store(MapiHdl hdl, int64_t nrows)
+{
+	char *p, *q;
+	int i, nparams = 0;
+	int64_t r;
+	size_t k, lim;
+
+	for (p = hdl->template; (q = strchr(p, PLACEHOLDER)) != NULL; p = q + 1)
+		if (q == hdl->template || q[-1] != '\\')
+			nparams++;
+	lim = 128 + nrows * (nparams + 1) * 8;
+	free(hdl->query);
+	if ((hdl->query = malloc(lim)) == NULL)
+		return mapi_setError(hdl->mid, "Memory allocation failure", "mapi_execute_batch", MERROR);
+	k = snprintf(hdl->query, lim,
+		     "EXECUTE %d FROM STDIN %" PRId64 " RECORDS USING DELIMITERS '|','\\n','\"';\n",
+		     hdl->batchid, nrows);
+
+	for (r = 0; r < nrows; r++) {
+		for (i = 0; i < nparams; i++) {
+			struct MapiParam *par = i < hdl->maxparams ? &hdl->params[i] : NULL;
+			char *src = par ? par->inparam : NULL;
+			const char *val = NULL;
+			int size = -1;
+
+			batchSpace(120);
+			if (i > 0)
+				hdl->query[k++] = '|';
+			if (src == NULL || (par->nulls && par->nulls[r])) {
+				strcpy(hdl->query + k, "null");
+				k += 4;
+				continue;
+			}
+			switch (par->intype) {
+			case MAPI_TINY:
+				k += sprintf(hdl->query + k, "%hhd", ((signed char *) src)[r]);
+				break;
+			case MAPI_UTINY:
+				k += sprintf(hdl->query + k, "%hhu", ((unsigned char *) src)[r]);
+				break;
+			case MAPI_SHORT:
+				k += sprintf(hdl->query + k, "%hd", ((short *) src)[r]);
+				break;
+			case MAPI_USHORT:
+				k += sprintf(hdl->query + k, "%hu", ((unsigned short *) src)[r]);
+				break;
+			case MAPI_INT:
+				k += sprintf(hdl->query + k, "%d", ((int *) src)[r]);
+				break;
+			case MAPI_UINT:
+				k += sprintf(hdl->query + k, "%u", ((unsigned int *) src)[r]);
+				break;
+			case MAPI_LONG:
+				k += sprintf(hdl->query + k, "%ld", ((long *) src)[r]);
+				break;
+			case MAPI_ULONG:
+				k += sprintf(hdl->query + k, "%lu", ((unsigned long *) src)[r]);
+				break;
+			case MAPI_LONGLONG:
+				k += sprintf(hdl->query + k, "%"PRId64, ((int64_t *) src)[r]);
+				break;
+			case MAPI_ULONGLONG:
+				k += sprintf(hdl->query + k, "%"PRIu64, ((uint64_t *) src)[r]);
+				break;
+			case MAPI_FLOAT:
+				k += sprintf(hdl->query + k, "%.9g", ((float *) src)[r]);
+				break;
+			case MAPI_DOUBLE:
+				k += sprintf(hdl->query + k, "%.17g", ((double *) src)[r]);
+				break;
+			case MAPI_DATE:
+				k += sprintf(hdl->query + k, "%04hd-%02hu-%02hu",
+					     ((MapiDate *) src)[r].year,
+					     ((MapiDate *) src)[r].month,
+					     ((MapiDate *) src)[r].day);
+				break;
+			case MAPI_TIME:
+				k += sprintf(hdl->query + k, "%02hu:%02hu:%02hu",
+					     ((MapiTime *) src)[r].hour,
+					     ((MapiTime *) src)[r].minute,
+					     ((MapiTime *) src)[r].second);
+				break;
+			case MAPI_DATETIME:
+				k += sprintf(hdl->query + k, "%04hd-%02hu-%02hu %02hu:%02hu:%02hu.%09u",
+					     ((MapiDateTime *) src)[r].year,
+					     ((MapiDateTime *) src)[r].month,
+					     ((MapiDateTime *) src)[r].day,
+					     ((MapiDateTime *) src)[r].hour,
+					     ((MapiDateTime *) src)[r].minute,
+					     ((MapiDateTime *) src)[r].second,
+					     ((MapiDateTime *) src)[r].fraction);
+				break;
+			case MAPI_CHAR:
+				val = src + r;
+				size = 1;
+				break;
+			default:
+				/* MAPI_VARCHAR and the values as text */
+				val = ((char **) src)[r];
+				if (val == NULL) {
+					strcpy(hdl->query + k, "null");
+					k += 4;
+					continue;
+				}
+				if (par->sizeptr)
+					size = par->sizeptr[r];
+				break;
+			}
+			if (val == NULL)
+				continue;
+			hdl->query[k++] = '"';
+			while (size < 0 ? *val : size > 0) {
+				batchSpace(3);
+				if (size > 0)
+					size--;
+				switch (*val) {
+				case '\n':
+					hdl->query[k++] = '\\';
+					hdl->query[k++] = 'n';
+					break;
+				case '\r':
+					hdl->query[k++] = '\\';
+					hdl->query[k++] = 'r';
+					break;
+				case '\\':
+				case '"':
+					hdl->query[k++] = '\\';
+					/* fall through */
+				default:
+					hdl->query[k++] = *val;
+					break;
+				}
+				val++;
+			}
+			hdl->query[k++] = '"';
+		}
+		batchSpace(2);
+		hdl->query[k++] = '\n';
+	}
+	hdl->query[k] = 0;
+	if (hdl->mid->trace == MAPI_TRACE)
+		printf("batch_store: %" PRId64 " rows, %zu bytes\n", nrows, k);
+	return MOK;
+}
+
+MapiMsg
+mapi_execute_batch(MapiHdl hdl, int64_t nrows)
+{
+	Mapi mid;
+	int retry;
+
+	mapi_hdl_check(hdl, "mapi_execute_batch");
+	mid = hdl->mid;
+	if (hdl->template == NULL || mid->languageId != LANG_SQL)
+		return mapi_setError(mid, "Batches need a prepared SQL query", "mapi_execute_batch", MERROR);
+	if (nrows <= 0)
+		return MOK;
+	/* the server forgets its prepared statements after an error, in
+	 * which case the template is prepared once more */
+	for (retry = 0; retry < 2; retry++) {
+		if (finish_pending(mid) != MOK || finish_handle(hdl) != MOK)
+			return MERROR;
+		if (hdl->batchid < 0) {
+			size_t len = strlen(hdl->template) + 9;
+
+			free(hdl->query);
+			if ((hdl->query = malloc(len)) == NULL)
+				return mapi_setError(mid, "Memory allocation failure", "mapi_execute_batch", MERROR);
+			snprintf(hdl->query, len, "PREPARE %s", hdl->template);
+			if (write_query(hdl) != MOK || read_into_cache(hdl, 1) != MOK)
+				return MERROR;
+			if (hdl->result == NULL || hdl->result->querytype != Q_PREPARE)
+				return mapi_setError(mid, hdl->result && hdl->result->errorstr ? hdl->result->errorstr : "Cannot prepare the query", "mapi_execute_batch", MERROR);
+			hdl->batchid = hdl->result->tableid;
+			if (finish_handle(hdl) != MOK)
+				return MERROR;
+		}
+		if (mapi_batch_store(hdl, nrows) != MOK)
+			return mid->error;
+		/* large batches are sent in parts, reading the answers */
+		if (write_query(hdl) == MOK && mid->active == hdl)
+			read_into_cache(hdl, 1);
+		if (mid->error != MSERVER || retry > 0 ||
+		    hdl->result == NULL || hdl->result->errorstr == NULL ||
+		    strcmp(hdl->result->sqlstate, "07003") != 0)
+			break;
+		mapi_clrError(mid);
+		hdl->batchid = -1;
+	}
+	return mid->error;
+}
+
 /*
  * The routine mapi_query is one of the most heavily used ones.
  * It sends a complete statement for execution
@@ -4246,9 +4578,151 @@ mapi_send(Mapi mid, const char *cmd)
 MapiMsg
 mapi_read_response(MapiHdl hdl)
 {
+	if (hdl->async == ASYNC_SENT)
+		return read_async(hdl->mid, hdl);
 	return read_into_cache(hdl, 1);
 }
 
+/* Read the answers to the queries sent with mapi_send_async, in the
+ * order in which they were sent, up to and including the one of upto
+ * (all of them if upto is NULL).  The server executes the queries of
+ * a connection one after the other, so the answers arrive in that
+ * order.  An error in one of the queries is kept with its handle and
+ * does not stop us from reading the others. */
+static MapiMsg
+read_async(Mapi mid, MapiHdl upto)
+{
+	MapiHdl hdl;
+
+	for (hdl = mid->async_first; hdl; hdl = hdl->async_next) {
+		if (hdl->async == ASYNC_SENT) {
+			assert(mid->active == NULL);
+			mid->active = hdl;
+			read_into_cache(hdl, 0);
+			if (!mid->connected)
+				return MERROR;
+			if (mid->error == MSERVER)
+				mapi_clrError(mid);
+			hdl->async = ASYNC_DONE;
+			mid->async_bytes -= strlen(hdl->query);
+		}
+		if (hdl == upto)
+			break;
+	}
+	return MOK;
+}
+
+/* read everything the server still has to send us */
+static MapiMsg
+finish_pending(Mapi mid)
+{
+	if (mid->active && read_into_cache(mid->active, 0) != MOK)
+		return MERROR;
+	return read_async(mid, NULL);
+}
+
+static void
+async_remove(Mapi mid, MapiHdl hdl)
+{
+	MapiHdl *p;
+
+	for (p = &mid->async_first; *p; p = &(*p)->async_next) {
+		if (*p == hdl) {
+			*p = hdl->async_next;
+			if (mid->async_last == hdl) {
+				MapiHdl last = mid->async_first;
+
+				while (last && last->async_next)
+					last = last->async_next;
+				mid->async_last = last;
+			}
+			break;
+		}
+	}
+	hdl->async = 0;
+	hdl->async_next = NULL;
+}
+
+/* Send a query without waiting for the answers to this or any of the
+ * earlier queries sent with this function.  The server executes the
+ * queries in the order in which they were sent.  The returned handle
+ * is returned again by mapi_poll once its answer has been read, and
+ * can be used like the handle returned by mapi_query from then on.
+ * Errors in the query itself are reported through
+ * mapi_result_error. */
+MapiHdl
+mapi_send_async(Mapi mid, const char *cmd)
+{
+	MapiHdl hdl;
+	size_t size;
+
+	mapi_check0(mid, "mapi_send_async");
+	if (mid->active && read_into_cache(mid->active, 0) != MOK)
+		return NULL;
+	size = strlen(cmd);
+	/* don't let the server block on writing answers we don't read
+	 * while we block on writing queries it doesn't read */
+	while (mid->async_bytes > 0 && mid->async_bytes + size > ASYNC_WINDOW) {
+		MapiHdl first;
+
+		for (first = mid->async_first; first; first = first->async_next)
+			if (first->async == ASYNC_SENT)
+				break;
+		if (first == NULL || read_async(mid, first) != MOK)
+			break;
+	}
+	hdl = prepareQuery(mapi_new_handle(mid), cmd);
+	if (hdl == NULL)
+		return NULL;
+	hdl->request_id = ++mid->async_requests;
+	if (mid->async_last)
+		mid->async_last->async_next = hdl;
+	else
+		mid->async_first = hdl;
+	mid->async_last = hdl;
+	if (mid->error != MOK)
+		return hdl;
+	if (hdl->query == NULL || strlen(hdl->query) > ASYNC_WINDOW) {
+		/* large queries are sent in pieces, each of which
+		 * is answered, so we must wait for everything */
+		hdl->async = ASYNC_DONE;
+		if (mapi_execute_internal(hdl) == MOK)
+			read_into_cache(hdl, 0);
+		return hdl;
+	}
+	if (write_query(hdl) != MOK) {
+		hdl->async = ASYNC_DONE;
+		return hdl;
+	}
+	mid->active = NULL;
+	hdl->async = ASYNC_SENT;
+	mid->async_bytes += strlen(hdl->query);
+	return hdl;
+}
+
+/* Return the handle of the oldest query sent with mapi_send_async
+ * that has not yet been returned, waiting for its answer if need be.
+ * Returns NULL if there are no such queries. */
+MapiHdl
+mapi_poll(Mapi mid)
+{
+	MapiHdl hdl;
+
+	mapi_check0(mid, "mapi_poll");
+	if ((hdl = mid->async_first) == NULL)
+		return NULL;
+	if (hdl->async == ASYNC_SENT && read_async(mid, hdl) != MOK)
+		return NULL;
+	async_remove(mid, hdl);
+	return hdl;
+}
+
+int64_t
+mapi_get_request_id(MapiHdl hdl)
+{
+	return hdl->request_id;
+}
+
 MapiMsg
 mapi_query_handle(MapiHdl hdl, const char *cmd)
 {
@@ -4270,7 +4744,7 @@ MapiHdl
 mapi_query_prep(Mapi mid)
 {
 	mapi_check0(mid, "mapi_query_prep");
-	if (mid->active && read_into_cache(mid->active, 0) != MOK)
+	if (finish_pending(mid) != MOK)
 		return NULL;
 	assert(mid->active == NULL);
 	if (mid->languageId == LANG_SQL) {
@@ -4387,8 +4861,7 @@ mapi_cache_limit(Mapi mid, int limit)
 	if (mid->languageId == LANG_SQL) {
 		MapiHdl hdl;
 
-		if (mid->active)
-			read_into_cache(mid->active, 0);
+		finish_pending(mid);
 
 		if (mid->tracelog) {
 			mapi_log_header(mid, "W");
@@ -4497,6 +4970,8 @@ mapi_fetch_line_internal(MapiHdl hdl)
 	struct MapiResultSet *result;
 	char *reply;
 
+	if (hdl->async == ASYNC_SENT && read_async(hdl->mid, hdl) != MOK)
+		return NULL;
 	/* try to read a line from the cache */
 	if ((result = hdl->result) == NULL || result->cache.writer <= 0 || result->cache.reader + 1 >= result->cache.writer) {
 		mid = hdl->mid;
@@ -4539,8 +5014,7 @@ mapi_fetch_line(MapiHdl hdl)
 	    result->cache.first + result->cache.tuplecount < result->row_count) {
 		if (hdl->needmore)	/* escalate */
 			return NULL;
-		if (hdl->mid->active != NULL)
-			read_into_cache(hdl->mid->active, 0);
+		finish_pending(hdl->mid);
 		hdl->mid->active = hdl;
 		hdl->active = result;
 		if (hdl->mid->tracelog) {
@@ -5067,12 +5541,16 @@ mapi_fetch_all_rows(MapiHdl hdl)
 	mapi_hdl_check(hdl, "mapi_fetch_all_rows");
 
 	mid = hdl->mid;
+	if (hdl->async == ASYNC_SENT && read_async(mid, hdl) != MOK)
+		return 0;
 	for (;;) {
 		if ((result = hdl->result) != NULL &&
 		    mid->languageId == LANG_SQL &&
 		    mid->active == NULL &&
 		    result->row_count > 0 &&
 		    result->cache.first + result->cache.tuplecount < result->row_count) {
+			if (read_async(mid, NULL) != MOK)
+				break;
 			mid->active = hdl;
 			hdl->active = result;
 			if (mid->tracelog) {
@@ -5398,3 +5876,202 @@ mapi_get_active(Mapi mid)
 	return mid->active;
 }
 
+
+/* Extract value i of width bits from an array of bit packed 64 bit
+ * words (least significant bit first). */
+static uint64_t
+mapi_unpack(const char *packed, int64_t i, int width)
+{
+	uint64_t bit = (uint64_t) i * width, v, w;
+
+	if (width == 0)
+		return 0;
+	memcpy(&v, packed + bit / 64 * 8, 8);
+	v >>= bit % 64;
+	if (bit % 64 + width > 64) {
+		memcpy(&w, packed + (bit / 64 + 1) * 8, 8);
+		v |= w << (64 - bit % 64);
+	}
+	if (width < 64)
+		v &= ((uint64_t) 1 << width) - 1;
+	return v;
+}
+
+static int
+mapi_isnull(const char *bitmap, int64_t i)
+{
+	return bitmap && (bitmap[i / 8] >> (i % 8)) & 1;
+}
+
+/* A protocol 10 result chunk sent to a client that announced
+ * COLUMN_ENCODING starts every column with a 16 byte header that
+ * describes how the column was encoded (see column_encoding in
+ * stream.h).  mapi_decode_column decodes the column of rows values of
+ * typelen bytes (-1 for strings) that starts at src into the layout it
+ * would have had without encoding.  The result is a malloced buffer of
+ * *size bytes; *consumed is set to the number of bytes of src used by
+ * the column.  The next column starts at the next multiple of eight
+ * bytes.  On malformed input NULL is returned. */
+char *
+mapi_decode_column(const char *src, size_t srclen, int64_t rows, int typelen, size_t *consumed, size_t *size)
+{
+	int64_t len, i, j, nonnull;
+	int enc, has_nulls, width, count;
+	const char *p, *end, *bitmap = NULL;
+	char *dst;
+
+	if (src == NULL || srclen < 16 || rows < 0)
+		return NULL;
+	memcpy(&len, src, 8);
+	if (len < 8 || (uint64_t) len > srclen - 8)
+		return NULL;
+	enc = (unsigned char) src[8];
+	has_nulls = src[9];
+	width = (unsigned char) src[10];
+	memcpy(&count, src + 12, 4);
+	p = src + 16;
+	end = src + 8 + len;
+	*consumed = (size_t) len + 8;
+
+	if (enc == COLUMN_ENCODING_PLAIN) {
+		*size = (size_t) (end - p);
+		if ((dst = malloc(*size ? *size : 1)) == NULL)
+			return NULL;
+		memcpy(dst, p, *size);
+		return dst;
+	}
+	if (width > 64 || count < 0)
+		return NULL;
+	nonnull = rows;
+	if (has_nulls) {
+		size_t bmsize = (size_t) (rows + 63) / 64 * 8;
+
+		if ((size_t) (end - p) < bmsize)
+			return NULL;
+		bitmap = p;
+		p += bmsize;
+		for (i = 0; i < rows; i++)
+			nonnull -= mapi_isnull(bitmap, i);
+	}
+
+	switch (enc) {
+	case COLUMN_ENCODING_FOR:
+	case COLUMN_ENCODING_DELTA: {
+		uint64_t base, step = 0, v = 0, nil;
+		int64_t npacked;
+
+		if (typelen != 1 && typelen != 2 && typelen != 4 && typelen != 8)
+			return NULL;
+		if (count != nonnull)
+			return NULL;
+		npacked = enc == COLUMN_ENCODING_FOR ? count : count > 0 ? count - 1 : 0;
+		if ((size_t) (end - p) < (enc == COLUMN_ENCODING_FOR ? 8 : 16) +
+		    (size_t) ((npacked * width + 63) / 64 * 8))
+			return NULL;
+		memcpy(&base, p, 8);
+		p += 8;
+		if (enc == COLUMN_ENCODING_DELTA) {
+			memcpy(&step, p, 8);
+			p += 8;
+		}
+		*size = (size_t) rows * typelen;
+		if ((dst = malloc(*size ? *size : 1)) == NULL)
+			return NULL;
+		nil = (uint64_t) 1 << (typelen * 8 - 1);
+		for (i = 0, j = 0; i < rows; i++) {
+			uint64_t x;
+
+			if (mapi_isnull(bitmap, i)) {
+				x = nil;
+			} else {
+				if (enc == COLUMN_ENCODING_FOR)
+					v = base + mapi_unpack(p, j, width);
+				else if (j == 0)
+					v = base;
+				else
+					v += step + mapi_unpack(p, j - 1, width);
+				x = v;
+				j++;
+			}
+			switch (typelen) {
+			case 1: {
+				uint8_t b = (uint8_t) x;
+				dst[i] = (char) b;
+				break;
+			}
+			case 2: {
+				uint16_t s = (uint16_t) x;
+				memcpy(dst + i * 2, &s, 2);
+				break;
+			}
+			case 4: {
+				uint32_t w = (uint32_t) x;
+				memcpy(dst + i * 4, &w, 4);
+				break;
+			}
+			default:
+				memcpy(dst + i * 8, &x, 8);
+				break;
+			}
+		}
+		return dst;
+	}
+	case COLUMN_ENCODING_DICT: {
+		const char **dict;
+		const char *q;
+		int64_t total = 0;
+		char *d;
+
+		if (typelen != -1)
+			return NULL;
+		if ((dict = malloc((count ? count : 1) * sizeof(char *))) == NULL)
+			return NULL;
+		for (q = p, i = 0; i < count; i++) {
+			const char *e = memchr(q, 0, end - q);
+
+			if (e == NULL) {
+				free(dict);
+				return NULL;
+			}
+			dict[i] = q;
+			q = e + 1;
+		}
+		q = p + ((q - p) + 7) / 8 * 8;
+		if (q > end ||
+		    (size_t) (end - q) < (size_t) ((nonnull * width + 63) / 64 * 8)) {
+			free(dict);
+			return NULL;
+		}
+		for (i = 0, j = 0; i < rows; i++) {
+			if (mapi_isnull(bitmap, i)) {
+				total += 2;
+			} else {
+				uint64_t k = mapi_unpack(q, j++, width);
+
+				if (k >= (uint64_t) count) {
+					free(dict);
+					return NULL;
+				}
+				total += strlen(dict[k]) + 1;
+			}
+		}
+		*size = (size_t) total + 8;
+		if ((dst = malloc(*size)) == NULL) {
+			free(dict);
+			return NULL;
+		}
+		memcpy(dst, &total, 8);
+		for (d = dst + 8, i = 0, j = 0; i < rows; i++) {
+			const char *v = mapi_isnull(bitmap, i) ? "\200" : dict[mapi_unpack(q, j++, width)];
+			size_t l = strlen(v) + 1;
+
+			memcpy(d, v, l);
+			d += l;
+		}
+		free(dict);
+		return dst;
+	}
+	default:
+		return NULL;
+	}
+}
@@ -163,11 +163,13 @@ mapi_export MapiMsg mapi_param_type(MapiHdl hdl, int fnr, int ctype, int sqltype
 mapi_export MapiMsg mapi_param_string(MapiHdl hdl, int fnr, int sqltype, char *ptr, int *sizeptr);
 mapi_export MapiMsg mapi_param(MapiHdl hdl, int fnr, char **ptr);
 mapi_export MapiMsg mapi_param_numeric(MapiHdl hdl, int fnr, int scale, int precision, void *ptr);
+mapi_export MapiMsg mapi_param_nulls(MapiHdl hdl, int fnr, char *nulls);
 mapi_export MapiMsg mapi_clear_params(MapiHdl hdl);
 mapi_export MapiHdl mapi_prepare(Mapi mid, const char *cmd);
 mapi_export MapiMsg mapi_prepare_handle(MapiHdl hdl, const char *cmd);
 mapi_export MapiMsg mapi_virtual_result(MapiHdl hdl, int columns, const char **columnnames, const char **columntypes, const int *columnlengths, int tuplecount, const char ***tuples);
 mapi_export MapiMsg mapi_execute(MapiHdl hdl);
+mapi_export MapiMsg mapi_execute_batch(MapiHdl hdl, int64_t nrows);
 mapi_export MapiMsg mapi_fetch_reset(MapiHdl hdl);
 mapi_export MapiMsg mapi_finish(MapiHdl hdl);
 mapi_export MapiHdl mapi_query(Mapi mid, const char *cmd);
@@ -177,6 +179,9 @@ mapi_export MapiMsg mapi_query_part(MapiHdl hdl, const char *cmd, size_t size);
 mapi_export MapiMsg mapi_query_done(MapiHdl hdl);
 mapi_export MapiHdl mapi_send(Mapi mid, const char *cmd);
 mapi_export MapiMsg mapi_read_response(MapiHdl hdl);
+mapi_export MapiHdl mapi_send_async(Mapi mid, const char *cmd);
+mapi_export MapiHdl mapi_poll(Mapi mid);
+mapi_export int64_t mapi_get_request_id(MapiHdl hdl);
 mapi_export MapiHdl mapi_stream_query(Mapi mid, const char *cmd, int windowsize);
 mapi_export MapiMsg mapi_cache_limit(Mapi mid, int limit);
 mapi_export MapiMsg mapi_cache_shuffle(MapiHdl hdl, int percentage);
@@ -220,6 +225,7 @@ mapi_export int mapi_get_tableid(MapiHdl hdl);
 mapi_export char *mapi_quote(const char *msg, int size);
 mapi_export char *mapi_unquote(char *msg);
 mapi_export MapiHdl mapi_get_active(Mapi mid);
+mapi_export char *mapi_decode_column(const char *src, size_t srclen, int64_t rows, int typelen, size_t *consumed, size_t *size);
 #ifdef _MSC_VER
 mapi_export const char *wsaerror(int);
 #endif
@@ -2838,6 +2838,48 @@ ODBCFetch(ODBCStmt *stmt,
 				buf[bufpos++] = (value)[_i];		\
 		} while (0)
 
+/* the size of the elements of a column-wise bound parameter array */
+static SQLLEN
+ODBCElementSize(ODBCDescRec *apdrec, SQLSMALLINT ctype)
+{
+	switch (ctype) {
+	case SQL_C_CHAR:
+	case SQL_C_WCHAR:
+	case SQL_C_BINARY:
+		return apdrec->sql_desc_octet_length;
+	case SQL_C_BIT:
+	case SQL_C_STINYINT:
+	case SQL_C_UTINYINT:
+		return (SQLLEN) sizeof(SQLCHAR);
+	case SQL_C_SSHORT:
+	case SQL_C_USHORT:
+		return (SQLLEN) sizeof(SQLSMALLINT);
+	case SQL_C_SLONG:
+	case SQL_C_ULONG:
+		return (SQLLEN) sizeof(SQLINTEGER);
+	case SQL_C_SBIGINT:
+	case SQL_C_UBIGINT:
+		return (SQLLEN) sizeof(SQLBIGINT);
+	case SQL_C_NUMERIC:
+		return (SQLLEN) sizeof(SQL_NUMERIC_STRUCT);
+	case SQL_C_FLOAT:
+		return (SQLLEN) sizeof(SQLREAL);
+	case SQL_C_DOUBLE:
+		return (SQLLEN) sizeof(SQLDOUBLE);
+	case SQL_C_TYPE_DATE:
+		return (SQLLEN) sizeof(SQL_DATE_STRUCT);
+	case SQL_C_TYPE_TIME:
+		return (SQLLEN) sizeof(SQL_TIME_STRUCT);
+	case SQL_C_TYPE_TIMESTAMP:
+		return (SQLLEN) sizeof(SQL_TIMESTAMP_STRUCT);
+	case SQL_C_GUID:
+		return (SQLLEN) sizeof(SQLGUID);
+	default:
+		/* the intervals */
+		return (SQLLEN) sizeof(SQL_INTERVAL_STRUCT);
+	}
+}
+
 SQLRETURN
 ODBCStore(ODBCStmt *stmt,
 	  SQLUSMALLINT param,
@@ -2875,11 +2917,9 @@ ODBCStore(ODBCStmt *stmt,
 
 	bind_type = stmt->ApplParamDescr->sql_desc_bind_type;
 	ptr = apdrec->sql_desc_data_ptr;
-	if (ptr && offset)
-		ptr = (SQLPOINTER) ((char *) ptr + offset + row * (bind_type == SQL_BIND_BY_COLUMN ? (SQLINTEGER) sizeof(SQLPOINTER) : bind_type));
 	strlen_or_ind_ptr = apdrec->sql_desc_indicator_ptr;
-	if (strlen_or_ind_ptr && offset)
-		strlen_or_ind_ptr = (SQLLEN *) ((char *) strlen_or_ind_ptr + offset + row * (bind_type == SQL_BIND_BY_COLUMN ? (SQLINTEGER) sizeof(SQLINTEGER) : bind_type));
+	if (strlen_or_ind_ptr && (offset || row))
+		strlen_or_ind_ptr = (SQLLEN *) ((char *) strlen_or_ind_ptr + offset + row * (bind_type == SQL_BIND_BY_COLUMN ? (SQLINTEGER) sizeof(SQLLEN) : bind_type));
 	if (ptr == NULL &&
 	    (strlen_or_ind_ptr == NULL || *strlen_or_ind_ptr != SQL_NULL_DATA)) {
 		/* COUNT field incorrect */
@@ -2906,6 +2946,10 @@ ODBCStore(ODBCStmt *stmt,
 		break;
 	}
 
+	/* column-wise bound arrays hold elements of the size of the C type */
+	if (ptr && (offset || row))
+		ptr = (SQLPOINTER) ((char *) ptr + offset + row * (bind_type == SQL_BIND_BY_COLUMN ? ODBCElementSize(apdrec, ctype) : bind_type));
+
 	if (strlen_or_ind_ptr != NULL && *strlen_or_ind_ptr == SQL_NULL_DATA) {
 		assigns(buf, bufpos, buflen, "NULL", stmt);
 		*bufp = buf;
@@ -2915,8 +2959,8 @@ ODBCStore(ODBCStmt *stmt,
 	}
 
 	strlen_or_ind_ptr = apdrec->sql_desc_octet_length_ptr;
-	if (strlen_or_ind_ptr && offset)
-		strlen_or_ind_ptr = (SQLLEN *) ((char *) strlen_or_ind_ptr + offset + row * (bind_type == SQL_BIND_BY_COLUMN ? (SQLINTEGER) sizeof(SQLINTEGER) : bind_type));
+	if (strlen_or_ind_ptr && (offset || row))
+		strlen_or_ind_ptr = (SQLLEN *) ((char *) strlen_or_ind_ptr + offset + row * (bind_type == SQL_BIND_BY_COLUMN ? (SQLINTEGER) sizeof(SQLLEN) : bind_type));
 
 	switch (ctype) {
 	case SQL_C_CHAR:
@@ -392,6 +392,120 @@ ODBCInitResult(ODBCStmt *stmt)
 	return SQL_ERROR;
 }
 
+/* Append a parameter value as a field of a record of an EXECUTE ..
+ * FROM STDIN statement.  The value is the SQL literal that ODBCStore
+ * produced: its keyword prefix (DATE, blob, ...) is dropped and the
+ * quoted string is quoted as in a CSV file instead.  Returns -1 if the
+ * literal cannot be a field, i.e. an interval with its qualifier. */
+static int
+ODBCStoreField(const char *lit, size_t len, char **bufp, size_t *bufposp, size_t *buflenp)
+{
+	const char *end = lit + len, *p;
+	char *buf = *bufp;
+	size_t bufpos = *bufposp;
+
+	/* quoting at most doubles the length */
+	if (bufpos + 2 * len + 8 >= *buflenp) {
+		size_t l = *buflenp + 2 * len + 1024;
+
+		if ((buf = realloc(buf, l)) == NULL)
+			return -2;
+		*bufp = buf;
+		*buflenp = l;
+	}
+	if (len == 4 && strncmp(lit, "NULL", 4) == 0) {
+		strcpy(buf + bufpos, "null");
+		*bufposp = bufpos + 4;
+		return 0;
+	}
+	if ((p = memchr(lit, '\'', len)) == NULL) {
+		/* numbers and booleans */
+		memcpy(buf + bufpos, lit, len);
+		*bufposp = bufpos + len;
+		return 0;
+	}
+	buf[bufpos++] = '"';
+	for (p++; p < end; p++) {
+		if (*p == '\\' && p + 1 < end) {
+			/* escapes are the same in CSV files */
+			buf[bufpos++] = *p++;
+			buf[bufpos++] = *p;
+		} else if (*p == '\'') {
+			if (p + 1 < end && p[1] == '\'') {
+				buf[bufpos++] = *p++;
+				continue;
+			}
+			break;
+		} else {
+			if (*p == '"')
+				buf[bufpos++] = '\\';
+			buf[bufpos++] = *p;
+		}
+	}
+	if (p + 1 < end)
+		return -1;
+	buf[bufpos++] = '"';
+	*bufposp = bufpos;
+	return 0;
+}
+
+/* Compose the query for an array of parameter sets: the prepared
+ * query is executed once, with the parameter sets following it as
+ * the records of a COPY INTO, such that the server appends them to
+ * the table in bulk. */
+static char *
+ODBCBatchQuery(ODBCStmt *stmt, SQLLEN offset, SQLULEN *nrowsp)
+{
+	ODBCDesc *desc = stmt->ApplParamDescr;
+	SQLUSMALLINT *operation = desc->sql_desc_array_status_ptr;
+	char *query, *val = NULL;
+	size_t querylen = 1024, querypos, vallen = 0, valpos;
+	SQLULEN row, nrows = 0;
+	int i, r;
+
+	for (row = 0; row < desc->sql_desc_array_size; row++)
+		if (operation == NULL || operation[row] != SQL_PARAM_IGNORE)
+			nrows++;
+	*nrowsp = nrows;
+	if ((query = malloc(querylen)) == NULL) {
+		addStmtError(stmt, "HY001", NULL, 0);
+		return NULL;
+	}
+	querypos = snprintf(query, querylen,
+			    "execute %d from stdin %lu records using delimiters '|','\\n','\"';\n",
+			    stmt->queryid, (unsigned long) nrows);
+	for (row = 0; row < desc->sql_desc_array_size; row++) {
+		if (operation && operation[row] == SQL_PARAM_IGNORE)
+			continue;
+		for (i = 1; i <= stmt->nparams; i++) {
+			valpos = 0;
+			if (ODBCStore(stmt, i, offset, row, &val, &valpos, &vallen, "") == SQL_ERROR) {
+				if (val)
+					free(val);
+				free(query);
+				return NULL;
+			}
+			r = ODBCStoreField(val, valpos, &query, &querypos, &querylen);
+			if (r < 0) {
+				free(val);
+				free(query);
+				if (r == -2) {
+					/* Memory allocation error */
+					addStmtError(stmt, "HY001", NULL, 0);
+				} else {
+					/* Optional feature not implemented */
+					addStmtError(stmt, "HYC00", "Interval parameters cannot be given in arrays", 0);
+				}
+				return NULL;
+			}
+			query[querypos++] = i < stmt->nparams ? '|' : '\n';
+		}
+	}
+	query[querypos] = 0;
+	free(val);
+	return query;
+}
+
 SQLRETURN
 MNDBExecute(ODBCStmt *stmt)
 {
@@ -405,6 +519,7 @@ MNDBExecute(ODBCStmt *stmt)
 	int i;
 	ODBCDesc *desc;
 	SQLLEN offset;
+	SQLULEN nrows = 1;
 
 	/* check statement cursor state, query should be prepared */
 	if (stmt->State == INITED ||
@@ -438,6 +553,16 @@ MNDBExecute(ODBCStmt *stmt)
 		return SQL_ERROR;
 	}
 
+	if (desc->sql_desc_bind_offset_ptr)
+		offset = *desc->sql_desc_bind_offset_ptr;
+	else
+		offset = 0;
+	if (desc->sql_desc_array_size > 1 && stmt->nparams > 0) {
+		if ((query = ODBCBatchQuery(stmt, offset, &nrows)) == NULL)
+			return SQL_ERROR;
+		goto execute;
+	}
+
 	querylen = 1024;
 	query = malloc(querylen); /* XXX allocate space for parameters */
 	if (query == NULL) {
@@ -447,10 +572,6 @@ MNDBExecute(ODBCStmt *stmt)
 	}
 	querypos = snprintf(query, querylen, "execute %d (", stmt->queryid);
 	/* XXX fill in parameter values */
-	if (desc->sql_desc_bind_offset_ptr)
-		offset = *desc->sql_desc_bind_offset_ptr;
-	else
-		offset = 0;
 	sep = "";
 	for (i = 1; i <= stmt->nparams; i++) {
 		if (ODBCStore(stmt, i, offset, 0, &query, &querypos, &querylen, sep) == SQL_ERROR) {
@@ -472,6 +593,7 @@ MNDBExecute(ODBCStmt *stmt)
 	query[querypos++] = ')';
 	query[querypos] = 0;
 
+  execute:
 #ifdef ODBCDEBUG
 	ODBCLOG("SQLExecute %p %s\n", stmt, query);
 #endif
@@ -490,6 +612,19 @@ MNDBExecute(ODBCStmt *stmt)
 	}
 	msg = mapi_query_handle(hdl, query);
 	free(query);
+	if (desc->sql_desc_array_size > 1 && stmt->nparams > 0) {
+		/* the parameter sets are inserted all or none */
+		ODBCDesc *ipd = stmt->ImplParamDescr;
+		SQLULEN row;
+
+		if (ipd->sql_desc_rows_processed_ptr)
+			*ipd->sql_desc_rows_processed_ptr = nrows;
+		if (ipd->sql_desc_array_status_ptr)
+			for (row = 0; row < desc->sql_desc_array_size; row++)
+				ipd->sql_desc_array_status_ptr[row] =
+					desc->sql_desc_array_status_ptr && desc->sql_desc_array_status_ptr[row] == SQL_PARAM_IGNORE ? SQL_PARAM_UNUSED :
+					msg == MOK ? SQL_PARAM_SUCCESS : SQL_PARAM_DIAG_UNAVAILABLE;
+	}
 	switch (msg) {
 	case MOK:
 		break;
@@ -790,8 +790,8 @@ MNDBGetInfo(ODBCDbc *dbc,
 		sValue = "N";	/* "Y" */
 		break;
 	case SQL_PARAM_ARRAY_ROW_COUNTS:
-		nValue = SQL_PARC_BATCH; /* ? */
-		/* SQL_PARC_NO_BATCH */
+		/* arrays of parameters are executed as a single statement */
+		nValue = SQL_PARC_NO_BATCH;
 		break;
 	case SQL_PARAM_ARRAY_SELECTS:
 		nValue = SQL_PAS_NO_SELECT;
@@ -95,6 +95,9 @@
 #include <lz4.h>
 #include <lz4frame.h>
 #endif
+#ifdef HAVE_LIBZSTD
+#include <zstd.h>
+#endif
 
 #ifdef HAVE_ICONV
 #ifdef HAVE_ICONV_H
@@ -2078,6 +2081,297 @@ open_lz4wastream(const char *restrict filename, const char *restrict mode)
 #define open_lz4wastream(filename, mode)	NULL
 #endif
 
+/* ------------------------------------------------------------------ */
+/* streams working on a zstd-compressed disk file */
+
+#ifdef HAVE_LIBZSTD
+static int zstd_level = 0;		/* 0 means ZSTD_CLEVEL_DEFAULT */
+static int zstd_nbworkers = 0;
+
+void
+mnstr_set_zstd_parameters(int level, int nbworkers)
+{
+	zstd_level = level;
+	zstd_nbworkers = nbworkers;
+}
+
+typedef struct zstd_stream {
+	FILE *fp;
+	ZSTD_CCtx *cctx;
+	ZSTD_DCtx *dctx;
+	ZSTD_inBuffer in;	/* compressed data read from fp */
+	char *buf;
+	size_t bufsiz;
+} zstd_stream;
+
+static ssize_t
+stream_zstdread(stream *restrict s, void *restrict buf, size_t elmsize, size_t cnt)
+{
+	zstd_stream *zs = s->stream_data.p;
+	ZSTD_outBuffer out = { buf, elmsize * cnt, 0 };
+	size_t ret;
+
+	if (zs == NULL || out.size == 0) {
+		s->errnr = MNSTR_READ_ERROR;
+		return -1;
+	}
+	while (out.pos < out.size) {
+		if (zs->in.pos == zs->in.size) {
+			if (feof(zs->fp))
+				break;
+			zs->in.size = fread(zs->buf, 1, zs->bufsiz, zs->fp);
+			zs->in.pos = 0;
+			if (ferror(zs->fp)) {
+				s->errnr = MNSTR_READ_ERROR;
+				return -1;
+			}
+			if (zs->in.size == 0)
+				break;
+		}
+		ret = ZSTD_decompressStream(zs->dctx, &out, &zs->in);
+		if (ZSTD_isError(ret)) {
+			s->errnr = MNSTR_READ_ERROR;
+			return -1;
+		}
+	}
+	return (ssize_t) (out.pos / elmsize);
+}
+
+/* compress what is in in, or with mode ZSTD_e_flush or ZSTD_e_end
+ * also everything buffered in the compression context */
+static int
+zstd_compress(zstd_stream *zs, ZSTD_inBuffer *in, ZSTD_EndDirective mode)
+{
+	size_t ret;
+
+	do {
+		ZSTD_outBuffer out = { zs->buf, zs->bufsiz, 0 };
+
+		ret = ZSTD_compressStream2(zs->cctx, &out, in, mode);
+		if (ZSTD_isError(ret))
+			return -1;
+		if (out.pos > 0 && fwrite(zs->buf, 1, out.pos, zs->fp) != out.pos)
+			return -1;
+	} while (mode == ZSTD_e_continue ? in->pos < in->size : ret != 0);
+	return 0;
+}
+
+static ssize_t
+stream_zstdwrite(stream *restrict s, const void *restrict buf, size_t elmsize, size_t cnt)
+{
+	zstd_stream *zs = s->stream_data.p;
+	ZSTD_inBuffer in = { buf, elmsize * cnt, 0 };
+
+	if (zs == NULL) {
+		s->errnr = MNSTR_WRITE_ERROR;
+		return -1;
+	}
+	if (in.size > 0 && zstd_compress(zs, &in, ZSTD_e_continue) < 0) {
+		s->errnr = MNSTR_WRITE_ERROR;
+		return -1;
+	}
+	return (ssize_t) cnt;
+}
+
+static void
+stream_zstdclose(stream *s)
+{
+	zstd_stream *zs = s->stream_data.p;
+
+	if (zs) {
+		if (s->access == ST_WRITE) {
+			ZSTD_inBuffer in = { NULL, 0, 0 };
+			if (zstd_compress(zs, &in, ZSTD_e_end) < 0)
+				s->errnr = MNSTR_WRITE_ERROR;
+			fflush(zs->fp);
+		}
+		fclose(zs->fp);
+		ZSTD_freeCCtx(zs->cctx);
+		ZSTD_freeDCtx(zs->dctx);
+		free(zs->buf);
+		free(zs);
+	}
+	s->stream_data.p = NULL;
+}
+
+static int
+stream_zstdflush(stream *s)
+{
+	zstd_stream *zs = s->stream_data.p;
+
+	if (zs == NULL)
+		return -1;
+	if (s->access == ST_WRITE) {
+		ZSTD_inBuffer in = { NULL, 0, 0 };
+		if (zstd_compress(zs, &in, ZSTD_e_flush) < 0 || fflush(zs->fp))
+			return -1;
+	}
+	return 0;
+}
+
+static stream *
+open_zstdstream(const char *restrict filename, const char *restrict flags)
+{
+	stream *s;
+	zstd_stream *zs;
+	char fl[3];
+
+	if ((zs = calloc(1, sizeof(struct zstd_stream))) == NULL)
+		return NULL;
+	if (flags[0] == 'r') {
+		zs->bufsiz = ZSTD_DStreamInSize();
+		zs->dctx = ZSTD_createDCtx();
+	} else {
+		zs->bufsiz = ZSTD_CStreamOutSize();
+		zs->cctx = ZSTD_createCCtx();
+		if (zs->cctx != NULL) {
+			(void) ZSTD_CCtx_setParameter(zs->cctx, ZSTD_c_compressionLevel, zstd_level);
+			/* fails if the library was built without threads,
+			 * which leaves us compressing in this thread */
+			if (zstd_nbworkers > 1)
+				(void) ZSTD_CCtx_setParameter(zs->cctx, ZSTD_c_nbWorkers, zstd_nbworkers);
+		}
+	}
+	if ((zs->cctx == NULL && zs->dctx == NULL) ||
+	    (zs->buf = malloc(zs->bufsiz)) == NULL) {
+		ZSTD_freeCCtx(zs->cctx);
+		ZSTD_freeDCtx(zs->dctx);
+		free(zs);
+		return NULL;
+	}
+	zs->in.src = zs->buf;
+	if ((s = create_stream(filename)) == NULL) {
+		ZSTD_freeCCtx(zs->cctx);
+		ZSTD_freeDCtx(zs->dctx);
+		free(zs->buf);
+		free(zs);
+		return NULL;
+	}
+	fl[0] = flags[0];	/* 'r' or 'w' */
+	fl[1] = 'b';		/* always binary */
+	fl[2] = '\0';
+#ifdef HAVE__WFOPEN
+	{
+		wchar_t *wfname = utf8towchar(filename);
+		wchar_t *wflags = utf8towchar(fl);
+		if (wfname != NULL)
+			zs->fp = _wfopen(wfname, wflags);
+		else
+			zs->fp = NULL;
+		if (wfname)
+			free(wfname);
+		if (wflags)
+			free(wflags);
+	}
+#else
+	{
+		char *fname = cvfilename(filename);
+		if (fname) {
+			zs->fp = fopen(fname, fl);
+			free(fname);
+		} else
+			zs->fp = NULL;
+	}
+#endif
+	if (zs->fp == NULL) {
+		destroy(s);
+		ZSTD_freeCCtx(zs->cctx);
+		ZSTD_freeDCtx(zs->dctx);
+		free(zs->buf);
+		free(zs);
+		return NULL;
+	}
+	s->read = stream_zstdread;
+	s->write = stream_zstdwrite;
+	s->close = stream_zstdclose;
+	s->flush = stream_zstdflush;
+	s->stream_data.p = (void *) zs;
+	if (flags[0] == 'r' && flags[1] != 'b') {
+		char buf[UTF8BOMLENGTH];
+		if (stream_zstdread(s, buf, 1, UTF8BOMLENGTH) == UTF8BOMLENGTH &&
+		    strncmp(buf, UTF8BOM, UTF8BOMLENGTH) == 0) {
+			s->isutf8 = 1;
+		} else {
+			rewind(zs->fp);
+			zs->in.pos = zs->in.size = 0;
+			(void) ZSTD_DCtx_reset(zs->dctx, ZSTD_reset_session_only);
+			mnstr_clearerr(s);
+		}
+	}
+	return s;
+}
+
+static stream *
+open_zstdrstream(const char *filename)
+{
+	stream *s;
+
+	if ((s = open_zstdstream(filename, "rb")) == NULL)
+		return NULL;
+	s->type = ST_BIN;
+	if (s->errnr == MNSTR_NO__ERROR &&
+	    stream_zstdread(s, (void *) &s->byteorder, sizeof(s->byteorder), 1) < 1) {
+		stream_zstdclose(s);
+		destroy(s);
+		return NULL;
+	}
+	return s;
+}
+
+static stream *
+open_zstdwstream(const char *restrict filename, const char *restrict mode)
+{
+	stream *s;
+
+	if ((s = open_zstdstream(filename, mode)) == NULL)
+		return NULL;
+	s->access = ST_WRITE;
+	s->type = ST_BIN;
+	if (s->errnr == MNSTR_NO__ERROR &&
+	    stream_zstdwrite(s, (void *) &s->byteorder, sizeof(s->byteorder), 1) < 1) {
+		stream_zstdclose(s);
+		destroy(s);
+		return NULL;
+	}
+	return s;
+}
+
+static stream *
+open_zstdrastream(const char *filename)
+{
+	stream *s;
+
+	if ((s = open_zstdstream(filename, "r")) == NULL)
+		return NULL;
+	s->type = ST_ASCII;
+	return s;
+}
+
+static stream *
+open_zstdwastream(const char *restrict filename, const char *restrict mode)
+{
+	stream *s;
+
+	if ((s = open_zstdstream(filename, mode)) == NULL)
+		return NULL;
+	s->access = ST_WRITE;
+	s->type = ST_ASCII;
+	return s;
+}
+#else
+void
+mnstr_set_zstd_parameters(int level, int nbworkers)
+{
+	(void) level;
+	(void) nbworkers;
+}
+
+#define open_zstdrstream(filename)	NULL
+#define open_zstdwstream(filename, mode)	NULL
+#define open_zstdrastream(filename)	NULL
+#define open_zstdwastream(filename, mode)	NULL
+#endif
+
 /* ------------------------------------------------------------------ */
 /* streams working on a disk file, compressed or not */
 
@@ -2102,6 +2396,8 @@ open_rstream(const char *filename)
 		return open_xzrstream(filename);
 	if (strcmp(ext, "lz4") == 0)
 		return open_lz4rstream(filename);
+	if (strcmp(ext, "zst") == 0)
+		return open_zstdrstream(filename);
 
 	if ((s = open_stream(filename, "rb")) == NULL)
 		return NULL;
@@ -2139,6 +2435,8 @@ open_wstream(const char *filename)
 		return open_xzwstream(filename, "wb");
 	if (strcmp(ext, "lz4") == 0)
 		return open_lz4wstream(filename, "wb");
+	if (strcmp(ext, "zst") == 0)
+		return open_zstdwstream(filename, "wb");
 
 	if ((s = open_stream(filename, "wb")) == NULL)
 		return NULL;
@@ -2176,6 +2474,8 @@ open_rastream(const char *filename)
 		return open_xzrastream(filename);
 	if (strcmp(ext, "lz4") == 0)
 		return open_lz4rastream(filename);
+	if (strcmp(ext, "zst") == 0)
+		return open_zstdrastream(filename);
 
 	if ((s = open_stream(filename, "r")) == NULL)
 		return NULL;
@@ -2204,6 +2504,8 @@ open_wastream(const char *filename)
 		return open_xzwastream(filename, "w");
 	if (strcmp(ext, "lz4") == 0)
 		return open_lz4wastream(filename, "w");
+	if (strcmp(ext, "zst") == 0)
+		return open_zstdwastream(filename, "w");
 
 	if ((s = open_stream(filename, "w")) == NULL)
 		return NULL;
@@ -4167,9 +4469,14 @@ typedef struct bs2 {
 	size_t readpos;
 	compression_method comp;
 	column_compression colcomp;
+	int complevel;
 	char *compbuf;
 	size_t compbufsiz;
 	char *buf;
+#ifdef HAVE_LIBZSTD
+	ZSTD_CCtx *zcctx;
+	ZSTD_DCtx *zdctx;
+#endif
 } bs2;
 
 
@@ -4201,6 +4508,23 @@ compress_stream_data(bs2 *s)
 #else
 		assert(0);
 		return -1;
+#endif
+	} else if (s->comp == COMPRESSION_ZSTD) {
+#ifdef HAVE_LIBZSTD
+		size_t compressed_length;
+		if (s->zcctx == NULL && (s->zcctx = ZSTD_createCCtx()) == NULL) {
+			s->s->errnr = -1;
+			return -1;
+		}
+		compressed_length = ZSTD_compressCCtx(s->zcctx, s->compbuf, s->compbufsiz, s->buf, s->nr, s->complevel);
+		if (ZSTD_isError(compressed_length)) {
+			s->s->errnr = -1;
+			return -1;
+		}
+		return (ssize_t) compressed_length;
+#else
+		assert(0);
+		return -1;
 #endif
 	}
 	return -1;
@@ -4235,6 +4559,23 @@ decompress_stream_data(bs2 *s)
 #else
 		assert(0);
 		return -1;
+#endif
+	} else if (s->comp == COMPRESSION_ZSTD) {
+#ifdef HAVE_LIBZSTD
+		size_t uncompressed_length;
+		if (s->zdctx == NULL && (s->zdctx = ZSTD_createDCtx()) == NULL) {
+			s->s->errnr = -1;
+			return -1;
+		}
+		uncompressed_length = ZSTD_decompressDCtx(s->zdctx, s->buf, s->bufsiz, s->compbuf, s->itotal);
+		if (ZSTD_isError(uncompressed_length)) {
+			s->s->errnr = -1;
+			return -1;
+		}
+		return (ssize_t) uncompressed_length;
+#else
+		assert(0);
+		return -1;
 #endif
 	}
 	return -1;
@@ -4256,6 +4597,12 @@ compression_size_bound(bs2 *s)
 		return -1;
 #else
 		return LZ4_compressBound(s->bufsiz);
+#endif
+	} else if (s->comp == COMPRESSION_ZSTD) {
+#ifndef HAVE_LIBZSTD
+		return -1;
+#else
+		return (ssize_t) ZSTD_compressBound(s->bufsiz);
 #endif
 	}
 	return -1;
@@ -4280,7 +4627,12 @@ bs2_create(stream *s, size_t bufsiz, compression_method comp)
 	ns->itotal = 0;
 	ns->bufsiz = bufsiz;
 	ns->comp = comp;
+	ns->complevel = 0;
 	ns->compbuf = NULL;
+#ifdef HAVE_LIBZSTD
+	ns->zcctx = NULL;
+	ns->zdctx = NULL;
+#endif
 
 	compress_bound = compression_size_bound(ns);
 	if (compress_bound > 0) {
@@ -4717,6 +5069,15 @@ bs2_colcomp(stream *ss)
 	return s->colcomp;
 }
 
+/* set the compression level of COMPRESSION_ZSTD blocks, 0 is the
+ * zstd default */
+void
+bs2_setcomplevel(stream *ss, int level)
+{
+	bs2 *s = (bs2 *) ss->stream_data.p;
+	s->complevel = level;
+}
+
 int
 isa_block_stream(stream *s)
 {
@@ -4764,6 +5125,10 @@ bs2_destroy(stream *ss)
 			free(s->buf);
 		if (s->compbuf)
 			free(s->compbuf);
+#ifdef HAVE_LIBZSTD
+		ZSTD_freeCCtx(s->zcctx);
+		ZSTD_freeDCtx(s->zdctx);
+#endif
 		free(s);
 	}
 	destroy(ss);
@@ -161,6 +161,10 @@ stream_export stream *open_rastream(const char *filename);
 /* open in ascii stream in write mode*/
 stream_export stream *open_wastream(const char *filename);
 
+/* compression level and number of worker threads used when writing
+ * zstd compressed (.zst) files; a level of 0 selects the zstd default */
+stream_export void mnstr_set_zstd_parameters(int level, int nbworkers);
+
 stream_export void close_stream(stream *s);
 
 stream_export stream *open_urlstream(const char *url);
@@ -229,6 +233,7 @@ typedef enum {
 	COMPRESSION_NONE = 0,
 	COMPRESSION_SNAPPY = 1,
 	COMPRESSION_LZ4 = 2,
+	COMPRESSION_ZSTD = 3,
 	COMPRESSION_AUTO = 255
 } compression_method;
 
@@ -237,6 +242,23 @@ typedef enum {
 	COLUMN_COMPRESSION_AUTO = 255
 } column_compression;
 
+/* With COLUMN_COMPRESSION_AUTO, every column of a protocol 10 result
+ * chunk starts with the header
+ *     [lng length][bte encoding][bte has_nulls][bte width][bte 0][int count]
+ * where length counts the bytes after the length itself.  If has_nulls
+ * is set, a bitmap of the NULL rows (padded to eight bytes) follows.
+ * The values follow in one of these encodings, where only the non-NULL
+ * rows are bit packed, least significant bit first, in 64 bit words: */
+typedef enum {
+	COLUMN_ENCODING_PLAIN = 0,	/* the unencoded protocol 10 column */
+	COLUMN_ENCODING_FOR = 1,	/* [lng reference] and count integers of
+								 * width bits added to it */
+	COLUMN_ENCODING_DELTA = 2,	/* [lng first] [lng min_delta] and count-1
+								 * deltas of width bits added to min_delta */
+	COLUMN_ENCODING_DICT = 3	/* count strings padded to eight bytes, and
+								 * indices of width bits into them */
+} column_encoding;
+
 stream_export stream *block_stream2(stream *s, size_t bufsiz, compression_method comp, column_compression colcomp);
 stream_export void *bs2_stealbuf(stream *ss);
 stream_export int bs2_resizebuf(stream *ss, size_t bufsiz);
@@ -244,6 +266,7 @@ stream_export void bs2_resetbuf(stream *ss);
 stream_export buffer bs2_buffer(stream *s);
 stream_export column_compression bs2_colcomp(stream *ss);
 stream_export void bs2_setpos(stream *ss, size_t pos);
+stream_export void bs2_setcomplevel(stream *ss, int level);
 
 
 /* read block of data including the end of block marker */
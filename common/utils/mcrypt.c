@@ -60,6 +60,11 @@ mcrypt_getHashAlgorithms(void)
 #ifdef HAVE_LIBLZ4
 		",COMPRESSION_LZ4"
 #endif
+#ifdef HAVE_LIBZSTD
+		",COMPRESSION_ZSTD"
+#endif
+		",RESULT_ARROW"
+		",COLUMN_ENCODING"
 		;
 	return algorithms;
 }
@@ -1836,9 +1836,14 @@ gdk_export ptr ATOMdup(int id, const void *val);
  *
  * The routine BAThash makes sure that a hash accelerator on the tail of the
  * BAT exists. GDK_FAIL is returned upon failure to create the supportive
- * structures.
+ * structures.  The hash of a persistent BAT is persisted once the BAT
+ * is committed, and BAThashpersisted tells whether the copy on disk is
+ * up to date.  BATcheckhash tells whether the BAT has a hash, loading
+ * a persisted one if needed.
  */
 gdk_export gdk_return BAThash(BAT *b, BUN masksize);
+gdk_export bool BAThashpersisted(BAT *b);
+gdk_export bool BATcheckhash(BAT *b);
 
 /*
  * @- Column Imprints Functions
@@ -1908,6 +1913,7 @@ gdk_export void *GDKmmap(const char *path, int mode, size_t len);
 gdk_export size_t GDK_mem_maxsize;	/* max allowed size of committed memory */
 gdk_export size_t GDK_vm_maxsize;	/* max allowed size of reserved vm */
 gdk_export int	GDK_vm_trim;		/* allow trimming */
+gdk_export int	GDK_shared_scans;	/* share concurrent scan selects */
 
 gdk_export size_t GDKmem_cursize(void);	/* RAM/swapmem that MonetDB has claimed from OS */
 gdk_export size_t GDKvm_cursize(void);	/* current MonetDB VM address space usage */
@@ -2782,6 +2788,80 @@ gdk_export gdk_return BATfirstn(BAT **topn, BAT **gids, BAT *b, BAT *cands, BAT
  */
 gdk_export BAT *BATsample(BAT *b, BUN n);
 
+/*
+ * @- Distinct value sketches
+ *
+ * @multitable @columnfractions 0.08 0.7
+ * @item gdk_return
+ * @tab BATsketch (bte *registers, BAT *b, BAT *s)
+ * @item dbl
+ * @tab HLLestimate (const bte *registers)
+ * @end multitable
+ *
+ * BATsketch folds the non-nil values of b (restricted to candidate
+ * list s) into an array of HLL_REGISTERS HyperLogLog registers, which
+ * the caller must have zero-initialized before the first call.
+ * HLLestimate returns the estimated number of distinct values seen,
+ * with a standard error of about 1.04/sqrt(HLL_REGISTERS).  HLLmerge
+ * combines two sketches.
+ *
+ * The grouped aggregates BATgroupapproxcountdistinct,
+ * BATgroupapproxquantile and BATgroupapproxmedian (see gdk_calc.h)
+ * use such sketches per group to approximate COUNT(DISTINCT) and
+ * quantiles without sorting or grouping on the values.
+ */
+#define HLL_PRECISION	10
+#define HLL_REGISTERS	(1 << HLL_PRECISION)
+
+gdk_export gdk_return BATsketch(bte *registers, BAT *b, BAT *s);
+gdk_export void HLLadd(bte *registers, BUN hash);
+gdk_export void HLLmerge(bte *dst, const bte *src);
+gdk_export dbl HLLestimate(const bte *registers);
+
+/*
+ * @- Window aggregates
+ *
+ * @multitable @columnfractions 0.08 0.7
+ * @item BAT *
+ * @tab BATwindowbound (BAT *b, BAT *p, BAT *o, int unit, int kind, int end, int desc, const void *offset)
+ * @item BAT *
+ * @tab BATwindowsum (BAT *b, BAT *s, BAT *e, int tp)
+ * @item BAT *
+ * @tab BATwindowshift (BAT *b, BAT *p, lng offset, const void *dflt)
+ * @end multitable
+ *
+ * The inputs are sorted on their partition and order keys.  p and o
+ * are set on the rows that start a new partition resp. a new group of
+ * peers (rows with equal order keys), and may be NULL if there is a
+ * single partition resp. no ordering.  BATwindowbound returns for
+ * each row the position of the first row of its frame (end == 0) or
+ * of the row following the last one (end != 0), where kind is one of
+ * the WINDOW_* bounds below, counted in rows or, for RANGE frames, in
+ * peers or ordering values (the values of b, in descending order if
+ * desc is set).  offset points to a lng for ROWS frames and to a
+ * value of the type of b for RANGE frames.  The aggregates take the
+ * start and end positions produced by BATwindowbound and skip nils.
+ * BATwindowshift returns the value offset rows away from each row in
+ * its partition, or dflt if that row does not exist.
+ */
+#define WINDOW_ROWS		0
+#define WINDOW_RANGE		1
+
+#define WINDOW_UNBOUNDED	0
+#define WINDOW_CURRENT		1
+#define WINDOW_PRECEDING	2
+#define WINDOW_FOLLOWING	3
+
+gdk_export BAT *BATwindowbound(BAT *b, BAT *p, BAT *o, int unit, int kind, int end, int desc, const void *offset);
+gdk_export BAT *BATwindowcount(BAT *b, BAT *s, BAT *e);
+gdk_export BAT *BATwindowsum(BAT *b, BAT *s, BAT *e, int tp);
+gdk_export BAT *BATwindowavg(BAT *b, BAT *s, BAT *e);
+gdk_export BAT *BATwindowmin(BAT *b, BAT *s, BAT *e);
+gdk_export BAT *BATwindowmax(BAT *b, BAT *s, BAT *e);
+gdk_export BAT *BATwindowfirst(BAT *b, BAT *s, BAT *e);
+gdk_export BAT *BATwindowlast(BAT *b, BAT *s, BAT *e);
+gdk_export BAT *BATwindowshift(BAT *b, BAT *p, lng offset, const void *dflt);
+
 /*
  *
  */
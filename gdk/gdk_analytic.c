@@ -0,0 +1,1090 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+/*
+ * @* Window aggregates
+ *
+ * The SQL window functions evaluate an aggregate over a frame of rows
+ * around each row of a BAT that is sorted on its partition and order
+ * keys.  BATwindowbound computes the position of the first row of
+ * the frame (or of the row following the last one) for each row,
+ * from the partition boundaries, the peer group boundaries and, for
+ * RANGE frames with an offset, the ordering values themselves.  The
+ * aggregates are then computed from the resulting pairs of bounds.
+ *
+ * Frame bounds never decrease from one row to the next, which the
+ * aggregates exploit.  Counts use prefix sums, O(1) per row.  Integer
+ * sums keep a running sum which is updated with the rows entering and
+ * leaving the frame, O(1) amortized per row.  Floating point sums,
+ * which cannot subtract the rows leaving the frame without losing
+ * precision, and minimums and maximums use a segment tree, O(log n)
+ * per row, except for frames that only grow at their end, which
+ * update a running aggregate.
+ *
+ * Large inputs are cut into slices which are processed by separate
+ * threads.  Slices of the bound computation are aligned with the
+ * partitions, the aggregates can be cut anywhere.
+ */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+#include "gdk_calc_private.h"
+
+/* inputs smaller than this are not worth spreading over threads */
+#define WINDOW_SLICE	((BUN) 1 << 16)
+
+typedef BUN (*window_work)(void *arg, BUN lo, BUN hi);
+
+struct window_slice {
+	window_work work;
+	void *arg;
+	BUN lo, hi;
+	BUN nils;
+	MT_Id tid;
+};
+
+static void
+window_slice_run(void *arg)
+{
+	struct window_slice *s = arg;
+
+	s->nils = (*s->work)(s->arg, s->lo, s->hi);
+}
+
+/* Run work over the rows [0, n), in parallel if n is large enough.
+ * If p is not NULL, the slices start at a row where p is set (the
+ * start of a partition).  Returns the total number of nils produced,
+ * or BUN_NONE if any slice failed. */
+static BUN
+window_parallel(BUN n, const bit *p, window_work work, void *arg)
+{
+	struct window_slice *slices;
+	int nslices = GDKnr_threads, i, j;
+	BUN lo, hi, nils = 0;
+
+	if (nslices > 1 && n / WINDOW_SLICE < (BUN) nslices)
+		nslices = (int) (n / WINDOW_SLICE);
+	if (nslices <= 1)
+		return (*work)(arg, 0, n);
+	if ((slices = GDKzalloc(nslices * sizeof(struct window_slice))) == NULL)
+		return (*work)(arg, 0, n);
+	for (i = j = 0, lo = 0; i < nslices && lo < n; i++) {
+		hi = i == nslices - 1 ? n : (BUN) ((lng) n * (i + 1) / nslices);
+		if (hi <= lo)
+			continue;
+		if (p)
+			while (hi < n && !p[hi])
+				hi++;
+		slices[j].work = work;
+		slices[j].arg = arg;
+		slices[j].lo = lo;
+		slices[j].hi = hi;
+		j++;
+		lo = hi;
+	}
+	nslices = j;
+	/* the first slice is processed by the calling thread, slices
+	 * for which no thread can be started as well */
+	for (i = 1; i < nslices; i++)
+		if (MT_create_thread(&slices[i].tid, window_slice_run, &slices[i], MT_THR_JOINABLE) < 0)
+			slices[i].work = NULL;
+	window_slice_run(&slices[0]);
+	for (i = 1; i < nslices; i++) {
+		if (slices[i].work == NULL) {
+			slices[i].work = work;
+			window_slice_run(&slices[i]);
+		} else {
+			MT_join_thread(slices[i].tid);
+		}
+	}
+	for (i = 0; i < nslices; i++) {
+		if (slices[i].nils == BUN_NONE) {
+			nils = BUN_NONE;
+			break;
+		}
+		nils += slices[i].nils;
+	}
+	GDKfree(slices);
+	return nils;
+}
+
+static BAT *
+window_result(BAT *bn, BUN n, BUN nils)
+{
+	if (nils == BUN_NONE) {
+		BBPreclaim(bn);
+		return NULL;
+	}
+	BATsetcount(bn, n);
+	bn->tsorted = bn->trevsorted = n <= 1;
+	bn->tkey = n <= 1;
+	bn->tnil = nils > 0;
+	bn->tnonil = nils == 0;
+	return bn;
+}
+
+/* the (clamped) frame [*s, *e) of row i */
+#define FRAME(i)							\
+	do {								\
+		s = start[i] < 0 ? 0 : start[i] > (lng) n ? n : (BUN) start[i]; \
+		e = end[i] < (lng) s ? s : end[i] > (lng) n ? n : (BUN) end[i]; \
+	} while (0)
+
+/*
+ * Frame bounds
+ */
+
+struct window_bound {
+	BAT *b;
+	const bit *p, *o;
+	int unit, kind, end, desc;
+	lng rows;
+	dbl range;
+	lng *res;
+};
+
+/* the ordering value of row i as a double */
+static inline dbl
+window_value(BAT *b, BUN i, int tpe, int *isnil)
+{
+	const void *v = Tloc(b, i);
+
+	switch (tpe) {
+	case TYPE_bte:
+		*isnil = is_bte_nil(*(const bte *) v);
+		return (dbl) *(const bte *) v;
+	case TYPE_sht:
+		*isnil = is_sht_nil(*(const sht *) v);
+		return (dbl) *(const sht *) v;
+	case TYPE_int:
+		*isnil = is_int_nil(*(const int *) v);
+		return (dbl) *(const int *) v;
+	case TYPE_lng:
+		*isnil = is_lng_nil(*(const lng *) v);
+		return (dbl) *(const lng *) v;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		*isnil = is_hge_nil(*(const hge *) v);
+		return (dbl) *(const hge *) v;
+#endif
+	case TYPE_flt:
+		*isnil = is_flt_nil(*(const flt *) v);
+		return (dbl) *(const flt *) v;
+	default:
+		*isnil = is_dbl_nil(*(const dbl *) v);
+		return *(const dbl *) v;
+	}
+}
+
+/* bounds of the frames of the rows in partition [ps, pe) */
+static void
+window_bound_partition(struct window_bound *w, BUN ps, BUN pe)
+{
+	lng *restrict res = w->res;
+	BUN i, j, k;
+
+	switch (w->kind) {
+	case WINDOW_UNBOUNDED:
+		for (i = ps; i < pe; i++)
+			res[i] = w->end ? (lng) pe : (lng) ps;
+		return;
+	case WINDOW_CURRENT:
+		if (w->unit == WINDOW_ROWS) {
+			for (i = ps; i < pe; i++)
+				res[i] = w->end ? (lng) i + 1 : (lng) i;
+			return;
+		}
+		/* the peers of the current row */
+		for (i = ps; i < pe; i = j) {
+			for (j = i + 1; j < pe && !(w->o && w->o[j]); j++)
+				;
+			for (k = i; k < j; k++)
+				res[k] = w->end ? (lng) j : (lng) i;
+		}
+		return;
+	}
+	if (w->unit == WINDOW_ROWS) {
+		lng k = w->kind == WINDOW_PRECEDING ? -w->rows : w->rows;
+
+		for (i = ps; i < pe; i++) {
+			lng t = (lng) i + k + (w->end != 0);
+
+			res[i] = t < (lng) ps ? (lng) ps : t > (lng) pe ? (lng) pe : t;
+		}
+		return;
+	} else {
+		/* RANGE with an offset: the nils are peers of each other
+		 * and sort together at one end of the partition, the
+		 * other rows have their frame limited by the value
+		 * offset from their own value, which moves in the
+		 * direction of the ordering, so a single pointer into
+		 * the partition suffices */
+		int tpe = ATOMbasetype(w->b->ttype), isnil;
+		BUN vs = ps, ve = pe;	/* the non-nil rows */
+		int up = (w->kind == WINDOW_FOLLOWING) != (w->desc != 0);
+		dbl v, lim, x;
+
+		for (i = ps; i < pe; i++) {
+			(void) window_value(w->b, i, tpe, &isnil);
+			if (!isnil)
+				break;
+		}
+		if (i > ps) {
+			/* leading nils */
+			for (j = ps; j < i; j++)
+				res[j] = w->end ? (lng) i : (lng) ps;
+			vs = i;
+		} else {
+			for (i = pe; i > ps; i--) {
+				(void) window_value(w->b, i - 1, tpe, &isnil);
+				if (!isnil)
+					break;
+			}
+			for (j = i; j < pe; j++)
+				res[j] = w->end ? (lng) pe : (lng) i;
+			ve = i;
+		}
+		for (i = j = vs; i < ve; i++) {
+			v = window_value(w->b, i, tpe, &isnil);
+			lim = up ? v + w->range : v - w->range;
+			/* advance j to the first row that is not
+			 * before the frame (start bound) or is after
+			 * the frame (end bound) */
+			while (j < ve) {
+				x = window_value(w->b, j, tpe, &isnil);
+				if (w->desc ? (w->end ? x >= lim : x > lim) : (w->end ? x <= lim : x < lim))
+					j++;
+				else
+					break;
+			}
+			res[i] = (lng) j;
+		}
+	}
+}
+
+static BUN
+window_bound_slice(void *arg, BUN lo, BUN hi)
+{
+	struct window_bound *w = arg;
+	BUN ps, pe;
+
+	for (ps = lo; ps < hi; ps = pe) {
+		for (pe = ps + 1; pe < hi && !(w->p && w->p[pe]); pe++)
+			;
+		window_bound_partition(w, ps, pe);
+	}
+	return 0;
+}
+
+BAT *
+BATwindowbound(BAT *b, BAT *p, BAT *o, int unit, int kind, int end, int desc, const void *offset)
+{
+	struct window_bound w;
+	BUN n = BATcount(b);
+	BAT *bn;
+
+	if ((p && BATcount(p) != n) || (o && BATcount(o) != n)) {
+		GDKerror("BATwindowbound: inputs not aligned\n");
+		return NULL;
+	}
+	w = (struct window_bound) {
+		.b = b,
+		.p = p ? (const bit *) Tloc(p, 0) : NULL,
+		.o = o ? (const bit *) Tloc(o, 0) : NULL,
+		.unit = unit,
+		.kind = kind,
+		.end = end,
+		.desc = desc,
+	};
+	if (kind == WINDOW_PRECEDING || kind == WINDOW_FOLLOWING) {
+		if (unit == WINDOW_ROWS) {
+			w.rows = *(const lng *) offset;
+			if (is_lng_nil(w.rows) || w.rows < 0) {
+				GDKerror("BATwindowbound: frame offset must be a non-negative number\n");
+				return NULL;
+			}
+		} else {
+			int isnil;
+
+			switch (ATOMbasetype(b->ttype)) {
+			case TYPE_bte:
+			case TYPE_sht:
+			case TYPE_int:
+			case TYPE_lng:
+#ifdef HAVE_HGE
+			case TYPE_hge:
+#endif
+			case TYPE_flt:
+			case TYPE_dbl:
+				break;
+			default:
+				GDKerror("BATwindowbound: RANGE offsets need a numeric ordering\n");
+				return NULL;
+			}
+			/* the offset has the type of the ordering values */
+			switch (ATOMbasetype(b->ttype)) {
+			case TYPE_bte:
+				w.range = *(const bte *) offset;
+				isnil = is_bte_nil(*(const bte *) offset);
+				break;
+			case TYPE_sht:
+				w.range = *(const sht *) offset;
+				isnil = is_sht_nil(*(const sht *) offset);
+				break;
+			case TYPE_int:
+				w.range = *(const int *) offset;
+				isnil = is_int_nil(*(const int *) offset);
+				break;
+			case TYPE_lng:
+				w.range = (dbl) *(const lng *) offset;
+				isnil = is_lng_nil(*(const lng *) offset);
+				break;
+#ifdef HAVE_HGE
+			case TYPE_hge:
+				w.range = (dbl) *(const hge *) offset;
+				isnil = is_hge_nil(*(const hge *) offset);
+				break;
+#endif
+			case TYPE_flt:
+				w.range = *(const flt *) offset;
+				isnil = is_flt_nil(*(const flt *) offset);
+				break;
+			default:
+				w.range = *(const dbl *) offset;
+				isnil = is_dbl_nil(*(const dbl *) offset);
+				break;
+			}
+			if (isnil || w.range < 0) {
+				GDKerror("BATwindowbound: frame offset must be a non-negative number\n");
+				return NULL;
+			}
+		}
+	}
+	if ((bn = COLnew(b->hseqbase, TYPE_lng, n, TRANSIENT)) == NULL)
+		return NULL;
+	w.res = (lng *) Tloc(bn, 0);
+	/* the partitions are processed in parallel, a single partition
+	 * in one go */
+	if (w.p)
+		(void) window_parallel(n, w.p, window_bound_slice, &w);
+	else
+		(void) window_bound_slice(&w, 0, n);
+	BATsetcount(bn, n);
+	/* bounds never decrease */
+	bn->tsorted = 1;
+	bn->trevsorted = n <= 1;
+	bn->tkey = n <= 1;
+	bn->tnil = 0;
+	bn->tnonil = 1;
+	return bn;
+}
+
+/*
+ * Count of the non-nil values using prefix sums
+ */
+
+struct window_count {
+	const lng *start, *end;
+	const lng *pre;		/* number of non-nils before each row */
+	BUN n;
+	lng *res;
+};
+
+static BUN
+window_count_slice(void *arg, BUN lo, BUN hi)
+{
+	struct window_count *w = arg;
+	const lng *start = w->start, *end = w->end;
+	BUN i, s, e, n = w->n;
+
+	for (i = lo; i < hi; i++) {
+		FRAME(i);
+		w->res[i] = w->pre ? w->pre[e] - w->pre[s] : (lng) (e - s);
+	}
+	return 0;
+}
+
+BAT *
+BATwindowcount(BAT *b, BAT *s, BAT *e)
+{
+	struct window_count w;
+	BUN n = BATcount(b), i;
+	lng *pre = NULL;
+	BAT *bn;
+
+	if (BATcount(s) != n || BATcount(e) != n) {
+		GDKerror("BATwindowcount: inputs not aligned\n");
+		return NULL;
+	}
+	if (!b->tnonil && b->ttype != TYPE_void) {
+		const void *nil = ATOMnilptr(b->ttype);
+		int (*cmp)(const void *, const void *) = ATOMcompare(b->ttype);
+		BATiter bi = bat_iterator(b);
+
+		if ((pre = GDKmalloc((n + 1) * sizeof(lng))) == NULL)
+			return NULL;
+		pre[0] = 0;
+		for (i = 0; i < n; i++)
+			pre[i + 1] = pre[i] + ((*cmp)(BUNtail(bi, i), nil) != 0);
+	}
+	if ((bn = COLnew(b->hseqbase, TYPE_lng, n, TRANSIENT)) == NULL) {
+		GDKfree(pre);
+		return NULL;
+	}
+	w = (struct window_count) {
+		.start = (const lng *) Tloc(s, 0),
+		.end = (const lng *) Tloc(e, 0),
+		.pre = pre,
+		.n = n,
+		.res = (lng *) Tloc(bn, 0),
+	};
+	(void) window_parallel(n, NULL, window_count_slice, &w);
+	GDKfree(pre);
+	return window_result(bn, n, 0);
+}
+
+/*
+ * Sums: a running sum for integers, a segment tree for floating
+ * point values
+ */
+
+struct window_sum {
+	BAT *b;
+	const lng *start, *end;
+	const dbl *tree;	/* floating point sums of nodes */
+	const lng *pre;		/* number of non-nils before each row */
+	BUN n;
+	void *res;
+	int tp;
+};
+
+/* integer sums: rows are removed from and added to the running sum of
+ * the previous frame, which is recomputed when the frames do not
+ * overlap */
+#define WINDOW_SUM_INT(TPE1, TPE2)					\
+	do {								\
+		const TPE1 *restrict vals = (const TPE1 *) Tloc(w->b, 0); \
+		TPE2 *restrict rb = (TPE2 *) w->res;			\
+		TPE2 sum = 0;						\
+		BUN cs = 0, ce = 0, cnt = 0;				\
+		for (i = lo; i < hi; i++) {				\
+			FRAME(i);					\
+			if (s < cs || e < ce || s > ce) {		\
+				cs = ce = s;				\
+				sum = 0;				\
+				cnt = 0;				\
+			}						\
+			for (; cs < s; cs++) {				\
+				if (!is_##TPE1##_nil(vals[cs])) {	\
+					SUBI_WITH_CHECK(TPE2, sum, TPE1, vals[cs], TPE2, sum, GDK_##TPE2##_max, goto overflow); \
+					cnt--;				\
+				}					\
+			}						\
+			for (; ce < e; ce++) {				\
+				if (!is_##TPE1##_nil(vals[ce])) {	\
+					ADDI_WITH_CHECK(TPE1, vals[ce], TPE2, sum, TPE2, sum, GDK_##TPE2##_max, goto overflow); \
+					cnt++;				\
+				}					\
+			}						\
+			if (cnt == 0) {					\
+				rb[i] = TPE2##_nil;			\
+				nils++;					\
+			} else {					\
+				rb[i] = sum;				\
+			}						\
+		}							\
+	} while (0)
+
+static inline dbl
+window_tree_sum(const dbl *tree, BUN n, BUN l, BUN r)
+{
+	dbl sum = 0;
+
+	for (l += n, r += n; l < r; l >>= 1, r >>= 1) {
+		if (l & 1)
+			sum += tree[l++];
+		if (r & 1)
+			sum += tree[--r];
+	}
+	return sum;
+}
+
+/* floating point sums: a frame which extends the previous one at its
+ * end adds the new rows, any other frame asks the tree */
+#define WINDOW_SUM_FLT(TPE1, TPE2)					\
+	do {								\
+		const TPE1 *restrict vals = (const TPE1 *) Tloc(w->b, 0); \
+		TPE2 *restrict rb = (TPE2 *) w->res;			\
+		dbl sum = 0;						\
+		BUN cs = BUN_NONE, ce = 0;				\
+		for (i = lo; i < hi; i++) {				\
+			FRAME(i);					\
+			if (s == cs && e >= ce) {			\
+				for (; ce < e; ce++)			\
+					if (!is_##TPE1##_nil(vals[ce])) \
+						sum += vals[ce];	\
+			} else {					\
+				sum = window_tree_sum(w->tree, n, s, e); \
+				cs = s;					\
+				ce = e;					\
+			}						\
+			if (w->pre ? w->pre[e] == w->pre[s] : e == s) { \
+				rb[i] = TPE2##_nil;			\
+				nils++;					\
+			} else if (sum > GDK_##TPE2##_max || sum < -GDK_##TPE2##_max) { \
+				goto overflow;				\
+			} else {					\
+				rb[i] = (TPE2) sum;			\
+			}						\
+		}							\
+	} while (0)
+
+static int
+window_sum_supported(int tpe, int tp)
+{
+	switch (tp) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+		switch (tpe) {
+		case TYPE_bte:
+		case TYPE_sht:
+		case TYPE_int:
+		case TYPE_lng:
+#ifdef HAVE_HGE
+		case TYPE_hge:
+#endif
+			return ATOMsize(tpe) <= ATOMsize(tp);
+		}
+		return 0;
+	case TYPE_flt:
+		return tpe == TYPE_flt;
+	case TYPE_dbl:
+		return tpe == TYPE_flt || tpe == TYPE_dbl;
+	}
+	return 0;
+}
+
+/* returns BUN_NONE on overflow */
+static BUN
+window_sum_slice(void *arg, BUN lo, BUN hi)
+{
+	struct window_sum *w = arg;
+	const lng *start = w->start, *end = w->end;
+	BUN i, s, e, n = w->n, nils = 0;
+	int abort_on_error = 1;
+
+	switch (ATOMbasetype(w->tp)) {
+	case TYPE_bte:
+		if (ATOMbasetype(w->b->ttype) == TYPE_bte)
+			WINDOW_SUM_INT(bte, bte);
+		else
+			goto unsupported;
+		break;
+	case TYPE_sht:
+		switch (ATOMbasetype(w->b->ttype)) {
+		case TYPE_bte:
+			WINDOW_SUM_INT(bte, sht);
+			break;
+		case TYPE_sht:
+			WINDOW_SUM_INT(sht, sht);
+			break;
+		default:
+			goto unsupported;
+		}
+		break;
+	case TYPE_int:
+		switch (ATOMbasetype(w->b->ttype)) {
+		case TYPE_bte:
+			WINDOW_SUM_INT(bte, int);
+			break;
+		case TYPE_sht:
+			WINDOW_SUM_INT(sht, int);
+			break;
+		case TYPE_int:
+			WINDOW_SUM_INT(int, int);
+			break;
+		default:
+			goto unsupported;
+		}
+		break;
+	case TYPE_lng:
+		switch (ATOMbasetype(w->b->ttype)) {
+		case TYPE_bte:
+			WINDOW_SUM_INT(bte, lng);
+			break;
+		case TYPE_sht:
+			WINDOW_SUM_INT(sht, lng);
+			break;
+		case TYPE_int:
+			WINDOW_SUM_INT(int, lng);
+			break;
+		case TYPE_lng:
+			WINDOW_SUM_INT(lng, lng);
+			break;
+		default:
+			goto unsupported;
+		}
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		switch (ATOMbasetype(w->b->ttype)) {
+		case TYPE_bte:
+			WINDOW_SUM_INT(bte, hge);
+			break;
+		case TYPE_sht:
+			WINDOW_SUM_INT(sht, hge);
+			break;
+		case TYPE_int:
+			WINDOW_SUM_INT(int, hge);
+			break;
+		case TYPE_lng:
+			WINDOW_SUM_INT(lng, hge);
+			break;
+		case TYPE_hge:
+			WINDOW_SUM_INT(hge, hge);
+			break;
+		default:
+			goto unsupported;
+		}
+		break;
+#endif
+	case TYPE_flt:
+		if (ATOMbasetype(w->b->ttype) == TYPE_flt)
+			WINDOW_SUM_FLT(flt, flt);
+		else
+			goto unsupported;
+		break;
+	case TYPE_dbl:
+		switch (ATOMbasetype(w->b->ttype)) {
+		case TYPE_flt:
+			WINDOW_SUM_FLT(flt, dbl);
+			break;
+		case TYPE_dbl:
+			WINDOW_SUM_FLT(dbl, dbl);
+			break;
+		default:
+			goto unsupported;
+		}
+		break;
+	default:
+		goto unsupported;
+	}
+	return nils;
+  unsupported:
+	assert(0);
+  overflow:
+	return BUN_NONE;
+}
+
+/* bottom-up segment tree: leaf i at n + i, node k sums nodes 2k and
+ * 2k+1 */
+#define WINDOW_TREE_SUM(TPE)						\
+	do {								\
+		const TPE *restrict vals = (const TPE *) Tloc(b, 0);	\
+		for (i = 0; i < n; i++)					\
+			tree[n + i] = is_##TPE##_nil(vals[i]) ? 0 : vals[i]; \
+		for (i = n - 1; i > 0 && i < n; i--)			\
+			tree[i] = tree[2 * i] + tree[2 * i + 1];	\
+	} while (0)
+
+BAT *
+BATwindowsum(BAT *b, BAT *s, BAT *e, int tp)
+{
+	struct window_sum w;
+	BUN n = BATcount(b), i, nils;
+	dbl *tree = NULL;
+	lng *pre = NULL;
+	BAT *bn;
+
+	if (BATcount(s) != n || BATcount(e) != n) {
+		GDKerror("BATwindowsum: inputs not aligned\n");
+		return NULL;
+	}
+	if (!window_sum_supported(ATOMbasetype(b->ttype), ATOMbasetype(tp))) {
+		GDKerror("BATwindowsum: type combination (sum(%s)->%s) not supported.\n",
+			 ATOMname(b->ttype), ATOMname(tp));
+		return NULL;
+	}
+	if (ATOMbasetype(b->ttype) == TYPE_flt || ATOMbasetype(b->ttype) == TYPE_dbl) {
+		if ((tree = GDKmalloc(2 * (n + 1) * sizeof(dbl))) == NULL)
+			return NULL;
+		if (ATOMbasetype(b->ttype) == TYPE_flt)
+			WINDOW_TREE_SUM(flt);
+		else
+			WINDOW_TREE_SUM(dbl);
+		if (!b->tnonil) {
+			int isnil;
+
+			if ((pre = GDKmalloc((n + 1) * sizeof(lng))) == NULL) {
+				GDKfree(tree);
+				return NULL;
+			}
+			pre[0] = 0;
+			for (i = 0; i < n; i++) {
+				(void) window_value(b, i, ATOMbasetype(b->ttype), &isnil);
+				pre[i + 1] = pre[i] + !isnil;
+			}
+		}
+	}
+	if ((bn = COLnew(b->hseqbase, tp, n, TRANSIENT)) == NULL) {
+		GDKfree(tree);
+		GDKfree(pre);
+		return NULL;
+	}
+	w = (struct window_sum) {
+		.b = b,
+		.start = (const lng *) Tloc(s, 0),
+		.end = (const lng *) Tloc(e, 0),
+		.tree = tree,
+		.pre = pre,
+		.n = n,
+		.res = Tloc(bn, 0),
+		.tp = tp,
+	};
+	nils = window_parallel(n, NULL, window_sum_slice, &w);
+	GDKfree(tree);
+	GDKfree(pre);
+	if (nils == BUN_NONE)
+		GDKerror("22003!overflow in calculation.\n");
+	return window_result(bn, n, nils);
+}
+
+BAT *
+BATwindowavg(BAT *b, BAT *s, BAT *e)
+{
+	BAT *sum, *cnt, *bn;
+	BUN n = BATcount(b), i, nils = 0;
+	int tp;
+	const lng *restrict c;
+	dbl *restrict r;
+
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		tp = TYPE_hge;
+#else
+		tp = TYPE_lng;
+#endif
+		break;
+	case TYPE_flt:
+	case TYPE_dbl:
+		tp = TYPE_dbl;
+		break;
+	default:
+		GDKerror("BATwindowavg: type %s not supported\n", ATOMname(b->ttype));
+		return NULL;
+	}
+	if ((sum = BATwindowsum(b, s, e, tp)) == NULL)
+		return NULL;
+	if ((cnt = BATwindowcount(b, s, e)) == NULL) {
+		BBPunfix(sum->batCacheid);
+		return NULL;
+	}
+	if ((bn = COLnew(b->hseqbase, TYPE_dbl, n, TRANSIENT)) == NULL) {
+		BBPunfix(sum->batCacheid);
+		BBPunfix(cnt->batCacheid);
+		return NULL;
+	}
+	c = (const lng *) Tloc(cnt, 0);
+	r = (dbl *) Tloc(bn, 0);
+	for (i = 0; i < n; i++) {
+		if (c[i] == 0) {
+			r[i] = dbl_nil;
+			nils++;
+		} else if (tp == TYPE_dbl) {
+			r[i] = ((const dbl *) Tloc(sum, 0))[i] / c[i];
+#ifdef HAVE_HGE
+		} else {
+			r[i] = (dbl) ((const hge *) Tloc(sum, 0))[i] / c[i];
+#else
+		} else {
+			r[i] = (dbl) ((const lng *) Tloc(sum, 0))[i] / c[i];
+#endif
+		}
+	}
+	BBPunfix(sum->batCacheid);
+	BBPunfix(cnt->batCacheid);
+	return window_result(bn, n, nils);
+}
+
+/*
+ * Minimum and maximum using a segment tree of the positions of the
+ * smallest (largest) values
+ */
+
+struct window_minmax {
+	BAT *b;
+	BATiter bi;
+	int tpe;
+	int (*cmp)(const void *, const void *);
+	int max;
+	const lng *start, *end;
+	oid *tree;
+	BUN n;
+	oid *res;
+};
+
+/* whether the value at position y is to be preferred over the one at
+ * position x; nil positions stand for rows with a nil value */
+static inline int
+window_better(struct window_minmax *w, oid x, oid y)
+{
+	int c;
+
+	if (is_oid_nil(y))
+		return 0;
+	if (is_oid_nil(x))
+		return 1;
+	switch (w->tpe) {
+#define CMP(TPE)	(((const TPE *) Tloc(w->b, 0))[y] < ((const TPE *) Tloc(w->b, 0))[x] ? -1 : \
+			 ((const TPE *) Tloc(w->b, 0))[y] > ((const TPE *) Tloc(w->b, 0))[x])
+	case TYPE_bte:
+		c = CMP(bte);
+		break;
+	case TYPE_sht:
+		c = CMP(sht);
+		break;
+	case TYPE_int:
+		c = CMP(int);
+		break;
+	case TYPE_lng:
+		c = CMP(lng);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		c = CMP(hge);
+		break;
+#endif
+	case TYPE_flt:
+		c = CMP(flt);
+		break;
+	case TYPE_dbl:
+		c = CMP(dbl);
+		break;
+#undef CMP
+	default:
+		c = (*w->cmp)(BUNtail(w->bi, y), BUNtail(w->bi, x));
+		break;
+	}
+	return w->max ? c > 0 : c < 0;
+}
+
+static BUN
+window_minmax_slice(void *arg, BUN lo, BUN hi)
+{
+	struct window_minmax *w = arg;
+	const lng *start = w->start, *end = w->end;
+	const oid *tree = w->tree;
+	BUN i, s, e, l, r, n = w->n, nils = 0;
+	BUN cs = BUN_NONE, ce = 0;
+	oid best = oid_nil;
+
+	for (i = lo; i < hi; i++) {
+		FRAME(i);
+		if (s == cs && e >= ce) {
+			/* the frame grows at its end */
+			for (; ce < e; ce++)
+				if (window_better(w, best, tree[n + ce]))
+					best = tree[n + ce];
+		} else {
+			best = oid_nil;
+			for (l = s + n, r = e + n; l < r; l >>= 1, r >>= 1) {
+				if ((l & 1) && window_better(w, best, tree[l++]))
+					best = tree[l - 1];
+				if ((r & 1) && window_better(w, best, tree[--r]))
+					best = tree[r];
+			}
+			cs = s;
+			ce = e;
+		}
+		w->res[i] = is_oid_nil(best) ? oid_nil : best + w->b->hseqbase;
+		nils += is_oid_nil(best);
+	}
+	return nils;
+}
+
+static BAT *
+windowminmax(BAT *b, BAT *s, BAT *e, int max)
+{
+	struct window_minmax w;
+	BUN n = BATcount(b), i;
+	const void *nil = ATOMnilptr(b->ttype);
+	BAT *pos, *bn;
+
+	if (BATcount(s) != n || BATcount(e) != n) {
+		GDKerror("BATwindow%s: inputs not aligned\n", max ? "max" : "min");
+		return NULL;
+	}
+	w = (struct window_minmax) {
+		.b = b,
+		.bi = bat_iterator(b),
+		.tpe = ATOMbasetype(b->ttype),
+		.cmp = ATOMcompare(b->ttype),
+		.max = max,
+		.start = (const lng *) Tloc(s, 0),
+		.end = (const lng *) Tloc(e, 0),
+		.n = n,
+	};
+	if (b->ttype == TYPE_void || ATOMvarsized(b->ttype) ||
+	    w.tpe == TYPE_oid || w.tpe == TYPE_ptr)
+		w.tpe = -1;	/* compare using the atom compare function */
+	if ((w.tree = GDKmalloc(2 * (n + 1) * sizeof(oid))) == NULL)
+		return NULL;
+	for (i = 0; i < n; i++)
+		w.tree[n + i] = (*w.cmp)(BUNtail(w.bi, i), nil) == 0 ? oid_nil : i;
+	for (i = n - 1; i > 0 && i < n; i--)
+		w.tree[i] = window_better(&w, w.tree[2 * i], w.tree[2 * i + 1]) ? w.tree[2 * i + 1] : w.tree[2 * i];
+	if ((pos = COLnew(0, TYPE_oid, n, TRANSIENT)) == NULL) {
+		GDKfree(w.tree);
+		return NULL;
+	}
+	w.res = (oid *) Tloc(pos, 0);
+	(void) window_parallel(n, NULL, window_minmax_slice, &w);
+	GDKfree(w.tree);
+	BATsetcount(pos, n);
+	pos->tsorted = pos->trevsorted = n <= 1;
+	pos->tkey = n <= 1;
+	pos->tnil = 0;
+	pos->tnonil = 0;
+	bn = BATproject(pos, b);
+	BBPunfix(pos->batCacheid);
+	if (bn)
+		BAThseqbase(bn, b->hseqbase);
+	return bn;
+}
+
+BAT *
+BATwindowmin(BAT *b, BAT *s, BAT *e)
+{
+	return windowminmax(b, s, e, 0);
+}
+
+BAT *
+BATwindowmax(BAT *b, BAT *s, BAT *e)
+{
+	return windowminmax(b, s, e, 1);
+}
+
+/*
+ * Values at a fixed position in or relative to the frame
+ */
+
+/* project the positions, replacing the values at invalid (nil)
+ * positions with dflt */
+static BAT *
+window_project(BAT *pos, BAT *b, const void *dflt)
+{
+	BAT *bn;
+	const oid *restrict p = (const oid *) Tloc(pos, 0);
+	BUN i, n = BATcount(pos);
+
+	if ((bn = BATproject(pos, b)) != NULL) {
+		BAThseqbase(bn, b->hseqbase);
+		if (dflt && ATOMcmp(b->ttype, dflt, ATOMnilptr(b->ttype)) != 0) {
+			for (i = 0; i < n; i++) {
+				if (is_oid_nil(p[i]) && BUNinplace(bn, i, dflt, TRUE) != GDK_SUCCEED) {
+					BBPunfix(bn->batCacheid);
+					bn = NULL;
+					break;
+				}
+			}
+		}
+	}
+	BBPunfix(pos->batCacheid);
+	return bn;
+}
+
+static BAT *
+windowfirstlast(BAT *b, BAT *s, BAT *e, int last)
+{
+	BUN n = BATcount(b), i;
+	const lng *restrict start = (const lng *) Tloc(s, 0);
+	const lng *restrict end = (const lng *) Tloc(e, 0);
+	oid *restrict p;
+	BUN fs, fe;
+	BAT *pos;
+
+	if (BATcount(s) != n || BATcount(e) != n) {
+		GDKerror("BATwindow%s: inputs not aligned\n", last ? "last" : "first");
+		return NULL;
+	}
+	if ((pos = COLnew(0, TYPE_oid, n, TRANSIENT)) == NULL)
+		return NULL;
+	p = (oid *) Tloc(pos, 0);
+	for (i = 0; i < n; i++) {
+		fs = start[i] < 0 ? 0 : start[i] > (lng) n ? n : (BUN) start[i];
+		fe = end[i] < (lng) fs ? fs : end[i] > (lng) n ? n : (BUN) end[i];
+		p[i] = fs == fe ? oid_nil : b->hseqbase + (last ? fe - 1 : fs);
+	}
+	BATsetcount(pos, n);
+	pos->tsorted = pos->trevsorted = n <= 1;
+	pos->tkey = n <= 1;
+	pos->tnil = 0;
+	pos->tnonil = 0;
+	return window_project(pos, b, NULL);
+}
+
+BAT *
+BATwindowfirst(BAT *b, BAT *s, BAT *e)
+{
+	return windowfirstlast(b, s, e, 0);
+}
+
+BAT *
+BATwindowlast(BAT *b, BAT *s, BAT *e)
+{
+	return windowfirstlast(b, s, e, 1);
+}
+
+/* the value offset rows before (negative) or after (positive) each
+ * row within its partition, dflt if that row does not exist */
+BAT *
+BATwindowshift(BAT *b, BAT *p, lng offset, const void *dflt)
+{
+	BUN n = BATcount(b), i, ps, pe;
+	const bit *restrict part = p ? (const bit *) Tloc(p, 0) : NULL;
+	oid *restrict o;
+	BAT *pos;
+
+	if (p && BATcount(p) != n) {
+		GDKerror("BATwindowshift: inputs not aligned\n");
+		return NULL;
+	}
+	if (is_lng_nil(offset)) {
+		GDKerror("BATwindowshift: offset must not be NULL\n");
+		return NULL;
+	}
+	if ((pos = COLnew(0, TYPE_oid, n, TRANSIENT)) == NULL)
+		return NULL;
+	o = (oid *) Tloc(pos, 0);
+	for (ps = 0; ps < n; ps = pe) {
+		for (pe = ps + 1; pe < n && !(part && part[pe]); pe++)
+			;
+		for (i = ps; i < pe; i++) {
+			lng t = (lng) i + offset;
+
+			o[i] = t < (lng) ps || t >= (lng) pe ? oid_nil : b->hseqbase + (oid) t;
+		}
+	}
+	BATsetcount(pos, n);
+	pos->tsorted = pos->trevsorted = n <= 1;
+	pos->tkey = n <= 1;
+	pos->tnil = 0;
+	pos->tnonil = 0;
+	return window_project(pos, b, dflt);
+}
@@ -1051,8 +1051,8 @@ BUNappend(BAT *b, const void *t, bit force)
 	PROPdestroy(b->tprops);
 	b->tprops = NULL;
 	if (b->thash == (Hash *) 1) {
-		/* don't bother first loading the hash to then change it */
-		HASHdestroy(b);
+		/* a persisted hash is loaded to be maintained */
+		(void) BATcheckhash(b);
 	}
 	if (b->thash) {
 		HASHins(b, p, t);
@@ -1156,12 +1156,17 @@ BUNinplace(BAT *b, BUN p, const void *t, bit force)
 		 * clear it */
 		b->tnil = 0;
 	}
-	HASHdestroy(b);
+	/* the hash is maintained, rather than rebuilt by the next
+	 * query; a persisted one is loaded for that */
+	if (b->thash == (Hash *) 1)
+		(void) BATcheckhash(b);
+	HASHdelete(b, p, BUNtail(bi, p));
 	PROPdestroy(b->tprops);
 	b->tprops = NULL;
 	OIDXdestroy(b);
 	IMPSdestroy(b);
 	Treplacevalue(b, BUNtloc(bi, p), t);
+	HASHinsert(b, p, t);
 
 	tt = b->ttype;
 	prv = p > 0 ? p - 1 : BUN_NONE;
@@ -584,10 +584,13 @@ BATappend(BAT *b, BAT *n, BAT *s, bit force)
 	OIDXdestroy(b);
 	PROPdestroy(b->tprops);
 	b->tprops = NULL;
-	if (b->thash == (Hash *) 1 || BATcount(b) == 0) {
-		/* don't bother first loading the hash to then change
-		 * it, or updating the hash if we replace the heap */
+	if (BATcount(b) == 0) {
+		/* don't bother updating the hash if we replace the
+		 * heap */
 		HASHdestroy(b);
+	} else if (b->thash == (Hash *) 1) {
+		/* a persisted hash is loaded to be maintained */
+		(void) BATcheckhash(b);
 	}
 
 	if (b->ttype == TYPE_void) {
@@ -709,12 +712,13 @@ BATappend(BAT *b, BAT *n, BAT *s, bit force)
 		    b->ttype != TYPE_void &&
 		    n->ttype != TYPE_void &&
 		    cand == NULL) {
-			/* use fast memcpy if we can, but then we
-			 * can't maintain the hash */
-			HASHdestroy(b);
+			/* use fast memcpy if we can, and then add
+			 * the copied values to the hash */
 			memcpy(Tloc(b, BUNlast(b)),
 			       Tloc(n, start),
 			       cnt * Tsize(n));
+			for (; b->thash && r < BUNlast(b) + cnt; r++)
+				HASHins(b, r, Tloc(b, r));
 			BATsetcount(b, BATcount(b) + cnt);
 		} else {
 			BATiter ni = bat_iterator(n);
@@ -3273,6 +3273,25 @@ BBPsync(int cnt, bat *subcommit)
 			}
 		}
 	}
+#ifdef PERSISTENTHASH
+	/* PHASE 3: persist the hashes that were built or maintained
+	 * since, now that the committed BATs they describe are on disk */
+	if (ret == GDK_SUCCEED) {
+		int idx = 0;
+
+		while (++idx < cnt) {
+			bat i = subcommit ? subcommit[idx] : idx;
+			BAT *b;
+
+			if (BBPvalid(i) && (BBP_status(i) & BBPPERSISTENT) &&
+			    (b = BBP_cache(i)) != NULL &&
+			    b->thash != NULL && b->thash != (Hash *) 1 &&
+			    b->thash != (Hash *) -1 &&
+			    !(((size_t *) b->thash->heap.base)[0] & ((size_t) 1 << 24)))
+				HASHsave(b);
+		}
+	}
+#endif
 	PERFDEBUG fprintf(stderr, "#BBPsync (ready time %d)\n", (t0 = GDKms()) - t1);
 	GDKfree(bakdir);
 	GDKfree(deldir);
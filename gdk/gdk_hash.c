@@ -217,6 +217,7 @@ BATcheckhash(BAT *b)
 #endif
 					    HASH_VERSION) &&
 				    hdata[4] == (size_t) BATcount(b) &&
+				    hdata[1] >= (size_t) BATcapacity(b) &&
 				    fstat(fd, &st) == 0 &&
 				    st.st_size >= (off_t) (h->heap.size = h->heap.free = (hdata[1] + hdata[2]) * hdata[3] + HASH_HEADER_SIZE * SIZEOF_SIZE_T) &&
 				    HEAPload(&h->heap, nme, "thash", 0) == GDK_SUCCEED) {
@@ -264,41 +265,84 @@ BATcheckhash(BAT *b)
 }
 
 #ifdef PERSISTENTHASH
-static void
-BAThashsync(void *arg)
+/* Write the first word of the header, which holds the persisted bit,
+ * to the hash file. */
+static const char *
+HASHwriteversion(Heap *hp)
 {
-	BAT *b = arg;
+	const char *failed = " failed";
 	int fd;
+
+	if ((fd = GDKfdlocate(hp->farmid, hp->filename, "rb+", NULL)) >= 0) {
+		if (write(fd, hp->base, SIZEOF_SIZE_T) >= 0) {
+			failed = ""; /* not failed */
+			if (!(GDKdebug & NOSYNCMASK)) {
+#if defined(NATIVE_WIN32)
+				_commit(fd);
+#elif defined(HAVE_FDATASYNC)
+				fdatasync(fd);
+#elif defined(HAVE_FSYNC)
+				fsync(fd);
+#endif
+			}
+		} else {
+			perror("write hash");
+		}
+		close(fd);
+	}
+	return failed;
+}
+
+/* Persist the hash of a BAT whose current state is on disk.  The hash
+ * may have been maintained since it was built, so the count in the
+ * header is brought up to date.  The persisted bit is only set once
+ * the rest of the file is written. */
+void
+HASHsave(BAT *b)
+{
 	lng t0 = 0;
 	const char *failed = " failed";
 
 	ALGODEBUG t0 = GDKusec();
 
 	MT_lock_set(&GDKhashLock(b->batCacheid));
-	if (b->thash != NULL) {
+	if (b->thash != NULL && b->thash != (Hash *) 1 &&
+	    b->thash != (Hash *) -1 && b->thash->heap.parentid == b->batCacheid) {
 		Heap *hp = &b->thash->heap;
-		if (HEAPsave(hp, hp->filename, NULL) == GDK_SUCCEED &&
-		    (fd = GDKfdlocate(hp->farmid, hp->filename, "rb+", NULL)) >= 0) {
-			((size_t *) hp->base)[0] |= 1 << 24;
-			if (write(fd, hp->base, SIZEOF_SIZE_T) >= 0) {
-				failed = ""; /* not failed */
-				if (!(GDKdebug & NOSYNCMASK)) {
-#if defined(NATIVE_WIN32)
-					_commit(fd);
-#elif defined(HAVE_FDATASYNC)
-					fdatasync(fd);
-#elif defined(HAVE_FSYNC)
-					fsync(fd);
-#endif
-				}
-			} else {
-				perror("write hash");
-			}
-			close(fd);
+
+		((size_t *) hp->base)[0] &= ~((size_t) 1 << 24);
+		((size_t *) hp->base)[4] = (size_t) BATcount(b);
+		if (HEAPsave(hp, hp->filename, NULL) == GDK_SUCCEED) {
+			((size_t *) hp->base)[0] |= (size_t) 1 << 24;
+			failed = HASHwriteversion(hp);
+			hp->dirty = FALSE;
 		}
 		ALGODEBUG fprintf(stderr, "#BAThash: persisting hash %s (" LLFMT " usec)%s\n", hp->filename, GDKusec() - t0, failed);
 	}
 	MT_lock_unset(&GDKhashLock(b->batCacheid));
+}
+
+/* The BAT is about to be saved while its hash was changed since it
+ * was persisted, so the file would no longer describe the BAT on disk
+ * once it is saved.  Clear the persisted bit in the file too. */
+void
+HASHstale(BAT *b)
+{
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if (b->thash != NULL && b->thash != (Hash *) 1 &&
+	    b->thash != (Hash *) -1 && b->thash->heap.parentid == b->batCacheid &&
+	    !(((size_t *) b->thash->heap.base)[0] & ((size_t) 1 << 24)) &&
+	    b->thash->heap.storage == STORE_MEM)
+		(void) HASHwriteversion(&b->thash->heap);
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+}
+
+static void
+BAThashsync(void *arg)
+{
+	BAT *b = arg;
+
+	HASHsave(b);
 	BBPunfix(b->batCacheid);
 }
 #endif
@@ -474,7 +518,9 @@ BAThash(BAT *b, BUN masksize)
 		h->heap.parentid = b->batCacheid;
 		b->thash = h;
 #ifdef PERSISTENTHASH
-		if (BBP_status(b->batCacheid) & BBPEXISTING) {
+		/* the hash of a BAT that was changed since it was last
+		 * saved is persisted when the BAT is committed */
+		if ((BBP_status(b->batCacheid) & BBPEXISTING) && !BATdirty(b)) {
 			MT_Id tid;
 			BBPfix(b->batCacheid);
 			if (MT_create_thread(&tid, BAThashsync, b,
@@ -495,6 +541,19 @@ BAThash(BAT *b, BUN masksize)
 	return GDK_SUCCEED;
 }
 
+bool
+BAThashpersisted(BAT *b)
+{
+	bool ret;
+
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	ret = b->thash == (Hash *) 1 ||
+		(b->thash != NULL && b->thash != (Hash *) -1 &&
+		 (((size_t *) b->thash->heap.base)[0] & ((size_t) 1 << 24)) != 0);
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+	return ret;
+}
+
 /*
  * The entry on which a value hashes can be calculated with the
  * routine HASHprobe.
@@ -537,6 +596,55 @@ HASHlist(Hash *h, BUN i)
 	return c;
 }
 
+/*
+ * An in-place update of a BUN moves it from the hash chain of its old
+ * value to that of its new value.  The chains are kept in descending
+ * BUN order, on which the hash select relies.
+ */
+void
+HASHdelete(BAT *b, BUN p, const void *v)
+{
+	Hash *h = b->thash;
+	BUN c, i, nxt;
+
+	if (h == NULL || h == (Hash *) 1 || h == (Hash *) -1)
+		return;
+	c = HASHprobe(h, v);
+	i = HASHget(h, c);
+	if (i == p) {
+		HASHput(h, c, HASHgetlink(h, p));
+	} else {
+		while (i != HASHnil(h) && (nxt = HASHgetlink(h, i)) != p)
+			i = nxt;
+		if (i == HASHnil(h))
+			return;
+		HASHputlink(h, i, HASHgetlink(h, p));
+	}
+	HASHmodified(h);
+}
+
+void
+HASHinsert(BAT *b, BUN p, const void *v)
+{
+	Hash *h = b->thash;
+	BUN c, i, nxt;
+
+	if (h == NULL || h == (Hash *) 1 || h == (Hash *) -1)
+		return;
+	c = HASHprobe(h, v);
+	i = HASHget(h, c);
+	if (i == HASHnil(h) || i < p) {
+		HASHputlink(h, p, i);
+		HASHput(h, c, p);
+	} else {
+		while ((nxt = HASHgetlink(h, i)) != HASHnil(h) && nxt > p)
+			i = nxt;
+		HASHputlink(h, p, nxt);
+		HASHputlink(h, i, p);
+	}
+	HASHmodified(h);
+}
+
 void
 HASHdestroy(BAT *b)
 {
@@ -227,6 +227,17 @@ gdk_export BUN HASHlist(Hash *h, BUN i);
 #define HASHfnd_flt(x,y,z)	HASHfnd_TYPE(x,y,z,flt)
 #define HASHfnd_dbl(x,y,z)	HASHfnd_TYPE(x,y,z,dbl)
 
+/*
+ * A hash that is changed no longer matches the copy that was persisted
+ * on disk, so it is marked dirty and loses the persisted bit of its
+ * header until it is saved again.  In case the hash heap is memory
+ * mapped, the latter also reaches the file. */
+#define HASHmodified(h)							\
+	do {								\
+		(h)->heap.dirty = TRUE;					\
+		((size_t *) (h)->heap.base)[0] &= ~((size_t) 1 << 24);	\
+	} while (0)
+
 /*
  * A new entry is added with HASHins using the BAT, the BUN index, and
  * a pointer to the value to be stored.
@@ -243,7 +254,7 @@ gdk_export BUN HASHlist(Hash *h, BUN i);
 			} else {					\
 				BUN _c = HASHprobe((b)->thash, (v));	\
 				HASHputall((b)->thash, (i), _c);	\
-				(b)->thash->heap.dirty = TRUE;		\
+				HASHmodified((b)->thash);		\
 			}						\
 		}							\
 	} while (0)
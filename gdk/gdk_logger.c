@@ -2736,8 +2736,8 @@ pre_allocate(logger *lg)
 	return GDK_SUCCEED;
 }
 
-gdk_return
-log_tend(logger *lg)
+static gdk_return
+log_tend_(logger *lg, int sync)
 {
 	logformat l;
 	gdk_return res = GDK_SUCCEED;
@@ -2778,7 +2778,7 @@ log_tend(logger *lg)
 	if (res != GDK_SUCCEED ||
 	    log_write_format(lg, &l) != GDK_SUCCEED ||
 	    mnstr_flush(lg->log) ||
-	    (!(GDKdebug & NOSYNCMASK) && mnstr_fsync(lg->log)) ||
+	    (sync && !(GDKdebug & NOSYNCMASK) && mnstr_fsync(lg->log)) ||
 	    pre_allocate(lg) != GDK_SUCCEED) {
 		fprintf(stderr, "!ERROR: log_tend: write failed\n");
 		return GDK_FAIL;
@@ -2786,6 +2786,30 @@ log_tend(logger *lg)
 	return GDK_SUCCEED;
 }
 
+gdk_return
+log_tend(logger *lg)
+{
+	return log_tend_(lg, 1);
+}
+
+/* end the transaction without waiting for the disk, the caller
+ * makes it durable later using log_sync */
+gdk_return
+log_tend_nosync(logger *lg)
+{
+	return log_tend_(lg, 0);
+}
+
+gdk_return
+log_sync(logger *lg)
+{
+	if (lg->log && !(GDKdebug & NOSYNCMASK) && mnstr_fsync(lg->log)) {
+		fprintf(stderr, "!ERROR: log_sync: sync failed\n");
+		return GDK_FAIL;
+	}
+	return GDK_SUCCEED;
+}
+
 gdk_return
 log_abort(logger *lg)
 {
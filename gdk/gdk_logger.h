@@ -127,6 +127,8 @@ gdk_export gdk_return log_delta(logger *lg, BAT *uid, BAT *uval, const char *n);
 
 gdk_export gdk_return log_tstart(logger *lg);	/* TODO return transaction id */
 gdk_export gdk_return log_tend(logger *lg);
+gdk_export gdk_return log_tend_nosync(logger *lg);
+gdk_export gdk_return log_sync(logger *lg);
 gdk_export gdk_return log_abort(logger *lg);
 
 gdk_export gdk_return log_sequence(logger *lg, int seq, lng id);
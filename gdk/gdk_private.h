@@ -13,7 +13,7 @@
 #endif
 
 #define DISABLE_PARENT_HASH 1
-/* #define PERSISTENTHASH 1 */
+#define PERSISTENTHASH 1
 #define PERSISTENTIDX 1
 
 #include "gdk_system_private.h"
@@ -38,8 +38,6 @@ __hidden str ATOMunknown_name(int a)
 	__attribute__((__visibility__("hidden")));
 __hidden void ATOMunknown_clean(void)
 	__attribute__((__visibility__("hidden")));
-__hidden bool BATcheckhash(BAT *b)
-	__attribute__((__visibility__("hidden")));
 __hidden bool BATcheckimprints(BAT *b)
 	__attribute__((__visibility__("hidden")));
 __hidden gdk_return BATcheckmodes(BAT *b, bool persistent)
@@ -149,14 +147,22 @@ __hidden gdk_return GDKssort(void *restrict h, void *restrict t, const void *res
 	__attribute__((__visibility__("hidden")));
 __hidden gdk_return GDKunlink(int farmid, const char *dir, const char *nme, const char *extension)
 	__attribute__((__visibility__("hidden")));
+__hidden void HASHdelete(BAT *b, BUN p, const void *v)
+	__attribute__((__visibility__("hidden")));
 __hidden void HASHfree(BAT *b)
 	__attribute__((__visibility__("hidden")));
 __hidden bool HASHgonebad(BAT *b, const void *v)
 	__attribute__((__visibility__("hidden")));
 __hidden BUN HASHmask(BUN cnt)
 	__attribute__((__visibility__("hidden")));
+__hidden void HASHinsert(BAT *b, BUN p, const void *v)
+	__attribute__((__visibility__("hidden")));
 __hidden gdk_return HASHnew(Hash *h, int tpe, BUN size, BUN mask, BUN count)
 	__attribute__((__visibility__("hidden")));
+__hidden void HASHsave(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden void HASHstale(BAT *b)
+	__attribute__((__visibility__("hidden")));
 __hidden gdk_return HEAPalloc(Heap *h, size_t nitems, size_t itemsize)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
@@ -127,9 +127,10 @@ doubleslice(BAT *b, BUN l1, BUN h1, BUN l2, BUN h2)
 	return virtualize(bn);
 }
 
+/* the hash chains are in descending order, so the walk stops below lo */
 #define HASHloop_bound(bi, h, hb, v, lo, hi)		\
 	for (hb = HASHget(h, HASHprobe((h), v));	\
-	     hb != HASHnil(h);				\
+	     hb != HASHnil(h) && hb >= (lo);		\
 	     hb = HASHgetlink(h,hb))			\
 		if (hb >= (lo) && hb < (hi) &&		\
 		    (cmp == NULL ||			\
@@ -150,12 +151,17 @@ BAT_hashselect(BAT *b, BAT *s, BAT *bn, const void *tl, BUN maximum)
 	l = 0;
 	h = BUNlast(b);
 
-#ifndef DISABLE_PARENT_HASH
 	if (VIEWtparent(b)) {
 		BAT *b2 = BBPdescriptor(VIEWtparent(b));
-		if (b2->batPersistence == PERSISTENT || BATcheckhash(b2)) {
+		if (
+#ifndef DISABLE_PARENT_HASH
+		    b2->batPersistence == PERSISTENT ||
+#endif
+		    BATcheckhash(b2)) {
 			/* only use parent's hash if it is persistent
-			 * or already has a hash */
+			 * or already has a hash; the latter also when
+			 * parent hashes are not built, such as the
+			 * hash of an indexed column */
 			ALGODEBUG
 				fprintf(stderr, "#hashselect(%s#"BUNFMT"): "
 					"using parent(%s#"BUNFMT") for hash\n",
@@ -172,7 +178,6 @@ BAT_hashselect(BAT *b, BAT *s, BAT *bn, const void *tl, BUN maximum)
 					BATgetId(b2), BATcount(b2));
 		}
 	}
-#endif
 	if (s && BATtdense(s)) {
 		/* no need for binary search in s, we just adjust the
 		 * boundaries */
@@ -845,6 +850,42 @@ scan_sel(candscan, o = *candlist++, w = (BUN) ((*(oid *) Tloc(s,q?(q - 1):0)) +
 /* scan/imprints select without candidates */
 scan_sel(fullscan, o = (oid) (p+off), w = (BUN) (q+off))
 
+/* scan select of the rows p up to q of b without candidate list;
+ * the qualifying oids are added to the cnt values already in bn */
+static BUN
+fullscan_range(BAT *b, BAT *bn, const void *tl, const void *th,
+	       bool li, bool hi, bool equi, bool anti, bool lval, bool hval,
+	       BUN p, BUN q, BUN cnt, BUN maximum, bool use_imprints)
+{
+	BAT *s = NULL;
+	lng off = (lng) b->hseqbase;
+	oid *restrict dst = (oid *) Tloc(bn, 0);
+	const oid *candlist = NULL;
+
+	/* call type-specific core scan select function */
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+		return fullscan_bte(scanargs);
+	case TYPE_sht:
+		return fullscan_sht(scanargs);
+	case TYPE_int:
+		return fullscan_int(scanargs);
+	case TYPE_flt:
+		return fullscan_flt(scanargs);
+	case TYPE_dbl:
+		return fullscan_dbl(scanargs);
+	case TYPE_lng:
+		return fullscan_lng(scanargs);
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		return fullscan_hge(scanargs);
+#endif
+	case TYPE_str:
+		return fullscan_str(scanargs);
+	default:
+		return fullscan_any(scanargs);
+	}
+}
 
 static BAT *
 BAT_scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
@@ -946,39 +987,9 @@ BAT_scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 			p = 0;
 			q = BUNlast(b);
 		}
-		candlist = NULL;
-		/* call type-specific core scan select function */
-		switch (t) {
-		case TYPE_bte:
-			cnt = fullscan_bte(scanargs);
-			break;
-		case TYPE_sht:
-			cnt = fullscan_sht(scanargs);
-			break;
-		case TYPE_int:
-			cnt = fullscan_int(scanargs);
-			break;
-		case TYPE_flt:
-			cnt = fullscan_flt(scanargs);
-			break;
-		case TYPE_dbl:
-			cnt = fullscan_dbl(scanargs);
-			break;
-		case TYPE_lng:
-			cnt = fullscan_lng(scanargs);
-			break;
-#ifdef HAVE_HGE
-		case TYPE_hge:
-			cnt = fullscan_hge(scanargs);
-			break;
-#endif
-		case TYPE_str:
-			cnt = fullscan_str(scanargs);
-			break;
-		default:
-			cnt = fullscan_any(scanargs);
-			break;
-		}
+		cnt = fullscan_range(b, bn, tl, th, li, hi, equi, anti,
+				     lval, hval, p, q, cnt, maximum,
+				     use_imprints);
 	}
 	if (cnt == BUN_NONE) {
 		return NULL;
@@ -994,6 +1005,222 @@ BAT_scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 	return bn;
 }
 
+/* Shared scans
+ *
+ * With gdk_shared_scans enabled, concurrent scan selects over the
+ * same column share a single circular pass over its heap.  A scan is
+ * identified by the location of the tail heap and the number of rows,
+ * so selects of different queries on the same (mitosis slice of a)
+ * column end up in the same scan.  The column is processed in blocks
+ * of SHAREDSCAN_BLOCK rows, and each block is evaluated for the
+ * predicates of all attached selects while it is in the CPU cache.
+ *
+ * A select that attaches to a running scan starts at the block the
+ * scan is at and wraps around until it has seen all blocks.  The oids
+ * found in the blocks before its starting point are collected
+ * separately and are put in front at the end, so that the result is
+ * sorted as usual.
+ *
+ * The blocks are scanned by one of the attached threads, the driver.
+ * The others wait on their semaphore until they are either done or
+ * have to take over because the driver itself is done.
+ */
+#define SHAREDSCAN_BLOCK	((BUN) 1 << 16)
+#define SHAREDSCAN_MINSIZE	(4 * SHAREDSCAN_BLOCK)
+#define SHAREDSCAN_MAXCLIENTS	64
+
+typedef struct scanclient {
+	BAT *b;			/* the column as seen by this select */
+	BAT *bn;		/* result from block start onward */
+	BAT *wrap;		/* result for the blocks before start */
+	BUN cnt, wcnt;
+	const void *tl, *th;
+	bool li, hi, equi, anti, lval, hval;
+	BUN maximum;
+	BUN start;		/* first block scanned for this select */
+	BUN todo;		/* blocks still to be scanned */
+	MT_Sema sema;
+	struct scanclient *next;
+} scanclient;
+
+typedef struct sharedscan {
+	const void *base;	/* identification of the column */
+	BUN count;
+	int type;
+	BUN nblocks;
+	BUN next;		/* next block to be scanned */
+	int nclients;
+	scanclient *clients;
+	scanclient *driver;
+	struct sharedscan *nextscan;
+} sharedscan;
+
+static sharedscan *sharedscans;
+static MT_Lock sharedscanLock MT_LOCK_INITIALIZER("sharedscanLock");
+
+static void
+sharedscan_block(scanclient *c, BUN blk)
+{
+	BUN p = blk * SHAREDSCAN_BLOCK;
+	BUN q = MIN(p + SHAREDSCAN_BLOCK, BATcount(c->b));
+
+	/* on failure, the result BAT has been freed */
+	if (blk < c->start) {
+		if (c->wrap != NULL &&
+		    (c->wcnt = fullscan_range(c->b, c->wrap, c->tl, c->th,
+					      c->li, c->hi, c->equi, c->anti,
+					      c->lval, c->hval, p, q, c->wcnt,
+					      c->maximum, false)) == BUN_NONE)
+			c->wrap = NULL;
+	} else {
+		if (c->bn != NULL &&
+		    (c->cnt = fullscan_range(c->b, c->bn, c->tl, c->th,
+					     c->li, c->hi, c->equi, c->anti,
+					     c->lval, c->hval, p, q, c->cnt,
+					     c->maximum, false)) == BUN_NONE)
+			c->bn = NULL;
+	}
+}
+
+static BAT *
+BAT_sharedscan(BAT *b, BAT *bn, const void *tl, const void *th,
+	       bool li, bool hi, bool equi, bool anti, bool lval, bool hval,
+	       BUN maximum)
+{
+	scanclient c, *snapshot[SHAREDSCAN_MAXCLIENTS], **cp;
+	sharedscan *sc, **scp;
+	BUN blk, cnt;
+	int i, n;
+
+	memset(&c, 0, sizeof(c));
+	c.b = b;
+	c.bn = bn;
+	c.tl = tl;
+	c.th = th;
+	c.li = li;
+	c.hi = hi;
+	c.equi = equi;
+	c.anti = anti;
+	c.lval = lval;
+	c.hval = hval;
+	c.maximum = maximum;
+
+	MT_lock_set(&sharedscanLock);
+	for (sc = sharedscans; sc; sc = sc->nextscan)
+		if (sc->base == Tloc(b, 0) &&
+		    sc->count == BATcount(b) &&
+		    sc->type == b->ttype)
+			break;
+	if (sc == NULL) {
+		if ((sc = GDKzalloc(sizeof(sharedscan))) == NULL) {
+			MT_lock_unset(&sharedscanLock);
+			GDKclrerr();
+			return BAT_scanselect(b, NULL, bn, tl, th, li, hi, equi,
+					      anti, lval, hval, maximum, false);
+		}
+		sc->base = Tloc(b, 0);
+		sc->count = BATcount(b);
+		sc->type = b->ttype;
+		sc->nblocks = (BATcount(b) + SHAREDSCAN_BLOCK - 1) / SHAREDSCAN_BLOCK;
+		sc->nextscan = sharedscans;
+		sharedscans = sc;
+	} else if (sc->nclients == SHAREDSCAN_MAXCLIENTS ||
+		   (sc->next > 0 &&
+		    (c.wrap = COLnew(0, TYPE_oid, 0, TRANSIENT)) == NULL)) {
+		/* scan on our own */
+		MT_lock_unset(&sharedscanLock);
+		GDKclrerr();
+		return BAT_scanselect(b, NULL, bn, tl, th, li, hi, equi,
+				      anti, lval, hval, maximum, false);
+	}
+	ALGODEBUG fprintf(stderr, "#BATselect(b=%s#" BUNFMT ",anti=%d): "
+			  "shared scan from block " BUNFMT " with %d others\n",
+			  BATgetId(b), BATcount(b), anti, sc->next,
+			  sc->nclients);
+	MT_sema_init(&c.sema, 0, "sharedscan");
+	c.start = sc->next;
+	c.todo = sc->nblocks;
+	c.next = sc->clients;
+	sc->clients = &c;
+	sc->nclients++;
+
+	while (c.todo > 0) {
+		if (sc->driver == NULL)
+			sc->driver = &c;
+		if (sc->driver != &c) {
+			MT_lock_unset(&sharedscanLock);
+			MT_sema_down(&c.sema);
+			MT_lock_set(&sharedscanLock);
+			continue;
+		}
+		/* all selects that are attached at this point
+		 * still need the next block */
+		blk = sc->next;
+		sc->next = (blk + 1) % sc->nblocks;
+		n = 0;
+		for (cp = &sc->clients; *cp; cp = &(*cp)->next)
+			if ((*cp)->todo > 0)
+				snapshot[n++] = *cp;
+		MT_lock_unset(&sharedscanLock);
+		for (i = 0; i < n; i++)
+			sharedscan_block(snapshot[i], blk);
+		MT_lock_set(&sharedscanLock);
+		for (i = 0; i < n; i++)
+			if (--snapshot[i]->todo == 0 && snapshot[i] != &c)
+				MT_sema_up(&snapshot[i]->sema);
+	}
+	if (sc->driver == &c) {
+		/* hand over to a select that is not done yet */
+		sc->driver = NULL;
+		for (cp = &sc->clients; *cp; cp = &(*cp)->next)
+			if ((*cp)->todo > 0) {
+				sc->driver = *cp;
+				MT_sema_up(&(*cp)->sema);
+				break;
+			}
+	}
+	for (cp = &sc->clients; *cp != &c; cp = &(*cp)->next)
+		;
+	*cp = c.next;
+	if (--sc->nclients == 0) {
+		for (scp = &sharedscans; *scp != sc; scp = &(*scp)->nextscan)
+			;
+		*scp = sc->nextscan;
+		GDKfree(sc);
+	}
+	MT_lock_unset(&sharedscanLock);
+	MT_sema_destroy(&c.sema);
+
+	if (c.bn == NULL || (c.start > 0 && c.wrap == NULL)) {
+		BBPreclaim(c.bn);
+		BBPreclaim(c.wrap);
+		return NULL;
+	}
+	bn = c.bn;
+	cnt = c.cnt;
+	if (c.wrap) {
+		/* the blocks before the starting point come first */
+		BATsetcount(c.wrap, c.wcnt);
+		if (BATextend(c.wrap, c.wcnt + cnt) != GDK_SUCCEED) {
+			BBPreclaim(c.wrap);
+			BBPreclaim(bn);
+			return NULL;
+		}
+		if (cnt > 0)
+			memcpy(Tloc(c.wrap, c.wcnt), Tloc(bn, 0), cnt * sizeof(oid));
+		BBPreclaim(bn);
+		bn = c.wrap;
+		cnt += c.wcnt;
+	}
+	BATsetcount(bn, cnt);
+	bn->tsorted = true;
+	bn->trevsorted = bn->batCount <= 1;
+	bn->tkey = true;
+	bn->tseqbase = cnt == 0 ? 0 : cnt == 1 || cnt == b->batCount ? b->hseqbase : oid_nil;
+
+	return bn;
+}
+
 /* generic range select
  *
  * Return a BAT with the OID values of b for qualifying tuples.  The
@@ -1721,17 +1948,13 @@ BATselect(BAT *b, BAT *s, const void *tl, const void *th,
 		  ATOMsize(b->ttype) >= sizeof(BUN) / 4 &&
 		  BATcount(b) * (ATOMsize(b->ttype) + 2 * sizeof(BUN)) < GDK_mem_maxsize / 2) ||
 		 (BATcheckhash(b)
-#ifndef DISABLE_PARENT_HASH
 		  || (parent != 0 &&
 		      BATcheckhash(BBPdescriptor(parent)))
-#endif
 			 ));
 	if (hash &&
 	    estimate == BUN_NONE &&
 	    !BATcheckhash(b)
-#ifndef DISABLE_PARENT_HASH
 	    && (parent == 0 || !BATcheckhash(BBPdescriptor(parent)))
-#endif
 		) {
 		/* no exact result size, but we need estimate to choose
 		 * between hash- & scan-select
@@ -1811,8 +2034,23 @@ BATselect(BAT *b, BAT *s, const void *tl, const void *th,
 			 */
 			use_imprints = true;
 		}
-		bn = BAT_scanselect(b, s, bn, tl, th, li, hi, equi, anti,
-				    lval, hval, maximum, use_imprints);
+		if (GDK_shared_scans &&
+		    BATcount(b) >= SHAREDSCAN_MINSIZE &&
+		    (s == NULL ||
+		     (BATtdense(s) &&
+		      s->tseqbase <= b->hseqbase &&
+		      s->tseqbase + BATcount(s) >= b->hseqbase + BATcount(b))) &&
+		    !(use_imprints && BATcheckimprints(b))) {
+			/* a scan over all of b that is not helped by
+			 * an existing index: share it with concurrent
+			 * selects on the same column */
+			bn = BAT_sharedscan(b, bn, tl, th, li, hi, equi, anti,
+					    lval, hval, maximum);
+		} else {
+			bn = BAT_scanselect(b, s, bn, tl, th, li, hi, equi,
+					    anti, lval, hval, maximum,
+					    use_imprints);
+		}
 	}
 
 	return virtualize(bn);
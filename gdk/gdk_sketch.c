@@ -0,0 +1,797 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+/*
+ * @* Distinct value sketches
+ *
+ * A HyperLogLog sketch (Flajolet, Fusy, Gandouet, Meunier, 2007)
+ * estimates the number of distinct values in a column in a single
+ * pass, using a fixed array of HLL_REGISTERS one-byte registers.  The
+ * low HLL_PRECISION bits of the (remixed) hash of a value select a
+ * register, and the register remembers the largest position of the
+ * first 1-bit seen in the remaining bits.
+ *
+ * Two sketches are merged by taking the element-wise maximum of their
+ * registers.  This makes sketches suitable for incremental
+ * maintenance (fold only the newly appended values into an existing
+ * sketch) and for combining partial results computed over slices of
+ * a BAT.
+ *
+ * The grouped approximate aggregates at the end of this file keep a
+ * sketch per group: a HyperLogLog sketch for the number of distinct
+ * values and a quantile sketch for quantiles.  Both kinds are
+ * mergeable, so large inputs are cut into slices which build their
+ * own sketches in parallel, after which the sketches of the slices
+ * are merged.
+ */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+#include "gdk_cand.h"
+#include <math.h>
+
+/* the atom hash functions are optimized for hash tables and do not
+ * spread their bits well enough for HyperLogLog (e.g. small integers
+ * hash to themselves), so we remix them with the 64 bit finalizer of
+ * MurmurHash3 */
+static inline ulng
+HLLmix(ulng h)
+{
+	h ^= h >> 33;
+	h *= UINT64_C(0xff51afd7ed558ccd);
+	h ^= h >> 33;
+	h *= UINT64_C(0xc4ceb9fe1a85ec53);
+	h ^= h >> 33;
+	return h;
+}
+
+void
+HLLadd(bte *registers, BUN hash)
+{
+	ulng h = HLLmix((ulng) hash);
+	BUN r = (BUN) (h & (HLL_REGISTERS - 1));
+	bte rank = 1;
+
+	h >>= HLL_PRECISION;
+	while ((h & 1) == 0 && rank <= 64 - HLL_PRECISION) {
+		rank++;
+		h >>= 1;
+	}
+	if (registers[r] < rank)
+		registers[r] = rank;
+}
+
+void
+HLLmerge(bte *dst, const bte *src)
+{
+	int i;
+
+	for (i = 0; i < HLL_REGISTERS; i++)
+		if (dst[i] < src[i])
+			dst[i] = src[i];
+}
+
+dbl
+HLLestimate(const bte *registers)
+{
+	const dbl m = (dbl) HLL_REGISTERS;
+	dbl sum = 0, est;
+	int i, zeros = 0;
+
+	for (i = 0; i < HLL_REGISTERS; i++) {
+		sum += ldexp(1.0, -registers[i]);
+		zeros += registers[i] == 0;
+	}
+	est = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+	/* small range correction: use linear counting while there
+	 * are still empty registers */
+	if (est <= 2.5 * m && zeros > 0)
+		est = m * log(m / zeros);
+	return est;
+}
+
+/* Fold the non-nil tail values of b, restricted to the candidate
+ * list s, into the HyperLogLog registers. */
+gdk_return
+BATsketch(bte *registers, BAT *b, BAT *s)
+{
+	BUN start, end, cnt, i;
+	const oid *cand = NULL, *candend = NULL;
+	BATiter bi;
+	const void *nil, *v;
+	int (*cmp)(const void *, const void *);
+	BUN (*hash)(const void *);
+	oid o;
+
+	BATcheck(b, "BATsketch", GDK_FAIL);
+	CANDINIT(b, s, start, end, cnt, cand, candend);
+
+	if (b->ttype == TYPE_void) {
+		/* all values are distinct (or all nil) */
+		if (is_oid_nil(b->tseqbase))
+			return GDK_SUCCEED;
+		for (;;) {
+			if (cand) {
+				if (cand == candend)
+					break;
+				i = *cand++ - b->hseqbase;
+				if (i >= end)
+					break;
+			} else {
+				i = start++;
+				if (i == end)
+					break;
+			}
+			o = b->tseqbase + i;
+			HLLadd(registers, ATOMhash(TYPE_oid, &o));
+		}
+		return GDK_SUCCEED;
+	}
+
+	bi = bat_iterator(b);
+	nil = ATOMnilptr(b->ttype);
+	cmp = ATOMcompare(b->ttype);
+	hash = BATatoms[b->ttype].atomHash;
+	for (;;) {
+		if (cand) {
+			if (cand == candend)
+				break;
+			i = *cand++ - b->hseqbase;
+			if (i >= end)
+				break;
+		} else {
+			i = start++;
+			if (i == end)
+				break;
+		}
+		v = BUNtail(bi, i);
+		if ((*cmp)(v, nil) != 0)
+			HLLadd(registers, (*hash)(v));
+	}
+	return GDK_SUCCEED;
+}
+
+/*
+ * @+ Grouped approximate aggregates
+ *
+ * The HyperLogLog sketch of a group starts out sparse: it keeps the
+ * distinct hashes seen, sorted, until there are HLL_SPARSE of them,
+ * which take as much memory as the registers.  Only then are they
+ * folded into registers.  Small groups are thus counted exactly (up
+ * to hash collisions) and groups cost memory in proportion to their
+ * number of distinct values.
+ *
+ * The quantile sketch of a group is a KLL sketch (Karnin, Lang,
+ * Liberty, 2016) with the same capacity QSK_CAPACITY at all levels.
+ * Level h holds positions in b of values which stand for 2^h input
+ * values each.  When a level is full, it is sorted and either its
+ * values at even or at odd positions, chosen at random, move to the
+ * next level.  Groups with fewer than QSK_CAPACITY values are not
+ * compacted at all and get the exact quantile.  The sketch keeps
+ * positions rather than values, so it works for any linear type and
+ * the quantile is one of the input values.
+ */
+
+#define HLL_SPARSE	(HLL_REGISTERS / (int) sizeof(BUN))
+#define QSK_CAPACITY	512
+#define QSK_LEVELS	64
+
+/* inputs smaller than this are not worth spreading over threads */
+#define SKETCH_SLICE	((BUN) 1 << 16)
+
+struct hll {
+	BUN *hashes;		/* sparse: sorted distinct hashes */
+	bte *registers;		/* dense: NULL while sparse */
+	BUN cnt, size;
+};
+
+struct qsk_level {
+	oid *pos;		/* positions in b */
+	BUN cnt, size;
+};
+
+struct qsk {
+	struct qsk_level *lvl;
+	int nlvl;
+	ulng rnd;		/* state of the coin flips */
+};
+
+struct sketch_ctx;
+
+struct sketch_ops {
+	size_t size;		/* size of the sketch of a group */
+	gdk_return (*add)(struct sketch_ctx *c, void *sk, BUN i);
+	gdk_return (*merge)(struct sketch_ctx *c, void *dst, void *src);
+	void (*destroy)(void *sk);
+};
+
+/* the sketches of a slice of the input */
+struct sketch_ctx {
+	const struct sketch_ops *ops;
+	BAT *b;
+	BATiter bi;
+	int (*cmp)(const void *, const void *);
+	BUN (*hash)(const void *);
+	const void *nil;
+	int skip_nils;
+	const oid *gids;	/* group of each row, NULL: one group */
+	oid min, max;		/* the range of group ids */
+	const oid *cand;	/* candidate list, NULL: none */
+	BUN lo, hi;		/* the rows (candidates) of the slice */
+	char *sketches;		/* one per group */
+	oid *tmp;		/* scratch space for sorting */
+	BUN tmpsize;
+	gdk_return ret;
+	MT_Id tid;
+};
+
+/* HyperLogLog sketches */
+
+static gdk_return
+hll_insert(struct hll *h, BUN hash)
+{
+	BUN lo = 0, hi = h->cnt, m;
+	BUN *hashes;
+
+	if (h->registers) {
+		HLLadd(h->registers, hash);
+		return GDK_SUCCEED;
+	}
+	while (lo < hi) {
+		m = (lo + hi) / 2;
+		if (h->hashes[m] < hash)
+			lo = m + 1;
+		else
+			hi = m;
+	}
+	if (lo < h->cnt && h->hashes[lo] == hash)
+		return GDK_SUCCEED;
+	if (h->cnt + 1 == HLL_SPARSE) {
+		/* switch to registers */
+		if ((h->registers = GDKzalloc(HLL_REGISTERS)) == NULL)
+			return GDK_FAIL;
+		for (m = 0; m < h->cnt; m++)
+			HLLadd(h->registers, h->hashes[m]);
+		HLLadd(h->registers, hash);
+		GDKfree(h->hashes);
+		h->hashes = NULL;
+		h->cnt = h->size = 0;
+		return GDK_SUCCEED;
+	}
+	if (h->cnt == h->size) {
+		BUN size = h->size ? 2 * h->size : 4;
+
+		if ((hashes = GDKrealloc(h->hashes, size * sizeof(BUN))) == NULL)
+			return GDK_FAIL;
+		h->hashes = hashes;
+		h->size = size;
+	}
+	memmove(h->hashes + lo + 1, h->hashes + lo, (h->cnt - lo) * sizeof(BUN));
+	h->hashes[lo] = hash;
+	h->cnt++;
+	return GDK_SUCCEED;
+}
+
+static gdk_return
+hll_add(struct sketch_ctx *c, void *sk, BUN i)
+{
+	return hll_insert(sk, (*c->hash)(BUNtail(c->bi, i)));
+}
+
+static gdk_return
+hll_merge(struct sketch_ctx *c, void *dst, void *src)
+{
+	struct hll *d = dst, *s = src;
+	BUN i;
+
+	(void) c;
+	if (s->registers && d->registers == NULL) {
+		/* take over the registers of src, and fold our
+		 * hashes into them */
+		d->registers = s->registers;
+		s->registers = NULL;
+		for (i = 0; i < d->cnt; i++)
+			HLLadd(d->registers, d->hashes[i]);
+		GDKfree(d->hashes);
+		d->hashes = NULL;
+		d->cnt = d->size = 0;
+		return GDK_SUCCEED;
+	}
+	if (s->registers) {
+		HLLmerge(d->registers, s->registers);
+		return GDK_SUCCEED;
+	}
+	for (i = 0; i < s->cnt; i++)
+		if (hll_insert(d, s->hashes[i]) != GDK_SUCCEED)
+			return GDK_FAIL;
+	return GDK_SUCCEED;
+}
+
+static void
+hll_destroy(void *sk)
+{
+	struct hll *h = sk;
+
+	GDKfree(h->hashes);
+	GDKfree(h->registers);
+}
+
+static lng
+hll_count(const struct hll *h)
+{
+	if (h->registers)
+		return (lng) (HLLestimate(h->registers) + 0.5);
+	return (lng) h->cnt;
+}
+
+static const struct sketch_ops hll_ops = {
+	.size = sizeof(struct hll),
+	.add = hll_add,
+	.merge = hll_merge,
+	.destroy = hll_destroy,
+};
+
+/* quantile sketches */
+
+#define QSK_CMP(c, p, q)	(*(c)->cmp)(BUNtail((c)->bi, p), BUNtail((c)->bi, q))
+
+/* sort the positions in a on their value, t is scratch space for
+ * half of them */
+static void
+qsk_sort(struct sketch_ctx *c, oid *restrict a, oid *restrict t, BUN n)
+{
+	BUN i, j, k, h;
+	oid p;
+
+	if (n < 16) {
+		for (i = 1; i < n; i++) {
+			p = a[i];
+			for (j = i; j > 0 && QSK_CMP(c, a[j - 1], p) > 0; j--)
+				a[j] = a[j - 1];
+			a[j] = p;
+		}
+		return;
+	}
+	h = n / 2;
+	qsk_sort(c, a, t, h);
+	qsk_sort(c, a + h, t, n - h);
+	if (QSK_CMP(c, a[h - 1], a[h]) <= 0)
+		return;
+	memcpy(t, a, h * sizeof(oid));
+	for (i = 0, j = h, k = 0; i < h && j < n; )
+		a[k++] = QSK_CMP(c, t[i], a[j]) <= 0 ? t[i++] : a[j++];
+	while (i < h)
+		a[k++] = t[i++];
+}
+
+static gdk_return
+qsk_append(struct qsk_level *l, const oid *pos, BUN n)
+{
+	if (l->cnt + n > l->size) {
+		BUN size = l->size ? l->size : 8;
+		oid *p;
+
+		while (size < l->cnt + n)
+			size *= 2;
+		if ((p = GDKrealloc(l->pos, size * sizeof(oid))) == NULL)
+			return GDK_FAIL;
+		l->pos = p;
+		l->size = size;
+	}
+	memcpy(l->pos + l->cnt, pos, n * sizeof(oid));
+	l->cnt += n;
+	return GDK_SUCCEED;
+}
+
+static gdk_return
+qsk_levels(struct qsk *q, int nlvl)
+{
+	struct qsk_level *lvl;
+
+	if (nlvl <= q->nlvl)
+		return GDK_SUCCEED;
+	assert(nlvl <= QSK_LEVELS);
+	if ((lvl = GDKrealloc(q->lvl, nlvl * sizeof(struct qsk_level))) == NULL)
+		return GDK_FAIL;
+	memset(lvl + q->nlvl, 0, (nlvl - q->nlvl) * sizeof(struct qsk_level));
+	q->lvl = lvl;
+	q->nlvl = nlvl;
+	return GDK_SUCCEED;
+}
+
+static gdk_return
+qsk_sortlevel(struct sketch_ctx *c, struct qsk_level *l)
+{
+	if (c->tmpsize < l->cnt / 2) {
+		oid *tmp;
+
+		if ((tmp = GDKrealloc(c->tmp, l->cnt * sizeof(oid))) == NULL)
+			return GDK_FAIL;
+		c->tmp = tmp;
+		c->tmpsize = l->cnt;
+	}
+	qsk_sort(c, l->pos, c->tmp, l->cnt);
+	return GDK_SUCCEED;
+}
+
+/* move half of the values of the full levels one level up */
+static gdk_return
+qsk_compact(struct sketch_ctx *c, struct qsk *q)
+{
+	struct qsk_level *l;
+	BUN i, n;
+	int h;
+
+	for (h = 0; h < q->nlvl; h++) {
+		if (q->lvl[h].cnt < QSK_CAPACITY)
+			continue;
+		if (qsk_levels(q, h + 2) != GDK_SUCCEED)
+			return GDK_FAIL;
+		l = &q->lvl[h];
+		if (qsk_sortlevel(c, l) != GDK_SUCCEED)
+			return GDK_FAIL;
+		/* xorshift64 */
+		q->rnd ^= q->rnd << 13;
+		q->rnd ^= q->rnd >> 7;
+		q->rnd ^= q->rnd << 17;
+		n = l->cnt & ~(BUN) 1;
+		for (i = q->rnd & 1; i < n; i += 2)
+			l->pos[i / 2] = l->pos[i];
+		if (qsk_append(&q->lvl[h + 1], l->pos, n / 2) != GDK_SUCCEED)
+			return GDK_FAIL;
+		/* an odd one out (the largest) stays behind */
+		if (l->cnt & 1)
+			l->pos[0] = l->pos[l->cnt - 1];
+		l->cnt &= 1;
+	}
+	return GDK_SUCCEED;
+}
+
+static gdk_return
+qsk_add(struct sketch_ctx *c, void *sk, BUN i)
+{
+	struct qsk *q = sk;
+	oid p = (oid) i;
+
+	if (q->nlvl == 0) {
+		if (qsk_levels(q, 1) != GDK_SUCCEED)
+			return GDK_FAIL;
+		q->rnd = UINT64_C(0x9e3779b97f4a7c15);
+	}
+	if (qsk_append(&q->lvl[0], &p, 1) != GDK_SUCCEED)
+		return GDK_FAIL;
+	if (q->lvl[0].cnt >= QSK_CAPACITY)
+		return qsk_compact(c, q);
+	return GDK_SUCCEED;
+}
+
+static gdk_return
+qsk_merge(struct sketch_ctx *c, void *dst, void *src)
+{
+	struct qsk *d = dst, *s = src;
+	int h;
+
+	if (s->nlvl == 0)
+		return GDK_SUCCEED;
+	if (d->nlvl == 0)
+		d->rnd = s->rnd;
+	if (qsk_levels(d, s->nlvl) != GDK_SUCCEED)
+		return GDK_FAIL;
+	for (h = 0; h < s->nlvl; h++)
+		if (qsk_append(&d->lvl[h], s->lvl[h].pos, s->lvl[h].cnt) != GDK_SUCCEED)
+			return GDK_FAIL;
+	return qsk_compact(c, d);
+}
+
+static void
+qsk_destroy(void *sk)
+{
+	struct qsk *q = sk;
+	int h;
+
+	for (h = 0; h < q->nlvl; h++)
+		GDKfree(q->lvl[h].pos);
+	GDKfree(q->lvl);
+}
+
+/* The position of the quantile, or oid_nil if the sketch is empty.
+ * The rank is rounded like BATgroupquantile does, so that sketches
+ * that were never compacted give the same answer. */
+static oid
+qsk_quantile(struct sketch_ctx *c, struct qsk *q, double quantile)
+{
+	BUN idx[QSK_LEVELS];
+	ulng w = 0, target, cum = 0;
+	int h, best;
+	double f;
+
+	for (h = 0; h < q->nlvl; h++) {
+		w += (ulng) q->lvl[h].cnt << h;
+		idx[h] = 0;
+		if (qsk_sortlevel(c, &q->lvl[h]) != GDK_SUCCEED)
+			return BUN_NONE;
+	}
+	if (w == 0)
+		return oid_nil;
+	f = (double) (w - 1) * quantile;
+	target = (w - 1) - (ulng) ((double) (w - 1) + 0.5 - f);
+	/* walk the levels in order of value, which are all sorted */
+	for (;;) {
+		best = -1;
+		for (h = 0; h < q->nlvl; h++)
+			if (idx[h] < q->lvl[h].cnt &&
+			    (best < 0 ||
+			     QSK_CMP(c, q->lvl[h].pos[idx[h]], q->lvl[best].pos[idx[best]]) < 0))
+				best = h;
+		assert(best >= 0);
+		cum += (ulng) 1 << best;
+		if (cum > target)
+			return q->lvl[best].pos[idx[best]];
+		idx[best]++;
+	}
+}
+
+static const struct sketch_ops qsk_ops = {
+	.size = sizeof(struct qsk),
+	.add = qsk_add,
+	.merge = qsk_merge,
+	.destroy = qsk_destroy,
+};
+
+/* grouped sketches */
+
+static void
+sketch_slice(void *arg)
+{
+	struct sketch_ctx *c = arg;
+	const struct sketch_ops *ops = c->ops;
+	BUN k, i;
+	oid gid = 0;
+
+	for (k = c->lo; k < c->hi; k++) {
+		i = c->cand ? c->cand[k] - c->b->hseqbase : k;
+		if (c->gids) {
+			gid = c->gids[i];
+			if (is_oid_nil(gid) || gid < c->min || gid > c->max)
+				continue;
+			gid -= c->min;
+		}
+		if (c->skip_nils &&
+		    (*c->cmp)(BUNtail(c->bi, i), c->nil) == 0)
+			continue;
+		if ((*ops->add)(c, c->sketches + gid * ops->size, i) != GDK_SUCCEED) {
+			c->ret = GDK_FAIL;
+			return;
+		}
+	}
+	c->ret = GDK_SUCCEED;
+}
+
+static void
+sketch_free(struct sketch_ctx *c, BUN ngrp)
+{
+	BUN g;
+
+	if (c->sketches)
+		for (g = 0; g < ngrp; g++)
+			(*c->ops->destroy)(c->sketches + g * c->ops->size);
+	GDKfree(c->sketches);
+	GDKfree(c->tmp);
+}
+
+/* Build the sketches of the groups of b in c, spreading the work over
+ * several threads when there are many more rows than groups. */
+static gdk_return
+sketch_build(struct sketch_ctx *c, const struct sketch_ops *ops, BAT *b,
+	     BAT *g, BAT *e, BAT *s, int skip_nils, BUN *ngrpp, oid *minp,
+	     const char *func)
+{
+	struct sketch_ctx *slices;
+	oid min, max;
+	BUN ngrp, start, end, n, grp;
+	const oid *cand = NULL, *candend = NULL;
+	const char *err;
+	int nslices = GDKnr_threads, i;
+
+	*c = (struct sketch_ctx) {.ops = ops};
+	*ngrpp = 0;
+	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
+				    &cand, &candend)) != NULL) {
+		GDKerror("%s: %s\n", func, err);
+		return GDK_FAIL;
+	}
+	*ngrpp = ngrp;
+	*minp = min;
+	*c = (struct sketch_ctx) {
+		.ops = ops,
+		.b = b,
+		.bi = bat_iterator(b),
+		.cmp = ATOMcompare(b->ttype),
+		.hash = BATatoms[b->ttype].atomHash,
+		.nil = ATOMnilptr(b->ttype),
+		.skip_nils = skip_nils,
+		.gids = g ? (const oid *) Tloc(g, 0) : NULL,
+		.min = min,
+		.max = max,
+		.cand = cand,
+		.lo = cand ? 0 : start,
+		.hi = cand ? (BUN) (candend - cand) : end,
+	};
+	if (ngrp == 0)
+		return GDK_SUCCEED;
+	if ((c->sketches = GDKzalloc(ngrp * ops->size)) == NULL)
+		return GDK_FAIL;
+
+	/* slices only pay off if there are many rows per group */
+	n = c->hi - c->lo;
+	if (nslices > 1 && n / SKETCH_SLICE < (BUN) nslices)
+		nslices = (int) (n / SKETCH_SLICE);
+	if (nslices > 1 && ngrp > n / nslices / 16)
+		nslices = 1;
+	if (nslices <= 1 ||
+	    (slices = GDKzalloc(nslices * sizeof(struct sketch_ctx))) == NULL) {
+		sketch_slice(c);
+		return c->ret;
+	}
+	for (i = 0; i < nslices; i++) {
+		slices[i] = *c;
+		slices[i].lo = c->lo + (BUN) ((lng) n * i / nslices);
+		slices[i].hi = c->lo + (BUN) ((lng) n * (i + 1) / nslices);
+		if (i > 0 &&
+		    (slices[i].sketches = GDKzalloc(ngrp * ops->size)) == NULL)
+			break;
+	}
+	nslices = i;
+	slices[nslices - 1].hi = c->hi;
+	/* the first slice is processed by the calling thread, slices
+	 * for which no thread can be started as well */
+	for (i = 1; i < nslices; i++)
+		if (MT_create_thread(&slices[i].tid, sketch_slice, &slices[i], MT_THR_JOINABLE) < 0)
+			slices[i].ops = NULL;
+	sketch_slice(&slices[0]);
+	for (i = 1; i < nslices; i++) {
+		if (slices[i].ops == NULL) {
+			slices[i].ops = ops;
+			sketch_slice(&slices[i]);
+		} else {
+			MT_join_thread(slices[i].tid);
+		}
+	}
+	/* slice 0 shares the sketches of c */
+	c->ret = slices[0].ret;
+	c->tmp = slices[0].tmp;
+	c->tmpsize = slices[0].tmpsize;
+	for (i = 1; i < nslices; i++) {
+		if (c->ret == GDK_SUCCEED && slices[i].ret != GDK_SUCCEED)
+			c->ret = GDK_FAIL;
+		for (grp = 0; c->ret == GDK_SUCCEED && grp < ngrp; grp++)
+			c->ret = (*ops->merge)(c, c->sketches + grp * ops->size,
+					       slices[i].sketches + grp * ops->size);
+		sketch_free(&slices[i], ngrp);
+	}
+	GDKfree(slices);
+	return c->ret;
+}
+
+BAT *
+BATgroupapproxcountdistinct(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
+			    int skip_nils, int abort_on_error)
+{
+	struct sketch_ctx c;
+	BUN ngrp, grp;
+	oid min;
+	BAT *bn = NULL;
+	lng *cnts;
+
+	(void) skip_nils;	/* nils are never counted */
+	(void) abort_on_error;
+	assert(tp == TYPE_lng);
+	(void) tp;
+	if (b && b->ttype == TYPE_void) {
+		/* count the materialized oids */
+		if ((b = COLcopy(b, TYPE_oid, 0, TRANSIENT)) == NULL)
+			return NULL;
+		bn = BATgroupapproxcountdistinct(b, g, e, s, tp, skip_nils, abort_on_error);
+		BBPunfix(b->batCacheid);
+		return bn;
+	}
+	if (sketch_build(&c, &hll_ops, b, g, e, s, 1, &ngrp, &min,
+			 "BATgroupapproxcountdistinct") != GDK_SUCCEED)
+		goto bailout;
+	if ((bn = COLnew(min, TYPE_lng, ngrp, TRANSIENT)) == NULL)
+		goto bailout;
+	cnts = (lng *) Tloc(bn, 0);
+	for (grp = 0; grp < ngrp; grp++)
+		cnts[grp] = hll_count((const struct hll *) (c.sketches + grp * sizeof(struct hll)));
+	BATsetcount(bn, ngrp);
+	bn->tsorted = bn->trevsorted = ngrp <= 1;
+	bn->tkey = ngrp <= 1;
+	bn->tnil = 0;
+	bn->tnonil = 1;
+	sketch_free(&c, ngrp);
+	return bn;
+
+  bailout:
+	sketch_free(&c, ngrp);
+	return NULL;
+}
+
+BAT *
+BATgroupapproxquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
+		       double quantile, int skip_nils, int abort_on_error)
+{
+	struct sketch_ctx c;
+	BUN ngrp, grp;
+	oid min, p;
+	BAT *bn, *pos = NULL;
+	oid *restrict ps;
+
+	(void) abort_on_error;
+	if (b == NULL) {
+		GDKerror("BATgroupapproxquantile: b must exist\n");
+		return NULL;
+	}
+	assert(tp == b->ttype);
+	(void) tp;
+	if (!ATOMlinear(b->ttype)) {
+		GDKerror("BATgroupapproxquantile: cannot determine quantile on "
+			 "non-linear type %s\n", ATOMname(b->ttype));
+		return NULL;
+	}
+	if (quantile < 0 || quantile > 1) {
+		GDKerror("BATgroupapproxquantile: cannot determine quantile for "
+			 "p=%f (p has to be in [0,1])\n", quantile);
+		return NULL;
+	}
+	if (b->ttype == TYPE_void) {
+		BAT *m;
+
+		if ((m = COLcopy(b, TYPE_oid, 0, TRANSIENT)) == NULL)
+			return NULL;
+		bn = BATgroupapproxquantile(m, g, e, s, TYPE_oid, quantile, skip_nils, abort_on_error);
+		BBPunfix(m->batCacheid);
+		return bn;
+	}
+	if (sketch_build(&c, &qsk_ops, b, g, e, s, skip_nils, &ngrp, &min,
+			 "BATgroupapproxquantile") != GDK_SUCCEED)
+		goto bailout;
+	if ((pos = COLnew(0, TYPE_oid, ngrp, TRANSIENT)) == NULL)
+		goto bailout;
+	ps = (oid *) Tloc(pos, 0);
+	for (grp = 0; grp < ngrp; grp++) {
+		p = qsk_quantile(&c, (struct qsk *) (c.sketches + grp * sizeof(struct qsk)), quantile);
+		if (p == BUN_NONE)
+			goto bailout;
+		ps[grp] = is_oid_nil(p) ? oid_nil : b->hseqbase + p;
+	}
+	BATsetcount(pos, ngrp);
+	pos->tsorted = pos->trevsorted = ngrp <= 1;
+	pos->tkey = ngrp <= 1;
+	pos->tnil = 0;
+	pos->tnonil = 0;
+	sketch_free(&c, ngrp);
+	bn = BATproject(pos, b);
+	BBPunfix(pos->batCacheid);
+	if (bn)
+		BAThseqbase(bn, min);
+	return bn;
+
+  bailout:
+	sketch_free(&c, ngrp);
+	if (pos)
+		BBPunfix(pos->batCacheid);
+	return NULL;
+}
+
+BAT *
+BATgroupapproxmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
+		     int skip_nils, int abort_on_error)
+{
+	return BATgroupapproxquantile(b, g, e, s, tp, 0.5, skip_nils, abort_on_error);
+}
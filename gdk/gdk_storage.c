@@ -749,6 +749,11 @@ BATsave(BAT *bd)
 	if (!BATdirty(b)) {
 		return GDK_SUCCEED;
 	}
+#ifdef PERSISTENTHASH
+	/* a hash changed since it was persisted would not describe
+	 * the saved BAT */
+	HASHstale(bd);
+#endif
 
 	/* copy the descriptor to a local variable in order to let our
 	 * messing in the BAT descriptor not affect other threads that
@@ -283,6 +283,7 @@ size_t GDK_mem_maxsize = GDK_VM_MAXSIZE;
 size_t GDK_vm_maxsize = GDK_VM_MAXSIZE;
 
 int GDK_vm_trim = 1;
+int GDK_shared_scans = 0;
 
 #define SEG_SIZE(x,y)	((x)+(((x)&((1<<(y))-1))?(1<<(y))-((x)&((1<<(y))-1)):0))
 
@@ -591,6 +592,8 @@ GDKinit(opt *set, int setlen)
 	GDKnr_threads = GDKgetenv_int("gdk_nr_threads", 0);
 	if (GDKnr_threads == 0)
 		GDKnr_threads = MT_check_nr_cores();
+	GDK_shared_scans = GDKgetenv_istrue("gdk_shared_scans") ||
+		GDKgetenv_isyes("gdk_shared_scans");
 
 	if ((p = GDKgetenv("gdk_dbpath")) != NULL &&
 	    (p = strrchr(p, DIR_SEP)) != NULL) {
@@ -780,6 +783,7 @@ GDKreset(int status, int exit)
 		GDKatomcnt = TYPE_str + 1;
 
 		GDK_vm_trim = 1;
+		GDK_shared_scans = 0;
 
 		if (GDK_mem_maxsize / 16 < GDK_mmap_minsize_transient) {
 			GDK_mmap_minsize_transient = GDK_mem_maxsize / 16;
@@ -153,7 +153,8 @@ typedef struct VARRECORD {
             cleanup:1,
             initialized:1,
             used:1,
-            disabled:1;
+            disabled:1,
+            feedback:1;
 	short depth;				/* scope block depth, set to -1 if not used */
 	short worker;				/* thread id of last worker producing it */
 	ValRecord value;
@@ -223,6 +224,7 @@ typedef struct MALBLK {
 	int calls;				/* number of calls */
 	lng optimize;			/* total optimizer time */
 	int activeClients;		/* load during mitosis optimization */
+	int misestimates;		/* feedback variables that deviated from their rowcnt */
 } *MalBlkPtr, MalBlkRecord;
 
 #define STACKINCR   128
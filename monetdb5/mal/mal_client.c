@@ -264,6 +264,7 @@ MCinitClientRecord(Client c, oid user, bstream *fin, stream *fout)
 	c->blocksize = BLOCK;
 	c->protocol = PROTOCOL_9;
 	c->compute_column_widths = 0;
+	c->arrow_results = 0;
 	MT_sema_init(&c->s, 0, "Client->s");
 	return c;
 }
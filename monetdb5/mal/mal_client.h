@@ -191,6 +191,7 @@ typedef struct CLIENT {
 	size_t blocksize;
 	protocol_version protocol;
 	int compute_column_widths;
+	int arrow_results;		/* PROT10 result sets as Arrow IPC messages */
 } *Client, ClientRec;
 
 mal_export void    MCinit(void);
@@ -141,6 +141,7 @@ newMalBlk(int elements)
 	mb->optimize = 0;
 	mb->stmt = NULL;
 	mb->activeClients = 1;
+	mb->misestimates = 0;
 	if (newMalBlkStmt(mb, elements) < 0) {
 		GDKfree(mb->var);
 		GDKfree(mb->stmt);
@@ -767,6 +768,7 @@ newVariable(MalBlkPtr mb, const char *name, size_t len, malType type)
 	}
 
 	setRowCnt(mb,n,0);
+	clrVarFeedback(mb,n);
 	setVarType(mb, n, type);
 	clrVarFixed(mb, n);
 	clrVarUsed(mb, n);
@@ -843,6 +845,7 @@ clearVariable(MalBlkPtr mb, int varid)
 	v->cleanup= 0;
 	v->initialized= 0;
 	v->used= 0;
+	v->feedback= 0;
 	v->rowcnt = 0;
 	v->eolife = 0;
 	v->stc = 0;
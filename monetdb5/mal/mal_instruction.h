@@ -110,6 +110,12 @@
 #define setRowCnt(M,I,C)	(M)->var[I].rowcnt = C
 #define getRowCnt(M,I)		((M)->var[I].rowcnt)
 
+/* the row count of a feedback variable is known, rather than
+ * estimated, at compile time; the interpreter checks it */
+#define clrVarFeedback(M,I)		((M)->var[I].feedback = 0)
+#define setVarFeedback(M,I)		((M)->var[I].feedback = 1)
+#define isVarFeedback(M,I)		((M)->var[I].feedback)
+
 #define setMitosisPartition(P,C)	(P)->mitosis = C
 #define getMitosisPartition(P)		((P)->mitosis)
 
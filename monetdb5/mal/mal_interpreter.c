@@ -20,6 +20,40 @@
 #include "mal_private.h"
   
 
+/*
+ * Cardinality feedback
+ * The front-end marks the variables whose row count it knew when the
+ * plan was compiled, e.g. the columns produced by sql.bind.  The plan
+ * (mitosis partitioning, mergetable expansion, join order) was tuned
+ * for those counts, so a large deviation at runtime means that the
+ * plan no longer fits the data.  The interpreter merely counts them;
+ * it is up to the front-end to compile and optimize a new plan.
+ */
+#define FEEDBACK_FACTOR		8
+#define FEEDBACK_MINROWS	((BUN) 1 << 16)
+
+static inline void
+checkFeedback(MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int i, a;
+	BAT *b;
+	BUN est, cnt;
+
+	for (i = 0; i < pci->retc; i++) {
+		a = getArg(pci, i);
+		if (!isVarFeedback(mb, a) ||
+			stk->stk[a].vtype != TYPE_bat ||
+			is_bat_nil(stk->stk[a].val.bval) ||
+			(b = BBPquickdesc(stk->stk[a].val.bval, FALSE)) == NULL)
+			continue;
+		est = getRowCnt(mb, a);
+		cnt = BATcount(b);
+		if ((cnt > est ? cnt : est) >= FEEDBACK_MINROWS &&
+			(cnt / FEEDBACK_FACTOR > est || est / FEEDBACK_FACTOR > cnt))
+			mb->misestimates++;	/* races are harmless */
+	}
+}
+
 /*
  * The struct alignment leads to 40% gain in simple instructions when set.
  */
@@ -825,6 +859,7 @@ str runMALsequence(Client cntxt, MalBlkPtr mb, int startpc,
 					lhs->val.pval != stk->stk[getArg(pci, i)].val.pval)
 					GDKfree(lhs->val.pval);
 			}
+			checkFeedback(mb, stk, pci);
 			if (GDKdebug & (CHECKMASK|PROPMASK) && exceptionVar < 0) {
 				BAT *b;
 
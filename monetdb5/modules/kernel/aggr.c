@@ -57,7 +57,8 @@ AGGRgrouped(bat *retval1, bat *retval2, const bat *bid, const bat *gid, const ba
 		throw(MAL, malfunc, SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
 	}
 	if (tp == TYPE_any &&
-		(grpfunc1 == BATgroupmedian || quantilefunc == BATgroupquantile))
+		(grpfunc1 == BATgroupmedian || quantilefunc == BATgroupquantile ||
+		 grpfunc1 == BATgroupapproxmedian || quantilefunc == BATgroupapproxquantile))
 		tp = b->ttype;
 
 	if (grpfunc1) {
@@ -872,6 +873,116 @@ AGGRsubquantilecand(bat *retval, const bat *bid, const bat *quantile, const bat
 					   quantile, "aggr.subquantile");
 }
 
+/* approximate aggregates, which keep a sketch per group instead of
+ * sorting or grouping the values */
+mal_export str AGGRapprox_count_distinct3(bat *retval, const bat *bid, const bat *gid, const bat *eid);
+str
+AGGRapprox_count_distinct3(bat *retval, const bat *bid, const bat *gid, const bat *eid)
+{
+	return AGGRgrouped(retval, NULL, bid, gid, eid, NULL, 1, 1, TYPE_lng,
+					   BATgroupapproxcountdistinct, NULL, NULL, NULL,
+					   "aggr.approx_count_distinct");
+}
+
+mal_export str AGGRapprox_count_distinct(bat *retval, const bat *bid, const bit *skip_nils);
+str
+AGGRapprox_count_distinct(bat *retval, const bat *bid, const bit *skip_nils)
+{
+	return AGGRgrouped(retval, NULL, bid, NULL, NULL, NULL, *skip_nils,
+					   0, TYPE_lng, BATgroupapproxcountdistinct, NULL,
+					   NULL, NULL, "aggr.subapprox_count_distinct");
+}
+
+mal_export str AGGRsubapprox_count_distinct(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils);
+str
+AGGRsubapprox_count_distinct(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils)
+{
+	return AGGRgrouped(retval, NULL, bid, gid, eid, NULL, *skip_nils,
+					   0, TYPE_lng, BATgroupapproxcountdistinct, NULL,
+					   NULL, NULL, "aggr.subapprox_count_distinct");
+}
+
+mal_export str AGGRsubapprox_count_distinctcand(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils);
+str
+AGGRsubapprox_count_distinctcand(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils)
+{
+	return AGGRgrouped(retval, NULL, bid, gid, eid, sid, *skip_nils,
+					   0, TYPE_lng, BATgroupapproxcountdistinct, NULL,
+					   NULL, NULL, "aggr.subapprox_count_distinct");
+}
+
+mal_export str AGGRapprox_median3(bat *retval, const bat *bid, const bat *gid, const bat *eid);
+str
+AGGRapprox_median3(bat *retval, const bat *bid, const bat *gid, const bat *eid)
+{
+	return AGGRgrouped(retval, NULL, bid, gid, eid, NULL, 0, 1, TYPE_any,
+					   BATgroupapproxmedian, NULL, NULL, NULL,
+					   "aggr.approx_median");
+}
+
+mal_export str AGGRapprox_median(bat *retval, const bat *bid, const bit *skip_nils);
+str
+AGGRapprox_median(bat *retval, const bat *bid, const bit *skip_nils)
+{
+	return AGGRgrouped(retval, NULL, bid, NULL, NULL, NULL, *skip_nils,
+					   0, TYPE_any, BATgroupapproxmedian, NULL,
+					   NULL, NULL, "aggr.subapprox_median");
+}
+
+mal_export str AGGRsubapprox_median(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils);
+str
+AGGRsubapprox_median(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils)
+{
+	return AGGRgrouped(retval, NULL, bid, gid, eid, NULL, *skip_nils,
+					   0, TYPE_any, BATgroupapproxmedian, NULL,
+					   NULL, NULL, "aggr.subapprox_median");
+}
+
+mal_export str AGGRsubapprox_mediancand(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils);
+str
+AGGRsubapprox_mediancand(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils)
+{
+	return AGGRgrouped(retval, NULL, bid, gid, eid, sid, *skip_nils,
+					   0, TYPE_any, BATgroupapproxmedian, NULL,
+					   NULL, NULL, "aggr.subapprox_median");
+}
+
+mal_export str AGGRapprox_quantile3(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bat *quantile);
+str
+AGGRapprox_quantile3(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bat *quantile)
+{
+	return AGGRgrouped(retval, NULL, bid, gid, eid, NULL, 0, 1, TYPE_any,
+					   NULL, NULL, BATgroupapproxquantile, quantile,
+					   "aggr.approx_quantile");
+}
+
+mal_export str AGGRapprox_quantile(bat *retval, const bat *bid, const bat *quantile, const bit *skip_nils);
+str
+AGGRapprox_quantile(bat *retval, const bat *bid, const bat *quantile, const bit *skip_nils)
+{
+	return AGGRgrouped(retval, NULL, bid, NULL, NULL, NULL, *skip_nils,
+					   0, TYPE_any, NULL, NULL, BATgroupapproxquantile,
+					   quantile, "aggr.subapprox_quantile");
+}
+
+mal_export str AGGRsubapprox_quantile(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bit *skip_nils);
+str
+AGGRsubapprox_quantile(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bit *skip_nils)
+{
+	return AGGRgrouped(retval, NULL, bid, gid, eid, NULL, *skip_nils,
+					   0, TYPE_any, NULL, NULL, BATgroupapproxquantile,
+					   quantile, "aggr.subapprox_quantile");
+}
+
+mal_export str AGGRsubapprox_quantilecand(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils);
+str
+AGGRsubapprox_quantilecand(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils)
+{
+	return AGGRgrouped(retval, NULL, bid, gid, eid, sid, *skip_nils,
+					   0, TYPE_any, NULL, NULL, BATgroupapproxquantile,
+					   quantile, "aggr.subapprox_quantile");
+}
+
 static str
 AGGRgroup_str_concat(bat *retval1, const bat *bid, const bat *gid, const bat *eid, const bat *sid, int skip_nils,
 					 int abort_on_error, BAT *(*str_func)(BAT *, BAT *, BAT *, BAT *, int, int, const str),
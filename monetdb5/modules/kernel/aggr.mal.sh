@@ -258,6 +258,69 @@ command subquantile(b:bat[:any_1],q:bat[:dbl],g:bat[:oid],e:bat[:any_2],s:bat[:o
 address AGGRsubquantilecand
 comment "Grouped median quantile with candidate list";
 
+command approx_count_distinct(b:bat[:any_1],g:bat[:oid],e:bat[:any_2]) :bat[:lng]
+address AGGRapprox_count_distinct3
+comment "Grouped approximate count of distinct values aggregate";
+
+function approx_count_distinct(b:bat[:any_1]) :lng;
+	bn := subapprox_count_distinct(b, true);
+	return algebra.fetch(bn, 0@0);
+end aggr.approx_count_distinct;
+
+command subapprox_count_distinct(b:bat[:any_1],skip_nils:bit) :bat[:lng]
+address AGGRapprox_count_distinct
+comment "Approximate count of distinct values aggregate";
+
+command subapprox_count_distinct(b:bat[:any_1],g:bat[:oid],e:bat[:any_2],skip_nils:bit) :bat[:lng]
+address AGGRsubapprox_count_distinct
+comment "Grouped approximate count of distinct values aggregate";
+
+command subapprox_count_distinct(b:bat[:any_1],g:bat[:oid],e:bat[:any_2],s:bat[:oid],skip_nils:bit) :bat[:lng]
+address AGGRsubapprox_count_distinctcand
+comment "Grouped approximate count of distinct values aggregate with candidate list";
+
+command approx_median(b:bat[:any_1],g:bat[:oid],e:bat[:any_2]) :bat[:any_1]
+address AGGRapprox_median3
+comment "Grouped approximate median aggregate";
+
+function approx_median(b:bat[:any_1]) :any_1;
+	bn := subapprox_median(b, true);
+	return algebra.fetch(bn, 0@0);
+end aggr.approx_median;
+
+command subapprox_median(b:bat[:any_1],skip_nils:bit) :bat[:any_1]
+address AGGRapprox_median
+comment "Approximate median aggregate";
+
+command subapprox_median(b:bat[:any_1],g:bat[:oid],e:bat[:any_2],skip_nils:bit) :bat[:any_1]
+address AGGRsubapprox_median
+comment "Grouped approximate median aggregate";
+
+command subapprox_median(b:bat[:any_1],g:bat[:oid],e:bat[:any_2],s:bat[:oid],skip_nils:bit) :bat[:any_1]
+address AGGRsubapprox_mediancand
+comment "Grouped approximate median aggregate with candidate list";
+
+command approx_quantile(b:bat[:any_1],g:bat[:oid],e:bat[:any_2],q:bat[:dbl]) :bat[:any_1]
+address AGGRapprox_quantile3
+comment "Grouped approximate quantile aggregate";
+
+function approx_quantile(b:bat[:any_1],q:bat[:dbl]) :any_1;
+	bn := subapprox_quantile(b, q, true);
+	return algebra.fetch(bn, 0@0);
+end aggr.approx_quantile;
+
+command subapprox_quantile(b:bat[:any_1],q:bat[:dbl],skip_nils:bit) :bat[:any_1]
+address AGGRapprox_quantile
+comment "Approximate quantile aggregate";
+
+command subapprox_quantile(b:bat[:any_1],q:bat[:dbl],g:bat[:oid],e:bat[:any_2],skip_nils:bit) :bat[:any_1]
+address AGGRsubapprox_quantile
+comment "Grouped approximate quantile aggregate";
+
+command subapprox_quantile(b:bat[:any_1],q:bat[:dbl],g:bat[:oid],e:bat[:any_2],s:bat[:oid],skip_nils:bit) :bat[:any_1]
+address AGGRsubapprox_quantilecand
+comment "Grouped approximate quantile aggregate with candidate list";
+
 EOF
 
 cat <<EOF
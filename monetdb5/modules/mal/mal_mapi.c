@@ -142,6 +142,7 @@ doChallenge(void *data)
 	size_t buflen = BLOCK;
 	column_compression colcomp = COLUMN_COMPRESSION_NONE;
 	int compute_column_widths = 0;
+	int arrow_results = 0;
 
 #ifdef _MSC_VER
 	srand((unsigned int) GDKusec());
@@ -182,6 +183,7 @@ doChallenge(void *data)
 		char *errmsg = NULL;
 		char *buflenstrend, *buflenstr = strstr(buf, "PROT10");
 		compression_method comp;
+		int complevel = 0;
 		protocol = PROTOCOL_10;
 		if ((buflenstr = strchr(buflenstr, ':')) == NULL ||
 			(buflenstr = strchr(buflenstr + 1, ':')) == NULL) {
@@ -201,6 +203,12 @@ doChallenge(void *data)
 		if (strstr(buf, "COMPUTECOLWIDTH")) {
 			compute_column_widths = 1;
 		}
+		if (strstr(buf, "RESULT_ARROW")) {
+			arrow_results = 1;
+		}
+		if (strstr(buf, "COLUMN_ENCODING")) {
+			colcomp = COLUMN_COMPRESSION_AUTO;
+		}
 
 		if (buflen < BLOCK) {
 			mnstr_printf(fdout, "!buffer size needs to be set and bigger than %d\n", BLOCK);
@@ -222,6 +230,15 @@ doChallenge(void *data)
 			comp = COMPRESSION_LZ4;
 #else
 			errmsg = "!server does not support LZ4 compression.\n";
+#endif
+		} else if ((buflenstr = strstr(buf, "COMPRESSION_ZSTD")) != NULL) {
+#ifdef HAVE_LIBZSTD
+			/* COMPRESSION_ZSTD=<level> overrides the server's zstd_level */
+			comp = COMPRESSION_ZSTD;
+			buflenstr += strlen("COMPRESSION_ZSTD");
+			complevel = buflenstr[0] == '=' ? atoi(buflenstr + 1) : GDKgetenv_int("zstd_level", 0);
+#else
+			errmsg = "!server does not support zstd compression.\n";
 #endif
 		} else if (strstr(buf, "COMPRESSION_NONE")) {
 			comp = COMPRESSION_NONE;
@@ -247,6 +264,8 @@ doChallenge(void *data)
 			close_stream(fdout);
 			fdin = block_stream2(from, buflen, comp, colcomp);
 			fdout = block_stream2(to, buflen, comp, colcomp);
+			if (fdout != NULL && complevel != 0)
+				bs2_setcomplevel(fdout, complevel);
 		}
 
 		if (fdin == NULL || fdout == NULL) {
@@ -276,7 +295,7 @@ doChallenge(void *data)
 		return;
 	}
 	bs->eof = 1;
-	MSscheduleClient(buf, challenge, bs, fdout, protocol, buflen, compute_column_widths);
+	MSscheduleClient(buf, challenge, bs, fdout, protocol, buflen, compute_column_widths, arrow_results);
 }
 
 static volatile ATOMIC_TYPE nlistener = 0; /* nr of listeners */
@@ -19,7 +19,7 @@
  *
  * The code below consists of a file reader, which breaks up the
  * file into chunks of distinct lines. Then multiple parallel threads
- * grab them, and break them on the field boundaries.
+ * grab disjoint blocks of them, and break them on the field boundaries.
  * After all fields are identified this way, the columns are converted
  * and stored in the BATs.
  *
@@ -47,9 +47,46 @@
 
 #define MAXWORKERS	64
 #define MAXBUFFERS 2
+#define MINSPLIT	1024	/* lines worth handing to another thread */
 /* We restrict the row length to be 32MB for the time being */
 #define MAXROWSIZE(X) (X > 32*1024*1024 ? X : 32*1024*1024)
 
+/*
+ * The record and field separators are located a word at a time. A
+ * byte of w equals c iff the corresponding byte of w ^ (c * SCANONES)
+ * is zero, and SCANZERO(w) is non-zero iff w contains a zero byte.
+ * Only a word with a hit is inspected byte by byte. The words are
+ * aligned, hence the scan may read up to sizeof(ulng) bytes beyond the
+ * terminating null byte, which is why the line buffers get SCANSLACK
+ * extra bytes.
+ */
+#define SCANONES	((ulng) 0x0101010101010101)
+#define SCANHIGHS	((ulng) 0x8080808080808080)
+#define SCANZERO(w)	(((w) - SCANONES) & ~(w) & SCANHIGHS)
+#define SCANSLACK	sizeof(ulng)
+
+/* return the first occurrence of c1, c2, c3 or the null byte in s */
+static inline char *
+tablet_scan(char *s, char c1, char c2, char c3)
+{
+	const ulng m1 = SCANONES * (unsigned char) c1;
+	const ulng m2 = SCANONES * (unsigned char) c2;
+	const ulng m3 = SCANONES * (unsigned char) c3;
+	ulng w;
+
+	for (; ((uintptr_t) s & (sizeof(ulng) - 1)) != 0; s++)
+		if (*s == 0 || *s == c1 || *s == c2 || *s == c3)
+			return s;
+	for (;; s += sizeof(ulng)) {
+		memcpy(&w, s, sizeof(ulng));
+		if (SCANZERO(w) | SCANZERO(w ^ m1) | SCANZERO(w ^ m2) | SCANZERO(w ^ m3))
+			break;
+	}
+	while (*s && *s != c1 && *s != c2 && *s != c3)
+		s++;
+	return s;
+}
+
 static MT_Lock errorlock MT_LOCK_INITIALIZER("errorlock");
 
 static BAT *
@@ -230,7 +267,7 @@ TABLETcollect_parts(BAT **bats, Tablet *as, BUN offset)
 static char *
 tablet_skip_string(char *s, char quote)
 {
-	while (*s) {
+	while (*(s = tablet_scan(s, quote, '\\', quote))) {
 		if (*s == '\\' && s[1] != '\0')
 			s++;
 		else if (*s == quote) {
@@ -262,13 +299,15 @@ TABLET_error(stream *s)
 }
 
 /* The output line is first built before being sent. It solves a problem
-   with UDP, where you may loose most of the information using short writes
+   with UDP, where you may loose most of the information using short writes.
+   The line is appended to *buf at *fillp; when fd is set, the buffer is
+   written and emptied.
 */
 static inline int
-output_line(char **buf, size_t *len, char **localbuf, size_t *locallen, Column *fmt, stream *fd, BUN nr_attrs, oid id)
+output_line(char **buf, size_t *len, ssize_t *fillp, char **localbuf, size_t *locallen, Column *fmt, stream *fd, BUN nr_attrs, oid id)
 {
 	BUN i;
-	ssize_t fill = 0;
+	ssize_t fill = *fillp;
 
 	for (i = 0; i < nr_attrs; i++) {
 		if (fmt[i].c == NULL)
@@ -306,21 +345,33 @@ output_line(char **buf, size_t *len, char **localbuf, size_t *locallen, Column *
 				}
 				strncpy(*buf + fill, p, l);
 				fill += l;
+			} else if (fill + f->seplen >= (ssize_t) *len) {
+				/* the buffer may be full with the previous rows */
+				char *nbuf;
+				nbuf = GDKrealloc(*buf, fill + f->seplen + BUFSIZ);
+				if( nbuf == NULL)
+					return -1; /* *buf freed by caller */
+				*buf = nbuf;
+				*len = fill + f->seplen + BUFSIZ;
 			}
 			strncpy(*buf + fill, f->sep, f->seplen);
 			fill += f->seplen;
 		}
 	}
-	if (fd && mnstr_write(fd, *buf, 1, fill) != fill)
-		return TABLET_error(fd);
+	if (fd) {
+		if (mnstr_write(fd, *buf, 1, fill) != fill)
+			return TABLET_error(fd);
+		fill = 0;
+	}
+	*fillp = fill;
 	return 0;
 }
 
 static inline int
-output_line_dense(char **buf, size_t *len, char **localbuf, size_t *locallen, Column *fmt, stream *fd, BUN nr_attrs)
+output_line_dense(char **buf, size_t *len, ssize_t *fillp, char **localbuf, size_t *locallen, Column *fmt, stream *fd, BUN nr_attrs)
 {
 	BUN i;
-	ssize_t fill = 0;
+	ssize_t fill = *fillp;
 
 	for (i = 0; i < nr_attrs; i++) {
 		Column *f = fmt + i;
@@ -351,12 +402,24 @@ output_line_dense(char **buf, size_t *len, char **localbuf, size_t *locallen, Co
 			strncpy(*buf + fill, p, l);
 			fill += l;
 			f->p++;
+		} else if (fill + f->seplen >= (ssize_t) *len) {
+			/* the buffer may be full with the previous rows */
+			char *nbuf;
+			nbuf = GDKrealloc(*buf, fill + f->seplen + BUFSIZ);
+			if( nbuf == NULL)
+				return -1;	/* *buf freed by caller */
+			*buf = nbuf;
+			*len = fill + f->seplen + BUFSIZ;
 		}
 		strncpy(*buf + fill, f->sep, f->seplen);
 		fill += f->seplen;
 	}
-	if (fd && mnstr_write(fd, *buf, 1, fill) != fill)
-		return TABLET_error(fd);
+	if (fd) {
+		if (mnstr_write(fd, *buf, 1, fill) != fill)
+			return TABLET_error(fd);
+		fill = 0;
+	}
+	*fillp = fill;
 	return 0;
 }
 
@@ -469,6 +532,7 @@ output_file_default(Tablet *as, BAT *order, stream *fd)
 	oid id;
 	BUN i = 0;
 	BUN offset = as->offset;
+	ssize_t fill = 0;
 
 	if (buf == NULL || localbuf == NULL) {
 		GDKfree(buf);
@@ -476,7 +540,7 @@ output_file_default(Tablet *as, BAT *order, stream *fd)
 		return -1;
 	}
 	for (q = offset + as->nr, p = offset, id = order->hseqbase + offset; p < q; p++, id++) {
-		if ((res = output_line(&buf, &len, &localbuf, &locallen, as->format, fd, as->nr_attrs, id)) < 0) {
+		if ((res = output_line(&buf, &len, &fill, &localbuf, &locallen, as->format, fd, as->nr_attrs, id)) < 0) {
 			GDKfree(buf);
 			GDKfree(localbuf);
 			return res;
@@ -500,6 +564,7 @@ output_file_dense(Tablet *as, stream *fd)
 	char *buf = GDKzalloc(len);
 	char *localbuf = GDKzalloc(len);
 	BUN i = 0;
+	ssize_t fill = 0;
 
 	if (buf == NULL || localbuf == NULL) {
 		GDKfree(buf);
@@ -507,7 +572,7 @@ output_file_dense(Tablet *as, stream *fd)
 		return -1;
 	}
 	for (i = 0; i < as->nr; i++) {
-		if ((res = output_line_dense(&buf, &len, &localbuf, &locallen, as->format, fd, as->nr_attrs)) < 0) {
+		if ((res = output_line_dense(&buf, &len, &fill, &localbuf, &locallen, as->format, fd, as->nr_attrs)) < 0) {
 			GDKfree(buf);
 			GDKfree(localbuf);
 			return res;
@@ -550,6 +615,130 @@ output_file_ordered(Tablet *as, BAT *order, stream *fd)
 	return res;
 }
 
+/*
+ * Large results are formatted by several threads.  The rows are cut
+ * into slices of OUTPUT_SLICE rows, and worker w formats the slices w,
+ * w + n, w + 2n, ... one at a time into its private buffer.  The
+ * calling thread writes the buffers to the stream in the order of the
+ * slices, and hands each buffer back to its worker once written.
+ */
+#define OUTPUT_SLICE	16384
+#define OUTPUT_PARALLEL	(8 * OUTPUT_SLICE)	/* smaller results are formatted serially */
+
+typedef struct {
+	Tablet *as;
+	BAT *order;					/* NULL when the columns are dense */
+	Column *fmt;				/* private copy, for the column cursors */
+	int id, nthreads;
+	char *buf, *localbuf;
+	size_t len, locallen;
+	ssize_t fill;
+	int res;
+	int stop;
+	MT_Sema ready;				/* a slice has been formatted */
+	MT_Sema free;				/* the buffer has been written */
+	MT_Id tid;
+} OUTPUTtask;
+
+static void
+output_worker(void *arg)
+{
+	OUTPUTtask *t = arg;
+	Tablet *as = t->as;
+	BUN s, p, q, i;
+
+	for (s = (BUN) t->id * OUTPUT_SLICE; s < as->nr; s += (BUN) t->nthreads * OUTPUT_SLICE) {
+		MT_sema_down(&t->free);
+		if (t->stop)
+			break;
+		q = s + OUTPUT_SLICE < as->nr ? s + OUTPUT_SLICE : as->nr;
+		t->fill = 0;
+		if (t->order == NULL) {
+			for (i = 0; i < as->nr_attrs; i++)
+				t->fmt[i].p = as->offset + s;
+			for (p = s; p < q && t->res == 0; p++)
+				t->res = output_line_dense(&t->buf, &t->len, &t->fill, &t->localbuf, &t->locallen, t->fmt, NULL, as->nr_attrs);
+		} else {
+			oid id = t->order->hseqbase + as->offset + s;
+
+			for (p = s; p < q && t->res == 0; p++, id++)
+				t->res = output_line(&t->buf, &t->len, &t->fill, &t->localbuf, &t->locallen, t->fmt, NULL, as->nr_attrs, id);
+		}
+		MT_sema_up(&t->ready);
+		if (t->res < 0)
+			break;
+	}
+}
+
+static int
+output_file_parallel(Tablet *as, BAT *order, stream *fd, int nthreads)
+{
+	OUTPUTtask *tasks = GDKzalloc(sizeof(OUTPUTtask) * nthreads);
+	int j, started = 0, res = 0;
+	BUN s;
+
+	if (tasks == NULL)
+		return -1;
+	for (j = 0; j < nthreads; j++) {
+		OUTPUTtask *t = tasks + j;
+
+		t->as = as;
+		t->order = order;
+		t->id = j;
+		t->nthreads = nthreads;
+		t->len = t->locallen = BUFSIZ;
+		t->buf = GDKzalloc(t->len);
+		t->localbuf = GDKzalloc(t->locallen);
+		t->fmt = GDKmalloc(sizeof(Column) * as->nr_attrs);
+		if (t->buf == NULL || t->localbuf == NULL || t->fmt == NULL) {
+			res = -1;
+			break;
+		}
+		memcpy(t->fmt, as->format, sizeof(Column) * as->nr_attrs);
+		MT_sema_init(&t->ready, 0, "output.ready");
+		MT_sema_init(&t->free, 1, "output.free");
+		if (MT_create_thread(&t->tid, output_worker, t, MT_THR_JOINABLE) < 0) {
+			MT_sema_destroy(&t->ready);
+			MT_sema_destroy(&t->free);
+			res = -1;
+			break;
+		}
+		started++;
+	}
+
+	for (s = 0; res == 0 && s * OUTPUT_SLICE < as->nr; s++) {
+		OUTPUTtask *t = tasks + s % nthreads;
+
+		MT_sema_down(&t->ready);
+		if (t->res < 0) {
+			res = t->res;
+			break;
+		}
+		if (mnstr_write(fd, t->buf, 1, t->fill) != t->fill) {
+			res = TABLET_error(fd);
+			break;
+		}
+		MT_sema_up(&t->free);
+	}
+
+	for (j = 0; j < started; j++) {
+		tasks[j].stop = 1;
+		MT_sema_up(&tasks[j].free);
+	}
+	for (j = 0; j < nthreads; j++) {
+		if (j < started) {
+			MT_join_thread(tasks[j].tid);
+			MT_sema_destroy(&tasks[j].ready);
+			MT_sema_destroy(&tasks[j].free);
+		}
+		GDKfree(tasks[j].buf);
+		GDKfree(tasks[j].localbuf);
+		GDKfree(tasks[j].fmt);
+	}
+	GDKfree(tasks);
+	return res;
+}
+
 int
 TABLEToutput_file(Tablet *as, BAT *order, stream *s)
 {
@@ -566,7 +755,15 @@ TABLEToutput_file(Tablet *as, BAT *order, stream *s)
 		as->nr = maxnr;
 
 	base = check_BATs(as);
-	if (!is_oid_nil(base)) {
+	if (GDKnr_threads > 1 && as->nr >= OUTPUT_PARALLEL &&
+		(is_oid_nil(base) || order->hseqbase == base)) {
+		BUN slices = (as->nr + OUTPUT_SLICE - 1) / OUTPUT_SLICE;
+		int threads = GDKnr_threads < MAXWORKERS ? GDKnr_threads : MAXWORKERS;
+
+		if ((BUN) threads > slices)
+			threads = (int) slices;
+		ret = output_file_parallel(as, is_oid_nil(base) ? order : NULL, s, threads);
+	} else if (!is_oid_nil(base)) {
 		if (order->hseqbase == base)
 			ret = output_file_dense(as, s);
 		else
@@ -590,7 +787,7 @@ TABLEToutput_file(Tablet *as, BAT *order, stream *s)
  *
  * The code below consists of a file reader, which breaks up the
  * file into chunks of distinct lines. Then multiple parallel threads
- * grab them, and break them on the field boundaries.
+ * grab disjoint blocks of them, and break them on the field boundaries.
  * After all fields are identified this way, the columns are converted
  * and stored in the BATs.
  *
@@ -939,7 +1136,24 @@ SQLworker_column(READERtask *task, int col)
 	MT_lock_unset(&mal_copyLock);
 
 	for (i = 0; i < task->top[task->cur]; i++) {
-		if (!fmt[col].skip && SQLinsert_val(task, col, i) < 0) {
+		if (fmt[col].skip)
+			continue;
+		if (fmt[col].frbat) {
+			/* convert a run of fields in one go; the field
+			 * that stopped it is handled (and reported) by
+			 * SQLinsert_val */
+			BAT *b = fmt[col].c;
+			int n = task->top[task->cur] - i;
+
+			if ((BUN) n > BATcapacity(b) - BATcount(b))
+				n = (int) (BATcapacity(b) - BATcount(b));
+			n = fmt[col].frbat(&fmt[col], fmt[col].adt, task->fields[col] + i, n, Tloc(b, BUNlast(b)));
+			b->batCount += n;
+			i += n;
+			if (i == task->top[task->cur])
+				break;
+		}
+		if (SQLinsert_val(task, col, i) < 0) {
 			BATsetcount(fmt[col].c, BATcount(fmt[col].c));
 			return -1;
 		}
@@ -1003,15 +1217,17 @@ SQLload_parse_line(READERtask *task, int idx)
 			}
 
 			/* eat away the column separator */
-			for (; *line; line++)
+			while (*(line = tablet_scan(line, '\\', ch, ch))) {
 				if (*line == '\\') {
 					if (line[1])
 						line++;
-				} else if (*line == ch && (task->seplen == 1 || strncmp(line, task->csep, task->seplen) == 0)) {
+				} else if (task->seplen == 1 || strncmp(line, task->csep, task->seplen) == 0) {
 					*line = 0;
 					line += task->seplen;
 					goto endoffieldcheck;
 				}
+				line++;
+			}
 
 			/* not enough fields */
 			if (i < as->nr_attrs - 1) {
@@ -1041,15 +1257,16 @@ SQLload_parse_line(READERtask *task, int idx)
 			mnstr_printf(GDKout, "before #2 %s\n", line);
 #endif
 			/* eat away the column separator */
-			for (; *line; line++)
-				if (*line == '\\') {
-					if (line[1])
-						line++;
-				} else if (*line == ch) {
+			while (*(line = tablet_scan(line, '\\', ch, ch))) {
+				if (*line == ch) {
 					*line = 0;
 					line++;
 					goto endoffield2;
 				}
+				if (line[1])
+					line++;
+				line++;
+			}
 #ifdef _DEBUG_TABLET_
 			mnstr_printf(GDKout, "#after #23 %s\n", line);
 #endif
@@ -1113,6 +1330,8 @@ SQLworker(void *arg)
 		case BREAKLINE:
 			t0 = GDKusec();
 			piece = (task->top[task->cur] + task->workers) / task->workers;
+			if (piece < MINSPLIT)
+				piece = MINSPLIT;
 #ifdef _DEBUG_TABLET_
 			mnstr_printf(GDKout, "#SQLworker id %d %d  piece %d-%d\n",
 						 task->id, task->top[task->cur], piece * task->id,
@@ -1185,6 +1404,16 @@ SQLworkdivider(READERtask *task, READERtask *ptask, int nr_attrs, int threads)
 	/* after a few rounds we stick to the work assignment */
 	if (task->rounds > 8)
 		return;
+	for (i = 0; i < nr_attrs; i++)
+		for (j = 0; j < threads; j++)
+			ptask[j].cols[i] = 0;
+	/* a small batch is handled by a single thread, which also keeps
+	 * the errors reported in order */
+	if (task->top[task->cur] < MINSPLIT) {
+		for (i = 0; i < nr_attrs; i++)
+			ptask[0].cols[i] = task->cols[i];
+		return;
+	}
 	/* simple round robin the first time */
 	if (threads == 1 || task->rounds++ == 0) {
 		for (i = j = 0; i < nr_attrs; i++, j++)
@@ -1193,9 +1422,6 @@ SQLworkdivider(READERtask *task, READERtask *ptask, int nr_attrs, int threads)
 	}
 	memset((char *) loc, 0, sizeof(lng) * MAXWORKERS);
 	/* use of load directives */
-	for (i = 0; i < nr_attrs; i++)
-		for (j = 0; j < threads; j++)
-			ptask[j].cols[i] = 0;
 
 	/* now allocate the work to the threads */
 	for (i = 0; i < nr_attrs; i++, j++) {
@@ -1324,100 +1550,34 @@ SQLproducer(void *p)
 			 * In the first phase we simply break the lines at the
 			 * record boundary. */
 			if (quote == 0) {
-				switch (rseplen) {
-				case 1:
-					for (; *e; e++) {
-						if (*e == '\\') {
-							if (*++e == 0)
-								break;
-							continue;
-						}
-						if (*e == *rsep)
-							break;
-					}
-					break;
-				case 2:
-					for (; *e; e++) {
-						if (*e == '\\') {
-							if (*++e == 0)
-								break;
-							continue;
-						}
-						if (*e == *rsep && e[1] == rsep[1])
-							break;
-					}
-					break;
-				default:
-					for (; *e; e++) {
-						if (*e == '\\') {
-							if (*++e == 0)
-								break;
-							continue;
-						}
-						if (*e == *rsep && strncmp(e, rsep, rseplen) == 0)
+				while (*(e = tablet_scan(e, '\\', *rsep, *rsep))) {
+					if (*e == '\\') {
+						if (*++e == 0)
 							break;
-					}
-				}
-				if (*e == 0) {
-					partial = e - s;
-					e = 0;	/* nonterminated record, we need more */
+					} else if (rseplen == 1 || strncmp(e, rsep, rseplen) == 0)
+						break;
+					e++;
 				}
 			} else {
 				char q = 0;
 
-				switch (rseplen) {
-				case 1:
-					for (; *e; e++) {
-						if (*e == q)
-							q = 0;
-						else if (*e == quote)
-							q = *e;
-						else if (*e == '\\') {
-							if (*++e == 0)
-								break;
-						} else if (!q && *e == *rsep)
+				while (*(e = tablet_scan(e, quote, '\\', *rsep))) {
+					if (*e == q)
+						q = 0;
+					else if (*e == quote)
+						q = *e;
+					else if (*e == '\\') {
+						if (*++e == 0)
 							break;
-					}
-					if (*e == 0) {
-						partial = e - s;
-						e = 0;	/* nonterminated record, we need more */
-					}
-					break;
-				case 2:
-					for (; *e; e++) {
-						if (*e == q)
-							q = 0;
-						else if (*e == quote)
-							q = *e;
-						else if (*e == '\\') {
-							if (e[1])
-								e++;
-						} else if (!q && e[0] == rsep[0] && e[1] == rsep[1])
-							break;
-					}
-					if (*e == 0) {
-						partial = e - s;
-						e = 0;	/* nonterminated record, we need more */
-					}
-					break;
-				default:
-					for (; *e; e++) {
-						if (*e == q)
-							q = 0;
-						else if (*e == quote)
-							q = *e;
-						else if (*e == '\\') {
-							if (*++e == 0)
-								break;
-						} else if (!q && *e == *rsep && strncmp(e, rsep, rseplen) == 0)
-							break;
-					}
-					if (*e == 0) {
-						partial = e - s;
-						e = 0;	/* nonterminated record, we need more */
-					}
+					} else if (!q && (rseplen == 1 || strncmp(e, rsep, rseplen) == 0))
+						break;
+					e++;
 				}
 			}
+			if (*e == 0) {
+				partial = e - s;
+				e = 0;	/* nonterminated record, we need more */
+			}
 			/* check for incomplete line and end of buffer condition */
 			if (e) {
 				/* found a complete record, do we need to skip it? */
@@ -1584,7 +1744,7 @@ SQLload_file(Client cntxt, Tablet *as, bstream *b, stream *out, const char *csep
 	BUN i, attr;
 	READERtask task;
 	READERtask ptask[MAXWORKERS];
-	int threads = (!maxrow || maxrow > (1 << 16)) ? (GDKnr_threads < MAXWORKERS && GDKnr_threads > 1 ? GDKnr_threads - 1 : MAXWORKERS - 1) : 1;
+	int threads = (maxrow < 0 || maxrow > (1 << 16)) ? (GDKnr_threads >= MAXWORKERS ? MAXWORKERS - 1 : GDKnr_threads > 1 ? GDKnr_threads - 1 : 1) : 1;
 	lng lio = 0, tio, t1 = 0, total = 0, iototal = 0;
 	int vmtrim = GDK_vm_trim;
 
@@ -1621,7 +1781,7 @@ SQLload_file(Client cntxt, Tablet *as, bstream *b, stream *out, const char *csep
 	}
 	task.cur = 0;
 	for (i = 0; i < MAXBUFFERS; i++) {
-		task.base[i] = GDKzalloc(MAXROWSIZE(2 * b->size) + 2);
+		task.base[i] = GDKzalloc(MAXROWSIZE(2 * b->size) + 2 + SCANSLACK);
 		task.rowlimit[i] = MAXROWSIZE(2 * b->size);
 		if (task.base[i] == 0) {
 			tablet_error(&task, lng_nil, int_nil, SQLSTATE(HY001) MAL_MALLOC_FAIL, "SQLload_file");
@@ -1666,9 +1826,10 @@ SQLload_file(Client cntxt, Tablet *as, bstream *b, stream *out, const char *csep
 #endif
 	as->error = NULL;
 
-	/* there is no point in creating more threads than we have columns */
-	if (as->nr_attrs < (BUN) threads)
-		threads = (int) as->nr_attrs;
+	/* all threads break disjoint blocks of lines on the field
+	 * boundaries, but a column is converted by a single thread, so
+	 * for narrow tables some of them only take part in the first
+	 * phase */
 
 	/* allocate enough space for pointers into the buffer pool.  */
 	/* the record separator is considered a column */
@@ -45,6 +45,10 @@ typedef struct Column_t {
 	int scale, precision;
 	ssize_t (*tostr)(void *extra, char **buf, size_t *len, int type, const void *a);
 	void *(*frstr)(struct Column_t *fmt, int type, const char *s);
+	/* optional bulk version of frstr: convert up to cnt fields into
+	 * consecutive values at dst, return the number of values
+	 * converted; stops at the first field that cannot be converted */
+	int (*frbat)(struct Column_t *fmt, int type, char **s, int cnt, void *dst);
 	void *extra;
 	void *data;
 	int skip;					/* only skip to the next field */
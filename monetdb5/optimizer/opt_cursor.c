@@ -0,0 +1,231 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+/* author M.Kersten
+ * The cursor optimizer defers the final projections of a query result
+ * to the moment the rows are sent to the client.  A result column that
+ * is a projection of a table column over a candidate list, used by the
+ * result set only, e.g.
+ *     X_9:bat[:int] := sql.bind(X_5, "sys", "t", "a", 0:int);
+ *     X_30:bat[:int] := algebra.projection(C_28:bat[:oid], X_9:bat[:int]);
+ *     sql.resultSet(X_50, X_51, X_52, X_54, X_56, X_30, X_31);
+ * is handed to the result set as the pair (C_28, X_9):
+ *     sql.resultCursor(X_50, X_51, X_52, X_54, X_56, C_28, X_9, nil:bat[:oid], X_31);
+ * Columns that are not such a projection come with a nil candidate
+ * list.  The result set then only holds the candidate list, which is
+ * dense and hence takes no space at all for a full table scan, and the
+ * rows are projected a chunk at a time while they are being sent, so
+ * the server does not materialize the complete result.
+ *
+ * The rewrite only pays off when the result set is not cut in pieces
+ * by mitosis, hence it is used in the streaming pipeline, which lacks
+ * mitosis and dataflow.
+ */
+#include "monetdb_config.h"
+#include "mal_builder.h"
+#include "opt_cursor.h"
+
+#if 0
+#define OPTDEBUGcursor(CODE) { CODE }
+#else
+#define OPTDEBUGcursor(CODE)
+#endif
+
+/* the variable is the base column of a table, as bound for reading */
+static int
+cursorColumn(MalBlkPtr mb, InstrPtr *old, int *def, int a)
+{
+	InstrPtr p;
+
+	if (def[a] < 0)
+		return 0;
+	p = old[def[a]];
+	return getModuleId(p) == sqlRef && getFunctionId(p) == bindRef &&
+		p->retc == 1 && p->argc == 6 &&
+		isVarConstant(mb, getArg(p, 5)) &&
+		getVarConstant(mb, getArg(p, 5)).val.ival == 0;
+}
+
+/* the result column can be projected while it is sent */
+static int
+cursorProjection(MalBlkPtr mb, InstrPtr *old, int *def, int *uses, int a)
+{
+	InstrPtr p;
+	int j;
+
+	if (def[a] < 0 || uses[a] != 1)
+		return 0;
+	p = old[def[a]];
+	if (getModuleId(p) != algebraRef || p->retc != 1 ||
+		(getFunctionId(p) != projectionRef && getFunctionId(p) != projectionpathRef) ||
+		p->argc < 3)
+		return 0;
+	for (j = p->retc; j < p->argc - 1; j++)
+		if (def[getArg(p, j)] == -2 || getBatType(getArgType(mb, p, j)) != TYPE_oid)
+			return 0;
+	return cursorColumn(mb, old, def, getArg(p, p->argc - 1));
+}
+
+#define CURSOR_PROJECTION	1
+#define CURSOR_RESULT	2
+
+str
+OPTcursorImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int i, j, a, found = 0, actions = 0;
+	int limit = mb->stop, slimit = mb->ssize;
+	InstrPtr p, q, r, *old = mb->stmt;
+	int *uses = NULL, *def = NULL, *mark = NULL, *cand = NULL;
+	char buf[256];
+	lng usec = GDKusec();
+	str msg = MAL_SUCCEED;
+
+	(void) stk;
+	(void) pci;
+
+	OPTDEBUGcursor(
+		fprintf(stderr, "#Optimize cursor\n");
+		fprintFunction(stderr, mb, 0, LIST_MAL_DEBUG);
+	)
+
+	uses = (int *) GDKzalloc(mb->vtop * sizeof(int));
+	def = (int *) GDKmalloc(mb->vtop * sizeof(int));
+	mark = (int *) GDKzalloc(limit * sizeof(int));
+	cand = (int *) GDKzalloc(limit * sizeof(int));
+	if (uses == NULL || def == NULL || mark == NULL || cand == NULL) {
+		msg = createException(MAL, "optimizer.cursor", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		goto wrapup;
+	}
+	for (i = 0; i < mb->vtop; i++)
+		def[i] = -1;
+	for (i = 0; i < limit; i++) {
+		p = old[i];
+		for (j = 0; j < p->retc; j++)
+			def[getArg(p, j)] = def[getArg(p, j)] == -1 ? i : -2;
+		for (; j < p->argc; j++)
+			uses[getArg(p, j)]++;
+	}
+
+	/* mark the result sets of columns and the projections that are
+	 * only used by them */
+	for (i = 0; i < limit; i++) {
+		p = old[i];
+		if (getModuleId(p) != sqlRef || getFunctionId(p) != resultSetRef ||
+			p->argc <= p->retc + 5 ||
+			!isaBatType(getArgType(mb, p, p->retc)))
+			continue;
+		for (j = p->retc + 5; j < p->argc; j++)
+			if (!isaBatType(getArgType(mb, p, j)))
+				break;
+		if (j < p->argc)
+			continue;
+		for (j = p->retc + 5; j < p->argc; j++) {
+			a = getArg(p, j);
+			if (cursorProjection(mb, old, def, uses, a)) {
+				mark[def[a]] = CURSOR_PROJECTION;
+				mark[i] = CURSOR_RESULT;
+				found++;
+			}
+		}
+	}
+	if (found == 0)
+		goto wrapup;
+
+	if (newMalBlkStmt(mb, mb->ssize) < 0) {
+		mb->stmt = old;
+		msg = createException(MAL, "optimizer.cursor", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		goto wrapup;
+	}
+
+	for (i = 0; i < limit; i++) {
+		p = old[i];
+		if (mark[i] == CURSOR_PROJECTION) {
+			/* the candidates are the first argument of a
+			 * projection, and the path without its last step
+			 * for a projection path */
+			cand[i] = getArg(p, 1);
+			if (p->argc > 3 && (q = copyInstruction(p)) != NULL) {
+				q->argc--;
+				getArg(q, 0) = newTmpVariable(mb, newBatType(TYPE_oid));
+				setVarUDFtype(mb, getArg(q, 0));
+				if (q->argc == 3)
+					setFunctionId(q, projectionRef);
+				q->typechk = TYPE_UNKNOWN;
+				pushInstruction(mb, q);
+				cand[i] = getArg(q, 0);
+			} else if (p->argc > 3) {
+				mark[i] = 0;
+			}
+			/* the projection itself is dropped as dead code */
+			pushInstruction(mb, p);
+			continue;
+		}
+		if (mark[i] != CURSOR_RESULT) {
+			pushInstruction(mb, p);
+			continue;
+		}
+		q = newInstruction(mb, sqlRef, resultCursorRef);
+		if (q == NULL) {
+			pushInstruction(mb, p);
+			continue;
+		}
+		getArg(q, 0) = getArg(p, 0);
+		for (j = p->retc; j < p->retc + 5; j++)
+			q = pushArgument(mb, q, getArg(p, j));
+		for (; q && j < p->argc; j++) {
+			a = getArg(p, j);
+			if (def[a] >= 0 && mark[def[a]] == CURSOR_PROJECTION) {
+				r = old[def[a]];
+				q = pushArgument(mb, q, cand[def[a]]);
+				q = pushArgument(mb, q, getArg(r, r->argc - 1));
+			} else {
+				q = pushNil(mb, q, newBatType(TYPE_oid));
+				q = pushArgument(mb, q, a);
+			}
+		}
+		if (q == NULL) {
+			pushInstruction(mb, p);
+			continue;
+		}
+		pushInstruction(mb, q);
+		freeInstruction(p);
+		OPTDEBUGcursor(
+			fprintf(stderr, "#Optimize cursor result set\n");
+			fprintInstruction(stderr, mb, 0, q, LIST_MAL_DEBUG);
+		)
+		actions++;
+	}
+	for (i = limit; i < slimit; i++)
+		if (old[i])
+			freeInstruction(old[i]);
+	GDKfree(old);
+
+	OPTDEBUGcursor(
+		fprintf(stderr, "#Optimize cursor done\n");
+		fprintFunction(stderr, mb, 0, LIST_MAL_DEBUG);
+	)
+
+    /* Defense line against incorrect plans */
+	if (actions > 0) {
+		chkTypes(cntxt->usermodule, mb, FALSE);
+		chkFlow(mb);
+		chkDeclarations(mb);
+	}
+wrapup:
+	GDKfree(uses);
+	GDKfree(def);
+	GDKfree(mark);
+	GDKfree(cand);
+    /* keep all actions taken as a post block comment */
+	usec = GDKusec()- usec;
+    snprintf(buf,256,"%-20s actions=%2d time=" LLFMT " usec","cursor",actions, usec);
+    newComment(mb,buf);
+	if( actions >= 0)
+		addtoMalBlkHistory(mb);
+	return msg;
+}
@@ -0,0 +1,16 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+#ifndef _MAL_CURSOR_
+#define _MAL_CURSOR_
+#include "opt_prelude.h"
+#include "opt_support.h"
+
+mal_export str OPTcursorImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p);
+
+#endif
@@ -7,16 +7,23 @@
  */
 
 /* author M.Kersten
- * This optimizer can be used for JIT optimization and moves
- * candidate lists into MAL operations where possible.
- * It should be ran after the candidates optimizer.
- * Specific snippets to be replaced
- *     C_1:bat[:oid] := sql.tid(X_0,"sys","t");
- *     X_4:bat[:int] := sql.bind(X_0,"sys","t","i",0);
- *     X_13 := algebra.projection(C_1,X_4);
- * projection can be avoided
+ * The JIT optimizer fuses expression trees of bulk arithmetic and
+ * comparison operators into a single instruction, such that they are
+ * evaluated in one loop over the input columns instead of producing a
+ * materialized intermediate per operator.  For example
+ *     X_10:bat[:lng] := batcalc.*(X_4:bat[:int], X_5:bat[:int]);
+ *     X_11:bat[:lng] := batcalc.+(X_10, X_6:bat[:lng]);
+ *     X_12:bat[:bit] := batcalc.>(X_11, 100:lng);
+ * becomes
+ *     X_12:bat[:bit] := batcapi.fused("$1 $2 *:lng $3 +:lng $4 >:bit", X_4, X_5, X_6, 100:lng);
+ * The expression is kept in postfix notation; $i refers to the i-th
+ * argument and each operator is annotated with its result type.
+ * The kernel is compiled with the C compiler of the C UDF interface,
+ * hence the optimizer only kicks in when embedded_c is enabled.
  *
- * A candidate list can be pushed into the calculations
+ * Only operators on the integer types are fused, because their
+ * overflow and nil semantics are exactly reproduced in the kernel.
+ * An intermediate is absorbed when it is used by its parent only.
  */
 #include "monetdb_config.h"
 #include "mal_builder.h"
@@ -28,72 +35,229 @@
 #define OPTDEBUGjit(CODE)
 #endif
 
+#define JIT_MAXOPS	32		/* operators in a single kernel */
+#define JIT_MAXEXPR	(JIT_MAXOPS * 24)
+
+static const char *jitops[] = {
+	"+", "-", "*", "/", "<", "<=", ">", ">=", "==", "!=", NULL
+};
+
+static int
+jitType(int tpe)
+{
+	switch (tpe) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static int
+jitFusable(MalBlkPtr mb, InstrPtr p)
+{
+	int i, tpe;
+
+	if (getModuleId(p) != batcalcRef || p->retc != 1 || p->argc != 3)
+		return 0;
+	for (i = 0; jitops[i]; i++)
+		if (strcmp(getFunctionId(p), jitops[i]) == 0)
+			break;
+	if (jitops[i] == NULL)
+		return 0;
+	tpe = getArgType(mb, p, 0);
+	if (!isaBatType(tpe) ||
+		(!jitType(getBatType(tpe)) && getBatType(tpe) != TYPE_bit))
+		return 0;
+	/* at least one of the operands should be a column */
+	if (!isaBatType(getArgType(mb, p, 1)) && !isaBatType(getArgType(mb, p, 2)))
+		return 0;
+	for (i = 1; i < 3; i++) {
+		tpe = getArgType(mb, p, i);
+		if (!jitType(isaBatType(tpe) ? getBatType(tpe) : tpe))
+			return 0;
+	}
+	return 1;
+}
+
+/* Produce the postfix expression of the tree rooted at pc and collect
+ * its distinct leaves. */
+static void
+jitExpression(MalBlkPtr mb, InstrPtr *old, int *def, int *absorbed, int pc, int *leaves, int *nleaves, char *buf, size_t *len)
+{
+	InstrPtr p = old[pc];
+	int i, j, a;
+
+	for (i = 1; i < 3; i++) {
+		a = getArg(p, i);
+		if (def[a] >= 0 && absorbed[def[a]] == pc) {
+			jitExpression(mb, old, def, absorbed, def[a], leaves, nleaves, buf, len);
+			continue;
+		}
+		for (j = 0; j < *nleaves; j++)
+			if (leaves[j] == a)
+				break;
+		if (j == *nleaves)
+			leaves[(*nleaves)++] = a;
+		*len += snprintf(buf + *len, JIT_MAXEXPR - *len, "$%d ", j + 1);
+	}
+	*len += snprintf(buf + *len, JIT_MAXEXPR - *len, "%s:%s ",
+					 getFunctionId(p), ATOMname(getBatType(getArgType(mb, p, 0))));
+}
+
+/* Put back the instructions absorbed by the tree rooted at pc */
+static void
+jitRestore(MalBlkPtr mb, InstrPtr *old, int *absorbed, int pc)
+{
+	int i;
+
+	for (i = 0; i < pc; i++)
+		if (absorbed[i] == pc) {
+			jitRestore(mb, old, absorbed, i);
+			absorbed[i] = -1;
+			pushInstruction(mb, old[i]);
+		}
+}
+
 str
 OPTjitImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 {
-	int i,actions = 0;
-	int limit = mb->stop;
+	int i, j, a, actions = 0;
+	int limit = mb->stop, slimit = mb->ssize;
 	InstrPtr p, q, *old = mb->stmt;
-	char buf[256];
+	int *uses = NULL, *def = NULL, *absorbed = NULL, *size = NULL;
+	int leaves[2 * JIT_MAXOPS], nleaves;
+	char buf[256], expr[JIT_MAXEXPR];
+	size_t len;
 	lng usec = GDKusec();
 	str msg = MAL_SUCCEED;
 
 	(void) stk;
-	(void) cntxt;
 	(void) pci;
 
+	if (!GDKgetenv_istrue("embedded_c") && !GDKgetenv_isyes("embedded_c"))
+		goto wrapup;
+	if (getModule(batcapiRef) == NULL)
+		goto wrapup;
+
 	OPTDEBUGjit(
 		fprintf(stderr, "#Optimize JIT\n");
 		fprintFunction(stderr, mb, 0, LIST_MAL_DEBUG);
 	)
 
-	setVariableScope(mb);
-	if ( newMalBlkStmt(mb, mb->ssize) < 0)
-		throw(MAL,"optimizer.jit", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	uses = (int *) GDKzalloc(mb->vtop * sizeof(int));
+	def = (int *) GDKmalloc(mb->vtop * sizeof(int));
+	absorbed = (int *) GDKmalloc(limit * sizeof(int));
+	size = (int *) GDKmalloc(limit * sizeof(int));
+	if (uses == NULL || def == NULL || absorbed == NULL || size == NULL) {
+		msg = createException(MAL, "optimizer.jit", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		goto wrapup;
+	}
+	for (i = 0; i < mb->vtop; i++)
+		def[i] = -1;
+	for (i = 0; i < limit; i++) {
+		p = old[i];
+		absorbed[i] = -1;
+		size[i] = 1;
+		/* moving instructions around is only safe in straight
+		 * line code and dataflow blocks */
+		if (p->barrier && p->barrier != EXITsymbol &&
+			!(getModuleId(p) == languageRef && getFunctionId(p) == dataflowRef))
+			goto wrapup;
+		for (j = 0; j < p->retc; j++)
+			def[getArg(p, j)] = def[getArg(p, j)] == -1 ? i : -2;
+		for (; j < p->argc; j++)
+			uses[getArg(p, j)]++;
+	}
 
-	/* peephole optimization */
+	/* an intermediate is absorbed into its only consumer */
 	for (i = 0; i < limit; i++) {
 		p = old[i];
+		if (!jitFusable(mb, p))
+			continue;
+		for (j = 1; j < 3; j++) {
+			a = getArg(p, j);
+			if (isaBatType(getVarType(mb, a)) &&
+				getBatType(getVarType(mb, a)) != TYPE_bit &&
+				def[a] >= 0 && uses[a] == 1 &&
+				jitFusable(mb, old[def[a]]) &&
+				def[getArg(old[def[a]], 1)] != -2 &&
+				def[getArg(old[def[a]], 2)] != -2 &&
+				size[i] + size[def[a]] <= JIT_MAXOPS) {
+				absorbed[def[a]] = i;
+				size[i] += size[def[a]];
+			}
+		}
+	}
 
-		if (p->token == ENDsymbol){
-			for(; i<limit; i++)
-				if (old[i])
-					pushInstruction(mb,old[i]);
-			break;
+	if (newMalBlkStmt(mb, mb->ssize) < 0) {
+		mb->stmt = old;
+		msg = createException(MAL, "optimizer.jit", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		goto wrapup;
+	}
+
+	for (i = 0; i < limit; i++) {
+		p = old[i];
+		if (p == NULL || absorbed[i] >= 0)
+			continue;	/* moved into its consumer */
+		if (size[i] == 1) {
+			pushInstruction(mb, p);
+			continue;
 		}
-		/* case 1
-		 * X_527 := algebra.projection(C_353, X_329);
-		 * X_535 := batcalc.-(100:lng, X_527); 
-		 */
-		if( getModuleId(p) == batcalcRef && *getFunctionId(p) == '-' && p->argc == 3 && isVarConstant(mb, getArg(p,1)) ){
-			q= getInstrPtr(mb, getVar(mb,getArg(p,2))->updated);
-			if ( q == 0)
-				q= getInstrPtr(mb, getVar(mb,getArg(p,2))->declared);
-			if( q && getArg(q,0) == getArg(p,2) && getModuleId(q) == algebraRef && getFunctionId(q) == projectionRef ){
-				getArg(p,2)=  getArg(q,2);
-				p= pushArgument(mb,p, getArg(q,1));
-				OPTDEBUGjit(
-					fprintf(stderr, "#Optimize JIT case 1\n");
-					fprintInstruction(stderr, mb,0,p,LIST_MAL_DEBUG);
-				)
-			}
+		nleaves = 0;
+		len = 0;
+		jitExpression(mb, old, def, absorbed, i, leaves, &nleaves, expr, &len);
+		assert(len > 0 && len < JIT_MAXEXPR);
+		expr[len - 1] = 0;
+		q = newInstruction(mb, batcapiRef, fusedRef);
+		if (q) {
+			getArg(q, 0) = getArg(p, 0);
+			q = pushStr(mb, q, expr);
+		}
+		for (j = 0; q && j < nleaves; j++)
+			q = pushArgument(mb, q, leaves[j]);
+		if (q == NULL) {
+			/* keep the original code */
+			jitRestore(mb, old, absorbed, i);
+			pushInstruction(mb, p);
+			continue;
 		}
-		pushInstruction(mb,p);
+		pushInstruction(mb, q);
+		freeInstruction(p);
+		OPTDEBUGjit(
+			fprintf(stderr, "#Optimize JIT fused\n");
+			fprintInstruction(stderr, mb, 0, q, LIST_MAL_DEBUG);
+		)
+		actions++;
 	}
+	/* the absorbed instructions are part of the fused expressions */
+	for (i = 0; i < limit; i++)
+		if (absorbed[i] >= 0)
+			freeInstruction(old[i]);
+	for (i = limit; i < slimit; i++)
+		if (old[i])
+			freeInstruction(old[i]);
+	GDKfree(old);
 
 	OPTDEBUGjit(
-		chkTypes(cntxt->usermodule,mb,TRUE);
-		GDKfree(msg);
-		msg = MAL_SUCCEED;
 		fprintf(stderr, "#Optimize JIT done\n");
 		fprintFunction(stderr, mb, 0, LIST_MAL_DEBUG);
 	)
 
-	GDKfree(old);
     /* Defense line against incorrect plans */
-	chkTypes(cntxt->usermodule, mb, FALSE);
-	chkFlow(mb);
-	chkDeclarations(mb);
+	if (actions > 0) {
+		chkTypes(cntxt->usermodule, mb, FALSE);
+		chkFlow(mb);
+		chkDeclarations(mb);
+	}
+wrapup:
+	GDKfree(uses);
+	GDKfree(def);
+	GDKfree(absorbed);
+	GDKfree(size);
     /* keep all actions taken as a post block comment */
 	usec = GDKusec()- usec;
     snprintf(buf,256,"%-20s actions=%2d time=" LLFMT " usec","jit",actions, usec);
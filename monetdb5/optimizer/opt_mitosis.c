@@ -261,6 +261,10 @@ OPTmitosisImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr p)
 
 			qv = getArg(q, 0) = newTmpVariable(mb, qtpe);
 			setVarUDFtype(mb, qv);
+			/* the pieces are equally sized slices of the column */
+			setRowCnt(mb, qv, r / pieces);
+			if (isVarFeedback(mb, getArg(p, 0)))
+				setVarFeedback(mb, qv);
 			if (upd) {
 				rv = getArg(q, 1) = newTmpVariable(mb, rtpe);
 				setVarUDFtype(mb, rv);
@@ -220,6 +220,75 @@ static struct PIPELINES {
  * development.  Do not use any of these pipelines in production
  * settings!
  */
+/* The jit pipe line is identical to the default pipeline, except
+ * that expression trees of bulk arithmetic are fused into compiled
+ * kernels.  It requires embedded_c to be enabled.
+ */
+	{"jit_pipe",
+	 "optimizer.inline();"
+	 "optimizer.remap();"
+	 "optimizer.costModel();"
+	 "optimizer.coercions();"
+	 "optimizer.evaluate();"
+	 "optimizer.emptybind();"
+	 "optimizer.pushselect();"
+	 "optimizer.aliases();"
+	 "optimizer.mitosis();"
+	 "optimizer.mergetable();"
+	 "optimizer.deadcode();"
+	 "optimizer.aliases();"
+	 "optimizer.constants();"
+	 "optimizer.commonTerms();"
+	 "optimizer.projectionpath();"
+	 "optimizer.deadcode();"
+	 "optimizer.reorder();"
+	 "optimizer.matpack();"
+	 "optimizer.dataflow();"
+	 "optimizer.querylog();"
+	 "optimizer.multiplex();"
+	 "optimizer.generator();"
+	 "optimizer.profiler();"
+	 "optimizer.candidates();"
+	 "optimizer.postfix();"
+	 "optimizer.deadcode();"
+	 "optimizer.jit();"
+	 "optimizer.wlc();"
+	 "optimizer.garbageCollector();",
+	 "experimental", NULL, NULL, 1},
+/* The streaming pipe line is identical to the sequential pipeline,
+ * except that the projections that produce the columns of the query
+ * result are done in chunks while the result is sent to the client,
+ * such that huge results are not materialized on the server.
+ */
+	{"streaming_pipe",
+	 "optimizer.inline();"
+	 "optimizer.remap();"
+	 "optimizer.costModel();"
+	 "optimizer.coercions();"
+	 "optimizer.evaluate();"
+	 "optimizer.emptybind();"
+	 "optimizer.pushselect();"
+	 "optimizer.aliases();"
+	 "optimizer.mergetable();"
+	 "optimizer.deadcode();"
+	 "optimizer.aliases();"
+	 "optimizer.constants();"
+	 "optimizer.commonTerms();"
+	 "optimizer.projectionpath();"
+	 "optimizer.reorder();"
+	 "optimizer.deadcode();"
+	 "optimizer.matpack();"
+	 "optimizer.cursor();"
+	 "optimizer.querylog();"
+	 "optimizer.multiplex();"
+	 "optimizer.generator();"
+	 "optimizer.profiler();"
+	 "optimizer.candidates();"
+	 "optimizer.postfix();"
+	 "optimizer.deadcode();"
+	 "optimizer.wlc();"
+	 "optimizer.garbageCollector();",
+	 "experimental", NULL, NULL, 1},
 /* sentinel */
 	{NULL, NULL, NULL, NULL, NULL, 0}
 };
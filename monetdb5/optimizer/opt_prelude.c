@@ -21,6 +21,7 @@ str affectedRowsRef;
 str aggrRef;
 str alarmRef;
 str algebraRef;
+str alter_add_partitionRef;
 str alter_add_tableRef;
 str alter_constraintRef;
 str alter_del_tableRef;
@@ -29,6 +30,7 @@ str alter_indexRef;
 str alter_roleRef;
 str alter_schemaRef;
 str alter_seqRef;
+str alter_set_partitionRef;
 str alter_set_tableRef;
 str alter_tableRef;
 str alter_triggerRef;
@@ -125,6 +127,7 @@ str export_tableRef;
 str findRef;
 str finishRef;
 str firstnRef;
+str fusedRef;
 str generatorRef;
 str getRef;
 str getTraceRef;
@@ -235,6 +238,7 @@ str remoteRef;
 str rename_userRef;
 str replaceRef;
 str replicatorRef;
+str resultCursorRef;
 str resultSetRef;
 str reuseRef;
 str revoke_functionRef;
@@ -333,6 +337,8 @@ void optimizerInit(void)
 	alter_add_tableRef = putName("alter_add_table");
 	alter_del_tableRef = putName("alter_del_table");
 	alter_set_tableRef = putName("alter_set_table");
+	alter_add_partitionRef = putName("alter_add_partition");
+	alter_set_partitionRef = putName("alter_set_partition");
 	avgRef = putName("avg");
 	arrayRef = putName("array");
 	batRef = putName("bat");
@@ -419,6 +425,7 @@ void optimizerInit(void)
 	findRef = putName("find");
 	finishRef = putName("finish");
 	firstnRef = putName("firstn");
+	fusedRef = putName("fused");
 	getRef = putName("get");
 	getTraceRef = putName("getTrace");
 	generatorRef = putName("generator");
@@ -537,6 +544,7 @@ void optimizerInit(void)
 	rename_userRef = putName("rename_user");
 	replaceRef = putName("replace");
 	replicatorRef = putName("replicator");
+	resultCursorRef = putName("resultCursor");
 	resultSetRef = putName("resultSet");
 	revokeRef = putName("revoke");
 	reuseRef = putName("reuse");
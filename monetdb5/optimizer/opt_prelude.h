@@ -19,6 +19,7 @@ mal_export  str affectedRowsRef;
 mal_export  str aggrRef;
 mal_export  str alarmRef;
 mal_export  str algebraRef;
+mal_export  str alter_add_partitionRef;
 mal_export  str alter_add_tableRef;
 mal_export  str alter_constraintRef;
 mal_export  str alter_del_tableRef;
@@ -27,6 +28,7 @@ mal_export  str alter_indexRef;
 mal_export  str alter_roleRef;
 mal_export  str alter_schemaRef;
 mal_export  str alter_seqRef;
+mal_export  str alter_set_partitionRef;
 mal_export  str alter_set_tableRef;
 mal_export  str alter_tableRef;
 mal_export  str alter_triggerRef;
@@ -123,6 +125,7 @@ mal_export  str export_tableRef;
 mal_export  str findRef;
 mal_export  str finishRef;
 mal_export  str firstnRef;
+mal_export  str fusedRef;
 mal_export  str generatorRef;
 mal_export  str getRef;
 mal_export  str getTraceRef;
@@ -243,6 +246,7 @@ mal_export  str remoteRef;
 mal_export  str rename_userRef;
 mal_export  str replaceRef;
 mal_export  str replicatorRef;
+mal_export  str resultCursorRef;
 mal_export  str resultSetRef;
 mal_export  str reuseRef;
 mal_export  str revoke_functionRef;
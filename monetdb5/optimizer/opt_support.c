@@ -32,6 +32,7 @@ struct OPTcatalog {
 {"commonTerms",	0,	0,	0},
 {"constants",	0,	0,	0},
 {"costModel",	0,	0,	0},
+{"cursor",		0,	0,	0},
 {"dataflow",	0,	0,	0},
 {"deadcode",	0,	0,	0},
 {"emptybind",	0,	0,	0},
@@ -33,6 +33,7 @@
 #include "opt_garbageCollector.h"
 #include "opt_generator.h"
 #include "opt_inline.h"
+#include "opt_cursor.h"
 #include "opt_jit.h"
 #include "opt_projectionpath.h"
 #include "opt_matpack.h"
@@ -64,6 +65,7 @@ struct{
 	{"commonTerms", &OPTcommonTermsImplementation,0,0},
 	{"constants", &OPTconstantsImplementation,0,0},
 	{"costModel", &OPTcostModelImplementation,0,0},
+	{"cursor", &OPTcursorImplementation,0,0},
 	{"dataflow", &OPTdataflowImplementation,0,0},
 	{"deadcode", &OPTdeadcodeImplementation,0,0},
 	{"emptybind", &OPTemptybindImplementation,0,0},
@@ -0,0 +1,13 @@
+START TRANSACTION;
+
+# fused integer expressions compiled by the jit optimizer
+CREATE TABLE fused(a SMALLINT, b SMALLINT, c INTEGER, d SMALLINT, e INTEGER);
+INSERT INTO fused VALUES (1,2,3,4,0), (5,6,7,8,1), (NULL,1,1,1,1), (10,10,10,2,5), (3,-4,2,1,-100);
+
+SET optimizer='jit_pipe';
+SELECT (a*b+c)/d > e FROM fused;
+SELECT a*b+c, (a*b+c)/d, a-b-d FROM fused;
+SELECT a*b+c FROM fused WHERE (a+b)*d > 20;
+SELECT a / (d - d) FROM fused;
+
+ROLLBACK;
@@ -44,5 +44,7 @@ cudf_export str CUDFevalStd(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
 cudf_export str CUDFevalAggr(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
 							 InstrPtr pci);
 cudf_export str CUDFprelude(void *ret);
+cudf_export str CUDFfused(Client cntxt, MalBlkPtr mb, MalStkPtr stk,
+						  InstrPtr pci);
 
 #endif /* _CUDF_LIB_ */
@@ -0,0 +1,403 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+/*
+ * Fused expression kernels
+ * The jit optimizer replaces a tree of batcalc operators over integer
+ * columns by a single call batcapi.fused(expr, arg...), where expr
+ * is the tree in postfix notation, e.g. "$1 $2 *:lng $3 >:bit" (see
+ * opt_jit.c).  The expression is translated into a C function that
+ * evaluates the whole tree in one pass over its inputs, which is
+ * compiled with the same compiler as the C UDFs.
+ *
+ * Intermediate values are kept in a long long, with the lng nil
+ * representing nil; each operator checks the range of its declared
+ * result type.  This reproduces the nil propagation, overflow and
+ * division by zero errors of the batcalc operators it replaces.
+ *
+ * Kernels are cached for the lifetime of the server, keyed on the
+ * expression and the types of its arguments.
+ */
+
+#include "capi.h"
+
+typedef int (*fused_kernel)(size_t cnt, const void *const *args,
+							void *res, size_t *nils);
+
+typedef struct _fused_kernels {
+	char *signature;
+	fused_kernel kernel;
+	void *dll_handle;
+	struct _fused_kernels *next;
+} fused_kernels;
+
+#define KERNEL_CACHE_SIZE 128
+
+static fused_kernels *kernel_cache[KERNEL_CACHE_SIZE];
+static MT_Lock kernel_lock MT_LOCK_INITIALIZER("kernel_lock");
+static int kernel_seqnr = 0;
+
+static const struct {
+	int type;
+	const char *ctype;
+	const char *nil;
+	const char *max;
+} kernel_types[] = {
+	{TYPE_bte, "signed char", "(-127-1)", "127"},
+	{TYPE_sht, "short", "(-32767-1)", "32767"},
+	{TYPE_int, "int", "(-2147483647-1)", "2147483647"},
+	{TYPE_lng, "long long", "(-9223372036854775807LL-1)", "9223372036854775807LL"},
+	{0, NULL, NULL, NULL}
+};
+
+static const struct {
+	const char *op;
+	const char *builtin;	/* overflow checking arithmetic */
+	const char *cmp;		/* comparison operator */
+} kernel_ops[] = {
+	{"+", "__builtin_add_overflow", NULL},
+	{"-", "__builtin_sub_overflow", NULL},
+	{"*", "__builtin_mul_overflow", NULL},
+	{"/", NULL, NULL},
+	{"<", NULL, "<"},
+	{"<=", NULL, "<="},
+	{">", NULL, ">"},
+	{">=", NULL, ">="},
+	{"==", NULL, "=="},
+	{"!=", NULL, "!="},
+	{NULL, NULL, NULL}
+};
+
+static int
+kernelType(int tpe)
+{
+	int i;
+
+	tpe = ATOMstorage(tpe);
+	for (i = 0; kernel_types[i].ctype; i++)
+		if (kernel_types[i].type == tpe)
+			return i;
+	return -1;
+}
+
+#define KERNEL_WRITE(...)												\
+	do {																\
+		if (fprintf(f, __VA_ARGS__) < 0) {								\
+			msg = createException(MAL, "batcapi.fused",					\
+								  "Failed to write to file: %s", strerror(errno)); \
+			goto bailout;												\
+		}																\
+	} while (0)
+
+/* Translate the postfix expression into C and write it to file f.
+ * The argument types are given in types, with a negative type
+ * denoting a scalar. */
+static str
+kernelGenerate(FILE *f, const char *expr, const int *types, int nargs, int restype)
+{
+	char stack[2 * 64][16];
+	char token[64], *opname, *s;
+	const char *e;
+	int top = 0, tmp = 0, i, t, o, rt = restype;
+	str msg = MAL_SUCCEED;
+
+	KERNEL_WRITE("#include <stddef.h>\n");
+	KERNEL_WRITE("#define N (-9223372036854775807LL-1)\n");
+	KERNEL_WRITE("int fused(size_t cnt, const void *const *args, void *res, size_t *nils)\n{\n");
+	for (i = 0; i < nargs; i++) {
+		t = kernelType(types[i] < 0 ? -types[i] : types[i]);
+		KERNEL_WRITE("\tconst %s *a%d = args[%d];\n", kernel_types[t].ctype, i + 1, i);
+	}
+	t = restype == TYPE_bit ? kernelType(TYPE_bte) : kernelType(restype);
+	KERNEL_WRITE("\t%s *r = res;\n", kernel_types[t].ctype);
+	KERNEL_WRITE("\tsize_t i, n = 0;\n\n\tfor (i = 0; i < cnt; i++) {\n");
+	KERNEL_WRITE("\t\tlong long t0 = 0");
+	for (e = expr; *e; e++)
+		if (*e == ':')
+			KERNEL_WRITE(", t%d", ++tmp);
+	KERNEL_WRITE(";\n");
+	for (i = 0; i < nargs; i++) {
+		t = kernelType(types[i] < 0 ? -types[i] : types[i]);
+		KERNEL_WRITE("\t\tconst long long v%d = a%d[%s] == %s ? N : a%d[%s];\n",
+					 i + 1, i + 1, types[i] < 0 ? "0" : "i", kernel_types[t].nil,
+					 i + 1, types[i] < 0 ? "0" : "i");
+	}
+
+	tmp = 0;
+	for (e = expr; *e; ) {
+		while (*e == ' ')
+			e++;
+		for (i = 0; e[i] && e[i] != ' ' && i < (int) sizeof(token) - 1; i++)
+			token[i] = e[i];
+		token[i] = 0;
+		e += i;
+		if (*token == 0)
+			break;
+		if (*token == '$') {
+			i = atoi(token + 1);
+			if (i < 1 || i > nargs || top == (int) (sizeof(stack) / sizeof(stack[0])))
+				goto illegal;
+			snprintf(stack[top++], sizeof(stack[0]), "v%d", i);
+			continue;
+		}
+		if ((s = strchr(token, ':')) == NULL || top < 2)
+			goto illegal;
+		*s++ = 0;
+		opname = token;
+		for (o = 0; kernel_ops[o].op; o++)
+			if (strcmp(kernel_ops[o].op, opname) == 0)
+				break;
+		if (kernel_ops[o].op == NULL)
+			goto illegal;
+		rt = ATOMindex(s);
+		if ((rt == TYPE_bit) != (kernel_ops[o].cmp != NULL) ||
+			(rt != TYPE_bit && kernelType(rt) < 0))
+			goto illegal;
+		tmp++;
+		top -= 2;
+		KERNEL_WRITE("\t\tif (%s == N || %s == N)\n\t\t\tt%d = N;\n",
+					 stack[top], stack[top + 1], tmp);
+		if (kernel_ops[o].builtin) {
+			KERNEL_WRITE("\t\telse if (%s(%s, %s, &t%d))\n\t\t\treturn 1;\n",
+						 kernel_ops[o].builtin, stack[top], stack[top + 1], tmp);
+		} else if (kernel_ops[o].cmp) {
+			KERNEL_WRITE("\t\telse\n\t\t\tt%d = %s %s %s;\n",
+						 tmp, stack[top], kernel_ops[o].cmp, stack[top + 1]);
+		} else {
+			KERNEL_WRITE("\t\telse if (%s == 0)\n\t\t\treturn 2;\n", stack[top + 1]);
+			KERNEL_WRITE("\t\telse\n\t\t\tt%d = %s / %s;\n",
+						 tmp, stack[top], stack[top + 1]);
+		}
+		if (rt != TYPE_bit) {
+			t = kernelType(rt);
+			KERNEL_WRITE("\t\tif (t%d != N && (t%d < -%s || t%d > %s))\n\t\t\treturn 1;\n",
+						 tmp, tmp, kernel_types[t].max, tmp, kernel_types[t].max);
+		}
+		snprintf(stack[top++], sizeof(stack[0]), "t%d", tmp);
+	}
+	if (top != 1 || tmp == 0 || rt != restype)
+		goto illegal;
+
+	t = restype == TYPE_bit ? kernelType(TYPE_bte) : kernelType(restype);
+	KERNEL_WRITE("\t\tif (t%d == N) {\n\t\t\tr[i] = %s;\n\t\t\tn++;\n\t\t} else\n\t\t\tr[i] = (%s) t%d;\n",
+				 tmp, kernel_types[t].nil, kernel_types[t].ctype, tmp);
+	KERNEL_WRITE("\t}\n\t*nils = n;\n\treturn 0;\n}\n");
+	return MAL_SUCCEED;
+
+  illegal:
+	msg = createException(MAL, "batcapi.fused", "Illegal expression: %s", expr);
+  bailout:
+	return msg;
+}
+
+/* Compile the kernel with the given signature into a shared library
+ * in the temporary directory of the database. */
+static str
+kernelCompile(fused_kernels *k, const char *expr, const int *types, int nargs, int restype)
+{
+	char name[64], buf[2 * FILENAME_MAX + 128], errbuf[BUFSIZ];
+	char *fname = NULL, *libname = NULL, *deldirpath = NULL;
+	const char *cc = GDKgetenv("capi_cc") ? GDKgetenv("capi_cc") : "cc";
+	FILE *f = NULL, *compiler;
+	size_t errlen = 0;
+	str msg = MAL_SUCCEED;
+
+	snprintf(name, sizeof(name), "%s%cfused%d", TEMPDIR_NAME, DIR_SEP, kernel_seqnr);
+	fname = GDKfilepath(0, BATDIR, name, "c");
+	snprintf(name, sizeof(name), "%s%c%sfused%d", TEMPDIR_NAME, DIR_SEP, SO_PREFIX, kernel_seqnr);
+	libname = GDKfilepath(0, BATDIR, name, SO_EXT[0] == '.' ? SO_EXT + 1 : SO_EXT);
+	deldirpath = GDKfilepath(0, NULL, TEMPDIR, NULL);
+	kernel_seqnr++;
+	if (fname == NULL || libname == NULL || deldirpath == NULL) {
+		msg = createException(MAL, "batcapi.fused", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		goto bailout;
+	}
+	if (mkdir(deldirpath, 0755) < 0 && errno != EEXIST) {
+		msg = createException(MAL, "batcapi.fused", "cannot create directory %s", deldirpath);
+		goto bailout;
+	}
+	if ((f = fopen(fname, "w")) == NULL) {
+		msg = createException(MAL, "batcapi.fused",
+							  "Failed to open file for JIT compilation: %s", strerror(errno));
+		errno = 0;
+		goto bailout;
+	}
+	msg = kernelGenerate(f, expr, types, nargs, restype);
+	if (fclose(f) != 0 && msg == MAL_SUCCEED)
+		msg = createException(MAL, "batcapi.fused", "Failed to write to file: %s", strerror(errno));
+	if (msg)
+		goto bailout;
+
+	snprintf(buf, sizeof(buf), "%s -O3 -fPIC -shared %s -o %s 2>&1 >/dev/null", cc, fname, libname);
+	if ((compiler = popen(buf, "r")) == NULL) {
+		msg = createException(MAL, "batcapi.fused", "Failed popen");
+		goto bailout;
+	}
+	while (errlen < sizeof(errbuf) - 1 &&
+		   fgets(errbuf + errlen, (int) (sizeof(errbuf) - errlen), compiler))
+		errlen += strlen(errbuf + errlen);
+	errbuf[errlen] = 0;
+	if (pclose(compiler) != 0) {
+		msg = createException(MAL, "batcapi.fused", "Failed to compile kernel:\n%s", errbuf);
+		goto bailout;
+	}
+	if ((k->dll_handle = dlopen(libname, RTLD_NOW)) == NULL) {
+		msg = createException(MAL, "batcapi.fused", "Failed to open shared library: %s.", dlerror());
+		goto bailout;
+	}
+	if ((k->kernel = (fused_kernel) dlsym(k->dll_handle, "fused")) == NULL) {
+		msg = createException(MAL, "batcapi.fused", "Failed to load function from library: %s.", dlerror());
+		dlclose(k->dll_handle);
+		k->dll_handle = NULL;
+	}
+  bailout:
+	GDKfree(fname);
+	GDKfree(libname);
+	GDKfree(deldirpath);
+	return msg;
+}
+
+static str
+kernelFind(fused_kernel *kernel, const char *expr, const int *types, int nargs, int restype)
+{
+	char *signature, *s;
+	size_t len = strlen(expr) + 8 * (nargs + 2);
+	BUN h;
+	int i;
+	fused_kernels *k;
+	str msg = MAL_SUCCEED;
+
+	if ((signature = GDKmalloc(len)) == NULL)
+		throw(MAL, "batcapi.fused", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	s = signature + snprintf(signature, len, "%s|%d", expr, restype);
+	for (i = 0; i < nargs; i++)
+		s += snprintf(s, len - (s - signature), "|%d", types[i]);
+	h = strHash(signature) % KERNEL_CACHE_SIZE;
+
+	MT_lock_set(&kernel_lock);
+	for (k = kernel_cache[h]; k; k = k->next)
+		if (strcmp(k->signature, signature) == 0)
+			break;
+	if (k == NULL) {
+		/* compile while holding the lock, such that concurrent
+		 * queries do not compile the same kernel */
+		if ((k = GDKzalloc(sizeof(fused_kernels))) == NULL) {
+			msg = createException(MAL, "batcapi.fused", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		} else if ((msg = kernelCompile(k, expr, types, nargs, restype)) != MAL_SUCCEED) {
+			GDKfree(k);
+			k = NULL;
+		} else {
+			k->signature = signature;
+			signature = NULL;
+			k->next = kernel_cache[h];
+			kernel_cache[h] = k;
+		}
+	}
+	MT_lock_unset(&kernel_lock);
+	GDKfree(signature);
+	if (k)
+		*kernel = k->kernel;
+	return msg;
+}
+
+str
+CUDFfused(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	bat *ret = getArgReference_bat(stk, pci, 0);
+	const char *expr = *getArgReference_str(stk, pci, 1);
+	int restype = getBatType(getArgType(mb, pci, 0));
+	int nargs = pci->argc - 2, i, tpe, rc;
+	BAT **bats = NULL, *bn = NULL;
+	const void **args = NULL;
+	int *types = NULL;
+	BUN cnt = BUN_NONE;
+	oid hseq = 0;
+	size_t nils = 0;
+	fused_kernel kernel = NULL;
+	str msg = MAL_SUCCEED;
+
+	(void) cntxt;
+
+	if (!GDKgetenv_istrue("embedded_c") && !GDKgetenv_isyes("embedded_c"))
+		throw(MAL, "batcapi.fused", "Embedded C has not been enabled. "
+			  "Start server with --set embedded_c=true");
+
+	bats = GDKzalloc(nargs * sizeof(BAT *));
+	args = GDKzalloc(nargs * sizeof(void *));
+	types = GDKzalloc(nargs * sizeof(int));
+	if (bats == NULL || args == NULL || types == NULL) {
+		msg = createException(MAL, "batcapi.fused", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		goto bailout;
+	}
+	for (i = 0; i < nargs; i++) {
+		tpe = getArgType(mb, pci, i + 2);
+		if (isaBatType(tpe)) {
+			if ((bats[i] = BATdescriptor(*getArgReference_bat(stk, pci, i + 2))) == NULL) {
+				msg = createException(MAL, "batcapi.fused", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+				goto bailout;
+			}
+			if (cnt == BUN_NONE) {
+				cnt = BATcount(bats[i]);
+				hseq = bats[i]->hseqbase;
+			} else if (BATcount(bats[i]) != cnt) {
+				msg = createException(MAL, "batcapi.fused", "inputs not the same size");
+				goto bailout;
+			}
+			types[i] = bats[i]->ttype;
+			args[i] = Tloc(bats[i], 0);
+		} else {
+			types[i] = -tpe;
+			args[i] = getArgReference(stk, pci, i + 2);
+		}
+		if (kernelType(types[i] < 0 ? -types[i] : types[i]) < 0) {
+			msg = createException(MAL, "batcapi.fused", SQLSTATE(42000) "Unsupported argument type %s",
+								  ATOMname(types[i] < 0 ? -types[i] : types[i]));
+			goto bailout;
+		}
+	}
+	if (cnt == BUN_NONE) {
+		msg = createException(MAL, "batcapi.fused", "At least one column argument expected");
+		goto bailout;
+	}
+
+	if ((bn = COLnew(hseq, restype, cnt, TRANSIENT)) == NULL) {
+		msg = createException(MAL, "batcapi.fused", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		goto bailout;
+	}
+	if (cnt > 0) {
+		if ((msg = kernelFind(&kernel, expr, types, nargs, restype)) != MAL_SUCCEED)
+			goto bailout;
+		rc = (*kernel)((size_t) cnt, args, Tloc(bn, 0), &nils);
+		if (rc == 1) {
+			msg = createException(MAL, "batcapi.fused", SQLSTATE(22003) "overflow in calculation.");
+			goto bailout;
+		}
+		if (rc == 2) {
+			msg = createException(MAL, "batcapi.fused", SQLSTATE(22012) "division by zero.");
+			goto bailout;
+		}
+	}
+	BATsetcount(bn, cnt);
+	bn->tnil = nils > 0;
+	bn->tnonil = nils == 0;
+	bn->tsorted = bn->trevsorted = cnt <= 1;
+	bn->tkey = cnt <= 1;
+	BBPkeepref(*ret = bn->batCacheid);
+	bn = NULL;
+
+  bailout:
+	if (bn)
+		BBPreclaim(bn);
+	for (i = 0; bats && i < nargs; i++)
+		if (bats[i])
+			BBPunfix(bats[i]->batCacheid);
+	GDKfree(bats);
+	GDKfree(args);
+	GDKfree(types);
+	return msg;
+}
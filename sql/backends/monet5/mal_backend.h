@@ -42,6 +42,7 @@ typedef struct backend {
 	int 	mvc_var;	
 	int	vtop;		/* top of the variable stack before the current function */
 	cq 	*q;		/* pointer to the cached query */
+	struct rcentry *rc;	/* result awaited by the result cache */
 } backend;
 
 extern backend *backend_reset(backend *b);
@@ -15,6 +15,7 @@
 #include "rel_prop.h"
 #include "rel_select.h"
 #include "rel_updates.h"
+#include "rel_matview.h"
 #include "rel_optimizer.h"
 #include "sql_env.h"
 #include "sql_optimizer.h"
@@ -2626,11 +2627,68 @@ rel2bin_predicate(backend *be)
 	return const_column(be, stmt_bool(be, 1));
 }
 
+/* Whether e compares a column that has a hash index of its own with a
+ * value.  The hash of such a column is persistent and maintained with
+ * the column, so the selection is answered by a probe. */
+static int
+exp_hash_lookup(sql_rel *rel, sql_exp *e)
+{
+	sql_exp *l, *r;
+	sql_column *c;
+	sql_rel *bt = NULL;
+	node *n;
+
+	if (!rel || e->type != e_cmp || e->flag != cmp_equal || is_anti(e))
+		return 0;
+	l = e->l;
+	r = e->r;
+	if (l->type != e_column) {
+		l = e->r;
+		r = e->l;
+	}
+	if (l->type != e_column || r->card > CARD_ATOM ||
+	    !l->r || ((char *) l->r)[0] == '%')
+		return 0;
+	c = name_find_column(rel, l->l, l->r, -2, &bt);
+	if (!c || !isTable(c->t) || !c->t->idxs.set)
+		return 0;
+	for (n = c->t->idxs.set->h; n; n = n->next) {
+		sql_idx *i = n->data;
+
+		if (hash_index(i->type) && list_length(i->columns) == 1 &&
+		    ((sql_kc *) i->columns->h->data)->c == c)
+			return 1;
+	}
+	return 0;
+}
+
+/* The selections are applied one after the other, each on the result
+ * of the previous ones.  A hash lookup goes first, such that it probes
+ * the hash of the whole column instead of the others scanning it. */
+static list *
+exps_hash_lookup_first(mvc *sql, sql_rel *rel)
+{
+	node *n, *m;
+	list *exps;
+
+	for (n = rel->exps->h; n; n = n->next)
+		if (exp_hash_lookup(rel->l, n->data))
+			break;
+	if (!n || n == rel->exps->h)
+		return rel->exps;
+	exps = sa_list(sql->sa);
+	append(exps, n->data);
+	for (m = rel->exps->h; m; m = m->next)
+		if (m != n)
+			append(exps, m->data);
+	return exps;
+}
+
 static stmt *
 rel2bin_select(backend *be, sql_rel *rel, list *refs)
 {
 	mvc *sql = be->mvc;
-	list *l; 
+	list *l, *exps; 
 	node *en, *n;
 	stmt *sub = NULL, *sel = NULL;
 	stmt *predicate = NULL;
@@ -2672,7 +2730,8 @@ rel2bin_select(backend *be, sql_rel *rel, list *refs)
 			sel = rel2bin_hash_lookup(be, rel, sub, NULL, i, en);
 		}
 	} 
-	for( en = rel->exps->h; en; en = en->next ) {
+	exps = sel ? rel->exps : exps_hash_lookup_first(sql, rel);
+	for( en = exps->h; en; en = en->next ) {
 		sql_exp *e = en->data;
 		stmt *s = exp_bin(be, e, sub, NULL, NULL, NULL, NULL, sel);
 
@@ -3235,10 +3294,10 @@ sql_insert_key(backend *be, list *inserts, sql_key *k, stmt *idx_inserts, stmt *
 	}
 }
 
-static int
-sql_stack_add_inserted( mvc *sql, const char *name, sql_table *t, stmt **updates) 
+/* the inserted rows as a relation named name */
+static sql_rel *
+sql_inserted_rel( mvc *sql, const char *name, sql_table *t, stmt **updates) 
 {
-	/* Put single relation of updates and old values on to the stack */
 	sql_rel *r = NULL;
 	node *n;
 	list *exps = sa_list(sql->sa);
@@ -3257,6 +3316,14 @@ sql_stack_add_inserted( mvc *sql, const char *name, sql_table *t, stmt **updates
 	}
 	r = rel_table_func(sql->sa, NULL, NULL, exps, 2);
 	r->l = ti;
+	return r;
+}
+
+static int
+sql_stack_add_inserted( mvc *sql, const char *name, sql_table *t, stmt **updates) 
+{
+	/* Put single relation of updates and old values on to the stack */
+	sql_rel *r = sql_inserted_rel(sql, name, t, updates);
 
 	return stack_push_rel_view(sql, name, r) ? 1 : 0;
 }
@@ -3344,6 +3411,72 @@ table_update_stmts(mvc *sql, sql_table *t, int *Len)
 	return updates;
 }
 
+static int
+sql_matview_stmt(backend *be, sql_rel *r)
+{
+	mvc *sql = be->mvc;
+	int sqltype = sql->type;
+
+	if (!r || (r = rel_optimizer(sql, r)) == NULL)
+		return 0;
+	if (!rel_bin(be, r))
+		return 0;
+	sql->type = sqltype;
+	return 1;
+}
+
+/* propagate the rows appended to t into the materialized views over it */
+static int
+sql_insert_matviews(backend *be, sql_table *t, stmt **updates)
+{
+	mvc *sql = be->mvc;
+	list *mvs = rel_matview_dependents(sql, t);
+	stmt **rows, *col = NULL;
+	node *n, *m;
+	int i, len;
+
+	if (!mvs)
+		return 0;
+	if (list_empty(mvs))
+		return 1;
+	/* the views read the appended rows as columns */
+	rows = table_update_stmts(sql, t, &len);
+	for (i = 0; i < len && !col; i++)
+		if (updates[i]->nrcols)
+			col = updates[i];
+	for (i = 0; i < len; i++) {
+		rows[i] = updates[i];
+		if (!rows[i]->nrcols)
+			rows[i] = col ? stmt_const(be, col, rows[i]) : create_const_column(be, rows[i]);
+	}
+	for (n = mvs->h; n; n = n->next) {
+		list *l = rel_matview_append(sql, n->data, t, sql_inserted_rel(sql, t->base.name, t, rows));
+
+		if (!l)
+			return 0;
+		for (m = l->h; m; m = m->next)
+			if (!sql_matview_stmt(be, m->data))
+				return 0;
+	}
+	return 1;
+}
+
+/* recompute the materialized views over t after its rows changed */
+static int
+sql_recompute_matviews(backend *be, sql_table *t)
+{
+	mvc *sql = be->mvc;
+	list *mvs = rel_matview_dependents(sql, t);
+	node *n;
+
+	if (!mvs)
+		return 0;
+	for (n = mvs->h; n; n = n->next)
+		if (!sql_matview_stmt(be, rel_matview_recompute(sql, n->data)))
+			return 0;
+	return 1;
+}
+
 static stmt *
 rel2bin_insert(backend *be, sql_rel *rel, list *refs)
 {
@@ -3378,6 +3511,17 @@ rel2bin_insert(backend *be, sql_rel *rel, list *refs)
 	if (!inserts)
 		return NULL;	
 
+	/* the rows that fit no member of a partitioned merge table */
+	if (isMergeTable(t)) {
+		stmt *rows = inserts->op4.lval->h->data;
+
+		if (rows->nrcols == 0)
+			rows = stmt_const(be, bin_first_column(be, inserts), rows);
+		s = stmt_aggr(be, rows, NULL, NULL, sql_bind_aggr(sql->sa, sql->session->schema, "count", NULL), 1, 0, 1);
+		(void)stmt_exception(be, s, sa_message(sql->sa, "INSERT INTO: no partition of merge table '%s' accepts the row (the partition key is NULL or outside all partitions)", t->base.name), 00001);
+		return stmt_atom_lng(be, 0);
+	}
+
 	if (idx_ins)
 		pin = refs_find_rel(refs, prel);
 
@@ -3430,6 +3574,8 @@ rel2bin_insert(backend *be, sql_rel *rel, list *refs)
 
 	if (!sql_insert_triggers(be, t, updates, 1)) 
 		return sql_error(sql, 02, SQLSTATE(42000) "INSERT INTO: triggers failed for table '%s'", t->base.name);
+	if (!ddl && !sql_insert_matviews(be, t, updates))
+		return sql_error(sql, 02, SQLSTATE(42000) "INSERT INTO: maintaining the materialized views failed for table '%s'", t->base.name);
 	if (ddl) {
 		list_prepend(l, ddl);
 	} else {
@@ -4294,6 +4440,8 @@ sql_update(backend *be, sql_table *t, stmt *rows, stmt **updates)
 /* after */
 	if (!sql_update_triggers(be, t, rows, updates, 1)) 
 		return sql_error(sql, 02, SQLSTATE(42000) "UPDATE: triggers failed for table '%s'", t->base.name);
+	if (!sql_recompute_matviews(be, t))
+		return sql_error(sql, 02, SQLSTATE(42000) "UPDATE: maintaining the materialized views failed for table '%s'", t->base.name);
 
 /* cascade ?? */
 	return l;
@@ -4393,6 +4541,8 @@ rel2bin_update(backend *be, sql_rel *rel, list *refs)
 /* after */
 	if (!sql_update_triggers(be, t, tids, updates, 1)) 
 		return sql_error(sql, 02, SQLSTATE(42000) "UPDATE: triggers failed for table '%s'", t->base.name);
+	if (!ddl && !sql_recompute_matviews(be, t))
+		return sql_error(sql, 02, SQLSTATE(42000) "UPDATE: maintaining the materialized views failed for table '%s'", t->base.name);
 
 	if (ddl) {
 		list_prepend(l, ddl);
@@ -4589,6 +4739,8 @@ sql_delete(backend *be, sql_table *t, stmt *rows)
 /* after */
 	if (!sql_delete_triggers(be, t, v, 1, 1, 3))
 		return sql_error(sql, 02, SQLSTATE(42000) "DELETE: triggers failed for table '%s'", t->base.name);
+	if (!sql_recompute_matviews(be, t))
+		return sql_error(sql, 02, SQLSTATE(42000) "DELETE: maintaining the materialized views failed for table '%s'", t->base.name);
 	if (rows) 
 		s = stmt_aggr(be, rows, NULL, NULL, sql_bind_aggr(sql->sa, sql->session->schema, "count", NULL), 1, 0, 1);
 	return s;
@@ -4768,6 +4920,11 @@ sql_truncate(backend *be, sql_table *t, int restart_sequences, int cascade)
 			error = 1;
 			goto finalize;
 		}
+		if (!sql_recompute_matviews(be, next)) {
+			sql_error(sql, 02, SQLSTATE(42000) "TRUNCATE: maintaining the materialized views failed for table '%s'", next->base.name);
+			error = 1;
+			goto finalize;
+		}
 	}
 
 finalize:
@@ -4846,6 +5003,15 @@ rel2bin_output(backend *be, sql_rel *rel, list *refs)
 	}
 }
 
+/* a list of inserts, as made for a partitioned merge table */
+static int
+is_insert_list(sql_rel *rel)
+{
+	if (rel->op == op_insert)
+		return 1;
+	return rel->op == op_ddl && rel->flag == DDL_LIST && is_insert_list(rel->l) && is_insert_list(rel->r);
+}
+
 static stmt *
 rel2bin_list(backend *be, sql_rel *rel, list *refs) 
 {
@@ -4860,6 +5026,13 @@ rel2bin_list(backend *be, sql_rel *rel, list *refs)
 		r = subrel_bin(be, rel->r, refs);
 	if (!l || !r)
 		return NULL;
+	/* the number of inserted rows is the sum over the list */
+	if (is_insert_list(rel) && l->type != st_list && r->type != st_list) {
+		sql_subtype *lng = sql_bind_localtype("lng");
+		sql_subfunc *add = sql_bind_func_result(sql->sa, sql->session->schema, "sql_add", lng, lng, lng);
+
+		return stmt_binop(be, l, r, add);
+	}
 	list_append(slist, l);
 	list_append(slist, r);
 	return stmt_list(be, slist);
@@ -5039,7 +5212,7 @@ rel2bin_ddl(backend *be, sql_rel *rel, list *refs)
 	} else if (rel->flag <= DDL_ALTER_TABLE) {
 		s = rel2bin_catalog_table(be, rel, refs);
 		sql->type = Q_SCHEMA;
-	} else if (rel->flag <= DDL_COMMENT_ON) {
+	} else if (rel->flag <= DDL_ALTER_TABLE_ADD_PARTITION) {
 		s = rel2bin_catalog2(be, rel, refs);
 		sql->type = Q_SCHEMA;
 	}
@@ -27,6 +27,7 @@
 #include "rel_partition.h"
 #include "rel_distribute.h"
 #include "rel_select.h"
+#include "rel_updates.h"
 #include "rel_rel.h"
 #include "rel_exp.h"
 #include "rel_dump.h"
@@ -128,6 +129,38 @@ sql_symbol2relation(mvc *c, symbol *sym)
 	return r;
 }
 
+/* EXECUTE .. FROM STDIN: the prepared statement is analysed once more,
+ * with its parameters bound to the columns of the rows that follow */
+sql_rel *
+sql_batch2relation(mvc *c, symbol *sym)
+{
+	dlist *l = sym->data.lval;
+	int id = l->h->data.i_val, i;
+	cq *q = qc_find(c->qc, id);
+	sql_rel *r;
+
+	if (!q)
+		return sql_error(c, 02, SQLSTATE(07003) "EXEC: No prepared statement with id: %d", id);
+	if (q->type != Q_PREPARE)
+		return sql_error(c, 02, SQLSTATE(07005) "EXEC: Given handle id is not for a prepared statement: %d", id);
+	for (i = 0; i < q->paramlen; i++)
+		sql_add_param(c, NULL, NULL);
+	c->emode = m_prepare;
+	r = rel_semantic(c, q->s);
+	c->emode = m_execute;
+	if (!r)
+		return NULL;
+	r = rel_import_params(c, r, l->h->next->next->next->data.lval, l->h->next->next->data.lval, l->h->next->next->next->next->data.sval, l->h->next->next->next->next->next->data.i_val);
+	if (r) {
+		r = rel_optimizer(c, r);
+		r = rel_distribute(c, r);
+		r = rel_partition(c, r);
+		if (rel_no_mitosis(r) || rel_need_distinct_query(r))
+			c->no_mitosis = 1;
+	}
+	return r;
+}
+
 /*
  * After the SQL statement has been executed, its data structures
  * should be garbage collected. For successful actions we have to finish
@@ -143,6 +176,7 @@ sqlcleanup(mvc *c, int err)
 	if ((c->emod & mod_locked) == mod_locked) {
 		/* here we should commit the transaction */
 		if (!err) {
+			backend_commit(c->session->tr);
 			sql_trans_commit(c->session->tr);
 			/* write changes to disk */
 			sql_trans_end(c->session);
@@ -350,7 +384,7 @@ create_table_or_view(mvc *sql, char *sname, char *tname, sql_table *t, int temp)
 		}
 	}
 	/* also create dependencies */
-	if (nt->query && isView(nt)) {
+	if (nt->query && (isView(nt) || isMatView(nt))) {
 		sql_rel *r = NULL;
 
 		sql->sa = sa_create();
@@ -1700,47 +1734,31 @@ DELTAproject(bat *result, const bat *sub, const bat *col, const bat *uid, const
 	}
 
 	if (BATcount(u_val)) {
-		BAT *o, *nu_id, *nu_val;
-		/* create subsets of u_id and u_val where the tail
-		 * values of u_id are also in s, and where those tail
-		 * values occur as head value in res */
-		if ((o = BATintersect(u_id, s, NULL, NULL, 0, BUN_NONE)) == NULL) {
+		BAT *o, *p, *nu_val;
+		/* the updated rows which are in s, o their positions in
+		 * u_id and p their positions in s, ie the head values of
+		 * res they replace */
+		if (BATjoin(&o, &p, u_id, s, NULL, NULL, 0, BATcount(u_id)) != GDK_SUCCEED) {
 			BBPunfix(s->batCacheid);
 			BBPunfix(res->batCacheid);
 			BBPunfix(u_id->batCacheid);
 			BBPunfix(u_val->batCacheid);
 			throw(MAL, "sql.delta", SQLSTATE(HY001) MAL_MALLOC_FAIL);
 		}
-		nu_id = BATproject(o, u_id);
 		nu_val = BATproject(o, u_val);
-		BBPunfix(u_id->batCacheid);
-		BBPunfix(u_val->batCacheid);
-		BBPunfix(o->batCacheid);
-		tres = BATdense(res->hseqbase, res->hseqbase, BATcount(res));
-		if (nu_id == NULL ||
-		    nu_val == NULL ||
-		    tres == NULL ||
-		    (o = BATintersect(nu_id, tres, NULL, NULL, 0, BUN_NONE)) == NULL) {
-			BBPunfix(s->batCacheid);
-			BBPunfix(res->batCacheid);
-			BBPreclaim(nu_id);
-			BBPreclaim(nu_val);
-			BBPreclaim(tres);
-			throw(MAL, "sql.delta", SQLSTATE(HY001) MAL_MALLOC_FAIL);
-		}
-		BBPunfix(tres->batCacheid);
-		u_id = BATproject(o, nu_id);
-		u_val = BATproject(o, nu_val);
-		BBPunfix(nu_id->batCacheid);
-		BBPunfix(nu_val->batCacheid);
 		BBPunfix(o->batCacheid);
-		if (u_id == NULL || u_val == NULL) {
+		if (nu_val == NULL) {
 			BBPunfix(s->batCacheid);
 			BBPunfix(res->batCacheid);
-			BBPreclaim(u_id);
-			BBPreclaim(u_val);
+			BBPunfix(u_id->batCacheid);
+			BBPunfix(u_val->batCacheid);
+			BBPunfix(p->batCacheid);
 			throw(MAL, "sql.delta", SQLSTATE(HY001) MAL_MALLOC_FAIL);
 		}
+		BBPunfix(u_id->batCacheid);
+		BBPunfix(u_val->batCacheid);
+		u_id = p;
+		u_val = nu_val;
 		/* now update res with the subset of u_id and u_val we
 		 * calculated */
 		if ((res = setwritable(res)) == NULL ||
@@ -2354,6 +2372,89 @@ mvc_table_result_wrap(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	return res;
 }
 
+/* unsafe pattern resultCursor(tbl:bat[:str], attr:bat[:str], tpe:bat[:str], len:bat[:int],scale:bat[:int], cols:bat[:any]...) :int */
+/* The columns come in pairs of a candidate list and a column, and the
+ * rows are projected while they are sent; a nil candidate list denotes
+ * a column that is used as is. */
+str
+mvc_result_cursor_wrap(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	int *res_id =getArgReference_int(stk,pci,0);
+	bat tblId= *getArgReference_bat(stk, pci,1);
+	bat atrId= *getArgReference_bat(stk, pci,2);
+	bat tpeId= *getArgReference_bat(stk, pci,3);
+	bat lenId= *getArgReference_bat(stk, pci,4);
+	bat scaleId= *getArgReference_bat(stk, pci,5);
+	bat bid, cid;
+	int i,res;
+	str tblname, colname, tpename, msg= MAL_SUCCEED;
+	int *digits, *scaledigits;
+	oid o = 0;
+	BATiter itertbl,iteratr,itertpe;
+	mvc *m = NULL;
+	BAT *b, *c, *tbl = NULL, *atr = NULL, *tpe = NULL, *len = NULL, *scale = NULL;
+
+	if ((msg = getSQLContext(cntxt, mb, &m, NULL)) != NULL)
+		return msg;
+	if ((msg = checkSQLContext(cntxt)) != NULL)
+		return msg;
+	if ((pci->argc - 6) % 2 != 0)
+		throw(SQL, "sql.resultCursor", SQLSTATE(42000) "Columns should come with candidate lists");
+	/* the number of rows is the size of the first candidate list */
+	bid = *getArgReference_bat(stk,pci,6);
+	if (is_bat_nil(bid))
+		bid = *getArgReference_bat(stk,pci,7);
+	b = BATdescriptor(bid);
+	if ( b == NULL)
+		throw(MAL,"sql.resultCursor", SQLSTATE(HY005) "Cannot access column descriptor");
+	res = *res_id = mvc_result_table(m, mb->tag, (pci->argc - 6) / 2, 1, b);
+	if (res < 0)
+		msg = createException(SQL, "sql.resultCursor", SQLSTATE(45000) "Result table construction failed");
+	BBPunfix(b->batCacheid);
+
+	tbl = BATdescriptor(tblId);
+	atr = BATdescriptor(atrId);
+	tpe = BATdescriptor(tpeId);
+	len = BATdescriptor(lenId);
+	scale = BATdescriptor(scaleId);
+	if( msg || tbl == NULL || atr == NULL || tpe == NULL || len == NULL || scale == NULL)
+		goto wrapup_result_cursor;
+	itertbl = bat_iterator(tbl);
+	iteratr = bat_iterator(atr);
+	itertpe = bat_iterator(tpe);
+	digits = (int*) Tloc(len,0);
+	scaledigits = (int*) Tloc(scale,0);
+
+	for( i = 6; msg == MAL_SUCCEED && i< pci->argc; i += 2, o++){
+		cid = *getArgReference_bat(stk,pci,i);
+		bid = *getArgReference_bat(stk,pci,i + 1);
+		tblname = BUNtail(itertbl,o);
+		colname = BUNtail(iteratr,o);
+		tpename = BUNtail(itertpe,o);
+		c = NULL;
+		b = BATdescriptor(bid);
+		if ( b == NULL || (!is_bat_nil(cid) && (c = BATdescriptor(cid)) == NULL))
+			msg= createException(MAL,"sql.resultCursor",SQLSTATE(HY005) "Cannot access column descriptor ");
+		else if (mvc_result_cursor(m, tblname, colname, tpename, *digits++, *scaledigits++, c, b))
+			msg = createException(SQL, "sql.resultCursor", SQLSTATE(42000) "Cannot access column descriptor %s.%s",tblname,colname);
+		if( b)
+			BBPunfix(bid);
+		if( c)
+			BBPunfix(cid);
+	}
+	/* now send it to the channel cntxt->fdout */
+	if (msg == MAL_SUCCEED &&
+		mvc_export_result(cntxt->sqlcontext, cntxt->fdout, res, mb->starttime, mb->optimize))
+		msg = createException(SQL, "sql.resultCursor", SQLSTATE(45000) "Result set construction failed");
+  wrapup_result_cursor:
+	if( tbl) BBPunfix(tblId);
+	if( atr) BBPunfix(atrId);
+	if( tpe) BBPunfix(tpeId);
+	if( len) BBPunfix(lenId);
+	if( scale) BBPunfix(scaleId);
+	return msg;
+}
+
 /* str mvc_affected_rows_wrap(int *m, int m, lng *nr, str *w); */
 str
 mvc_affected_rows_wrap(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
@@ -3945,10 +4046,148 @@ SQLreuse(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 }
 
 /*
- * The vacuum operation inspects the table for ordered properties and
- * will keep them.  To avoid expensive shuffles, the reorganisation is
- * balanced by the number of outstanding deletions.
+ * The vacuum operation rewrites the columns and the indices of the table
+ * without the deleted rows.  The order of the rows is kept and the
+ * string heaps are rebuilt, such that the space of deleted and updated
+ * strings is reclaimed.  The oids change, hence the join indices of the
+ * foreign keys referring to the table are renumbered.  The table is
+ * rewritten in a single transaction, concurrent readers are not
+ * blocked, concurrent writers conflict.
  */
+
+/* the current values of a column or index without the deleted rows */
+static str
+vacuum_bat(bat *ret, BAT *b, BAT *ui, BAT *uv, BAT *ins, BAT *del)
+{
+	str msg = MAL_SUCCEED;
+	bat full;
+	BAT *f, *bn;
+
+	if (b == NULL || ui == NULL || uv == NULL || ins == NULL)
+		msg = createException(SQL, "sql.vacuum", SQLSTATE(HY005) "Cannot access column descriptor");
+	else if ((msg = DELTAbat(&full, &b->batCacheid, &ui->batCacheid, &uv->batCacheid, &ins->batCacheid)) == MAL_SUCCEED) {
+		if ((msg = BKCshrinkBAT(ret, &full, &del->batCacheid)) == MAL_SUCCEED) {
+			/* shrinking keeps the order */
+			f = BBPquickdesc(full, 0);
+			bn = BBPquickdesc(*ret, 0);
+			bn->tsorted = f->tsorted;
+			bn->trevsorted = f->trevsorted;
+		}
+		BBPrelease(full);
+	}
+	if (b)
+		BBPunfix(b->batCacheid);
+	if (ui)
+		BBPunfix(ui->batCacheid);
+	if (uv)
+		BBPunfix(uv->batCacheid);
+	if (ins)
+		BBPunfix(ins->batCacheid);
+	return msg;
+}
+
+/* map the old oids of the table to the new ones, nil for the deleted */
+static BAT *
+vacuum_map(BAT *del, BUN cnt)
+{
+	BAT *map, *sdel;
+	oid *m, *o, *ol, nxt = 0;
+	BUN p;
+
+	if (BATsort(&sdel, NULL, NULL, del, NULL, NULL, 0, 0) != GDK_SUCCEED)
+		return NULL;
+	if ((map = COLnew(0, TYPE_oid, cnt, TRANSIENT)) == NULL) {
+		BBPunfix(sdel->batCacheid);
+		return NULL;
+	}
+	m = (oid *) Tloc(map, 0);
+	o = (oid *) Tloc(sdel, 0);
+	ol = (oid *) Tloc(sdel, BUNlast(sdel));
+	for (p = 0; p < cnt; p++) {
+		if (o < ol && *o == p) {
+			m[p] = oid_nil;
+			while (o < ol && *o == p)
+				o++;
+		} else {
+			m[p] = nxt++;
+		}
+	}
+	BBPunfix(sdel->batCacheid);
+	BATsetcount(map, cnt);
+	map->tsorted = map->trevsorted = 0;
+	map->tkey = 0;
+	map->tnil = nxt < cnt;
+	map->tnonil = nxt == cnt;
+	return map;
+}
+
+/* renumber the oids of a join index, the deleted rows can't be
+ * referred to */
+static BAT *
+vacuum_renumber(BAT *b, BAT *map)
+{
+	BAT *bn = BATproject(b, map);
+
+	if (bn) {
+		bn->tsorted = b->tsorted;
+		bn->trevsorted = b->trevsorted;
+	}
+	return bn;
+}
+
+/* renumber the join index of a foreign key referring to the vacuumed
+ * table, only the oids after the first deleted row change */
+static str
+vacuum_fkey(sql_trans *tr, sql_idx *i, BAT *map, oid first)
+{
+	str msg;
+	bat full;
+	BAT *b, *ui, *uv, *ins, *tids, *o, *n;
+	int res;
+
+	b = store_funcs.bind_idx(tr, i, RDONLY);
+	ui = store_funcs.bind_idx(tr, i, RD_UPD_ID);
+	uv = store_funcs.bind_idx(tr, i, RD_UPD_VAL);
+	ins = store_funcs.bind_idx(tr, i, RD_INS);
+	if (b == NULL || ui == NULL || uv == NULL || ins == NULL)
+		msg = createException(SQL, "sql.vacuum", SQLSTATE(HY005) "Cannot access index descriptor");
+	else
+		msg = DELTAbat(&full, &b->batCacheid, &ui->batCacheid, &uv->batCacheid, &ins->batCacheid);
+	if (b)
+		BBPunfix(b->batCacheid);
+	if (ui)
+		BBPunfix(ui->batCacheid);
+	if (uv)
+		BBPunfix(uv->batCacheid);
+	if (ins)
+		BBPunfix(ins->batCacheid);
+	if (msg)
+		return msg;
+
+	if ((b = BATdescriptor(full)) == NULL) {
+		BBPrelease(full);
+		throw(SQL, "sql.vacuum", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	BBPrelease(full);
+	tids = BATthetaselect(b, NULL, &first, ">=");
+	o = tids ? BATproject(tids, b) : NULL;
+	n = o ? BATproject(o, map) : NULL;
+	BBPunfix(b->batCacheid);
+	if (o)
+		BBPunfix(o->batCacheid);
+	if (n == NULL) {
+		if (tids)
+			BBPunfix(tids->batCacheid);
+		throw(SQL, "sql.vacuum", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+	res = BATcount(tids) ? store_funcs.update_idx(tr, i, tids, n, TYPE_bat) : LOG_OK;
+	BBPunfix(tids->batCacheid);
+	BBPunfix(n->batCacheid);
+	if (res != LOG_OK)
+		throw(SQL, "sql.vacuum", SQLSTATE(42000) "Renumbering the foreign key index %s failed", i->base.name);
+	return MAL_SUCCEED;
+}
+
 str
 SQLvacuum(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 {
@@ -3957,14 +4196,13 @@ SQLvacuum(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	sql_trans *tr;
 	sql_schema *s;
 	sql_table *t;
-	sql_column *c;
 	mvc *m = NULL;
-	str msg;
-	BAT *b, *del;
-	node *o;
-	int ordered = 0;
-	BUN cnt = 0;
-	BUN dcnt;
+	str msg = MAL_SUCCEED;
+	BAT *del, *map = NULL, *b;
+	bat *bids;
+	node *o, *n;
+	int i, nr;
+	oid first;
 
 	if ((msg = getSQLContext(cntxt, mb, &m, NULL)) != NULL)
 		return msg;
@@ -3979,10 +4217,10 @@ SQLvacuum(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 
 	if (m->user_id != USER_MONETDB)
 		throw(SQL, "sql.vacuum", SQLSTATE(42000) "insufficient privileges");
-	if ((!list_empty(t->idxs.set) || !list_empty(t->keys.set)))
-		throw(SQL, "sql.vacuum", SQLSTATE(42000) "vacuum not allowed on tables with indices");
 	if (t->system)
 		throw(SQL, "sql.vacuum", SQLSTATE(42000) "vacuum not allowed on system tables");
+	if (!isTable(t))
+		throw(SQL, "sql.vacuum", SQLSTATE(42000) "vacuum only allowed on tables");
 
 	if (has_snapshots(m->session->tr))
 		throw(SQL, "sql.vacuum", SQLSTATE(42000) "vacuum not allowed on snapshots");
@@ -3991,33 +4229,117 @@ SQLvacuum(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 		throw(SQL, "sql.vacuum", SQLSTATE(42000) "vacuum only allowed in auto commit mode");
 	tr = m->session->tr;
 
-	for (o = t->columns.set->h; o && ordered == 0; o = o->next) {
-		c = o->data;
-		b = store_funcs.bind_col(tr, c, RDONLY);
-		if (b == NULL)
-			throw(SQL, "sql.vacuum", SQLSTATE(HY005) "Cannot access column descriptor");
-		ordered |= BATtordered(b);
-		cnt = BATcount(b);
-		BBPunfix(b->batCacheid);
-	}
-
 	/* get the deletions BAT */
 	del = mvc_bind_dbat(m, sch, tbl, RD_INS);
 	if( del == NULL)
 		throw(SQL, "sql.vacuum", SQLSTATE(HY005) "Cannot access deletion column");
+	if (BATcount(del) == 0) {
+		BBPunfix(del->batCacheid);
+		return MAL_SUCCEED;
+	}
 
-	dcnt = BATcount(del);
+	nr = list_length(t->columns.set) + (t->idxs.set ? list_length(t->idxs.set) : 0);
+	if ((bids = GDKzalloc(nr * sizeof(bat))) == NULL) {
+		BBPunfix(del->batCacheid);
+		throw(SQL, "sql.vacuum", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+	i = 0;
+	for (o = t->columns.set->h; o && !msg; o = o->next, i++) {
+		sql_column *c = o->data;
+
+		msg = vacuum_bat(&bids[i], store_funcs.bind_col(tr, c, RDONLY),
+				 store_funcs.bind_col(tr, c, RD_UPD_ID),
+				 store_funcs.bind_col(tr, c, RD_UPD_VAL),
+				 store_funcs.bind_col(tr, c, RD_INS), del);
+		if (!msg && !map) {
+			/* all rows, including the deleted */
+			BUN cnt = BATcount(BBPquickdesc(bids[i], 0)) + BATcount(del);
+
+			if ((map = vacuum_map(del, cnt)) == NULL)
+				msg = createException(SQL, "sql.vacuum", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		}
+	}
+	for (o = t->idxs.set ? t->idxs.set->h : NULL; o && !msg; o = o->next, i++) {
+		sql_idx *ci = o->data;
+
+		/* some indices have no bats */
+		if ((hash_index(ci->type) && list_length(ci->columns) <= 1) || !idx_has_column(ci->type))
+			continue;
+		msg = vacuum_bat(&bids[i], store_funcs.bind_idx(tr, ci, RDONLY),
+				 store_funcs.bind_idx(tr, ci, RD_UPD_ID),
+				 store_funcs.bind_idx(tr, ci, RD_UPD_VAL),
+				 store_funcs.bind_idx(tr, ci, RD_INS), del);
+		/* a foreign key to the table itself */
+		if (!msg && ci->type == join_idx && ci->key &&
+		    ((sql_fkey *) ci->key)->rkey->k.t == t) {
+			BAT *bn;
+
+			b = BATdescriptor(bids[i]);
+			bn = b ? vacuum_renumber(b, map) : NULL;
+			if (b)
+				BBPunfix(b->batCacheid);
+			BBPrelease(bids[i]);
+			bids[i] = 0;
+			if (bn == NULL)
+				msg = createException(SQL, "sql.vacuum", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+			else
+				BBPkeepref(bids[i] = bn->batCacheid);
+		}
+	}
+
+	/* the foreign keys of other tables referring to this one */
+	first = del->tseqbase;
+	if (!msg && del->ttype != TYPE_void) {
+		BAT *sdel = NULL;
+
+		if (BATsort(&sdel, NULL, NULL, del, NULL, NULL, 0, 0) != GDK_SUCCEED)
+			msg = createException(SQL, "sql.vacuum", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		else {
+			first = *(oid *) Tloc(sdel, 0);
+			BBPunfix(sdel->batCacheid);
+		}
+	}
+	for (o = t->keys.set ? t->keys.set->h : NULL; o && !msg; o = o->next) {
+		sql_key *k = o->data;
+
+		if (k->type != pkey && k->type != ukey)
+			continue;
+		for (n = ((sql_ukey *) k)->keys ? ((sql_ukey *) k)->keys->h : NULL; n && !msg; n = n->next) {
+			sql_fkey *fk = n->data;
+
+			if (fk->k.t != t && fk->k.idx)
+				msg = vacuum_fkey(tr, fk->k.idx, map, first);
+		}
+	}
 	BBPunfix(del->batCacheid);
-	if (dcnt > 0) {
-		/* now decide on the algorithm */
-		if (ordered) {
-			if (dcnt > cnt / 20)
-				return SQLshrink(cntxt, mb, stk, pci);
-		} else {
-			return SQLreuse(cntxt, mb, stk, pci);
+	if (map)
+		BBPunfix(map->batCacheid);
+
+	if (!msg) {
+		mvc_clear_table(m, t);
+		i = 0;
+		for (o = t->columns.set->h; o; o = o->next, i++) {
+			sql_column *c = o->data;
+
+			if ((b = BATdescriptor(bids[i])) != NULL) {
+				store_funcs.append_col(tr, c, b, TYPE_bat);
+				BBPunfix(b->batCacheid);
+			}
+		}
+		for (o = t->idxs.set ? t->idxs.set->h : NULL; o; o = o->next, i++) {
+			sql_idx *ci = o->data;
+
+			if (bids[i] && (b = BATdescriptor(bids[i])) != NULL) {
+				store_funcs.append_idx(tr, ci, b, TYPE_bat);
+				BBPunfix(b->batCacheid);
+			}
 		}
 	}
-	return MAL_SUCCEED;
+	for (i = 0; i < nr; i++)
+		if (bids[i])
+			BBPrelease(bids[i]);
+	GDKfree(bids);
+	return msg;
 }
 
 /*
@@ -4245,7 +4567,7 @@ sql_storage(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 								if (BUNappend(indices, &sz, FALSE) != GDK_SUCCEED)
 									goto bailout;
 
-								bitval = 0; /* HASHispersistent(bn); */
+								bitval = BAThashpersisted(bn);
 								if (BUNappend(phash, &bitval, FALSE) != GDK_SUCCEED)
 									goto bailout;
 
@@ -4356,7 +4678,7 @@ sql_storage(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 									sz = bn->thash && bn->thash != (Hash *) 1 ? bn->thash->heap.size : 0; /* HASHsize() */
 									if (BUNappend(indices, &sz, FALSE) != GDK_SUCCEED)
 										goto bailout;
-									bitval = 0; /* HASHispersistent(bn); */
+									bitval = BAThashpersisted(bn);
 									if (BUNappend(phash, &bitval, FALSE) != GDK_SUCCEED)
 										goto bailout;
 
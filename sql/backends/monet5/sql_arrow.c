@@ -0,0 +1,882 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+/*
+ * Arrow IPC result sets for protocol 10.
+ *
+ * The head of a result set is the protocol 10 header
+ *     "*\n"[tableid][queryid][rowcount][colcount][timezone]
+ * followed by an encapsulated Arrow Schema message; every chunk is
+ *     "+\n"[rows] (or "-\n"[rows] for continuations)
+ * followed by an encapsulated RecordBatch message.  Like the columns
+ * of protocol 10, each message starts at the next eight byte boundary
+ * of the block, so that all buffers in the body are aligned.
+ *
+ * The body of a RecordBatch is written straight into the block of the
+ * stream.  Integers, floats, oids, times, intervals and hugeint
+ * decimals have the same layout in a BAT as in an Arrow array, so
+ * their values are copied from the BAT heap as a whole; only their
+ * validity bitmaps are computed, and those are left out for BATs that
+ * are known not to contain nils.  Strings are copied with an offsets
+ * array, and dates, timestamps, booleans and narrow decimals are
+ * converted to their Arrow representation.  Types Arrow does not know
+ * are sent as strings.
+ *
+ * The Arrow metadata are FlatBuffers, which are constructed front to
+ * back by the small builder below: a table is written directly after
+ * its vtable, and the objects it refers to are written after the
+ * table.
+ */
+
+#include "monetdb_config.h"
+#include "sql_arrow.h"
+#include "mtime.h"
+
+/* types of the Arrow Type union */
+#define ARROW_INT			2
+#define ARROW_FLOATINGPOINT	3
+#define ARROW_BINARY		4
+#define ARROW_UTF8			5
+#define ARROW_BOOL			6
+#define ARROW_DECIMAL		7
+#define ARROW_DATE			8
+#define ARROW_TIME			9
+#define ARROW_TIMESTAMP		10
+#define ARROW_DURATION		18
+
+/* types of the Arrow MessageHeader union */
+#define ARROW_SCHEMA		1
+#define ARROW_RECORDBATCH	3
+
+#define ARROW_METADATA_V4	3
+#define ARROW_MILLISECOND	1
+
+typedef struct {
+	char *buf;
+	size_t len;
+	size_t cap;
+	int err;
+} fbbuilder;
+
+/* Reserve n zeroed bytes at the next multiple of align, and return
+ * their position. */
+static size_t
+fb_reserve(fbbuilder *f, size_t align, size_t n)
+{
+	size_t pos = (f->len + align - 1) & ~(align - 1);
+
+	if (f->err)
+		return 0;
+	if (pos + n > f->cap) {
+		size_t cap = 2 * (pos + n) + 256;
+		char *buf = GDKrealloc(f->buf, cap);
+
+		if (buf == NULL) {
+			f->err = 1;
+			return 0;
+		}
+		f->buf = buf;
+		f->cap = cap;
+	}
+	memset(f->buf + f->len, 0, pos + n - f->len);
+	f->len = pos + n;
+	return pos;
+}
+
+/* FlatBuffers are little endian, whatever the byte order of the host */
+static void
+fb_put(fbbuilder *f, size_t pos, uint64_t v, int n)
+{
+	if (f->err)
+		return;
+	while (n-- > 0) {
+		f->buf[pos++] = (char) (v & 0xFF);
+		v >>= 8;
+	}
+}
+
+/* store the offset from position at to the object at target */
+static void
+fb_ref(fbbuilder *f, size_t at, size_t target)
+{
+	fb_put(f, at, (uint64_t) (target - at), 4);
+}
+
+/* Add a table with n fields of the given sizes, where a size of 0
+ * means that the field is absent.  The positions of the fields are
+ * returned in pos. */
+static size_t
+fb_table(fbbuilder *f, int n, const int *size, size_t *pos)
+{
+	size_t vt = fb_reserve(f, 2, 4 + 2 * n);
+	size_t tab = fb_reserve(f, 8, 4);
+	int i;
+
+	for (i = 0; i < n; i++)
+		pos[i] = size[i] ? fb_reserve(f, size[i], size[i]) : 0;
+	fb_put(f, vt, 4 + 2 * n, 2);
+	fb_put(f, vt + 2, f->len - tab, 2);
+	for (i = 0; i < n; i++)
+		fb_put(f, vt + 4 + 2 * i, size[i] ? pos[i] - tab : 0, 2);
+	fb_put(f, tab, tab - vt, 4);
+	return tab;
+}
+
+/* Add a vector of n elements of elsize bytes aligned at align (a
+ * multiple of 4), and return its position; the elements follow the
+ * four byte length. */
+static size_t
+fb_vector(fbbuilder *f, size_t n, size_t elsize, size_t align)
+{
+	size_t pos;
+
+	if ((f->len + 4) % align)
+		fb_reserve(f, 1, align - (f->len + 4) % align);
+	pos = fb_reserve(f, 4, 4 + n * elsize);
+	fb_put(f, pos, n, 4);
+	return pos;
+}
+
+/* add a string, and refer to it from position at */
+static void
+fb_string(fbbuilder *f, size_t at, const char *s)
+{
+	size_t len = s ? strlen(s) : 0;
+	size_t pos = fb_reserve(f, 4, 4 + len + 1);
+
+	fb_put(f, pos, len, 4);
+	if (!f->err && len)
+		memcpy(f->buf + pos + 4, s, len);
+	fb_ref(f, at, pos);
+}
+
+/* start a Message, and return the position of its header reference */
+static size_t
+fb_message(fbbuilder *f, int header_type, lng body_length)
+{
+	static const int size[4] = {2, 1, 4, 8};
+	size_t pos[4], root = fb_reserve(f, 4, 4);
+
+	fb_ref(f, root, fb_table(f, 4, size, pos));
+	fb_put(f, pos[0], ARROW_METADATA_V4, 2);
+	fb_put(f, pos[1], header_type, 1);
+	fb_put(f, pos[3], (uint64_t) body_length, 8);
+	return pos[2];
+}
+
+/* how the values of a result column are laid out in the Arrow body */
+typedef enum {
+	AX_COPY,					/* fixed width values copied from the heap */
+	AX_BOOL,					/* bitmap of the bit values */
+	AX_DECIMAL,					/* decimals widened to 128 bits */
+	AX_DATE,					/* days since 1970-01-01 */
+	AX_TIMESTAMP,				/* milliseconds since 1970-01-01 */
+	AX_STRING,					/* offsets into the string data */
+	AX_BLOB,					/* offsets into the blob data */
+	AX_CONVERT,					/* offsets into the values as strings */
+} ax_kind;
+
+typedef struct {
+	BAT *b;
+	BATiter bi;
+	ax_kind kind;
+	int width;					/* bytes per value of a fixed width array */
+} ax_col;
+
+static void
+arrow_classify(res_col *c, ax_col *a)
+{
+	int mtype = a->b->ttype;
+
+	a->width = 0;
+	switch (c->type.type->eclass) {
+	case EC_BIT:
+		a->kind = AX_BOOL;
+		return;
+	case EC_DEC:
+		a->kind = ATOMstorage(mtype) == TYPE_hge ? AX_COPY : AX_DECIMAL;
+		a->width = 16;
+		return;
+	case EC_DATE:
+		a->kind = AX_DATE;
+		a->width = sizeof(int);
+		return;
+	case EC_TIMESTAMP:
+		a->kind = AX_TIMESTAMP;
+		a->width = sizeof(lng);
+		return;
+	case EC_CHAR:
+	case EC_STRING:
+		a->kind = ATOMstorage(mtype) == TYPE_str ? AX_STRING : AX_CONVERT;
+		return;
+	case EC_BLOB:
+		a->kind = AX_BLOB;
+		return;
+	case EC_POS:
+	case EC_NUM:
+	case EC_FLT:
+	case EC_TIME:
+	case EC_SEC:
+	case EC_MONTH:
+		if (mtype == TYPE_void) {
+			a->kind = AX_COPY;
+			a->width = sizeof(oid);
+			return;
+		}
+		if (!ATOMvarsized(mtype)) {
+			a->kind = AX_COPY;
+			a->width = ATOMsize(mtype);
+			return;
+		}
+		/* fall through */
+	default:
+		/* values of types like json and url are strings already */
+		a->kind = ATOMstorage(mtype) == TYPE_str ? AX_STRING : AX_CONVERT;
+		return;
+	}
+}
+
+static void
+arrow_release(ax_col *cols, int n)
+{
+	while (n > 0)
+		BBPunfix(cols[--n].b->batCacheid);
+	GDKfree(cols);
+}
+
+static ax_col *
+arrow_columns(res_table *t)
+{
+	ax_col *cols = GDKzalloc(sizeof(ax_col) * t->nr_cols);
+	int i;
+
+	if (cols == NULL)
+		return NULL;
+	for (i = 0; i < t->nr_cols; i++) {
+		if ((cols[i].b = BATdescriptor(t->cols[i].b)) == NULL) {
+			arrow_release(cols, i);
+			return NULL;
+		}
+		cols[i].bi = bat_iterator(cols[i].b);
+		arrow_classify(t->cols + i, cols + i);
+	}
+	return cols;
+}
+
+/* add the Arrow type of a column to the Field with the given fields */
+static void
+arrow_field_type(fbbuilder *f, res_col *c, ax_col *a, size_t type_type, size_t type)
+{
+	sql_type *st = c->type.type;
+	size_t pos[3];
+	int id;
+
+	switch (a->kind) {
+	case AX_BOOL:
+		id = ARROW_BOOL;
+		fb_ref(f, type, fb_table(f, 0, NULL, pos));
+		break;
+	case AX_DECIMAL:
+		id = ARROW_DECIMAL;
+		fb_ref(f, type, fb_table(f, 3, (int[3]) {4, 4, 4}, pos));
+		fb_put(f, pos[0], c->type.digits, 4);
+		fb_put(f, pos[1], c->type.scale, 4);
+		fb_put(f, pos[2], 128, 4);
+		break;
+	case AX_DATE:
+		id = ARROW_DATE;
+		fb_ref(f, type, fb_table(f, 1, (int[1]) {2}, pos));
+		fb_put(f, pos[0], 0, 2);	/* DAY */
+		break;
+	case AX_TIMESTAMP:
+		id = ARROW_TIMESTAMP;
+		fb_ref(f, type, fb_table(f, 2, (int[2]) {2, type_has_tz(&c->type) ? 4 : 0}, pos));
+		fb_put(f, pos[0], ARROW_MILLISECOND, 2);
+		if (type_has_tz(&c->type))
+			fb_string(f, pos[1], "UTC");
+		break;
+	case AX_BLOB:
+		id = ARROW_BINARY;
+		fb_ref(f, type, fb_table(f, 0, NULL, pos));
+		break;
+	case AX_STRING:
+	case AX_CONVERT:
+		id = ARROW_UTF8;
+		fb_ref(f, type, fb_table(f, 0, NULL, pos));
+		break;
+	case AX_COPY:
+	default:
+		switch (st->eclass) {
+		case EC_DEC:
+		case EC_NUM:
+			if (a->width == 16) {
+				/* hugeint */
+				id = ARROW_DECIMAL;
+				fb_ref(f, type, fb_table(f, 3, (int[3]) {4, 4, 4}, pos));
+				fb_put(f, pos[0], st->eclass == EC_DEC ? c->type.digits : 38, 4);
+				fb_put(f, pos[1], st->eclass == EC_DEC ? c->type.scale : 0, 4);
+				fb_put(f, pos[2], 128, 4);
+				break;
+			}
+			/* fall through */
+		case EC_POS:
+		case EC_MONTH:
+			/* month intervals are sent as numbers of months, since
+			 * few Arrow libraries can do anything with YEAR_MONTH
+			 * intervals */
+			id = ARROW_INT;
+			fb_ref(f, type, fb_table(f, 2, (int[2]) {4, 1}, pos));
+			fb_put(f, pos[0], 8 * a->width, 4);
+			fb_put(f, pos[1], st->eclass != EC_POS, 1);
+			break;
+		case EC_FLT:
+			id = ARROW_FLOATINGPOINT;
+			fb_ref(f, type, fb_table(f, 1, (int[1]) {2}, pos));
+			fb_put(f, pos[0], a->width == 4 ? 1 : 2, 2);	/* SINGLE or DOUBLE */
+			break;
+		case EC_TIME:
+			id = ARROW_TIME;
+			fb_ref(f, type, fb_table(f, 2, (int[2]) {2, 4}, pos));
+			fb_put(f, pos[0], ARROW_MILLISECOND, 2);
+			fb_put(f, pos[1], 32, 4);
+			break;
+		case EC_SEC:
+		default:
+			id = ARROW_DURATION;
+			fb_ref(f, type, fb_table(f, 1, (int[1]) {2}, pos));
+			fb_put(f, pos[0], ARROW_MILLISECOND, 2);
+			break;
+		}
+		break;
+	}
+	fb_put(f, type_type, id, 1);
+}
+
+/* add a KeyValue to the vector element at position at */
+static void
+arrow_keyvalue(fbbuilder *f, size_t at, const char *key, const char *value)
+{
+	size_t pos[2];
+
+	fb_ref(f, at, fb_table(f, 2, (int[2]) {4, 4}, pos));
+	fb_string(f, pos[0], key);
+	fb_string(f, pos[1], value);
+}
+
+static void
+arrow_schema(fbbuilder *f, res_table *t, ax_col *cols)
+{
+	size_t header = fb_message(f, ARROW_SCHEMA, 0);
+	size_t pos[7], fields;
+	int i;
+
+	fb_ref(f, header, fb_table(f, 2, (int[2]) {2, 4}, pos));
+#ifdef WORDS_BIGENDIAN
+	fb_put(f, pos[0], 1, 2);
+#else
+	fb_put(f, pos[0], 0, 2);
+#endif
+	fields = fb_vector(f, t->nr_cols, 4, 4);
+	fb_ref(f, pos[1], fields);
+	fields += 4;
+	for (i = 0; i < t->nr_cols; i++) {
+		res_col *c = t->cols + i;
+		size_t meta;
+
+		fb_ref(f, fields + 4 * i, fb_table(f, 7, (int[7]) {4, 1, 1, 4, 0, 4, 4}, pos));
+		fb_string(f, pos[0], c->name);
+		fb_put(f, pos[1], 1, 1);
+		arrow_field_type(f, c, cols + i, pos[2], pos[3]);
+		fb_ref(f, pos[5], fb_vector(f, 0, 4, 4));
+		meta = fb_vector(f, 2, 4, 4);
+		fb_ref(f, pos[6], meta);
+		meta += 4;
+		arrow_keyvalue(f, meta, "monetdb.table", c->tn);
+		arrow_keyvalue(f, meta + 4, "monetdb.type", c->type.type->sqlname);
+	}
+}
+
+/* Write the prefix of an encapsulated message with len bytes of
+ * metadata. */
+static void
+arrow_prefix(char *buf, size_t len)
+{
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		buf[i] = (char) 0xFF;
+		buf[4 + i] = (char) ((len >> (8 * i)) & 0xFF);
+	}
+}
+
+/* number of zero bytes that bring position pos to an eight byte boundary */
+#define ARROW_PAD(pos)	((8 - (pos) % 8) % 8)
+
+int
+mvc_export_head_arrow(backend *b, stream *s, res_table *t)
+{
+	fbbuilder f = {NULL, 0, 0, 0};
+	char prefix[8], pad[8] = {0};
+	size_t len;
+	ax_col *cols;
+	int fres = 0;
+
+	(void) b;
+	if ((cols = arrow_columns(t)) == NULL)
+		return -1;
+	arrow_schema(&f, t, cols);
+	arrow_release(cols, t->nr_cols);
+	if (f.err) {
+		GDKfree(f.buf);
+		return -1;
+	}
+	len = f.len + ARROW_PAD(f.len);
+	arrow_prefix(prefix, len);
+	if (mnstr_write(s, pad, 1, ARROW_PAD(bs2_buffer(s).pos)) < 0 ||
+		mnstr_write(s, prefix, 1, 8) != 8 ||
+		mnstr_write(s, f.buf, 1, f.len) != (ssize_t) f.len ||
+		mnstr_write(s, pad, 1, len - f.len) < 0 ||
+		mnstr_flush(s) < 0)
+		fres = -1;
+	GDKfree(f.buf);
+	return fres;
+}
+
+/* Compute the validity bitmap of n rows from srow on of a fixed width
+ * column, and return the number of nils. */
+#define ARROW_VALIDITY(TYPE, ISNIL)									\
+	do {															\
+		const TYPE *v = (const TYPE *) Tloc(a->b, srow);			\
+		for (j = 0; j < n; j++) {									\
+			if (ISNIL(v[j]))										\
+				nils++;												\
+			else													\
+				valid[j >> 3] |= 1 << (j & 7);						\
+		}															\
+	} while (0)
+
+static BUN
+arrow_validity(ax_col *a, uint8_t *valid, BUN srow, BUN n)
+{
+	BUN j, nils = 0;
+
+	memset(valid, 0, (n + 7) / 8);
+	if (a->b->ttype == TYPE_void) {
+		if (is_oid_nil(a->b->tseqbase))
+			return n;
+		memset(valid, 0xFF, (n + 7) / 8);
+		return 0;
+	}
+	switch (ATOMstorage(a->b->ttype)) {
+	case TYPE_bte:
+		ARROW_VALIDITY(bte, is_bte_nil);
+		break;
+	case TYPE_sht:
+		ARROW_VALIDITY(sht, is_sht_nil);
+		break;
+	case TYPE_int:
+		ARROW_VALIDITY(int, is_int_nil);
+		break;
+	case TYPE_lng:
+		ARROW_VALIDITY(lng, is_lng_nil);
+		break;
+	case TYPE_oid:
+		ARROW_VALIDITY(oid, is_oid_nil);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		ARROW_VALIDITY(hge, is_hge_nil);
+		break;
+#endif
+	case TYPE_flt:
+		ARROW_VALIDITY(flt, is_flt_nil);
+		break;
+	case TYPE_dbl:
+		ARROW_VALIDITY(dbl, is_dbl_nil);
+		break;
+	default:
+		memset(valid, 0xFF, (n + 7) / 8);
+		break;
+	}
+	return nils;
+}
+
+/* Return the value of a column that is sent as a string, and set
+ * *len to its length; NULL means nil. */
+static const char *
+arrow_string(ax_col *a, BUN row, char **result, size_t *length, size_t *len)
+{
+	int mtype = a->b->ttype;
+	const void *element = BUNtail(a->bi, row);
+	const char *str;
+
+	if (a->kind == AX_STRING) {
+		if (GDK_STRNIL(element))
+			return NULL;
+		*len = strlen(element);
+		return element;
+	}
+	if (BATatoms[mtype].atomCmp(element, BATatoms[mtype].atomNull) == 0)
+		return NULL;
+	if (BATatoms[mtype].atomToStr(result, length, element) < 0)
+		return NULL;
+	/* the string conversion functions quote some values for the text
+	 * protocol, which Arrow clients are not interested in */
+	str = *result;
+	*len = strlen(str);
+	if (str[0] == '"') {
+		str++;
+		*len -= 2;
+	}
+	return str;
+}
+
+/* bytes a row of a variable width column takes in the body */
+static size_t
+arrow_varsize(ax_col *a, BUN row, char **result, size_t *length)
+{
+	size_t len = 0;
+
+	if (a->kind == AX_BLOB) {
+		const blob *v = (const blob *) BUNtail(a->bi, row);
+		len = v->nitems == ~(size_t) 0 ? 0 : v->nitems;
+	} else {
+		(void) arrow_string(a, row, result, length, &len);
+	}
+	return sizeof(int) + len;
+}
+
+typedef struct {
+	lng offset;
+	lng length;
+} ax_buffer;
+
+/* Write rows srow up to srow + n of a column at position p of the body
+ * that starts at body, and add its FieldNode and buffers. */
+static char *
+arrow_column(ax_col *a, BUN srow, BUN n, char *body, char *p, lng *node, ax_buffer **buffers, char **result, size_t *length)
+{
+	uint8_t *valid = (uint8_t *) p;
+	BUN j, nils = 0;
+	ax_buffer *bf = *buffers;
+	char *v;
+
+	/* validity bitmap, which is left out when there are no nils */
+	bf->offset = p - body;
+	bf->length = 0;
+	if (a->kind == AX_COPY || a->kind == AX_DECIMAL) {
+		if (!a->b->tnonil && (nils = arrow_validity(a, valid, srow, n)) > 0) {
+			bf->length = (n + 7) / 8;
+			p += bf->length + ARROW_PAD(bf->length);
+		}
+	} else {
+		/* the other kinds check their values for nils as they go */
+		bf->length = (n + 7) / 8;
+		memset(valid, 0, bf->length);
+		p += bf->length + ARROW_PAD(bf->length);
+	}
+	bf++;
+
+	v = p;
+	switch (a->kind) {
+	case AX_COPY:
+		if (a->b->ttype == TYPE_void) {
+			oid *o = (oid *) v;
+			for (j = 0; j < n; j++)
+				o[j] = is_oid_nil(a->b->tseqbase) ? oid_nil : a->b->tseqbase + srow + j;
+		} else {
+			memcpy(v, Tloc(a->b, srow), n * a->width);
+		}
+		p += n * a->width;
+		break;
+	case AX_DECIMAL: {
+		lng *d = (lng *) v;
+		for (j = 0; j < n; j++) {
+			lng x;
+			switch (ATOMstorage(a->b->ttype)) {
+			case TYPE_bte:
+				x = ((const bte *) Tloc(a->b, 0))[srow + j];
+				break;
+			case TYPE_sht:
+				x = ((const sht *) Tloc(a->b, 0))[srow + j];
+				break;
+			case TYPE_int:
+				x = ((const int *) Tloc(a->b, 0))[srow + j];
+				break;
+			default:
+				x = ((const lng *) Tloc(a->b, 0))[srow + j];
+				break;
+			}
+#ifdef WORDS_BIGENDIAN
+			d[2 * j] = x < 0 ? -1 : 0;
+			d[2 * j + 1] = x;
+#else
+			d[2 * j] = x;
+			d[2 * j + 1] = x < 0 ? -1 : 0;
+#endif
+		}
+		p += n * 16;
+		break;
+	}
+	case AX_BOOL: {
+		const bit *b = (const bit *) Tloc(a->b, srow);
+		memset(v, 0, (n + 7) / 8);
+		for (j = 0; j < n; j++) {
+			if (is_bit_nil(b[j])) {
+				nils++;
+				continue;
+			}
+			valid[j >> 3] |= 1 << (j & 7);
+			if (b[j])
+				v[j >> 3] |= 1 << (j & 7);
+		}
+		p += (n + 7) / 8;
+		break;
+	}
+	case AX_DATE: {
+		const date *d = (const date *) Tloc(a->b, srow);
+		date epoch = MTIMEtodate(1, 1, 1970);
+		int *o = (int *) v;
+		for (j = 0; j < n; j++) {
+			if (date_isnil(d[j])) {
+				o[j] = 0;
+				nils++;
+				continue;
+			}
+			valid[j >> 3] |= 1 << (j & 7);
+			o[j] = d[j] - epoch;
+		}
+		p += n * sizeof(int);
+		break;
+	}
+	case AX_TIMESTAMP: {
+		const timestamp *ts = (const timestamp *) Tloc(a->b, srow);
+		lng *o = (lng *) v;
+		for (j = 0; j < n; j++) {
+			str msg;
+			if (ts_isnil(ts[j])) {
+				o[j] = 0;
+				nils++;
+				continue;
+			}
+			if ((msg = MTIMEepoch2lng(o + j, ts + j)) != MAL_SUCCEED) {
+				freeException(msg);
+				return NULL;
+			}
+			valid[j >> 3] |= 1 << (j & 7);
+		}
+		p += n * sizeof(lng);
+		break;
+	}
+	case AX_STRING:
+	case AX_CONVERT:
+	case AX_BLOB: {
+		int *offsets = (int *) v;
+		char *data;
+		offsets[0] = 0;
+		p += (n + 1) * sizeof(int);
+		p += ARROW_PAD((size_t) (p - body));
+		data = p;
+		for (j = 0; j < n; j++) {
+			size_t len = 0;
+			if (a->kind == AX_BLOB) {
+				const blob *x = (const blob *) BUNtail(a->bi, srow + j);
+				if (x->nitems == ~(size_t) 0) {
+					nils++;
+				} else {
+					len = x->nitems;
+					memcpy(p, x->data, len);
+					valid[j >> 3] |= 1 << (j & 7);
+				}
+			} else {
+				const char *str = arrow_string(a, srow + j, result, length, &len);
+				if (str == NULL) {
+					nils++;
+					len = 0;
+				} else {
+					memcpy(p, str, len);
+					valid[j >> 3] |= 1 << (j & 7);
+				}
+			}
+			p += len;
+			offsets[j + 1] = (int) (p - data);
+		}
+		bf->offset = v - body;
+		bf->length = (n + 1) * sizeof(int);
+		bf++;
+		v = data;
+		break;
+	}
+	}
+	bf->offset = v - body;
+	bf->length = p - v;
+	bf++;
+	p += ARROW_PAD((size_t) (p - body));
+
+	if (a->kind != AX_COPY && a->kind != AX_DECIMAL && nils == 0)
+		(*buffers)->length = 0;
+	node[0] = (lng) n;
+	node[1] = (lng) nils;
+	*buffers = bf;
+	return p;
+}
+
+/* upper bound of the size of the metadata of a RecordBatch */
+#define ARROW_BATCH_METADATA(ncols)	(256 + 64 * (size_t) (ncols))
+
+int
+mvc_export_table_arrow(backend *b, stream *s, res_table *t, BUN offset, BUN nr, int initial_transfer)
+{
+	size_t bsize = b->client->blocksize;
+	size_t fixed_bits = 0, header, metadata;
+	BUN row, srow, count = offset + nr;
+	int i, nvar = 0, fres = 0;
+	char *result = NULL;
+	size_t length = 0;
+	lng *nodes = NULL;
+	ax_buffer *buffers = NULL;
+	ax_col *cols;
+
+	if ((cols = arrow_columns(t)) == NULL)
+		return -1;
+	nodes = GDKmalloc(2 * sizeof(lng) * t->nr_cols);
+	buffers = GDKmalloc(3 * sizeof(ax_buffer) * t->nr_cols);
+	if (nodes == NULL || buffers == NULL) {
+		fres = -1;
+		goto cleanup;
+	}
+	for (i = 0; i < t->nr_cols; i++) {
+		/* one validity bit per row, and the fixed width values */
+		fixed_bits += 1 + (cols[i].kind == AX_BOOL ? 1 : 8 * cols[i].width);
+		if (cols[i].width == 0 && cols[i].kind != AX_BOOL)
+			nvar++;
+	}
+
+	// ensure the buffer is currently empty
+	assert(bs2_buffer(s).pos == 0);
+
+	/* the protocol 10 chunk header, padding, and the message prefix */
+	header = 2 + sizeof(lng);
+	header += ARROW_PAD(header) + 8;
+	metadata = ARROW_BATCH_METADATA(t->nr_cols);
+
+	row = srow = offset;
+	while (row < count) {
+		fbbuilder f = {NULL, 0, 0, 0};
+		char *buf = bs2_buffer(s).buf, *body, *p;
+		lng *node = nodes;
+		ax_buffer *bf = buffers;
+		size_t bytes_left, varbytes = 0;
+		size_t overhead = header + metadata + (size_t) t->nr_cols * (4 * 8 + sizeof(int));
+
+		bytes_left = bsize > overhead ? bsize - overhead : 0;
+		if (nvar == 0) {
+			row = srow + (BUN) (8 * bytes_left / fixed_bits);
+			if (row > count)
+				row = count;
+		} else {
+			while (row < count) {
+				size_t rowsize = 0;
+				for (i = 0; i < t->nr_cols; i++)
+					if (cols[i].width == 0 && cols[i].kind != AX_BOOL)
+						rowsize += arrow_varsize(cols + i, row, &result, &length);
+				if (((row - srow + 1) * fixed_bits + 7) / 8 + varbytes + rowsize > bytes_left)
+					break;
+				varbytes += rowsize;
+				row++;
+			}
+		}
+		if (row == srow) {
+			/* a single row does not fit: ask the client for a larger block */
+			size_t rowsize = (fixed_bits + 7) / 8;
+			lng new_size;
+
+			for (i = 0; i < t->nr_cols; i++)
+				if (cols[i].width == 0 && cols[i].kind != AX_BOOL)
+					rowsize += arrow_varsize(cols + i, row, &result, &length);
+			new_size = (lng) (overhead + rowsize + 1024);
+			if (!mnstr_writeLng(s, (lng) -1) ||
+				!mnstr_writeLng(s, new_size) ||
+				mnstr_flush(s) < 0 ||
+				bs2_resizebuf(s, (size_t) new_size) < 0) {
+				fres = -1;
+				goto cleanup;
+			}
+			buf = bs2_buffer(s).buf;
+			bsize = (size_t) new_size;
+			row = srow + 1;
+		}
+
+		// buffer has to be empty currently
+		assert(bs2_buffer(s).pos == 0);
+		if (!mnstr_writeStr(s, initial_transfer ? "+\n" : "-\n") ||
+			!mnstr_writeLng(s, (lng) (row - srow))) {
+			fres = -1;
+			goto cleanup;
+		}
+		initial_transfer = 0;
+
+		body = p = buf + header + metadata;
+		for (i = 0; i < t->nr_cols; i++) {
+			p = arrow_column(cols + i, srow, row - srow, body, p, node, &bf, &result, &length);
+			if (p == NULL) {
+				fres = -1;
+				goto cleanup;
+			}
+			node += 2;
+		}
+		assert((size_t) (p - buf) <= bsize);
+
+		{
+			size_t header_pos = fb_message(&f, ARROW_RECORDBATCH, (lng) (p - body));
+			size_t pos[3], vec;
+			lng *n;
+			ax_buffer *x;
+
+			fb_ref(&f, header_pos, fb_table(&f, 3, (int[3]) {8, 4, 4}, pos));
+			fb_put(&f, pos[0], (uint64_t) (row - srow), 8);
+			vec = fb_vector(&f, t->nr_cols, 16, 8);
+			fb_ref(&f, pos[1], vec);
+			for (n = nodes, vec += 4; n < node; n++, vec += 8)
+				fb_put(&f, vec, (uint64_t) *n, 8);
+			vec = fb_vector(&f, bf - buffers, 16, 8);
+			fb_ref(&f, pos[2], vec);
+			for (x = buffers, vec += 4; x < bf; x++, vec += 16) {
+				fb_put(&f, vec, (uint64_t) x->offset, 8);
+				fb_put(&f, vec + 8, (uint64_t) x->length, 8);
+			}
+		}
+		if (f.err || f.len > metadata) {
+			assert(f.err);
+			GDKfree(f.buf);
+			fres = -1;
+			goto cleanup;
+		}
+		memset(buf + 2 + sizeof(lng), 0, header - 8 - 2 - sizeof(lng));
+		arrow_prefix(buf + header - 8, metadata);
+		memcpy(buf + header, f.buf, f.len);
+		memset(buf + header + f.len, 0, metadata - f.len);
+		GDKfree(f.buf);
+
+		bs2_setpos(s, p - buf);
+		// flush the current chunk
+		if (mnstr_flush(s) < 0) {
+			fres = -1;
+			goto cleanup;
+		}
+		srow = row;
+	}
+cleanup:
+	arrow_release(cols, t->nr_cols);
+	GDKfree(nodes);
+	GDKfree(buffers);
+	GDKfree(result);
+	if (mnstr_errnr(s))
+		return -1;
+	return fres;
+}
@@ -0,0 +1,24 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+#ifndef _SQL_ARROW_H_
+#define _SQL_ARROW_H_
+
+#include "sql_result.h"
+#include "bat/res_table.h"
+
+/*
+ * Clients that announce RESULT_ARROW in the protocol 10 handshake
+ * receive the column descriptions of a result set as an Arrow IPC
+ * Schema message and every chunk of rows as an Arrow IPC RecordBatch
+ * message, in the framing of protocol 10.
+ */
+extern int mvc_export_head_arrow(backend *b, stream *s, res_table *t);
+extern int mvc_export_table_arrow(backend *b, stream *s, res_table *t, BUN offset, BUN nr, int initial_transfer);
+
+#endif /* _SQL_ARROW_H_ */
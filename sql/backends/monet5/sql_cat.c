@@ -129,6 +129,111 @@ alter_table_add_table(mvc *sql, char *msname, char *mtname, char *psname, char *
 	return MAL_SUCCEED;
 }
 
+static char *
+alter_table_set_partition(mvc *sql, char *sname, char *tname, int tpe, char *cname)
+{
+	sql_schema *s = mvc_bind_schema(sql, sname);
+	sql_table *t = NULL;
+	sql_column *c = NULL;
+
+	if (s)
+		t = mvc_bind_table(sql, s, tname);
+	if (!t)
+		throw(SQL,"sql.alter_table_set_partition",SQLSTATE(42S02) "ALTER TABLE: no such table '%s' in schema '%s'", tname, sname);
+	if (!isMergeTable(t))
+		throw(SQL,"sql.alter_table_set_partition",SQLSTATE(42000) "ALTER TABLE: cannot partition '%s.%s', it is not a MERGE TABLE", sname, tname);
+	if (cs_size(&t->members))
+		throw(SQL,"sql.alter_table_set_partition",SQLSTATE(42000) "ALTER TABLE: cannot partition MERGE TABLE '%s.%s', it already has members", sname, tname);
+	if (!(c = mvc_bind_column(sql, t, cname)))
+		throw(SQL,"sql.alter_table_set_partition",SQLSTATE(42S22) "ALTER TABLE: no such column '%s' in table '%s.%s'", cname, sname, tname);
+	if (sql_trans_set_partition(sql->session->tr, t, c, tpe) < 0)
+		throw(SQL,"sql.alter_table_set_partition",SQLSTATE(42000) "ALTER TABLE: cannot partition MERGE TABLE '%s.%s'", sname, tname);
+	return MAL_SUCCEED;
+}
+
+/* Compare two partition bounds or values of column c, both in its
+ * storage format. */
+static int
+partition_value_cmp(sql_column *c, const char *a, const char *b)
+{
+	int tpe = c->type.type->localtype, res;
+	ptr pa = NULL, pb = NULL;
+	size_t la = 0, lb = 0;
+
+	if (ATOMstorage(tpe) == TYPE_str)
+		return strcmp(a, b);
+	if (ATOMfromstr(tpe, &pa, &la, a) < 0 || ATOMfromstr(tpe, &pb, &lb, b) < 0)
+		res = strcmp(a, b);
+	else
+		res = ATOMcmp(tpe, pa, pb);
+	GDKfree(pa);
+	GDKfree(pb);
+	return res;
+}
+
+/* Add pt to the partitioned merge table mt, with the bounds (range
+ * partitioning) or values (value partitioning) in vals.  No row may
+ * belong to two members. */
+static char *
+alter_table_add_partition(mvc *sql, char *msname, char *mtname, char *psname, char *ptname, int tpe, char **vals, int nvals)
+{
+	sql_trans *tr = sql->session->tr;
+	sql_schema *ms = mvc_bind_schema(sql, msname);
+	sql_table *mt = NULL, *pt = NULL;
+	sql_allocator *sa;
+	sql_column *c;
+	node *n;
+	char *msg = MAL_SUCCEED;
+	int ptpe = 0, i;
+
+	if (ms)
+		mt = mvc_bind_table(sql, ms, mtname);
+	if (!mt || !(c = sql_trans_partition_column(tr, mt, &ptpe)) || ptpe != tpe)
+		throw(SQL,"sql.alter_table_add_partition",SQLSTATE(42000) "ALTER TABLE: table '%s.%s' is not partitioned that way", msname, mtname);
+	if (tpe == PARTITION_RANGE && (nvals != 2 || (vals[0] && vals[1] && partition_value_cmp(c, vals[0], vals[1]) >= 0)))
+		throw(SQL,"sql.alter_table_add_partition",SQLSTATE(42000) "ALTER TABLE: the minimum of partition '%s.%s' must be below its maximum", psname, ptname);
+
+	if ((sa = sa_create()) == NULL)
+		throw(SQL,"sql.alter_table_add_partition",SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	for (n = mt->members.set ? mt->members.set->h : NULL; n && !msg; n = n->next) {
+		sql_part *p = n->data;
+		sql_table *q = find_sql_table(mt->s, p->base.name);
+
+		if (!q)
+			continue;
+		if (tpe == PARTITION_RANGE) {
+			char *lo = NULL, *hi = NULL;
+
+			if (sql_trans_range_partition(tr, sa, mt, q, &lo, &hi) &&
+			    (!vals[0] || !hi || partition_value_cmp(c, vals[0], hi) < 0) &&
+			    (!lo || !vals[1] || partition_value_cmp(c, lo, vals[1]) < 0))
+				msg = createException(SQL,"sql.alter_table_add_partition",SQLSTATE(42000) "ALTER TABLE: the range of partition '%s.%s' overlaps with partition '%s'", psname, ptname, q->base.name);
+		} else {
+			list *qvals = sql_trans_value_partition(tr, sa, mt, q);
+			node *m;
+
+			for (m = qvals ? qvals->h : NULL; m && !msg; m = m->next)
+				for (i = 0; i < nvals && !msg; i++)
+					if (partition_value_cmp(c, vals[i], m->data) == 0)
+						msg = createException(SQL,"sql.alter_table_add_partition",SQLSTATE(42000) "ALTER TABLE: the value '%s' of partition '%s.%s' already belongs to partition '%s'", vals[i], psname, ptname, q->base.name);
+		}
+	}
+	sa_destroy(sa);
+
+	if (msg || (msg = alter_table_add_table(sql, msname, mtname, psname, ptname)) != MAL_SUCCEED)
+		return msg;
+	pt = mvc_bind_table(sql, mvc_bind_schema(sql, psname), ptname);
+	if (tpe == PARTITION_RANGE) {
+		if (sql_trans_add_range_partition(tr, mt, pt, vals[0], vals[1]) < 0)
+			throw(SQL,"sql.alter_table_add_partition",SQLSTATE(42000) "ALTER TABLE: cannot add partition '%s.%s'", psname, ptname);
+	} else {
+		for (i = 0; i < nvals; i++)
+			if (sql_trans_add_value_partition(tr, mt, pt, vals[i]) < 0)
+				throw(SQL,"sql.alter_table_add_partition",SQLSTATE(42000) "ALTER TABLE: cannot add partition '%s.%s'", psname, ptname);
+	}
+	return MAL_SUCCEED;
+}
+
 static char *
 alter_table_del_table(mvc *sql, char *msname, char *mtname, char *psname, char *ptname, int drop_action)
 {
@@ -691,6 +796,20 @@ alter_table(Client cntxt, mvc *sql, char *sname, sql_table *t)
 				if (r != GDK_SUCCEED)
 					throw(SQL, "sql.alter_table", GDK_EXCEPTION);
 			}
+			if (i->type == hash_idx && list_length(i->columns) == 1) {
+				/* build the hash now, rather than in the first
+				 * query; it is persisted with the column and
+				 * maintained on its updates */
+				gdk_return r = GDK_SUCCEED;
+				sql_kc *ic = i->columns->h->data;
+				BAT *b = mvc_bind(sql, nt->s->base.name, nt->base.name, ic->c->base.name, 0);
+				if (b && BATcount(b) > 0)
+					r = BAThash(b, 0);
+				if (b)
+					BBPunfix(b->batCacheid);
+				if (r != GDK_SUCCEED)
+					throw(SQL, "sql.alter_table", GDK_EXCEPTION);
+			}
 			mvc_copy_idx(sql, nt, i);
 		}
 	}
@@ -1212,6 +1331,42 @@ SQLalter_add_table(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	return msg;
 }
 
+str
+SQLalter_set_partition(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci) 
+{	mvc *sql = NULL;
+	str msg;
+	str sname = *getArgReference_str(stk, pci, 1); 
+	char *tname = SaveArgReference(stk, pci, 2);
+	int tpe = *getArgReference_int(stk, pci, 3);
+	char *cname = SaveArgReference(stk, pci, 4);
+
+	initcontext();
+	msg = alter_table_set_partition(sql, sname, tname, tpe, cname);
+	return msg;
+}
+
+str
+SQLalter_add_partition(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci) 
+{	mvc *sql = NULL;
+	str msg;
+	str sname = *getArgReference_str(stk, pci, 1); 
+	char *mtname = SaveArgReference(stk, pci, 2);
+	char *psname = SaveArgReference(stk, pci, 3);
+	char *ptname = SaveArgReference(stk, pci, 4);
+	int tpe = *getArgReference_int(stk, pci, 5);
+	int i, nvals = pci->argc - 6;
+	char **vals;
+
+	initcontext();
+	if ((vals = GDKmalloc(sizeof(char *) * (nvals + 1))) == NULL)
+		throw(SQL, "sql.alter_table_add_partition", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	for (i = 0; i < nvals; i++)
+		vals[i] = SaveArgReference(stk, pci, 6 + i);
+	msg = alter_table_add_partition(sql, sname, mtname, psname, ptname, tpe, vals, nvals);
+	GDKfree(vals);
+	return msg;
+}
+
 str
 SQLalter_del_table(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci) 
 {	mvc *sql = NULL;
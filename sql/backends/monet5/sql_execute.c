@@ -25,6 +25,7 @@
 #include "sql_mvc.h"
 #include "sql_user.h"
 #include "sql_optimizer.h"
+#include "sql_resultcache.h"
 #include "sql_datetime.h"
 #include "rel_optimizer.h"
 #include "rel_partition.h"
@@ -280,7 +281,7 @@ static str
 SQLrun(Client c, backend *be, mvc *m)
 {
 	str msg= MAL_SUCCEED;
-	MalBlkPtr mc = 0, mb=c->curprg->def;
+	MalBlkPtr mc = 0, qt = 0, mb=c->curprg->def;
 	InstrPtr p=0;
 	int i,j, retc;
 	ValPtr val;
@@ -310,6 +311,7 @@ SQLrun(Client c, backend *be, mvc *m)
 			return msg;
 		}
 		if( getFunctionId(p) &&  p->blk && qc_isaquerytemplate(getFunctionId(p)) ) {
+			qt = p->blk;
 			mc = copyMalBlk(p->blk);
 			if (!mc) {
 				freeMalBlk(mb);
@@ -340,6 +342,17 @@ SQLrun(Client c, backend *be, mvc *m)
 			break;
 		}
 	}
+	/* answer it from the result cache, saving the execution */
+	if (qt) {
+		switch (rc_lookup(be, mb)) {
+		case 1:
+			freeMalBlk(mb);
+			return MAL_SUCCEED;
+		case -1:
+			freeMalBlk(mb);
+			throw(SQL, "sql.resultSet", SQLSTATE(45000) "Result set construction failed");
+		}
+	}
 	// JIT optimize the SQL query using all current information
 	// This include template constants, BAT sizes.
 	if( m->emod & mod_debug)
@@ -347,6 +360,7 @@ SQLrun(Client c, backend *be, mvc *m)
 	msg = SQLoptimizeQuery(c, mb);
 	if( msg != MAL_SUCCEED){
 		// freeMalBlk(mb);
+		rc_done(be);
 		return msg;
 	}
 	mb->keephistory = FALSE;
@@ -356,6 +370,7 @@ SQLrun(Client c, backend *be, mvc *m)
 		// mal block might be so broken free causes segfault
 		msg = mb->errors;
 		mb->errors = 0;
+		rc_done(be);
 		return msg;
 	}
 
@@ -374,6 +389,10 @@ SQLrun(Client c, backend *be, mvc *m)
 			msg = runMAL(c, mb, 0, 0);
 		}
 	}
+	rc_done(be);
+	/* pass the cardinality feedback on to the query template */
+	if (qt)
+		qt->misestimates += mb->misestimates;
 
 	// release the resources
 	freeMalBlk(mb);
@@ -801,7 +820,14 @@ cleanup_engine:
 
 	if (m->type != Q_SCHEMA && be->q && msg) {
 		qc_delete(m->qc, be->q);
-	} 
+	} else if (m->type != Q_SCHEMA && be->q &&
+		   be->q->type != Q_PREPARE && be->q->code &&
+		   ((Symbol) be->q->code)->def->misestimates) {
+		/* the base tables no longer resemble the ones the plan
+		 * was optimized for; the next call compiles a new plan */
+		qc_unshare(be->q);
+		qc_delete(m->qc, be->q);
+	}
 	be->q = NULL;
 	sqlcleanup(be->mvc, (!msg) ? 0 : -1);
 	MSresetInstructions(c->curprg->def, 1);
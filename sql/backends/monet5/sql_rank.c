@@ -305,3 +305,190 @@ SQLdense_rank(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	}
 	return MAL_SUCCEED;
 }
+
+/* the bounds of the window frames, see BATwindowbound */
+str
+SQLwindow_bound(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	if (isaBatType(getArgType(mb, pci, 1))) {
+		bat *res = getArgReference_bat(stk, pci, 0);
+		BAT *b = BATdescriptor(*getArgReference_bat(stk, pci, 1)), *p = NULL, *o = NULL, *r;
+		int unit = *getArgReference_int(stk, pci, 4);
+		int kind = *getArgReference_int(stk, pci, 5);
+		bit end = *getArgReference_bit(stk, pci, 6);
+		bit desc = *getArgReference_bit(stk, pci, 7);
+
+		if (!b)
+			throw(SQL, "sql.window_bound", SQLSTATE(HY005) "Cannot access column descriptor");
+		if (isaBatType(getArgType(mb, pci, 2)))
+			p = BATdescriptor(*getArgReference_bat(stk, pci, 2));
+		if (isaBatType(getArgType(mb, pci, 3)))
+			o = BATdescriptor(*getArgReference_bat(stk, pci, 3));
+		if ((!p && isaBatType(getArgType(mb, pci, 2))) ||
+		    (!o && isaBatType(getArgType(mb, pci, 3)))) {
+			BBPunfix(b->batCacheid);
+			if (p) BBPunfix(p->batCacheid);
+			if (o) BBPunfix(o->batCacheid);
+			throw(SQL, "sql.window_bound", SQLSTATE(HY005) "Cannot access column descriptor");
+		}
+		r = BATwindowbound(b, p, o, unit, kind, end, desc, getArgReference(stk, pci, 8));
+		BBPunfix(b->batCacheid);
+		if (p) BBPunfix(p->batCacheid);
+		if (o) BBPunfix(o->batCacheid);
+		if (!r)
+			throw(SQL, "sql.window_bound", GDK_EXCEPTION);
+		BBPkeepref(*res = r->batCacheid);
+	} else { /* single value, its frame is the value itself */
+		lng *res = getArgReference_lng(stk, pci, 0);
+
+		*res = *getArgReference_bit(stk, pci, 6) ? 1 : 0;
+	}
+	return MAL_SUCCEED;
+}
+
+static str
+SQLwindow_aggr(MalBlkPtr mb, MalStkPtr stk, InstrPtr pci, const char *func, BAT *(*aggr)(BAT *, BAT *, BAT *))
+{
+	int tp = getArgType(mb, pci, 0);
+
+	if (isaBatType(getArgType(mb, pci, 1))) {
+		bat *res = getArgReference_bat(stk, pci, 0);
+		BAT *b = BATdescriptor(*getArgReference_bat(stk, pci, 1)), *s, *e, *r;
+
+		if (!b)
+			throw(SQL, func, SQLSTATE(HY005) "Cannot access column descriptor");
+		s = BATdescriptor(*getArgReference_bat(stk, pci, 2));
+		e = BATdescriptor(*getArgReference_bat(stk, pci, 3));
+		if (!s || !e) {
+			BBPunfix(b->batCacheid);
+			if (s) BBPunfix(s->batCacheid);
+			if (e) BBPunfix(e->batCacheid);
+			throw(SQL, func, SQLSTATE(HY005) "Cannot access column descriptor");
+		}
+		/* sum is the only aggregate whose result type differs */
+		if (aggr)
+			r = (*aggr)(b, s, e);
+		else
+			r = BATwindowsum(b, s, e, getBatType(tp));
+		BBPunfix(b->batCacheid);
+		BBPunfix(s->batCacheid);
+		BBPunfix(e->batCacheid);
+		if (!r)
+			throw(SQL, func, GDK_EXCEPTION);
+		BBPkeepref(*res = r->batCacheid);
+	} else { /* single value, its frame is either the value itself or empty */
+		ValPtr res = &stk->stk[getArg(pci, 0)];
+		ValPtr v = &stk->stk[getArg(pci, 1)];
+		int empty = *getArgReference_lng(stk, pci, 2) >= *getArgReference_lng(stk, pci, 3);
+
+		if (aggr == BATwindowcount) {
+			*getArgReference_lng(stk, pci, 0) = !empty && !VALisnil(v);
+		} else if (empty) {
+			if (VALinit(res, tp, ATOMnilptr(tp)) == NULL)
+				throw(SQL, func, SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		} else {
+			if (VALcopy(res, v) == NULL)
+				throw(SQL, func, SQLSTATE(HY001) MAL_MALLOC_FAIL);
+			if (res->vtype != tp && VALconvert(tp, res) == NULL)
+				throw(SQL, func, GDK_EXCEPTION);
+		}
+	}
+	return MAL_SUCCEED;
+}
+
+str
+SQLwindow_sum(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	return SQLwindow_aggr(mb, stk, pci, "sql.sum", NULL);
+}
+
+str
+SQLwindow_avg(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	return SQLwindow_aggr(mb, stk, pci, "sql.avg", BATwindowavg);
+}
+
+str
+SQLwindow_count(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	return SQLwindow_aggr(mb, stk, pci, "sql.count", BATwindowcount);
+}
+
+str
+SQLwindow_min(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	return SQLwindow_aggr(mb, stk, pci, "sql.min", BATwindowmin);
+}
+
+str
+SQLwindow_max(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	return SQLwindow_aggr(mb, stk, pci, "sql.max", BATwindowmax);
+}
+
+str
+SQLwindow_first_value(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	return SQLwindow_aggr(mb, stk, pci, "sql.first_value", BATwindowfirst);
+}
+
+str
+SQLwindow_last_value(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	return SQLwindow_aggr(mb, stk, pci, "sql.last_value", BATwindowlast);
+}
+
+/* lag and lead shift the values within the partitions */
+static str
+SQLwindow_shift(MalBlkPtr mb, MalStkPtr stk, InstrPtr pci, const char *func, int lag)
+{
+	lng offset = *getArgReference_lng(stk, pci, 2);
+	ValPtr dflt = &stk->stk[getArg(pci, 3)];
+
+	if (is_lng_nil(offset) || offset < 0)
+		throw(SQL, func, SQLSTATE(42000) "The offset must be a non-negative number");
+	if (isaBatType(getArgType(mb, pci, 1))) {
+		bat *res = getArgReference_bat(stk, pci, 0);
+		BAT *b = BATdescriptor(*getArgReference_bat(stk, pci, 1)), *p = NULL, *r;
+
+		if (!b)
+			throw(SQL, func, SQLSTATE(HY005) "Cannot access column descriptor");
+		if (isaBatType(getArgType(mb, pci, 4)) &&
+		    (p = BATdescriptor(*getArgReference_bat(stk, pci, 4))) == NULL) {
+			BBPunfix(b->batCacheid);
+			throw(SQL, func, SQLSTATE(HY005) "Cannot access column descriptor");
+		}
+		r = BATwindowshift(b, p, lag ? -offset : offset, VALget(dflt));
+		BBPunfix(b->batCacheid);
+		if (p) BBPunfix(p->batCacheid);
+		if (!r)
+			throw(SQL, func, GDK_EXCEPTION);
+		BBPkeepref(*res = r->batCacheid);
+	} else { /* single value, there are no other rows */
+		if (VALcopy(&stk->stk[getArg(pci, 0)], offset ? dflt : &stk->stk[getArg(pci, 1)]) == NULL)
+			throw(SQL, func, SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+	return MAL_SUCCEED;
+}
+
+str
+SQLwindow_lag(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	return SQLwindow_shift(mb, stk, pci, "sql.lag", 1);
+}
+
+str
+SQLwindow_lead(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	(void)cntxt;
+	return SQLwindow_shift(mb, stk, pci, "sql.lead", 0);
+}
@@ -12,6 +12,8 @@
 
 #include "monetdb_config.h"
 #include "sql_result.h"
+#include "sql_arrow.h"
+#include "sql_resultcache.h"
 #include "str.h"
 #include "tablet.h"
 #include "mtime.h"
@@ -826,6 +828,279 @@ _ASCIIadt_frStr(Column *c, int type, const char *s)
 }
 
 
+/*
+ * COPY INTO converts the fields of a column a block at a time.  The
+ * common spellings of integers, decimals, floating point numbers,
+ * dates and timestamps are parsed inline, without allocations and
+ * with runs of eight digits converted at once using integer
+ * arithmetic on a machine word (SWAR).  Any other spelling is handed
+ * to the frstr function of the column, such that the accepted syntax
+ * and the error messages remain the same.
+ */
+static const lng frbat_pow10[19] = {
+	LL_CONSTANT(1), LL_CONSTANT(10), LL_CONSTANT(100), LL_CONSTANT(1000),
+	LL_CONSTANT(10000), LL_CONSTANT(100000), LL_CONSTANT(1000000),
+	LL_CONSTANT(10000000), LL_CONSTANT(100000000),
+	LL_CONSTANT(1000000000), LL_CONSTANT(10000000000),
+	LL_CONSTANT(100000000000), LL_CONSTANT(1000000000000),
+	LL_CONSTANT(10000000000000), LL_CONSTANT(100000000000000),
+	LL_CONSTANT(1000000000000000), LL_CONSTANT(10000000000000000),
+	LL_CONSTANT(100000000000000000), LL_CONSTANT(1000000000000000000),
+};
+
+/* number of consecutive digits at s */
+static inline int
+frbat_digits(const char *s)
+{
+	const char *e = s;
+
+	while (*e >= '0' && *e <= '9')
+		e++;
+	return (int) (e - s);
+}
+
+/* value of the n (at most 18) digits at s */
+static inline lng
+frbat_value(const char *s, int n)
+{
+	ulng v = 0;
+
+#ifndef WORDS_BIGENDIAN
+	for (; n >= 8; n -= 8, s += 8) {
+		ulng w;
+
+		/* the first digit ends up in the lowest byte; combine
+		 * neighbouring digits into pairs, then the pairs into
+		 * one eight digit number */
+		memcpy(&w, s, sizeof(w));
+		w -= UINT64_C(0x3030303030303030);
+		w = w * 10 + (w >> 8);
+		w = (((w & UINT64_C(0x000000FF000000FF)) * (100 + (UINT64_C(1000000) << 32))) +
+			 (((w >> 16) & UINT64_C(0x000000FF000000FF)) * (1 + (UINT64_C(10000) << 32)))) >> 32;
+		v = v * 100000000 + w;
+	}
+#endif
+	for (; n > 0; n--, s++)
+		v = v * 10 + (ulng) (*s - '0');
+	return (lng) v;
+}
+
+/* [+-]?[0-9]+ with an absolute value of at most max */
+static inline int
+frbat_integer(const char *s, lng max, lng *r)
+{
+	int neg = 0, n;
+	lng v;
+
+	if (*s == '-') {
+		neg = 1;
+		s++;
+	} else if (*s == '+') {
+		s++;
+	}
+	n = frbat_digits(s);
+	if (n == 0 || n > 18 || s[n])
+		return 0;
+	v = frbat_value(s, n);
+	if (v > max)
+		return 0;
+	*r = neg ? -v : v;
+	return 1;
+}
+
+/* [+-]?[0-9]*(\.[0-9]*)? scaled to the decimal type of the column */
+static inline int
+frbat_decimal(const char *s, int digits, int scale, lng *r)
+{
+	int neg = 0, n, f = 0;
+	lng v;
+
+	if (*s == '-') {
+		neg = 1;
+		s++;
+	} else if (*s == '+') {
+		s++;
+	}
+	while (*s == '0' && s[1] >= '0' && s[1] <= '9')
+		s++;
+	n = frbat_digits(s);
+	if (n > digits - scale)
+		return 0;
+	v = frbat_value(s, n);
+	s += n;
+	if (*s == '.') {
+		s++;
+		f = frbat_digits(s);
+		if (f > scale)
+			return 0;
+		v = v * frbat_pow10[f] + frbat_value(s, f);
+		s += f;
+	}
+	if (*s || n + f == 0)
+		return 0;
+	v *= frbat_pow10[scale - f];
+	*r = neg ? -v : v;
+	return 1;
+}
+
+/* [+-]?[0-9]*(\.[0-9]*)? with at most 15 digits; both the digits and
+ * the power of ten are exact doubles, so the quotient is rounded
+ * exactly like strtod would */
+static inline int
+frbat_double(const char *s, dbl *r)
+{
+	int neg = 0, n, f = 0;
+	lng v;
+	dbl d;
+
+	if (*s == '-') {
+		neg = 1;
+		s++;
+	} else if (*s == '+') {
+		s++;
+	}
+	n = frbat_digits(s);
+	if (n > 15)
+		return 0;
+	v = frbat_value(s, n);
+	s += n;
+	if (*s == '.') {
+		s++;
+		f = frbat_digits(s);
+		if (n + f > 15)
+			return 0;
+		v = v * frbat_pow10[f] + frbat_value(s, f);
+		s += f;
+	}
+	if (*s || n + f == 0)
+		return 0;
+	d = (dbl) v / (dbl) frbat_pow10[f];
+	*r = neg ? -d : d;
+	return 1;
+}
+
+#define frbat_isdigit(c)	((c) >= '0' && (c) <= '9')
+
+/* YYYY-MM-DD */
+static inline int
+frbat_date(const char *s, date *r)
+{
+	if (!frbat_isdigit(s[0]) || !frbat_isdigit(s[1]) ||
+		!frbat_isdigit(s[2]) || !frbat_isdigit(s[3]) || s[4] != '-' ||
+		!frbat_isdigit(s[5]) || !frbat_isdigit(s[6]) || s[7] != '-' ||
+		!frbat_isdigit(s[8]) || !frbat_isdigit(s[9]))
+		return 0;
+	*r = MTIMEtodate((int) frbat_value(s + 8, 2),
+					 (int) frbat_value(s + 5, 2),
+					 (int) frbat_value(s, 4));
+	return !date_isnil(*r);
+}
+
+/* YYYY-MM-DD HH:MM:SS(\.[0-9]{1,3})? in the local time zone */
+static inline int
+frbat_timestamp(const char *s, timestamp *r)
+{
+	date d;
+	daytime t;
+	int hour, min, sec, msec = 0, f;
+
+	if (!frbat_date(s, &d) || (s[10] != ' ' && s[10] != 'T') ||
+		!frbat_isdigit(s[11]) || !frbat_isdigit(s[12]) || s[13] != ':' ||
+		!frbat_isdigit(s[14]) || !frbat_isdigit(s[15]) || s[16] != ':' ||
+		!frbat_isdigit(s[17]) || !frbat_isdigit(s[18]))
+		return 0;
+	hour = (int) frbat_value(s + 11, 2);
+	min = (int) frbat_value(s + 14, 2);
+	sec = (int) frbat_value(s + 17, 2);
+	if (hour > 23 || min > 59 || sec > 59)
+		return 0;
+	s += 19;
+	if (*s == '.') {
+		s++;
+		f = frbat_digits(s);
+		if (f == 0 || f > 3)
+			return 0;
+		msec = (int) (frbat_value(s, f) * frbat_pow10[3 - f]);
+		s += f;
+	}
+	if (*s)
+		return 0;
+	t = ((hour * 60 + min) * 60 + sec) * 1000 + msec;
+	MTIMEtimestamp_create_default(r, &d, &t);
+	return !timestamp_isnil(*r);
+}
+
+#define FRBAT(TPE, FAST)										\
+	do {														\
+		TPE *r = (TPE *) dst;									\
+		for (i = 0; i < cnt; i++) {								\
+			const char *v = s[i];								\
+			const void *p;										\
+			if (v == NULL) {									\
+				r[i] = *(const TPE *) c->nildata;				\
+				c->c->tnonil = 0;								\
+				continue;										\
+			}													\
+			if (FAST)											\
+				continue;										\
+			if ((p = c->frstr(c, type, v)) == NULL)				\
+				return i;										\
+			r[i] = *(const TPE *) p;							\
+		}														\
+	} while (0)
+
+static int
+_ASCIIadt_frBat(Column *c, int type, char **s, int cnt, void *dst)
+{
+	int i;
+	lng l;
+
+	if (type == TYPE_bte) {
+		FRBAT(bte, (frbat_integer(v, GDK_bte_max, &l) && ((r[i] = (bte) l), 1)));
+	} else if (type == TYPE_sht) {
+		FRBAT(sht, (frbat_integer(v, GDK_sht_max, &l) && ((r[i] = (sht) l), 1)));
+	} else if (type == TYPE_int) {
+		FRBAT(int, (frbat_integer(v, GDK_int_max, &l) && ((r[i] = (int) l), 1)));
+	} else if (type == TYPE_lng) {
+		FRBAT(lng, frbat_integer(v, GDK_lng_max, &r[i]));
+	} else if (type == TYPE_dbl) {
+		FRBAT(dbl, frbat_double(v, &r[i]));
+	} else if (type == TYPE_date) {
+		FRBAT(date, frbat_date(v, &r[i]) && v[10] == 0);
+	} else if (type == TYPE_timestamp) {
+		FRBAT(timestamp, frbat_timestamp(v, &r[i]));
+	}
+	return cnt;
+}
+
+static int
+dec_frbat(Column *c, int type, char **s, int cnt, void *dst)
+{
+	sql_column *col = c->extra;
+	int digits = (int) col->type.digits, scale = (int) col->type.scale;
+	int i;
+	lng l;
+
+	if (type == TYPE_bte) {
+		FRBAT(bte, (frbat_decimal(v, digits, scale, &l) && ((r[i] = (bte) l), 1)));
+	} else if (type == TYPE_sht) {
+		FRBAT(sht, (frbat_decimal(v, digits, scale, &l) && ((r[i] = (sht) l), 1)));
+	} else if (type == TYPE_int) {
+		FRBAT(int, (frbat_decimal(v, digits, scale, &l) && ((r[i] = (int) l), 1)));
+	} else if (type == TYPE_lng) {
+		FRBAT(lng, frbat_decimal(v, digits, scale, &r[i]));
+	}
+	return cnt;
+}
+
+static int
+has_frbat(int type)
+{
+	return type == TYPE_bte || type == TYPE_sht || type == TYPE_int ||
+		type == TYPE_lng || type == TYPE_dbl || type == TYPE_date ||
+		type == TYPE_timestamp;
+}
+
 static ssize_t
 _ASCIIadt_toStr(void *extra, char **buf, size_t *len, int type, const void *a)
 {
@@ -947,6 +1222,7 @@ mvc_import_table(Client cntxt, BAT ***bats, mvc *m, bstream *bs, sql_table *t, c
 			fmt[i].adt = ATOMindex(col->type.type->base.name);
 			fmt[i].tostr = &_ASCIIadt_toStr;
 			fmt[i].frstr = &_ASCIIadt_frStr;
+			fmt[i].frbat = has_frbat(fmt[i].adt) ? &_ASCIIadt_frBat : NULL;
 			fmt[i].extra = col;
 			fmt[i].len = ATOMlen(fmt[i].adt, ATOMnilptr(fmt[i].adt));
 			fmt[i].data = GDKzalloc(fmt[i].len);
@@ -971,9 +1247,11 @@ mvc_import_table(Client cntxt, BAT ***bats, mvc *m, bstream *bs, sql_table *t, c
 			if (col->type.type->eclass == EC_DEC) {
 				fmt[i].tostr = &dec_tostr;
 				fmt[i].frstr = &dec_frstr;
+				fmt[i].frbat = col->type.digits <= 18 ? &dec_frbat : NULL;
 			} else if (col->type.type->eclass == EC_SEC) {
 				fmt[i].tostr = &dec_tostr;
 				fmt[i].frstr = &sec_frstr;
+				fmt[i].frbat = NULL;
 			}
 			fmt[i].size = ATOMsize(fmt[i].adt);
 
@@ -1482,8 +1760,228 @@ eight_byte_align(char* ptr) {
 	return (char*) (((size_t) ptr + 7) & ~7);
 }
 
+// bytes taken by n values of width bits packed in 64 bit words
+#define packed_size(n, width) ((((n) * (width) + 63) / 64) * sizeof(ulng))
+#define null_bitmap_size(n) ((((n) + 63) / 64) * sizeof(ulng))
+
+static int
+bits_needed(ulng v) {
+	int w = 0;
+	while (v) {
+		w++;
+		v >>= 1;
+	}
+	return w;
+}
+
+static void
+bitpack(ulng *out, size_t i, int width, ulng v) {
+	size_t bit = i * width;
+	out[bit / 64] |= v << (bit % 64);
+	if (bit % 64 + width > 64)
+		out[bit / 64 + 1] |= v >> (64 - bit % 64);
+}
+
+static int
+prot10_scratch(char **scratch, size_t *scratchlen, size_t size) {
+	if (size > *scratchlen) {
+		char *p = GDKrealloc(*scratch, size);
+		if (!p)
+			return -1;
+		*scratch = p;
+		*scratchlen = size;
+	}
+	memset(*scratch, 0, size);
+	return 0;
+}
+
+// re-encode integer values of typelen bytes with a frame of reference or with deltas
+static size_t
+prot10_encode_ints(const char *plain, size_t rows, int typelen, char **scratch, size_t *scratchlen, char **encoded, column_encoding *enc, int *has_nulls, int *width, int *count) {
+	size_t plain_size = rows * typelen, bmsize = null_bitmap_size(rows);
+	size_t i, nn = 0, size_for, size_delta = 0;
+	lng *vals, min = 0, max = 0, min_d = 0, max_d = 0;
+	ulng *bitmap, *packed;
+	char *out;
+	int wf, wd = 0;
+
+	if (prot10_scratch(scratch, scratchlen, rows * sizeof(lng) + bmsize + 2 * sizeof(lng) + packed_size(rows, 64) + sizeof(ulng)) < 0)
+		return 0;
+	vals = (lng *) *scratch;
+	out = *encoded = *scratch + rows * sizeof(lng);
+	bitmap = (ulng *) out;
+	for (i = 0; i < rows; i++) {
+		lng v;
+		int isnil;
+		switch (typelen) {
+		case 1:
+			v = ((const bte *) plain)[i];
+			isnil = is_bte_nil((bte) v);
+			break;
+		case 2:
+			v = ((const sht *) plain)[i];
+			isnil = is_sht_nil((sht) v);
+			break;
+		case 4:
+			v = ((const int *) plain)[i];
+			isnil = is_int_nil((int) v);
+			break;
+		default:
+			v = ((const lng *) plain)[i];
+			isnil = is_lng_nil(v);
+			break;
+		}
+		if (isnil) {
+			bitmap[i / 64] |= (ulng) 1 << (i % 64);
+			continue;
+		}
+		if (nn == 0) {
+			min = max = v;
+		} else {
+			lng d = (lng) ((ulng) v - (ulng) vals[nn - 1]);
+			if (v < min)
+				min = v;
+			if (v > max)
+				max = v;
+			if (nn == 1 || d < min_d)
+				min_d = d;
+			if (nn == 1 || d > max_d)
+				max_d = d;
+		}
+		vals[nn++] = v;
+	}
+	if (nn == rows)
+		bmsize = 0;
+	*has_nulls = nn < rows;
+	*count = (int) nn;
+
+	wf = bits_needed((ulng) max - (ulng) min);
+	size_for = bmsize + sizeof(lng) + packed_size(nn, wf);
+	if (nn > 1) {
+		wd = bits_needed((ulng) max_d - (ulng) min_d);
+		size_delta = bmsize + 2 * sizeof(lng) + packed_size(nn - 1, wd);
+	}
+	if (size_for >= plain_size && (nn <= 1 || size_delta >= plain_size))
+		return 0;
+	if (nn > 1 && size_delta < size_for) {
+		*enc = COLUMN_ENCODING_DELTA;
+		*width = wd;
+		((lng *) (out + bmsize))[0] = vals[0];
+		((lng *) (out + bmsize))[1] = min_d;
+		packed = (ulng *) (out + bmsize + 2 * sizeof(lng));
+		if (wd > 0)
+			for (i = 1; i < nn; i++)
+				bitpack(packed, i - 1, wd, (ulng) vals[i] - (ulng) vals[i - 1] - (ulng) min_d);
+		return size_delta;
+	}
+	*enc = COLUMN_ENCODING_FOR;
+	*width = wf;
+	((lng *) (out + bmsize))[0] = min;
+	packed = (ulng *) (out + bmsize + sizeof(lng));
+	if (wf > 0)
+		for (i = 0; i < nn; i++)
+			bitpack(packed, i, wf, (ulng) vals[i] - (ulng) min);
+	return size_for;
+}
+
+// re-encode strings with a dictionary if they repeat enough
+static size_t
+prot10_encode_strings(const char *plain, size_t plain_size, size_t rows, char **scratch, size_t *scratchlen, char **encoded, column_encoding *enc, int *has_nulls, int *width, int *count) {
+	size_t maxdict = rows / 4, mask = 1, i, nn = 0, ndict = 0, dictsize = 0, bmsize = null_bitmap_size(rows), size;
+	const char **dict, *p = plain + sizeof(lng);
+	int *slot, *index, w;
+	ulng *bitmap, *packed;
+	char *out, *d;
+
+	if (maxdict == 0)
+		return 0;
+	while (mask < 2 * maxdict)
+		mask <<= 1;
+	if (prot10_scratch(scratch, scratchlen, mask * sizeof(int) + maxdict * sizeof(char *) + rows * sizeof(int) + bmsize + plain_size) < 0)
+		return 0;
+	slot = (int *) *scratch;
+	dict = (const char **) (*scratch + mask * sizeof(int));
+	index = (int *) (*scratch + mask * sizeof(int) + maxdict * sizeof(char *));
+	out = *encoded = *scratch + mask * sizeof(int) + maxdict * sizeof(char *) + rows * sizeof(int);
+	bitmap = (ulng *) out;
+	mask--;
+	for (i = 0; i < rows; i++) {
+		size_t len = strlen(p), h;
+		if (strcmp(p, str_nil) == 0) {
+			bitmap[i / 64] |= (ulng) 1 << (i % 64);
+			p += len + 1;
+			continue;
+		}
+		// slots hold dictionary index + 1
+		for (h = strHash(p) & mask; slot[h]; h = (h + 1) & mask)
+			if (strcmp(dict[slot[h] - 1], p) == 0)
+				break;
+		if (!slot[h]) {
+			if (ndict == maxdict)
+				return 0;
+			dict[ndict] = p;
+			dictsize += len + 1;
+			slot[h] = (int) ++ndict;
+		}
+		index[nn++] = slot[h] - 1;
+		p += len + 1;
+	}
+	if (nn == rows)
+		bmsize = 0;
+	w = ndict > 1 ? bits_needed(ndict - 1) : 0;
+	dictsize = (dictsize + 7) & ~7;
+	size = bmsize + dictsize + packed_size(nn, w);
+	if (size >= plain_size)
+		return 0;
+	*enc = COLUMN_ENCODING_DICT;
+	*has_nulls = nn < rows;
+	*width = w;
+	*count = (int) ndict;
+	d = out + bmsize;
+	for (i = 0; i < ndict; i++)
+		d = mystpcpy(d, dict[i]) + 1;
+	packed = (ulng *) (out + bmsize + dictsize);
+	if (w > 0)
+		for (i = 0; i < nn; i++)
+			bitpack(packed, i, w, (ulng) index[i]);
+	return size;
+}
+
+// write the header of a column that was written in the plain layout
+// after it, and re-encode the values if that makes them smaller
+static char *
+prot10_encode_column(stream *s, char *start, char *end, size_t rows, int typelen, int intcol, int strcol, char **scratch, size_t *scratchlen) {
+	char *plain = start + 2 * sizeof(lng);
+	size_t plain_size = end - plain, size = 0;
+	column_encoding enc = COLUMN_ENCODING_PLAIN;
+	int has_nulls = 0, width = 0, count = 0;
+	char *encoded = NULL;
+
+	if (mnstr_byteorder(s) == 1234 && rows > 0) {
+		// the encodings work on native values
+		if (intcol)
+			size = prot10_encode_ints(plain, rows, typelen, scratch, scratchlen, &encoded, &enc, &has_nulls, &width, &count);
+		else if (strcol)
+			size = prot10_encode_strings(plain, plain_size, rows, scratch, scratchlen, &encoded, &enc, &has_nulls, &width, &count);
+	}
+	if (size > 0) {
+		memcpy(plain, encoded, size);
+		end = plain + size;
+	} else {
+		enc = COLUMN_ENCODING_PLAIN;
+		has_nulls = width = count = 0;
+	}
+	*(lng *) start = mnstr_swap_lng(s, end - start - sizeof(lng));
+	start[8] = (char) enc;
+	start[9] = (char) has_nulls;
+	start[10] = (char) width;
+	start[11] = 0;
+	*(int *) (start + 12) = count;
+	return end;
+}
+
 static int
-mvc_export_table_prot10(backend *b, stream *s, res_table *t, BAT *order, BUN offset, BUN nr) {
+mvc_export_table_prot10(backend *b, stream *s, res_table *t, BAT *order, BUN offset, BUN nr, int initial_transfer) {
 	lng count = 0;
 	size_t row = 0;
 	size_t srow = 0;
@@ -1496,7 +1994,9 @@ mvc_export_table_prot10(backend *b, stream *s, res_table *t, BAT *order, BUN off
 	BATiter *iterators = NULL;
 	char *result = NULL;
 	size_t length = 0;
-	int initial_transfer = 1;
+	int colcomp = bs2_colcomp(s) == COLUMN_COMPRESSION_AUTO;
+	char *scratch = NULL;
+	size_t scratchlen = 0;
 
 	(void) order; // FIXME: respect explicitly ordered output
 
@@ -1556,6 +2056,9 @@ mvc_export_table_prot10(backend *b, stream *s, res_table *t, BAT *order, BUN off
 		// every varsized member has an 8-byte header indicating the length of the header in the block
 		// subtract this from the amount of bytes left
 		bytes_left -= length_prefixed * sizeof(lng);
+		// and with column compression every column has a header
+		if (colcomp)
+			bytes_left -= t->nr_cols * 2 * sizeof(lng);
 
 		if (varsized == 0) {
 			// no varsized elements, so we can immediately compute the amount of elements
@@ -1601,6 +2104,8 @@ mvc_export_table_prot10(backend *b, stream *s, res_table *t, BAT *order, BUN off
 			}
 			if (row == srow) {
 				lng new_size = rowsize + 1024;
+				if (colcomp)
+					new_size += t->nr_cols * 2 * sizeof(lng);
 				if (!mnstr_writeLng(s, (lng) -1) || 
 					!mnstr_writeLng(s, new_size) || 
 					mnstr_flush(s) < 0) {
@@ -1641,7 +2146,13 @@ mvc_export_table_prot10(backend *b, stream *s, res_table *t, BAT *order, BUN off
 			res_col *c = t->cols + i;
 			int mtype = iterators[i].b->ttype;
 			int convert_to_string = !type_supports_binary_transfer(c->type.type);
+			char *colstart = NULL;
 			buf = eight_byte_align(buf);
+			if (colcomp) {
+				// leave room for the [length][encoding] header of the column
+				colstart = buf;
+				buf += 2 * sizeof(lng);
+			}
 			if (ATOMvarsized(mtype) || convert_to_string) {
 				if (c->type.type->eclass == EC_BLOB) {
 					// transfer blobs as [lng][data] combination
@@ -1723,6 +2234,7 @@ mvc_export_table_prot10(backend *b, stream *s, res_table *t, BAT *order, BUN off
 					int swap = mnstr_byteorder(s) != 1234;
 					date *dates = (date*) Tloc(iterators[i].b, srow);
 					lng *bufptr = (lng*) buf;
+					tstamp.payload.p_msecs = 0;
 					for(j = 0; j < (row - srow); j++) {
 						tstamp.payload.p_days = dates[j];
 						MTIMEepoch2lng(&time, &tstamp);
@@ -1774,6 +2286,16 @@ mvc_export_table_prot10(backend *b, stream *s, res_table *t, BAT *order, BUN off
 				}
 				buf += (row - srow) * atom_size;
 			}
+			if (colcomp) {
+				int varsized = ATOMvarsized(mtype) || convert_to_string;
+				int eclass = c->type.type->eclass;
+				int typelen = (eclass == EC_TIMESTAMP || eclass == EC_DATE) ? (int) sizeof(lng) : ATOMsize(mtype);
+				int intcol = !varsized && eclass != EC_FLT && ATOMstorage(mtype) != TYPE_hge &&
+					(typelen == 1 || typelen == 2 || typelen == 4 || typelen == 8);
+				int strcol = varsized && eclass != EC_BLOB;
+
+				buf = prot10_encode_column(s, colstart, buf, row - srow, typelen, intcol, strcol, &scratch, &scratchlen);
+			}
 		}
 
 		assert(buf >= bs2_buffer(s).buf);
@@ -1800,6 +2322,7 @@ cleanup:
 	if (result) {
 		GDKfree(result);
 	}
+	GDKfree(scratch);
 	if (mnstr_errnr(s))
 		return -1;
 	return fres;
@@ -1823,7 +2346,9 @@ mvc_export_table(backend *b, stream *s, res_table *t, BAT *order, BUN offset, BU
 		return 0;
 
 	if (b->client->protocol == PROTOCOL_10) {
-		return mvc_export_table_prot10(b, s, t, order, offset, nr);
+		if (b->client->arrow_results)
+			return mvc_export_table_arrow(b, s, t, offset, nr, 1);
+		return mvc_export_table_prot10(b, s, t, order, offset, nr, 1);
 	}
 
 	as.nr_attrs = t->nr_cols + 1;	/* for the leader */
@@ -2217,6 +2742,11 @@ mvc_export_head_prot10(backend *b, stream *s, int res_id, int only_header, int c
 		fres = -1;
 		goto cleanup;
 	}
+	// Arrow clients get the columns as an Arrow Schema message instead
+	if (b->client->arrow_results) {
+		fres = mvc_export_head_arrow(b, s, t);
+		goto cleanup;
+	}
 
 	// after that, the data of the individual columns is written
 	for (i = 0; i < (size_t) t->nr_cols; i++) {
@@ -2513,6 +3043,132 @@ mvc_export_file(backend *b, stream *s, res_table *t, lng starttime, lng maloptim
 	return res;
 }
 
+/* rows of a cursor that are projected and sent at a time */
+#define CURSOR_CHUNK	((BUN) 1 << 20)
+
+/* replace the columns of a cursor by their projections */
+static int
+res_table_materialize(res_table *t)
+{
+	int i;
+
+	for (i = 0; i < t->nr_cols; i++) {
+		res_col *c = t->cols + i;
+		BAT *cand, *col, *bn;
+
+		if (!c->cand)
+			continue;
+		cand = BATdescriptor(c->cand);
+		col = BATdescriptor(c->b);
+		if (cand == NULL || col == NULL) {
+			if (cand)
+				BBPunfix(cand->batCacheid);
+			if (col)
+				BBPunfix(col->batCacheid);
+			return -1;
+		}
+		bn = BATproject(cand, col);
+		BBPunfix(cand->batCacheid);
+		BBPunfix(col->batCacheid);
+		if (bn == NULL)
+			return -1;
+		BBPretain(bn->batCacheid);
+		BBPunfix(bn->batCacheid);
+		BBPrelease(c->b);
+		BBPrelease(c->cand);
+		c->b = bn->batCacheid;
+		c->cand = 0;
+	}
+	return 0;
+}
+
+/* send the rows of a cursor, projecting a chunk of the columns at a
+ * time, such that only one chunk of the result is materialized */
+static int
+mvc_export_cursor(backend *b, stream *s, res_table *t, BUN nr)
+{
+	res_table chunk = *t;
+	res_col *cols;
+	BAT **bats;
+	BUN lo, hi;
+	int i, res = 0;
+
+	cols = GDKmalloc(sizeof(res_col) * t->nr_cols);
+	bats = GDKzalloc(sizeof(BAT *) * t->nr_cols);
+	if (cols == NULL || bats == NULL) {
+		GDKfree(cols);
+		GDKfree(bats);
+		return -1;
+	}
+	memcpy(cols, t->cols, sizeof(res_col) * t->nr_cols);
+	chunk.cols = cols;
+	lo = 0;
+	do {
+		hi = lo + CURSOR_CHUNK < nr ? lo + CURSOR_CHUNK : nr;
+		for (i = 0; i < t->nr_cols; i++) {
+			res_col *c = t->cols + i;
+			BAT *col = BATdescriptor(c->b), *cand = NULL, *slice;
+
+			if (col == NULL) {
+				res = -1;
+				break;
+			}
+			if (c->cand && (cand = BATdescriptor(c->cand)) == NULL) {
+				BBPunfix(col->batCacheid);
+				res = -1;
+				break;
+			}
+			if (cand) {
+				slice = BATslice(cand, lo, hi);
+				bats[i] = slice ? BATproject(slice, col) : NULL;
+				if (slice)
+					BBPunfix(slice->batCacheid);
+				BBPunfix(cand->batCacheid);
+			} else {
+				bats[i] = BATslice(col, lo, hi);
+			}
+			BBPunfix(col->batCacheid);
+			if (bats[i] == NULL) {
+				res = -1;
+				break;
+			}
+			BAThseqbase(bats[i], 0);
+			cols[i].b = bats[i]->batCacheid;
+			cols[i].cand = 0;
+		}
+		if (res == 0) {
+			if (b->client->protocol == PROTOCOL_10) {
+				if (b->client->arrow_results)
+					res = mvc_export_table_arrow(b, s, &chunk, 0, hi - lo, lo == 0);
+				else
+					res = mvc_export_table_prot10(b, s, &chunk, bats[0], 0, hi - lo, lo == 0);
+			} else {
+				res = mvc_export_table(b, s, &chunk, bats[0], 0, hi - lo, "[ ", ",\t", "\t]\n", "\"", "NULL");
+			}
+		}
+		for (i = 0; i < t->nr_cols; i++) {
+			if (bats[i])
+				BBPunfix(bats[i]->batCacheid);
+			bats[i] = NULL;
+		}
+		lo = hi;
+	} while (res == 0 && lo < nr);
+	GDKfree(cols);
+	GDKfree(bats);
+	return res;
+}
+
+static int
+res_table_cursor(res_table *t)
+{
+	int i;
+
+	for (i = 0; i < t->nr_cols; i++)
+		if (t->cols[i].cand)
+			return 1;
+	return 0;
+}
+
 int
 mvc_export_result(backend *b, stream *s, int res_id, lng starttime, lng maloptimizer)
 {
@@ -2528,12 +3184,18 @@ mvc_export_result(backend *b, stream *s, int res_id, lng starttime, lng maloptim
 
 	/* Proudly supporting SQLstatementIntern's output flag */
 	if (b->output_format == OFMT_NONE) {
-		return 0;
+		return res_table_cursor(t) ? res_table_materialize(t) : 0;
 	}
 	/* we shouldn't have anything else but Q_TABLE here */
 	assert(t->query_type == Q_TABLE);
+	if ((t->tsep || json) && res_table_cursor(t) && res_table_materialize(t) < 0)
+		return -1;
 	if (t->tsep)
 		return mvc_export_file(b, s, t, starttime, maloptimizer);
+	/* the result cache keeps the projected columns */
+	if (rc_wants(b, t) && res_table_cursor(t) && res_table_materialize(t) < 0)
+		return -1;
+	rc_capture(b, t);
 
 	if (!json) {
 		mvc_export_head(b, s, res_id, TRUE, TRUE, starttime, maloptimizer);
@@ -2567,6 +3229,12 @@ mvc_export_result(backend *b, stream *s, int res_id, lng starttime, lng maloptim
 			res = mvc_export_table(b, s, t, order, 1, count - 2, "\t{\n\t\t\"%s\" : ", ",\n\t\t\"%s\" : ", "\n\t},\n", "\"", "null");
 			res = mvc_export_table(b, s, t, order, count - 1, 1, "\t{\n\t\t\"%s\" : ", ",\n\t\t\"%s\" : ", "\n\t}\n]\n", "\"", "null");
 		}
+	} else if (res_table_cursor(t)) {
+		res = mvc_export_cursor(b, s, t, count);
+		/* the rows that are left are fetched after the
+		 * transaction ended, when the columns may have changed */
+		if (res >= 0 && !clean)
+			res = res_table_materialize(t);
 	} else {
 		res = mvc_export_table(b, s, t, order, 0, count, "[ ", ",\t", "\t]\n", "\"", "NULL");
 	}
@@ -2591,6 +3259,8 @@ mvc_export_chunk(backend *b, stream *s, int res_id, BUN offset, BUN nr)
 
 	if (!s || !t)
 		return 0;
+	if (res_table_cursor(t) && res_table_materialize(t) < 0)
+		return -1;
 
 	order = BATdescriptor(t->order);
 	if (!order)
@@ -2652,6 +3322,21 @@ mvc_result_column(mvc *m, char *tn, char *name, char *typename, int digits, int
 	return res_col_create(m->session->tr, m->results, tn, name, typename, digits, scale, TYPE_bat, b) == NULL;
 }
 
+int
+mvc_result_cursor(mvc *m, char *tn, char *name, char *typename, int digits, int scale, BAT *cand, BAT *b)
+{
+	res_col *c = res_col_create(m->session->tr, m->results, tn, name, typename, digits, scale, TYPE_bat, b);
+
+	/* return 0 on success, non-zero on failure */
+	if (c == NULL)
+		return 1;
+	if (cand) {
+		c->cand = cand->batCacheid;
+		BBPretain(c->cand);
+	}
+	return 0;
+}
+
 int
 mvc_result_value(mvc *m, const char *tn, const char *name, const char *typename, int digits, int scale, ptr *p, int mtype)
 {
@@ -0,0 +1,607 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+/*
+ * The result cache
+ * ================
+ *
+ * Dashboards fire the same read-only queries over and over against
+ * tables that hardly change. The query cache saves their compilation,
+ * the result cache saves their execution as well. It is enabled with
+ * --set sql_result_cache=<MiB> and shared by all clients.
+ *
+ * An entry is keyed on the query template with its arguments bound, ie
+ * the plan before it is optimized for the current BAT sizes, and on the
+ * numbers of the commits which changed the tables read by the plan
+ * last. Each commit stamps the tables it changed with its number and
+ * drops the entries reading them, a schema change drops all of them.
+ * A client only uses or adds an entry when its transaction has seen
+ * those commits and has no changes of its own pending. Plans calling
+ * user defined or volatile functions, or anything with side effects,
+ * are not cached.
+ *
+ * The results are kept as BATs, in least recently used order. The
+ * oldest entries are evicted when the BATs exceed the memory budget.
+ */
+
+#include "monetdb_config.h"
+#include "sql_resultcache.h"
+#include "sql_result.h"
+#include "bat/res_table.h"
+#include "opt_prelude.h"
+#include "opt_support.h"
+
+#define RC_HASHSIZE 256		/* must be a power of two */
+
+typedef struct rcversion {
+	struct rcversion *next;	/* hash bucket chain */
+	sqlid id;		/* the table */
+	int nr;			/* the commit which changed it last */
+} rcversion;
+
+typedef struct rcentry {
+	struct rcentry *next;	/* hash bucket chain */
+	struct rcentry *newer, *older;	/* least recently used order */
+	int key;		/* hash key of the plan */
+	MalBlkPtr plan;		/* template with its arguments bound */
+	int nr_tables;
+	sqlid *tables;		/* the tables read by the plan */
+	int *versions;		/* and the commits which changed them last */
+	int commit_number;	/* last commit seen when computed */
+	int nr_cols;
+	res_col *cols;		/* the result columns */
+	size_t size;		/* bytes held by the result */
+} rcentry;
+
+static MT_Lock rc_lock MT_LOCK_INITIALIZER("rc_lock");
+static rcentry *rc_hash[RC_HASHSIZE];
+static rcversion *rc_versions[RC_HASHSIZE];
+static rcentry *rc_newest = NULL, *rc_oldest = NULL;
+static size_t rc_budget = 0, rc_used = 0;
+static int rc_schema_change = 0;	/* last commit changing the schema */
+
+static void
+rc_destroy(rcentry *e)
+{
+	int i;
+
+	if (e->plan)
+		freeMalBlk(e->plan);
+	if (e->cols) {
+		for (i = 0; i < e->nr_cols; i++) {
+			res_col *c = e->cols + i;
+
+			if (c->b)
+				BBPrelease(c->b);
+			GDKfree(c->tn);
+			GDKfree(c->name);
+		}
+		GDKfree(e->cols);
+	}
+	GDKfree(e->tables);
+	GDKfree(e->versions);
+	GDKfree(e);
+}
+
+static void
+rc_destroy_list(rcentry *e)
+{
+	rcentry *n;
+
+	for (; e; e = n) {
+		n = e->next;
+		rc_destroy(e);
+	}
+}
+
+/* Remove an entry from the cache, the caller holds rc_lock. It is
+ * moved to the dead list, to be destroyed after the lock is
+ * released. */
+static void
+rc_remove(rcentry *e, rcentry **dead)
+{
+	rcentry **p;
+
+	for (p = &rc_hash[e->key & (RC_HASHSIZE - 1)]; *p != e; p = &(*p)->next)
+		;
+	*p = e->next;
+	if (e->newer)
+		e->newer->older = e->older;
+	else
+		rc_newest = e->older;
+	if (e->older)
+		e->older->newer = e->newer;
+	else
+		rc_oldest = e->newer;
+	rc_used -= e->size;
+	e->next = *dead;
+	*dead = e;
+}
+
+static void
+rc_touch(rcentry *e)
+{
+	if (e == rc_newest)
+		return;
+	e->newer->older = e->older;
+	if (e->older)
+		e->older->newer = e->newer;
+	else
+		rc_oldest = e->newer;
+	e->newer = NULL;
+	e->older = rc_newest;
+	rc_newest->newer = e;
+	rc_newest = e;
+}
+
+static int
+rc_version(sqlid id)
+{
+	rcversion *v;
+
+	for (v = rc_versions[id & (RC_HASHSIZE - 1)]; v; v = v->next)
+		if (v->id == id)
+			return v->nr;
+	return 0;
+}
+
+static void
+rc_set_version(sqlid id, int nr)
+{
+	rcversion *v, **h = &rc_versions[id & (RC_HASHSIZE - 1)];
+
+	for (v = *h; v; v = v->next) {
+		if (v->id == id) {
+			v->nr = nr;
+			return;
+		}
+	}
+	/* without memory the entries reading the table are dropped
+	 * without remembering the change, so fall back to a schema
+	 * change */
+	if ((v = GDKmalloc(sizeof(rcversion))) == NULL) {
+		rc_schema_change = nr;
+		return;
+	}
+	v->id = id;
+	v->nr = nr;
+	v->next = *h;
+	*h = v;
+}
+
+/* Is the entry still valid for a transaction which has seen the
+ * commits up to nr? */
+static int
+rc_current(rcentry *e, int nr)
+{
+	int i;
+
+	if (rc_schema_change > e->commit_number || rc_schema_change > nr)
+		return 0;
+	for (i = 0; i < e->nr_tables; i++) {
+		int v = rc_version(e->tables[i]);
+
+		if (v != e->versions[i] || v > nr)
+			return 0;
+	}
+	return 1;
+}
+
+static BUN
+rc_value_hash(const ValRecord *v)
+{
+	switch (ATOMstorage(v->vtype)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_flt:
+	case TYPE_dbl:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_str:
+		return ATOMhash(ATOMstorage(v->vtype), VALptr(v));
+	default:
+		return 0;
+	}
+}
+
+static int
+rc_key(MalBlkPtr mb)
+{
+	unsigned int h = (unsigned int) mb->stop;
+	int i;
+
+	for (i = 1; i < mb->stop; i++) {
+		InstrPtr p = getInstrPtr(mb, i);
+
+		h = h * 31 + (unsigned int) (size_t) getFunctionId(p);
+		h = h * 31 + (unsigned int) p->argc;
+	}
+	for (i = 0; i < mb->vtop; i++)
+		if (isVarConstant(mb, i))
+			h = h * 31 + (unsigned int) rc_value_hash(&getVarConstant(mb, i));
+	return (int) (h & INT_MAX);
+}
+
+static int
+rc_same_plan(MalBlkPtr a, MalBlkPtr b)
+{
+	int i, j;
+
+	if (a->stop != b->stop || a->vtop != b->vtop)
+		return 0;
+	for (i = 0; i < a->stop; i++) {
+		InstrPtr p = getInstrPtr(a, i), q = getInstrPtr(b, i);
+
+		if (p->token != q->token || p->barrier != q->barrier ||
+		    p->argc != q->argc || p->retc != q->retc)
+			return 0;
+		/* the names of the templates differ between the clients */
+		if (i > 0 && (getModuleId(p) != getModuleId(q) || getFunctionId(p) != getFunctionId(q)))
+			return 0;
+		for (j = 0; j < p->argc; j++)
+			if (getArg(p, j) != getArg(q, j))
+				return 0;
+	}
+	for (i = 0; i < a->vtop; i++) {
+		if (getVarType(a, i) != getVarType(b, i) ||
+		    isVarConstant(a, i) != isVarConstant(b, i))
+			return 0;
+		if (isVarConstant(a, i) && VALcmp(&getVarConstant(a, i), &getVarConstant(b, i)) != 0)
+			return 0;
+	}
+	return 1;
+}
+
+/* Functions whose results may differ between two calls with the same
+ * arguments, or which read more than the tables bound by the plan. */
+static int
+rc_volatile(const char *mod, const char *fcn)
+{
+	return strcmp(mod, userRef) == 0 ||
+		strcmp(mod, "remote") == 0 ||
+		strcmp(mod, "sample") == 0 ||
+		(strcmp(mod, "uuid") == 0 && strcmp(fcn, "new") == 0) ||
+		(strcmp(mod, mtimeRef) == 0 && strncmp(fcn, "current_", 8) == 0) ||
+		strcmp(fcn, "rand") == 0 ||
+		strcmp(fcn, "next_value") == 0 ||
+		strcmp(fcn, "get_value") == 0;
+}
+
+static const char *
+rc_const_str(MalBlkPtr mb, InstrPtr p, int i)
+{
+	if (i >= p->argc || !isVarConstant(mb, getArg(p, i)) ||
+	    getVarType(mb, getArg(p, i)) != TYPE_str)
+		return NULL;
+	return getVarConstant(mb, getArg(p, i)).val.sval;
+}
+
+/* Collect the tables read by the plan, returns the number of tables or
+ * -1 when its result may not be cached. */
+static int
+rc_tables(mvc *m, MalBlkPtr mb, sqlid **tables)
+{
+	int i, j, nr = 0;
+	sqlid *ids = NULL;
+
+	for (i = 1; i < mb->stop; i++) {
+		InstrPtr p = getInstrPtr(mb, i);
+		const char *mod = getModuleId(p), *fcn = getFunctionId(p);
+
+		if (p->token == ENDsymbol || mod == NULL || fcn == NULL)
+			continue;
+		/* the result set and its meta data */
+		if ((mod == querylogRef && fcn == defineRef) ||
+		    (mod == batRef && (fcn == newRef || fcn == appendRef)) ||
+		    (mod == sqlRef && (fcn == resultSetRef || fcn == resultCursorRef)))
+			continue;
+		if (rc_volatile(mod, fcn))
+			goto refuse;
+		if (mod == malRef && fcn == multiplexRef) {
+			const char *m = rc_const_str(mb, p, p->retc), *f = rc_const_str(mb, p, p->retc + 1);
+
+			if (m == NULL || f == NULL || rc_volatile(m, f))
+				goto refuse;
+			continue;
+		}
+		if (hasSideEffects(mb, p, FALSE))
+			goto refuse;
+		if (mod == sqlRef && (fcn == bindRef || fcn == bindidxRef || fcn == tidRef)) {
+			const char *sname = rc_const_str(mb, p, p->retc + 1);
+			const char *tname = rc_const_str(mb, p, p->retc + 2);
+			sql_schema *s;
+			sql_table *t;
+			sqlid *n;
+
+			if (sname == NULL || tname == NULL ||
+			    (s = mvc_bind_schema(m, sname)) == NULL ||
+			    (t = mvc_bind_table(m, s, tname)) == NULL ||
+			    isTempTable(t) || isRemote(t) || isStream(t))
+				goto refuse;
+			for (j = 0; j < nr; j++)
+				if (ids[j] == t->base.id)
+					break;
+			if (j < nr)
+				continue;
+			if ((n = GDKrealloc(ids, (nr + 1) * sizeof(sqlid))) == NULL)
+				goto refuse;
+			ids = n;
+			ids[nr++] = t->base.id;
+		}
+	}
+	*tables = ids;
+	return nr;
+  refuse:
+	GDKfree(ids);
+	return -1;
+}
+
+void
+rc_init(lng budget)
+{
+	MT_lock_init(&rc_lock, "rc_lock");
+	rc_budget = budget > 0 ? (size_t) budget : 0;
+}
+
+void
+rc_exit(void)
+{
+	rcentry *dead = NULL;
+	rcversion *v, *n;
+	int i;
+
+	MT_lock_set(&rc_lock);
+	while (rc_oldest)
+		rc_remove(rc_oldest, &dead);
+	for (i = 0; i < RC_HASHSIZE; i++) {
+		for (v = rc_versions[i]; v; v = n) {
+			n = v->next;
+			GDKfree(v);
+		}
+		rc_versions[i] = NULL;
+	}
+	rc_budget = 0;
+	MT_lock_unset(&rc_lock);
+	rc_destroy_list(dead);
+}
+
+/* Answer the query from the cache. Returns 1 when the result is sent,
+ * -1 when sending it failed and 0 on a miss, after which the result of
+ * a cacheable plan is awaited in be->rc. */
+int
+rc_lookup(backend *be, MalBlkPtr mb)
+{
+	mvc *m = be->mvc;
+	sql_trans *tr = m->session->tr;
+	lng starttime = GDKusec();
+	rcentry *e;
+	int key, i, nr, res_id = 0;
+	sqlid *tables = NULL;
+
+	if (!rc_budget || !be->q || be->q->type != Q_TABLE ||
+	    m->emode != m_normal || m->emod || be->output_format == OFMT_NONE ||
+	    tr->parent != gtrans || tr->wtime || tr->schema_updates)
+		return 0;
+
+	key = rc_key(mb);
+	MT_lock_set(&rc_lock);
+	for (e = rc_hash[key & (RC_HASHSIZE - 1)]; e; e = e->next)
+		if (e->key == key && rc_same_plan(e->plan, mb))
+			break;
+	if (e && rc_current(e, tr->commit_number)) {
+		BAT *b = BATdescriptor(e->cols[0].b);
+
+		rc_touch(e);
+		res_id = b ? mvc_result_table(m, mb->tag, e->nr_cols, Q_TABLE, b) : -1;
+		if (b)
+			BBPunfix(b->batCacheid);
+		for (i = 0; res_id >= 0 && i < e->nr_cols; i++) {
+			res_col *c = e->cols + i;
+
+			if ((b = BATdescriptor(c->b)) == NULL ||
+			    mvc_result_column(m, c->tn, c->name, c->type.type->sqlname, c->type.digits, c->type.scale, b)) {
+				m->results = res_tables_remove(m->results, m->results);
+				res_id = -1;
+			}
+			if (b)
+				BBPunfix(b->batCacheid);
+		}
+		MT_lock_unset(&rc_lock);
+		if (res_id < 0 || mvc_export_result(be, be->client->fdout, res_id, starttime, 0) < 0)
+			return -1;
+		return 1;
+	}
+	MT_lock_unset(&rc_lock);
+
+	if ((nr = rc_tables(m, mb, &tables)) < 0)
+		return 0;
+	if ((e = GDKzalloc(sizeof(rcentry))) == NULL ||
+	    (nr && (e->versions = GDKmalloc(nr * sizeof(int))) == NULL) ||
+	    (e->plan = copyMalBlk(mb)) == NULL) {
+		GDKfree(tables);
+		if (e)
+			rc_destroy(e);
+		return 0;
+	}
+	e->key = key;
+	e->nr_tables = nr;
+	e->tables = tables;
+	e->commit_number = tr->commit_number;
+	MT_lock_set(&rc_lock);
+	for (i = 0; i < nr; i++)
+		if ((e->versions[i] = rc_version(tables[i])) > e->commit_number)
+			break;
+	MT_lock_unset(&rc_lock);
+	if (i < nr || rc_schema_change > e->commit_number) {
+		rc_destroy(e);
+		return 0;
+	}
+	be->rc = e;
+	return 0;
+}
+
+static size_t
+rc_bat_size(BAT *b, BUN cnt)
+{
+	size_t size = (size_t) cnt * Tsize(b);
+
+	if (b->tvheap && BATcount(b) > 0)
+		size += (size_t) ((dbl) b->tvheap->free * cnt / BATcount(b));
+	return size;
+}
+
+/* Should the result be kept? The columns of a cursor are projected
+ * first, which is only done when they fit in the budget. */
+int
+rc_wants(backend *be, res_table *t)
+{
+	size_t size = 0;
+	int i;
+
+	if (!be->rc)
+		return 0;
+	for (i = 0; i < t->nr_cols; i++) {
+		res_col *c = t->cols + i;
+		BAT *b = BBPquickdesc(c->b, FALSE), *cand = c->cand ? BBPquickdesc(c->cand, FALSE) : NULL;
+
+		if (b == NULL || (c->cand && cand == NULL)) {
+			size = rc_budget + 1;
+			break;
+		}
+		size += rc_bat_size(b, cand ? BATcount(cand) : BATcount(b));
+	}
+	if (size > rc_budget) {
+		rc_done(be);
+		return 0;
+	}
+	return 1;
+}
+
+/* Add the result awaited in be->rc to the cache. */
+void
+rc_capture(backend *be, res_table *t)
+{
+	rcentry *e = be->rc, *o, *dead = NULL;
+	int i;
+
+	if (!e)
+		return;
+	be->rc = NULL;
+	if (t->nr_cols == 0 || (e->cols = GDKzalloc(t->nr_cols * sizeof(res_col))) == NULL) {
+		rc_destroy(e);
+		return;
+	}
+	e->nr_cols = t->nr_cols;
+	for (i = 0; i < t->nr_cols; i++) {
+		res_col *c = t->cols + i, *n = e->cols + i;
+		BAT *b;
+
+		if (c->cand || (b = BATdescriptor(c->b)) == NULL) {
+			rc_destroy(e);
+			return;
+		}
+		/* the cache outlives the transaction, so it should not
+		 * share the heaps of the tables */
+		if (isVIEW(b) || b->batPersistence == PERSISTENT) {
+			BAT *bn = COLcopy(b, b->ttype, TRUE, TRANSIENT);
+
+			BBPunfix(b->batCacheid);
+			if ((b = bn) == NULL) {
+				rc_destroy(e);
+				return;
+			}
+		}
+		n->b = b->batCacheid;
+		BBPretain(n->b);
+		e->size += rc_bat_size(b, BATcount(b));
+		BBPunfix(b->batCacheid);
+		n->type = c->type;
+		n->tn = GDKstrdup(c->tn);
+		n->name = GDKstrdup(c->name);
+		if (n->tn == NULL || n->name == NULL) {
+			rc_destroy(e);
+			return;
+		}
+	}
+	MT_lock_set(&rc_lock);
+	for (o = rc_hash[e->key & (RC_HASHSIZE - 1)]; o; o = o->next)
+		if (o->key == e->key && rc_same_plan(o->plan, e->plan))
+			break;
+	/* another client may have been ahead, or a commit overtook us */
+	if (o || e->size > rc_budget || !rc_current(e, e->commit_number)) {
+		MT_lock_unset(&rc_lock);
+		rc_destroy(e);
+		return;
+	}
+	while (rc_oldest && rc_used + e->size > rc_budget)
+		rc_remove(rc_oldest, &dead);
+	e->next = rc_hash[e->key & (RC_HASHSIZE - 1)];
+	rc_hash[e->key & (RC_HASHSIZE - 1)] = e;
+	e->older = rc_newest;
+	if (rc_newest)
+		rc_newest->newer = e;
+	else
+		rc_oldest = e;
+	rc_newest = e;
+	rc_used += e->size;
+	MT_lock_unset(&rc_lock);
+	rc_destroy_list(dead);
+}
+
+/* The query finished without producing the awaited result. */
+void
+rc_done(backend *be)
+{
+	if (be->rc)
+		rc_destroy(be->rc);
+	be->rc = NULL;
+}
+
+/* Called with the store locked, just before the transaction commits. */
+void
+rc_commit(sql_trans *tr)
+{
+	rcentry *e, *o, *dead = NULL;
+	node *n, *m;
+	int i, nr = store_next_commit();
+
+	if (!rc_budget)
+		return;
+	MT_lock_set(&rc_lock);
+	if (tr->schema_updates) {
+		rc_schema_change = nr;
+		while (rc_oldest)
+			rc_remove(rc_oldest, &dead);
+	} else if (tr->schemas.set) {
+		for (n = tr->schemas.set->h; n; n = n->next) {
+			sql_schema *s = n->data;
+
+			if (!s->tables.set)
+				continue;
+			for (m = s->tables.set->h; m; m = m->next) {
+				sql_table *t = m->data;
+
+				if (t->base.wtime)
+					rc_set_version(t->base.id, nr);
+			}
+		}
+		for (e = rc_oldest; e; e = o) {
+			o = e->newer;
+			for (i = 0; i < e->nr_tables; i++)
+				if (rc_version(e->tables[i]) != e->versions[i])
+					break;
+			if (i < e->nr_tables || rc_schema_change > e->commit_number)
+				rc_remove(e, &dead);
+		}
+	}
+	MT_lock_unset(&rc_lock);
+	rc_destroy_list(dead);
+}
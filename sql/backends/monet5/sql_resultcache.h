@@ -0,0 +1,23 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+#ifndef _SQL_RESULTCACHE_H_
+#define _SQL_RESULTCACHE_H_
+
+#include "sql.h"
+#include "mal_backend.h"
+
+extern void rc_init(lng budget);
+extern void rc_exit(void);
+extern int rc_lookup(backend *be, MalBlkPtr mb);
+extern int rc_wants(backend *be, res_table *t);
+extern void rc_capture(backend *be, res_table *t);
+extern void rc_done(backend *be);
+extern void rc_commit(sql_trans *tr);
+
+#endif /* _SQL_RESULTCACHE_H_ */
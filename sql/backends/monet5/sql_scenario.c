@@ -22,6 +22,7 @@
 #include "sql_result.h"
 #include "sql_gencode.h"
 #include "sql_optimizer.h"
+#include "sql_resultcache.h"
 #include "sql_assert.h"
 #include "sql_execute.h"
 #include "sql_env.h"
@@ -83,6 +84,61 @@ monet5_freecode(int clientid, backend_code code, backend_stack stk, int nr, char
 #endif
 }
 
+/* Query templates are shared with the other clients, unless they
+ * call functions compiled in the namespace of this client or refer to
+ * its temporary tables. */
+static backend_code
+monet5_sharecode(int clientid, backend_code code)
+{
+	MalBlkPtr mb = ((Symbol) code)->def;
+	InstrPtr p;
+	int i, j, a;
+
+	(void) clientid;
+	for (i = 1; i < mb->stop; i++) {
+		p = getInstrPtr(mb, i);
+		if (getModuleId(p) == userRef)
+			return NULL;
+		/* also look for functions called by name, e.g. by
+		 * mal.multiplex */
+		for (j = p->retc; j < p->argc; j++) {
+			a = getArg(p, j);
+			if (!isVarConstant(mb, a) || getVarType(mb, a) != TYPE_str)
+				continue;
+			if (strcmp(getVarConstant(mb, a).val.sval, userRef) == 0 ||
+			    (getModuleId(p) == sqlRef &&
+			     strcmp(getVarConstant(mb, a).val.sval, "tmp") == 0))
+				return NULL;
+		}
+	}
+	return (backend_code) copyMalBlk(mb);
+}
+
+static backend_code
+monet5_importcode(int clientid, backend_code code, char *name)
+{
+	Client c = MCgetClient(clientid);
+	Symbol s = newSymbol(name, FUNCTIONsymbol);
+
+	if (s == NULL)
+		return NULL;
+	freeMalBlk(s->def);
+	s->def = copyMalBlk((MalBlkPtr) code);
+	if (s->def == NULL) {
+		freeSymbol(s);
+		return NULL;
+	}
+	setFunctionId(getInstrPtr(s->def, 0), s->name);
+	insertSymbol(c->usermodule, s);
+	return (backend_code) s;
+}
+
+static void
+monet5_freesharedcode(backend_code code)
+{
+	freeMalBlk((MalBlkPtr) code);
+}
+
 str
 SQLsession(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 {
@@ -200,6 +256,7 @@ SQLexit(Client c)
 	(void) c;		/* not used */
 	MT_lock_set(&sql_contextLock);
 	if (SQLinitialized) {
+		rc_exit();
 		mvc_exit();
 		SQLinitialized = FALSE;
 	}
@@ -248,8 +305,13 @@ SQLinit(void)
 	memset((char *) &be_funcs, 0, sizeof(backend_functions));
 	be_funcs.fstack = &monet5_freestack;
 	be_funcs.fcode = &monet5_freecode;
+	be_funcs.fsharecode = &monet5_sharecode;
+	be_funcs.fimportcode = &monet5_importcode;
+	be_funcs.ffreesharedcode = &monet5_freesharedcode;
 	be_funcs.fresolve_function = &monet5_resolve_function;
+	be_funcs.fcommit = &rc_commit;
 	monet5_user_init(&be_funcs);
+	rc_init(GDKgetenv_int("sql_result_cache", 0) * LL_CONSTANT(1024) * 1024);
 
 	msg = MTIMEtimezone(&tz, &gmt);
 	if (msg)
@@ -978,6 +1040,79 @@ cachable(mvc *m, sql_rel *r)
 	return 1;
 }
 
+/* Query templates are shared with other clients when they do not
+ * depend on the state of the session, i.e. its declared variables and
+ * tables or uncommitted changes to the catalog. */
+static int
+sharable(mvc *m)
+{
+	return m->emode == m_normal && m->topvars == NR_GLOBAL_VARS &&
+		!m->session->tr->schema_updates;
+}
+
+/* Pick up a template compiled by another client */
+static cq *
+import_query(mvc *m)
+{
+	char qname[IDLENGTH];
+	str name;
+	cq *q;
+
+	(void) snprintf(qname, IDLENGTH, "s%d_%d", m->qc->id, m->qc->clientid);
+	if ((name = putName(qname)) == NULL)
+		return NULL;
+	q = qc_import(m->qc, name, m->sym, m->args, m->argc,
+		      m->scanner.key ^ m->session->schema->base.id,
+		      m->session->schema->base.id, m->user_id, m->role_id,
+		      m->session->tr->schema_number);
+	/* keep the numbering of a compiled template */
+	if (q)
+		m->qc->id++;
+	return q;
+}
+
+/*
+ * The rows of an EXECUTE .. FROM STDIN that could not be compiled,
+ * e.g. because the server forgot the prepared statement, are skipped,
+ * such that they are not mistaken for SQL statements.  This is only
+ * possible if the number of records is given, and rows are assumed to
+ * end at a newline.
+ */
+static void
+SQLskip_records(Client c, mvc *m)
+{
+	dlist *l = m->sym->data.lval, *nr = l->h->next->next->data.lval;
+	bstream *in = m->scanner.rs;
+	lng n;
+
+	if (nr == NULL || nr->h->data.l_val < 0)
+		return;
+	n = nr->h->data.l_val;
+	if (nr->h->next->data.l_val > 1)
+		n += nr->h->next->data.l_val - 1;
+	scanner_query_processed(&m->scanner);
+	while (n > 0) {
+		char *s = in->buf + in->pos, *e = in->buf + in->len;
+
+		while (s < e && n > 0)
+			if (*s++ == '\n')
+				n--;
+		in->pos = s - in->buf;
+		if (n == 0)
+			break;
+		/* ask the client for the next block, as COPY INTO does */
+		if (bstream_next(in) < 0)
+			break;
+		if (in->eof) {
+			if (mnstr_write(c->fdout, PROMPT2, sizeof(PROMPT2) - 1, 1) == 1)
+				mnstr_flush(c->fdout);
+			in->eof = 0;
+			if (bstream_next(in) <= 0)
+				break;
+		}
+	}
+}
+
 /*
  * The core part of the SQL interface, parse the query and
  * store away the template (non)optimized code in the query cache
@@ -1142,7 +1277,7 @@ SQLparser(Client c)
 	 * produce code.
 	 */
 	be->q = NULL;
-	if (m->emode == m_execute) {
+	if (m->emode == m_execute && dlist_length(m->sym->data.lval) == 2) {
 		assert(m->sym->data.lval->h->type == type_int);
 		be->q = qc_find(m->qc, m->sym->data.lval->h->data.i_val);
 		if (!be->q) {
@@ -1165,10 +1300,17 @@ SQLparser(Client c)
 		/* query template was found in the query cache */
 		scanner_query_processed(&(m->scanner));
 		m->no_mitosis = be->q->no_mitosis;
+	} else if (caching(m) && cachable(m, NULL) && sharable(m) && (be->q = import_query(m)) != NULL) {
+		/* another client compiled the query template already */
+		scanner_query_processed(&(m->scanner));
+		m->no_mitosis = be->q->no_mitosis;
 	} else {
 		sql_rel *r;
 
-		r = sql_symbol2relation(m, m->sym);
+		if (m->emode == m_execute)	/* EXECUTE .. FROM STDIN */
+			r = sql_batch2relation(m, m->sym);
+		else
+			r = sql_symbol2relation(m, m->sym);
 
 		if (!r || (err = mvc_status(m) && m->type != Q_TRANS && *m->errstr)) {
 			if (strlen(m->errstr) > 6 && m->errstr[5] == '!')
@@ -1177,11 +1319,13 @@ SQLparser(Client c)
 				msg = createException(PARSE, "SQLparser", SQLSTATE(42000) "%s", m->errstr);
 			*m->errstr = 0;
 			msg = handle_error(m, pstatus, msg);
+			if (m->emode == m_execute)
+				SQLskip_records(c, m);
 			sqlcleanup(m, err);
 			goto finalize;
 		}
 
-		if ((!caching(m) || !cachable(m, r)) && m->emode != m_prepare) {
+		if ((!caching(m) || !cachable(m, r) || m->emode == m_execute) && m->emode != m_prepare) {
 			char *q = query_cleaned(QUERY(m->scanner));
 			if(!q) {
 				err = 1;
@@ -1244,6 +1388,11 @@ SQLparser(Client c)
 				err = 1;
 				msg = createException(PARSE, "SQLparser", SQLSTATE(HY001) MAL_MALLOC_FAIL);
 			}
+			/* offer the template to the other clients */
+			if (!err && sharable(m) && (be->q->type == Q_TABLE || be->q->type == Q_UPDATE))
+				qc_share(m->qc, be->q, m->session->schema->base.id,
+					 m->user_id, m->role_id,
+					 m->session->tr->schema_number);
 		}
 	}
 	if (err)
@@ -507,6 +507,7 @@ stmt_tid(backend *be, sql_table *t, int partition)
 		sql_trans *tr = be->mvc->session->tr;
 		BUN rows = (BUN) store_funcs.count_col(tr, t->columns.set->h->data, 1);
 		setRowCnt(mb,getArg(q,0),rows);
+		setVarFeedback(mb,getArg(q,0));
 		if (t->p && 0)
 			setMitosisPartition(q, t->p->base.id);
 	}
@@ -576,6 +577,8 @@ stmt_bat(backend *be, sql_column *c, int access, int partition)
 		if (c && (!isRemote(c->t) && !isMergeTable(c->t))) {
 			BUN rows = (BUN) store_funcs.count_col(tr, c, 1);
 			setRowCnt(mb,getArg(q,0),rows);
+			if (access == RDONLY)
+				setVarFeedback(mb,getArg(q,0));
 			if (c->t->p && 0)
 				setMitosisPartition(q, c->t->p->base.id);
 		}
@@ -633,6 +636,8 @@ stmt_idxbat(backend *be, sql_idx *i, int access, int partition)
 		if (i && (!isRemote(i->t) && !isMergeTable(i->t))) {
 			BUN rows = (BUN) store_funcs.count_idx(tr, i, 1);
 			setRowCnt(mb,getArg(q,0),rows);
+			if (access == RDONLY)
+				setVarFeedback(mb,getArg(q,0));
 			if (i->t->p && 0)
 				setMitosisPartition(q, i->t->p->base.id);
 		}
@@ -2335,6 +2340,8 @@ stmt_catalog(backend *be, int type, stmt *args)
 	case DDL_ALTER_TABLE_DEL_TABLE:	q = newStmt(mb, sqlcatalogRef, alter_del_tableRef); break;
 	case DDL_ALTER_TABLE_SET_ACCESS:q = newStmt(mb, sqlcatalogRef, alter_set_tableRef); break;
 	case DDL_COMMENT_ON:	q = newStmt(mb, sqlcatalogRef, comment_onRef); break;
+	case DDL_ALTER_TABLE_SET_PARTITION:	q = newStmt(mb, sqlcatalogRef, alter_set_partitionRef); break;
+	case DDL_ALTER_TABLE_ADD_PARTITION:	q = newStmt(mb, sqlcatalogRef, alter_add_partitionRef); break;
 	default:
 		showException(GDKout, SQL, "sql", "catalog operation unknown\n");
 	}
@@ -52,6 +52,370 @@ strToStrSQuote(char **dst, size_t *len, const void *src)
 	return l;
 }
 
+/*
+ * Besides the summary in sys.statistics, ANALYZE keeps a value
+ * distribution per column: an equi-depth histogram in
+ * sys.statistics_histogram, the most common values in
+ * sys.statistics_mcv, and a HyperLogLog distinct value sketch in
+ * the sketch column of sys.statistics.  All three can be maintained
+ * incrementally: the sketch is exactly mergeable, while appended
+ * values are counted in the histogram bucket and MCV entry they fall
+ * into, extending the outer buckets where needed.
+ */
+typedef struct distribution {
+	int tpe;
+	int nbuckets;
+	ptr low[STATISTICS_BUCKETS], high[STATISTICS_BUCKETS];
+	lng count[STATISTICS_BUCKETS], uniq[STATISTICS_BUCKETS];
+	int nmcv;
+	ptr mcv[STATISTICS_MCV];
+	lng mcvcount[STATISTICS_MCV];
+} distribution;
+
+static void
+distribution_clear(distribution *d)
+{
+	int i;
+
+	for (i = 0; i < d->nbuckets; i++) {
+		GDKfree(d->low[i]);
+		GDKfree(d->high[i]);
+	}
+	for (i = 0; i < d->nmcv; i++)
+		GDKfree(d->mcv[i]);
+	d->nbuckets = d->nmcv = 0;
+}
+
+static void
+sketch2str(char *dst, const bte *registers)
+{
+	static const char hex[] = "0123456789abcdef";
+	int i;
+
+	for (i = 0; i < HLL_REGISTERS; i++) {
+		*dst++ = hex[(registers[i] >> 4) & 0xF];
+		*dst++ = hex[registers[i] & 0xF];
+	}
+	*dst = 0;
+}
+
+static int
+hexval(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	return -1;
+}
+
+static int
+str2sketch(bte *registers, const char *src)
+{
+	int i, h, l;
+
+	if (src == NULL || strlen(src) != 2 * HLL_REGISTERS)
+		return -1;
+	for (i = 0; i < HLL_REGISTERS; i++) {
+		if ((h = hexval(src[2 * i])) < 0 ||
+		    (l = hexval(src[2 * i + 1])) < 0)
+			return -1;
+		registers[i] = (bte) (h << 4 | l);
+	}
+	return 0;
+}
+
+/* Build the histogram and most common value list from the non-nil
+ * values of b (restricted to the sample, if any).  Counts are scaled
+ * from the number of rows inspected to total. */
+static str
+distribution_build(distribution *d, BAT *b, BAT *bsample, lng total)
+{
+	BAT *cand, *vals, *sorted;
+	BATiter bi;
+	BUN n, i, lo, hi, runstart;
+	int (*cmp)(const void *, const void *) = ATOMcompare(b->ttype);
+	int k, j;
+	dbl scale;
+
+	d->tpe = b->ttype;
+	d->nbuckets = d->nmcv = 0;
+	if ((cand = BATselect(b, bsample, ATOMnilptr(b->ttype), NULL, 1, 1, 1)) == NULL)
+		throw(SQL, "analyze", GDK_EXCEPTION);
+	vals = BATproject(cand, b);
+	BBPunfix(cand->batCacheid);
+	if (vals == NULL)
+		throw(SQL, "analyze", GDK_EXCEPTION);
+	if (BATsort(&sorted, NULL, NULL, vals, NULL, NULL, 0, 0) != GDK_SUCCEED) {
+		BBPunfix(vals->batCacheid);
+		throw(SQL, "analyze", GDK_EXCEPTION);
+	}
+	BBPunfix(vals->batCacheid);
+	n = BATcount(sorted);
+	if (n == 0) {
+		BBPunfix(sorted->batCacheid);
+		return MAL_SUCCEED;
+	}
+	scale = (dbl) total / (bsample ? BATcount(bsample) : BATcount(b));
+	bi = bat_iterator(sorted);
+
+	/* equi-depth: every bucket covers the same number of values */
+	d->nbuckets = n < STATISTICS_BUCKETS ? (int) n : STATISTICS_BUCKETS;
+	for (k = 0; k < d->nbuckets; k++) {
+		lo = (BUN) ((lng) k * n / d->nbuckets);
+		hi = (BUN) ((lng) (k + 1) * n / d->nbuckets);
+		d->low[k] = ATOMdup(d->tpe, BUNtail(bi, lo));
+		d->high[k] = ATOMdup(d->tpe, BUNtail(bi, hi - 1));
+		d->count[k] = (lng) ((hi - lo) * scale);
+		d->uniq[k] = 1;
+		for (i = lo + 1; i < hi; i++)
+			d->uniq[k] += (*cmp)(BUNtail(bi, i - 1), BUNtail(bi, i)) != 0;
+	}
+
+	/* keep the longest runs of equal values, ignoring values that
+	 * occur only once */
+	for (runstart = 0, i = 1; i <= n; i++) {
+		lng len;
+
+		if (i < n && (*cmp)(BUNtail(bi, runstart), BUNtail(bi, i)) == 0)
+			continue;
+		len = (lng) (i - runstart);
+		if (len > 1 &&
+		    (d->nmcv < STATISTICS_MCV || len > d->mcvcount[d->nmcv - 1])) {
+			if (d->nmcv == STATISTICS_MCV)
+				GDKfree(d->mcv[--d->nmcv]);
+			for (j = d->nmcv; j > 0 && d->mcvcount[j - 1] < len; j--) {
+				d->mcv[j] = d->mcv[j - 1];
+				d->mcvcount[j] = d->mcvcount[j - 1];
+			}
+			d->mcv[j] = ATOMdup(d->tpe, BUNtail(bi, runstart));
+			d->mcvcount[j] = len;
+			d->nmcv++;
+		}
+		runstart = i;
+	}
+	for (j = 0; j < d->nmcv; j++)
+		d->mcvcount[j] = (lng) (d->mcvcount[j] * scale);
+	BBPunfix(sorted->batCacheid);
+
+	for (k = 0; k < d->nbuckets; k++)
+		if (d->low[k] == NULL || d->high[k] == NULL)
+			throw(SQL, "analyze", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	for (j = 0; j < d->nmcv; j++)
+		if (d->mcv[j] == NULL)
+			throw(SQL, "analyze", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	return MAL_SUCCEED;
+}
+
+static ptr
+value_fromstr(int tpe, const char *s)
+{
+	ptr p = NULL;
+	size_t len = 0;
+
+	if (s == NULL || ATOMfromstr(tpe, &p, &len, s) < 0 || p == NULL) {
+		GDKfree(p);
+		return NULL;
+	}
+	return p;
+}
+
+/* Read the persisted statistics of column c: the number of rows they
+ * describe, the sketch and the value distribution.  Returns 0 if no
+ * usable statistics exist. */
+static int
+statistics_load(sql_trans *tr, sql_column *c, int tpe, lng *cnt, lng *nils, bte *registers, distribution *d)
+{
+	sql_schema *sys = find_sql_schema(tr, "sys");
+	sql_table *stats = find_sql_table(sys, "statistics");
+	sql_table *hist = find_sql_table(sys, "statistics_histogram");
+	sql_table *mcv = find_sql_table(sys, "statistics_mcv");
+	sql_column *sc;
+	rids *rs;
+	oid rid;
+	void *v;
+	int ok;
+
+	d->tpe = tpe;
+	d->nbuckets = d->nmcv = 0;
+	if (stats == NULL || hist == NULL || mcv == NULL)
+		return 0;
+	rid = table_funcs.column_find_row(tr, find_sql_column(stats, "column_id"), &c->base.id, NULL);
+	if (is_oid_nil(rid))
+		return 0;
+	v = table_funcs.column_find_value(tr, find_sql_column(stats, "count"), rid);
+	*cnt = *(lng *) v;
+	_DELETE(v);
+	v = table_funcs.column_find_value(tr, find_sql_column(stats, "nils"), rid);
+	*nils = *(lng *) v;
+	_DELETE(v);
+	v = table_funcs.column_find_value(tr, find_sql_column(stats, "sketch"), rid);
+	ok = str2sketch(registers, v) == 0;
+	_DELETE(v);
+	if (!ok || is_lng_nil(*cnt) || is_lng_nil(*nils))
+		return 0;
+
+	sc = find_sql_column(hist, "column_id");
+	rs = table_funcs.rids_select(tr, sc, &c->base.id, &c->base.id, NULL);
+	rs = table_funcs.rids_orderby(tr, rs, find_sql_column(hist, "bucket"));
+	for (rid = table_funcs.rids_next(rs); ok && !is_oid_nil(rid); rid = table_funcs.rids_next(rs)) {
+		int k;
+
+		v = table_funcs.column_find_value(tr, find_sql_column(hist, "bucket"), rid);
+		k = *(int *) v;
+		_DELETE(v);
+		if (k != d->nbuckets || k >= STATISTICS_BUCKETS) {
+			ok = 0;
+			break;
+		}
+		v = table_funcs.column_find_value(tr, find_sql_column(hist, "lowval"), rid);
+		d->low[k] = value_fromstr(tpe, v);
+		_DELETE(v);
+		v = table_funcs.column_find_value(tr, find_sql_column(hist, "highval"), rid);
+		d->high[k] = value_fromstr(tpe, v);
+		_DELETE(v);
+		v = table_funcs.column_find_value(tr, find_sql_column(hist, "count"), rid);
+		d->count[k] = *(lng *) v;
+		_DELETE(v);
+		v = table_funcs.column_find_value(tr, find_sql_column(hist, "unique"), rid);
+		d->uniq[k] = *(lng *) v;
+		_DELETE(v);
+		d->nbuckets++;
+		ok = d->low[k] != NULL && d->high[k] != NULL;
+	}
+	table_funcs.rids_destroy(rs);
+
+	sc = find_sql_column(mcv, "column_id");
+	rs = table_funcs.rids_select(tr, sc, &c->base.id, &c->base.id, NULL);
+	for (rid = table_funcs.rids_next(rs); ok && !is_oid_nil(rid); rid = table_funcs.rids_next(rs)) {
+		int j = d->nmcv;
+
+		if (j == STATISTICS_MCV) {
+			ok = 0;
+			break;
+		}
+		v = table_funcs.column_find_value(tr, find_sql_column(mcv, "value"), rid);
+		d->mcv[j] = value_fromstr(tpe, v);
+		_DELETE(v);
+		v = table_funcs.column_find_value(tr, find_sql_column(mcv, "count"), rid);
+		d->mcvcount[j] = *(lng *) v;
+		_DELETE(v);
+		d->nmcv++;
+		ok = d->mcv[j] != NULL;
+	}
+	table_funcs.rids_destroy(rs);
+	if (!ok)
+		distribution_clear(d);
+	return ok;
+}
+
+/* Count the values of b in the range [first, last) in the existing
+ * distribution. */
+static str
+distribution_fold(distribution *d, BAT *b, BUN first, BUN last)
+{
+	BATiter bi = bat_iterator(b);
+	int (*cmp)(const void *, const void *) = ATOMcompare(b->ttype);
+	const void *nil = ATOMnilptr(b->ttype);
+	BUN i;
+	int j, lo, hi, mid;
+
+	for (i = first; i < last; i++) {
+		const void *v = BUNtail(bi, i);
+
+		if ((*cmp)(v, nil) == 0)
+			continue;
+		for (j = 0; j < d->nmcv; j++) {
+			if ((*cmp)(v, d->mcv[j]) == 0) {
+				d->mcvcount[j]++;
+				break;
+			}
+		}
+		if (d->nbuckets == 0)
+			continue;
+		/* find the first bucket whose upper bound is >= v */
+		lo = 0;
+		hi = d->nbuckets;
+		while (lo < hi) {
+			mid = (lo + hi) / 2;
+			if ((*cmp)(d->high[mid], v) < 0)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo == d->nbuckets) {
+			ptr p = ATOMdup(d->tpe, v);
+			if (p == NULL)
+				throw(SQL, "analyze", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+			GDKfree(d->high[--lo]);
+			d->high[lo] = p;
+		} else if (lo == 0 && (*cmp)(v, d->low[0]) < 0) {
+			ptr p = ATOMdup(d->tpe, v);
+			if (p == NULL)
+				throw(SQL, "analyze", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+			GDKfree(d->low[0]);
+			d->low[0] = p;
+		}
+		d->count[lo]++;
+	}
+	return MAL_SUCCEED;
+}
+
+/* Replace the persisted histogram and most common values of column
+ * c by those in d. */
+static str
+distribution_store(Client cntxt, sql_column *c, distribution *d, ssize_t (*tostr)(str*,size_t*,const void*))
+{
+	char *query, *low = NULL, *high = NULL;
+	size_t querylen = 1024, pos = 0, lowlen = 0, highlen = 0;
+	str msg = MAL_SUCCEED;
+	int k;
+
+	if ((query = GDKmalloc(querylen)) == NULL)
+		throw(SQL, "analyze", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	pos += snprintf(query + pos, querylen - pos,
+			"delete from sys.statistics_histogram where \"column_id\" = %d;\n"
+			"delete from sys.statistics_mcv where \"column_id\" = %d;\n",
+			c->base.id, c->base.id);
+	for (k = 0; k < d->nbuckets + d->nmcv; k++) {
+		size_t need;
+
+		if (tostr(&low, &lowlen, k < d->nbuckets ? d->low[k] : d->mcv[k - d->nbuckets]) < 0 ||
+		    (k < d->nbuckets && tostr(&high, &highlen, d->high[k]) < 0)) {
+			msg = createException(SQL, "analyze", GDK_EXCEPTION);
+			break;
+		}
+		need = pos + strlen(low) + (k < d->nbuckets ? strlen(high) : 0) + 128;
+		if (need > querylen) {
+			char *nquery;
+
+			querylen = need * 2;
+			if ((nquery = GDKrealloc(query, querylen)) == NULL) {
+				msg = createException(SQL, "analyze", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+				break;
+			}
+			query = nquery;
+		}
+		if (k < d->nbuckets)
+			pos += snprintf(query + pos, querylen - pos,
+					"insert into sys.statistics_histogram values(%d,%d,'%s','%s'," LLFMT "," LLFMT ");\n",
+					c->base.id, k, low, high, d->count[k], d->uniq[k]);
+		else
+			pos += snprintf(query + pos, querylen - pos,
+					"insert into sys.statistics_mcv values(%d,'%s'," LLFMT ");\n",
+					c->base.id, low, d->mcvcount[k - d->nbuckets]);
+	}
+	GDKfree(low);
+	GDKfree(high);
+#ifdef DEBUG_SQL_STATISTICS
+	fprintf(stderr, "%s\n", query);
+#endif
+	if (msg == MAL_SUCCEED)
+		msg = SQLstatementIntern(cntxt, &query, "SQLanalyze", TRUE, FALSE, NULL);
+	GDKfree(query);
+	return msg;
+}
+
 str
 sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 {
@@ -71,10 +435,15 @@ sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 	int argc = pci->argc;
 	int width = 0;
 	int minmax = *getArgReference_int(stk, pci, 1);
+	int incremental = (minmax & ANALYZE_INCREMENTAL) != 0;
 	int sfnd = 0, tfnd = 0, cfnd = 0;
+	bte registers[HLL_REGISTERS];
+	char sketch[2 * HLL_REGISTERS + 1];
+	distribution dist = { .nbuckets = 0, .nmcv = 0 };
 
 	if (msg != MAL_SUCCEED || (msg = checkSQLContext(cntxt)) != NULL)
 		return msg;
+	minmax &= ANALYZE_MINMAX;
 
 	dquery = (char *) GDKzalloc(96);
 	if (dquery == NULL) {
@@ -92,7 +461,7 @@ sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 		sch = *getArgReference_str(stk, pci, 3);
 	}
 #ifdef DEBUG_SQL_STATISTICS
-	fprintf(stderr, "analyze %s.%s.%s sample " LLFMT "%s\n", (sch ? sch : ""), (tbl ? tbl : " "), (col ? col : " "), samplesize, (minmax)?"MinMax":"");
+	fprintf(stderr, "analyze %s.%s.%s sample " LLFMT "%s%s\n", (sch ? sch : ""), (tbl ? tbl : " "), (col ? col : " "), samplesize, (minmax)?"MinMax":"", (incremental)?"Incremental":"");
 #endif
 	for (nsch = tr->schemas.set->h; nsch; nsch = nsch->next) {
 		sql_base *b = nsch->data;
@@ -111,11 +480,8 @@ sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 				if (tbl && strcmp(bt->name, tbl))
 					continue;
 				if (t->persistence != SQL_PERSIST) {
-					GDKfree(dquery);
-					GDKfree(query);
-					GDKfree(maxval);
-					GDKfree(minval);
-					throw(SQL, "analyze", SQLSTATE(42S02) "Table '%s' is not persistent", bt->name);
+					msg = createException(SQL, "analyze", SQLSTATE(42S02) "Table '%s' is not persistent", bt->name);
+					goto bailout;
 				}
 				tfnd = 1;
 				if (isTable(t) && t->columns.set)
@@ -124,7 +490,7 @@ sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 						sql_column *c = (sql_column *) ncol->data;
 						BAT *bn, *br;
 						BAT *bsample;
-						lng sz;
+						lng sz, oldcnt = 0, oldnils = 0;
 						ssize_t (*tostr)(str*,size_t*,const void*);
 						void *val=0;
 
@@ -149,36 +515,79 @@ sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 
 						snprintf(dquery, 96, "delete from sys.statistics where \"column_id\" = %d;", c->base.id);
 						cfnd = 1;
-						if (samplesize > 0) {
-							bsample = BATsample(bn, (BUN) samplesize);
-						} else
-							bsample = NULL;
-						br = BATselect(bn, bsample, ATOMnilptr(bn->ttype), NULL, 1, 0, 0);
-						if (br == NULL) {
-							BBPunfix(bn->batCacheid);
-							/* XXX throw error instead? */
-							continue;
-						}
-						nils = BATcount(br);
-						BBPunfix(br->batCacheid);
-						if (bn->tkey)
-							uniq = sz;
-						else if (!minmax) {
-							BAT *en;
-							if (bsample)
-								br = BATproject(bsample, bn);
-							else
-								br = bn;
-							if (br && (en = BATunique(br, NULL)) != NULL) {
-								uniq = BATcount(en);
-								BBPunfix(en->batCacheid);
+						if (incremental &&
+						    statistics_load(tr, c, bn->ttype, &oldcnt, &oldnils, registers, &dist) &&
+						    oldcnt > sz)
+							distribution_clear(&dist);
+						if (incremental && dist.nbuckets > 0) {
+							/* only look at the rows appended
+							 * since the previous analyze */
+							bsample = BATdense(0, bn->hseqbase + (oid) oldcnt, (BUN) (sz - oldcnt));
+							if (bsample == NULL ||
+							    BATsketch(registers, bn, bsample) != GDK_SUCCEED ||
+							    (br = BATselect(bn, bsample, ATOMnilptr(bn->ttype), NULL, 1, 0, 0)) == NULL) {
+								if (bsample)
+									BBPunfix(bsample->batCacheid);
+								BBPunfix(bn->batCacheid);
+								msg = createException(SQL, "analyze", GDK_EXCEPTION);
+								goto bailout;
+							}
+							nils = oldnils + (lng) BATcount(br);
+							uniq = (lng) HLLestimate(registers);
+							BBPunfix(br->batCacheid);
+							BBPunfix(bsample->batCacheid);
+							if ((msg = distribution_fold(&dist, bn, (BUN) oldcnt, (BUN) sz)) != MAL_SUCCEED) {
+								BBPunfix(bn->batCacheid);
+								goto bailout;
+							}
+						} else {
+							memset(registers, 0, sizeof(registers));
+							if (BATsketch(registers, bn, NULL) != GDK_SUCCEED) {
+								BBPunfix(bn->batCacheid);
+								msg = createException(SQL, "analyze", GDK_EXCEPTION);
+								goto bailout;
+							}
+							if (samplesize > 0) {
+								bsample = BATsample(bn, (BUN) samplesize);
 							} else
-								uniq = 0;
-							if (bsample && br)
-								BBPunfix(br->batCacheid);
+								bsample = NULL;
+							br = BATselect(bn, bsample, ATOMnilptr(bn->ttype), NULL, 1, 0, 0);
+							if (br == NULL) {
+								BBPunfix(bn->batCacheid);
+								/* XXX throw error instead? */
+								continue;
+							}
+							nils = BATcount(br);
+							BBPunfix(br->batCacheid);
+							if (!minmax && tostr &&
+							    (msg = distribution_build(&dist, bn, bsample, sz)) != MAL_SUCCEED) {
+								if (bsample)
+									BBPunfix(bsample->batCacheid);
+								BBPunfix(bn->batCacheid);
+								goto bailout;
+							}
+							if (bn->tkey)
+								uniq = sz;
+							else if (minmax)
+								uniq = (lng) HLLestimate(registers);
+							else {
+								BAT *en;
+								if (bsample)
+									br = BATproject(bsample, bn);
+								else
+									br = bn;
+								if (br && (en = BATunique(br, NULL)) != NULL) {
+									uniq = BATcount(en);
+									BBPunfix(en->batCacheid);
+								} else
+									uniq = 0;
+								if (bsample && br)
+									BBPunfix(br->batCacheid);
+							}
+							if (bsample)
+								BBPunfix(bsample->batCacheid);
 						}
-						if (bsample)
-							BBPunfix(bsample->batCacheid);
+						sketch2str(sketch, registers);
 						/* use BATordered(_rev)
 						 * and not
 						 * BATt(rev)ordered
@@ -194,9 +603,9 @@ sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 							GDKfree(maxval);
 							maxval = GDKmalloc(4);
 							if (maxval == NULL) {
-								GDKfree(dquery);
-								GDKfree(minval);
-								throw(SQL, "analyze", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+								BBPunfix(bn->batCacheid);
+								msg = createException(SQL, "analyze", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+								goto bailout;
 							}
 							maxlen = 4;
 						}
@@ -204,9 +613,9 @@ sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 							GDKfree(minval);
 							minval = GDKmalloc(4);
 							if (minval == NULL){
-								GDKfree(dquery);
-								GDKfree(maxval);
-								throw(SQL, "analyze", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+								BBPunfix(bn->batCacheid);
+								msg = createException(SQL, "analyze", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+								goto bailout;
 							}
 							minlen = 4;
 						}
@@ -216,10 +625,9 @@ sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 							else {
 								if (tostr(&maxval, &maxlen, val) < 0) {
 									GDKfree(val);
-									GDKfree(dquery);
-									GDKfree(minval);
-									GDKfree(maxval);
-									throw(SQL, "analyze", GDK_EXCEPTION);
+									BBPunfix(bn->batCacheid);
+									msg = createException(SQL, "analyze", GDK_EXCEPTION);
+									goto bailout;
 								}
 								GDKfree(val);
 							}
@@ -228,10 +636,9 @@ sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 							else {
 								if (tostr(&minval, &minlen, val) < 0) {
 									GDKfree(val);
-									GDKfree(dquery);
-									GDKfree(minval);
-									GDKfree(maxval);
-									throw(SQL, "analyze", GDK_EXCEPTION);
+									BBPunfix(bn->batCacheid);
+									msg = createException(SQL, "analyze", GDK_EXCEPTION);
+									goto bailout;
 								}
 								GDKfree(val);
 							}
@@ -239,46 +646,43 @@ sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 							strcpy(maxval, "nil");
 							strcpy(minval, "nil");
 						}
-						if (strlen(minval) + strlen(maxval) + 1024 > querylen) {
-							querylen = strlen(minval) + strlen(maxval) + 1024;
+						if (strlen(minval) + strlen(maxval) + sizeof(sketch) + 1024 > querylen) {
+							querylen = strlen(minval) + strlen(maxval) + sizeof(sketch) + 1024;
 							GDKfree(query);
 							query = GDKmalloc(querylen);
 							if (query == NULL) {
-								GDKfree(dquery);
-								GDKfree(maxval);
-								GDKfree(minval);
-								throw(SQL, "analyze", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+								BBPunfix(bn->batCacheid);
+								msg = createException(SQL, "analyze", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+								goto bailout;
 							}
 						}
-						snprintf(query, querylen, "insert into sys.statistics (column_id,type,width,stamp,\"sample\",count,\"unique\",nils,minval,maxval,sorted,revsorted) values(%d,'%s',%d,now()," LLFMT "," LLFMT "," LLFMT "," LLFMT ",'%s','%s',%s,%s);", c->base.id, c->type.type->sqlname, width, (samplesize ? samplesize : sz), sz, uniq, nils, minval, maxval, sorted ? "true" : "false", revsorted ? "true" : "false");
+						snprintf(query, querylen, "insert into sys.statistics (column_id,type,width,stamp,\"sample\",count,\"unique\",nils,minval,maxval,sorted,revsorted,sketch) values(%d,'%s',%d,now()," LLFMT "," LLFMT "," LLFMT "," LLFMT ",'%s','%s',%s,%s,'%s');", c->base.id, c->type.type->sqlname, width, (samplesize && !incremental ? samplesize : sz), sz, uniq, nils, minval, maxval, sorted ? "true" : "false", revsorted ? "true" : "false", sketch);
 #ifdef DEBUG_SQL_STATISTICS
 						fprintf(stderr, "%s\n", dquery);
 						fprintf(stderr, "%s\n", query);
 #endif
 						BBPunfix(bn->batCacheid);
 						msg = SQLstatementIntern(cntxt, &dquery, "SQLanalyze", TRUE, FALSE, NULL);
-						if (msg) {
-							GDKfree(dquery);
-							GDKfree(query);
-							GDKfree(maxval);
-							GDKfree(minval);
-							return msg;
-						}
+						if (msg)
+							goto bailout;
 						msg = SQLstatementIntern(cntxt, &query, "SQLanalyze", TRUE, FALSE, NULL);
-						if (msg) {
-							GDKfree(dquery);
-							GDKfree(query);
-							GDKfree(maxval);
-							GDKfree(minval);
-							return msg;
-						}
+						if (msg)
+							goto bailout;
+						if (tostr &&
+						    (msg = distribution_store(cntxt, c, &dist, tostr)) != MAL_SUCCEED)
+							goto bailout;
+						distribution_clear(&dist);
 					}
 			}
 	}
+  bailout:
+	distribution_clear(&dist);
 	GDKfree(dquery);
 	GDKfree(query);
 	GDKfree(maxval);
 	GDKfree(minval);
+	if (msg)
+		return msg;
 	if (sch && !sfnd)
 		throw(SQL, "analyze", SQLSTATE(3F000) "Schema '%s' does not exist", sch);
 	if (tbl && !tfnd)
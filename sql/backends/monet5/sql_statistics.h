@@ -24,6 +24,13 @@
 #define sql5_export extern
 #endif
 
+/* bits of the minmax argument of sql_analyze */
+#define ANALYZE_MINMAX		1	/* skip the (sampled) exact distinct count */
+#define ANALYZE_INCREMENTAL	2	/* only fold appended rows into existing statistics */
+
+#define STATISTICS_BUCKETS	32	/* equi-depth histogram buckets per column */
+#define STATISTICS_MCV		10	/* most common values kept per column */
+
 sql5_export str sql_analyze(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
 
 #endif /* _SQL_STATISTICS_DEF */
@@ -1531,6 +1531,87 @@ sql_update_default(Client c, mvc *sql)
 	return err;		/* usually MAL_SUCCEED */
 }
 
+static str
+sql_update_default_statistics(Client c, mvc *sql)
+{
+	size_t bufsize = 2048, pos = 0;
+	char *buf, *err;
+	char *schema;
+
+	schema = stack_get_string(sql, "current_schema");
+	if ((buf = GDKmalloc(bufsize)) == NULL)
+		throw(SQL, "sql_update_default_statistics", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+
+	pos += snprintf(buf + pos, bufsize - pos, "set schema sys;\n");
+
+	/* 80_statistics.sql */
+	pos += snprintf(buf + pos, bufsize - pos,
+			"alter table sys.statistics add column sketch string;\n"
+			"create table sys.statistics_histogram(\n"
+			"\t\"column_id\" integer,\n"
+			"\t\"bucket\" integer,\n"
+			"\tlowval string,\n"
+			"\thighval string,\n"
+			"\t\"count\" bigint,\n"
+			"\t\"unique\" bigint);\n"
+			"create table sys.statistics_mcv(\n"
+			"\t\"column_id\" integer,\n"
+			"\t\"value\" string,\n"
+			"\t\"count\" bigint);\n"
+			"update sys._tables set system = true where name in ('statistics_histogram', 'statistics_mcv') and schema_id = (select id from sys.schemas where name = 'sys');\n");
+
+	if (schema)
+		pos += snprintf(buf + pos, bufsize - pos, "set schema \"%s\";\n", schema);
+	pos += snprintf(buf + pos, bufsize - pos, "commit;\n");
+
+	assert(pos < bufsize);
+	printf("Running database upgrade commands:\n%s\n", buf);
+	err = SQLstatementIntern(c, &buf, "update", 1, 0, NULL);
+	GDKfree(buf);
+	return err;		/* usually MAL_SUCCEED */
+}
+
+static str
+sql_update_default_partitions(Client c, mvc *sql)
+{
+	size_t bufsize = 2048, pos = 0;
+	char *buf, *err;
+	char *schema;
+
+	schema = stack_get_string(sql, "current_schema");
+	if ((buf = GDKmalloc(bufsize)) == NULL)
+		throw(SQL, "sql_update_default_partitions", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+
+	pos += snprintf(buf + pos, bufsize - pos, "set schema sys;\n");
+
+	/* 19_partitions.sql */
+	pos += snprintf(buf + pos, bufsize - pos,
+			"create table sys.table_partitions(\n"
+			"\t\"table_id\" integer,\n"
+			"\t\"column_id\" integer,\n"
+			"\t\"type\" integer);\n"
+			"create table sys.range_partitions(\n"
+			"\t\"table_id\" integer,\n"
+			"\t\"partition_id\" integer,\n"
+			"\tminimum string,\n"
+			"\tmaximum string);\n"
+			"create table sys.value_partitions(\n"
+			"\t\"table_id\" integer,\n"
+			"\t\"partition_id\" integer,\n"
+			"\t\"value\" string);\n"
+			"update sys._tables set system = true where name in ('table_partitions', 'range_partitions', 'value_partitions') and schema_id = (select id from sys.schemas where name = 'sys');\n");
+
+	if (schema)
+		pos += snprintf(buf + pos, bufsize - pos, "set schema \"%s\";\n", schema);
+	pos += snprintf(buf + pos, bufsize - pos, "commit;\n");
+
+	assert(pos < bufsize);
+	printf("Running database upgrade commands:\n%s\n", buf);
+	err = SQLstatementIntern(c, &buf, "update", 1, 0, NULL);
+	GDKfree(buf);
+	return err;		/* usually MAL_SUCCEED */
+}
+
 void
 SQLupgrades(Client c, mvc *m)
 {
@@ -1661,4 +1742,18 @@ SQLupgrades(Client c, mvc *m)
 			freeException(err);
 		}
 	}
+
+	if (mvc_bind_table(m, s, "statistics_histogram") == NULL) {
+		if ((err = sql_update_default_statistics(c, m)) != NULL) {
+			fprintf(stderr, "!%s\n", err);
+			freeException(err);
+		}
+	}
+
+	if (mvc_bind_table(m, s, "table_partitions") == NULL) {
+		if ((err = sql_update_default_partitions(c, m)) != NULL) {
+			fprintf(stderr, "!%s\n", err);
+			freeException(err);
+		}
+	}
 }
@@ -0,0 +1,42 @@
+import os, sys
+try:
+    from MonetDBtesting import process
+except ImportError:
+    import process
+
+src = os.environ['TSTSRCDIR']
+
+def path(f):
+    return os.path.join(src, f).replace('\\', '\\\\')
+
+def client(query):
+    clt = process.client('sql',
+                         stdin = process.PIPE,
+                         stdout = process.PIPE,
+                         stderr = process.PIPE,
+                         interactive = False,
+                         echo = False)
+    out, err = clt.communicate(query)
+    # normalize output
+    sys.stdout.write(out.replace(src.replace('\\', '\\\\'), '${TSTSRCDIR}').replace('\\\\', '/'))
+    sys.stderr.write(err.replace(src.replace('\\', '\\\\'), '${TSTSRCDIR}').replace('\\\\', '/'))
+
+client('create table arrowerr (i int, b bigint, d decimal(9,2), f double, s varchar(10), bo boolean, dt date, ts timestamp, tm time);\n')
+# nested columns and wrong number of columns
+client("copy into arrowerr from '%s';\n" % path('nested.parquet'))
+client("create table arrownarrow (i int);\n")
+client("copy into arrownarrow from '%s';\n" % path('types.arrow'))
+# values that do not fit the column
+client("create table arrowshort (i int, b bigint, d decimal(9,2), f double, s varchar(1), bo boolean, dt date, ts timestamp, tm time);\n")
+client("copy into arrowshort from '%s';\n" % path('types_snappy.parquet'))
+client("create table arrowtiny (i int, b int, d decimal(9,2), f double, s varchar(10), bo boolean, dt date, ts timestamp, tm time);\n")
+client("copy into arrowtiny from '%s';\n" % path('types.arrow'))
+client("create table arrowtype (i int, b bigint, d decimal(9,2), f double, s int, bo boolean, dt date, ts timestamp, tm time);\n")
+client("copy into arrowtype from '%s';\n" % path('types_plain.parquet'))
+# not allowed with LOCKED
+client("copy into arrowerr from '%s' locked;\n" % path('types.arrow'))
+# not an Arrow or Parquet file
+client("copy into arrowerr from '%s';\n" % path('notparquet.arrow'))
+client("copy into arrowerr from '%s';\n" % path('nonexistent.parquet'))
+client("select count(*) from arrowerr;\n")
+client('drop table arrowerr;\ndrop table arrownarrow;\ndrop table arrowshort;\ndrop table arrowtiny;\ndrop table arrowtype;\n')
@@ -0,0 +1,886 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+/*
+ * Columnar bulk loading
+ * COPY INTO t FROM 'file' reads files in the Apache Arrow IPC format
+ * (file or stream variant) and in the Apache Parquet format when their
+ * name ends in .arrow, .arrows, .feather or .parquet.  Columns are
+ * matched by position with the columns of the table.
+ *
+ * The Arrow in-memory layout of fixed width columns is the layout of a
+ * BAT tail, hence those values are copied with a single memcpy from
+ * the memory mapped file into the heap of the column, after which only
+ * NULLs and the values that collide with the MonetDB nil are patched.
+ * Other columns (narrower or wider integers, rescaled decimals, dates,
+ * timestamps and strings) are converted value by value.
+ *
+ * The readers only need the metadata of both formats, which are
+ * decoded by hand (FlatBuffers for Arrow, Thrift for Parquet), so the
+ * module does not depend on external libraries.  Nested types,
+ * dictionary encoded Arrow columns and compressed Arrow record batches
+ * are not supported.
+ */
+#include "monetdb_config.h"
+#include "arrow.h"
+#include "mtime.h"
+#include "str.h"
+#include "gdk_posix.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#define arr_isvalid(a, i)	((a)->valid == NULL || (((a)->valid[(i) >> 3] >> ((i) & 7)) & 1))
+
+#ifdef HAVE_HGE
+typedef hge arr_int;
+#define ARR_MAXDIGITS 38
+#else
+typedef lng arr_int;
+#define ARR_MAXDIGITS 18
+#endif
+
+static arr_int
+arr_pow10(int n)
+{
+	arr_int r = 1;
+
+	while (n-- > 0)
+		r *= 10;
+	return r;
+}
+
+/* the value at position i of an ARR_INT, ARR_DATE, ARR_TIME or
+ * ARR_TIMESTAMP array; returns 0 when it does not fit an arr_int */
+static inline int
+arr_get(const arr_array *a, BUN i, arr_int *v)
+{
+	const char *p = (const char *) a->values + i * a->width;
+
+	switch (a->width) {
+	case 1:
+		*v = a->is_signed ? (arr_int) *(const int8_t *) p : (arr_int) *(const uint8_t *) p;
+		return 1;
+	case 2: {
+		uint16_t x;
+		memcpy(&x, p, sizeof(x));
+		*v = a->is_signed ? (arr_int) (int16_t) x : (arr_int) x;
+		return 1;
+	}
+	case 4: {
+		uint32_t x;
+		memcpy(&x, p, sizeof(x));
+		*v = a->is_signed ? (arr_int) (int32_t) x : (arr_int) x;
+		return 1;
+	}
+	case 8: {
+		uint64_t x;
+		memcpy(&x, p, sizeof(x));
+#ifndef HAVE_HGE
+		if (!a->is_signed && x > (uint64_t) GDK_lng_max)
+			return 0;
+#endif
+		*v = a->is_signed ? (arr_int) (int64_t) x : (arr_int) x;
+		return 1;
+	}
+	case 16: {
+#ifdef HAVE_HGE
+		memcpy(v, p, sizeof(hge));
+		return 1;
+#else
+		uint64_t lo, hi;
+		memcpy(&lo, p, sizeof(lo));
+		memcpy(&hi, p + 8, sizeof(hi));
+		if (hi != ((int64_t) lo < 0 ? ~(uint64_t) 0 : 0))
+			return 0;
+		*v = (lng) lo;
+		return 1;
+#endif
+	}
+	}
+	return 0;
+}
+
+/* floor division, for times before the epoch */
+static inline lng
+arr_floordiv(lng a, lng b)
+{
+	lng q = a / b;
+
+	if ((a % b) != 0 && ((a < 0) != (b < 0)))
+		q--;
+	return q;
+}
+
+/* Report an error for row i of the array appended to b, with the rows
+ * counted from the first row loaded, or an error for the whole column
+ * if i is BUN_NONE. */
+static str
+arr_error(BAT *b, sql_column *c, const char *fname, BUN i, const char *msg)
+{
+	if (i == BUN_NONE)
+		return createException(SQL, "arrow.copy_from", SQLSTATE(42000)
+							   "file '%s', column '%s': %s",
+							   fname, c->base.name, msg);
+	return createException(SQL, "arrow.copy_from", SQLSTATE(42000)
+						   "file '%s', row " BUNFMT ", column '%s': %s",
+						   fname, BATcount(b) + i + 1, c->base.name, msg);
+}
+
+BAT *
+arrow_column(sql_column *c, BUN cap)
+{
+	return COLnew(0, c->type.type->localtype, cap, TRANSIENT);
+}
+
+/* the integer types: rescale and range check unless the layout is
+ * the same, in which case the values are copied as is */
+#define APPEND_INT(TPE, MAX)											\
+	do {																\
+		TPE *o = (TPE *) Tloc(b, BUNlast(b));							\
+		if (a->kind == ARR_INT && a->is_signed &&						\
+			a->width == (int) sizeof(TPE) && a->scale == scale) {		\
+			memcpy(o, a->values, a->count * sizeof(TPE));				\
+			for (i = 0; i < a->count; i++) {							\
+				if (!arr_isvalid(a, i)) {								\
+					o[i] = TPE##_nil;									\
+					nonil = 0;											\
+				} else if (is_##TPE##_nil(o[i]) ||						\
+						   (maxval && (o[i] >= maxval || o[i] <= -maxval))) \
+					return arr_error(b, c, fname, i, "value out of range"); \
+			}															\
+			break;														\
+		}																\
+		if (a->kind != ARR_INT)											\
+			return arr_error(b, c, fname, BUN_NONE, "incompatible column type");	\
+		for (i = 0; i < a->count; i++) {								\
+			arr_int v;													\
+			if (!arr_isvalid(a, i)) {									\
+				o[i] = TPE##_nil;										\
+				nonil = 0;												\
+				continue;												\
+			}															\
+			if (!arr_get(a, i, &v))										\
+				return arr_error(b, c, fname, i, "value out of range");	\
+			if (scale > a->scale) {										\
+				arr_int m = arr_pow10(scale - a->scale);				\
+				if (v > ((arr_int) MAX) / m || v < -((arr_int) MAX) / m) \
+					return arr_error(b, c, fname, i, "value out of range"); \
+				v *= m;													\
+			} else if (scale < a->scale) {								\
+				arr_int m = arr_pow10(a->scale - scale);				\
+				if (v % m != 0)											\
+					return arr_error(b, c, fname, i, "too many decimals");	\
+				v /= m;													\
+			}															\
+			if (v > (arr_int) MAX || v < -(arr_int) MAX ||				\
+				(maxval && (v >= maxval || v <= -maxval)))				\
+				return arr_error(b, c, fname, i, "value out of range");	\
+			o[i] = (TPE) v;												\
+		}																\
+	} while (0)
+
+#define APPEND_FLT(TPE)													\
+	do {																\
+		TPE *o = (TPE *) Tloc(b, BUNlast(b));							\
+		if (a->kind == ARR_FLOAT && a->width == (int) sizeof(TPE)) {	\
+			memcpy(o, a->values, a->count * sizeof(TPE));				\
+			for (i = 0; i < a->count; i++) {							\
+				if (!arr_isvalid(a, i))									\
+					o[i] = TPE##_nil;									\
+				nonil &= !is_##TPE##_nil(o[i]);							\
+			}															\
+			break;														\
+		}																\
+		for (i = 0; i < a->count; i++) {								\
+			arr_int v;													\
+			if (!arr_isvalid(a, i)) {									\
+				o[i] = TPE##_nil;										\
+				nonil = 0;												\
+			} else if (a->kind == ARR_FLOAT && a->width == 4) {		\
+				o[i] = (TPE) ((const flt *) a->values)[i];				\
+			} else if (a->kind == ARR_FLOAT && a->width == 8) {		\
+				o[i] = (TPE) ((const dbl *) a->values)[i];				\
+			} else if (a->kind == ARR_INT && arr_get(a, i, &v)) {		\
+				o[i] = (TPE) ((dbl) v / (dbl) arr_pow10(a->scale));		\
+			} else {													\
+				return arr_error(b, c, fname, BUN_NONE, "incompatible column type"); \
+			}															\
+			nonil &= !is_##TPE##_nil(o[i]);								\
+		}																\
+	} while (0)
+
+/* Append the values of array a to b, the BAT of column c. */
+str
+arrow_append(BAT *b, sql_column *c, const arr_array *a, const char *fname)
+{
+	int tpe = c->type.type->localtype;
+	int scale = c->type.type->eclass == EC_DEC ? (int) c->type.scale : 0;
+	arr_int maxval = 0;
+	BUN i, cnt = BATcount(b);
+	int nonil = 1;
+	date epoch = MTIMEtodate(1, 1, 1970);
+
+	if (a->count == 0)
+		return MAL_SUCCEED;
+	if (c->type.type->eclass == EC_DEC && c->type.digits <= ARR_MAXDIGITS)
+		maxval = arr_pow10((int) c->type.digits);
+	if (!ATOMvarsized(tpe) && BATcapacity(b) < cnt + a->count &&
+		BATextend(b, cnt + a->count) != GDK_SUCCEED)
+		throw(SQL, "arrow.copy_from", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+
+	if (tpe == TYPE_bte) {
+		APPEND_INT(bte, GDK_bte_max);
+	} else if (tpe == TYPE_sht) {
+		APPEND_INT(sht, GDK_sht_max);
+	} else if (tpe == TYPE_int) {
+		APPEND_INT(int, GDK_int_max);
+	} else if (tpe == TYPE_lng) {
+		APPEND_INT(lng, GDK_lng_max);
+#ifdef HAVE_HGE
+	} else if (tpe == TYPE_hge) {
+		APPEND_INT(hge, GDK_hge_max);
+#endif
+	} else if (tpe == TYPE_flt) {
+		APPEND_FLT(flt);
+	} else if (tpe == TYPE_dbl) {
+		APPEND_FLT(dbl);
+	} else if (tpe == TYPE_bit) {
+		bit *o = (bit *) Tloc(b, cnt);
+
+		if (a->kind != ARR_BOOL)
+			return arr_error(b, c, fname, BUN_NONE, "incompatible column type");
+		for (i = 0; i < a->count; i++) {
+			const uint8_t *bits = a->values;
+
+			if (!arr_isvalid(a, i)) {
+				o[i] = bit_nil;
+				nonil = 0;
+			} else {
+				o[i] = (bits[i >> 3] >> (i & 7)) & 1;
+			}
+		}
+	} else if (tpe == TYPE_date) {
+		date *o = (date *) Tloc(b, cnt);
+		date dmin = MTIMEtodate(1, 1, -5867411), dmax = MTIMEtodate(31, 12, 5867411);
+
+		if (a->kind != ARR_DATE)
+			return arr_error(b, c, fname, BUN_NONE, "incompatible column type");
+		for (i = 0; i < a->count; i++) {
+			arr_int v;
+			lng d;
+
+			if (!arr_isvalid(a, i)) {
+				o[i] = date_nil;
+				nonil = 0;
+				continue;
+			}
+			if (!arr_get(a, i, &v))
+				return arr_error(b, c, fname, i, "value out of range");
+			d = arr_floordiv((lng) v, a->unit) + epoch;
+			if (d < dmin || d > dmax)
+				return arr_error(b, c, fname, i, "value out of range");
+			o[i] = (date) d;
+		}
+	} else if (tpe == TYPE_daytime) {
+		daytime *o = (daytime *) Tloc(b, cnt);
+
+		if (a->kind != ARR_TIME)
+			return arr_error(b, c, fname, BUN_NONE, "incompatible column type");
+		for (i = 0; i < a->count; i++) {
+			arr_int v;
+			lng ms;
+
+			if (!arr_isvalid(a, i)) {
+				o[i] = daytime_nil;
+				nonil = 0;
+				continue;
+			}
+			if (!arr_get(a, i, &v))
+				return arr_error(b, c, fname, i, "value out of range");
+			ms = a->unit >= 1000 ? (lng) v / (a->unit / 1000) : (lng) v * 1000;
+			if (ms < 0 || ms >= 24 * 60 * 60 * 1000)
+				return arr_error(b, c, fname, i, "value out of range");
+			o[i] = (daytime) ms;
+		}
+	} else if (tpe == TYPE_timestamp) {
+		timestamp *o = (timestamp *) Tloc(b, cnt);
+
+		if (a->kind != ARR_TIMESTAMP && a->kind != ARR_DATE)
+			return arr_error(b, c, fname, BUN_NONE, "incompatible column type");
+		for (i = 0; i < a->count; i++) {
+			arr_int v;
+			lng ms, d;
+			date dt;
+			daytime t;
+
+			if (!arr_isvalid(a, i)) {
+				o[i] = *timestamp_nil;
+				nonil = 0;
+				continue;
+			}
+			if (!arr_get(a, i, &v))
+				return arr_error(b, c, fname, i, "value out of range");
+			if (a->kind == ARR_DATE) {
+				d = arr_floordiv((lng) v, a->unit);
+				ms = 0;
+			} else {
+				ms = a->unit >= 1000 ? arr_floordiv((lng) v, a->unit / 1000) : (lng) v * 1000;
+				d = arr_floordiv(ms, 24 * 60 * 60 * 1000);
+				ms -= d * 24 * 60 * 60 * 1000;
+			}
+			dt = (date) (d + epoch);
+			t = (daytime) ms;
+			if (a->utc && a->kind == ARR_TIMESTAMP) {
+				o[i].days = dt;
+				o[i].msecs = t;
+			} else {
+				MTIMEtimestamp_create_default(&o[i], &dt, &t);
+			}
+		}
+	} else if (tpe == TYPE_oid) {
+		/* a column that is skipped */
+		oid *o = (oid *) Tloc(b, cnt);
+
+		for (i = 0; i < a->count; i++)
+			o[i] = oid_nil;
+		nonil = 0;
+	} else if (tpe == TYPE_str) {
+		char *buf = NULL;
+		size_t buflen = 0;
+
+		if (a->kind != ARR_STRING)
+			return arr_error(b, c, fname, BUN_NONE, "incompatible column type");
+		for (i = 0; i < a->count; i++) {
+			lng start, end;
+			const char *v = str_nil;
+
+			if (arr_isvalid(a, i)) {
+				int len;
+
+				if (a->width == 4) {
+					start = ((const int *) a->offsets)[i];
+					end = ((const int *) a->offsets)[i + 1];
+				} else {
+					start = ((const lng *) a->offsets)[i];
+					end = ((const lng *) a->offsets)[i + 1];
+				}
+				if (start < 0 || end < start || (size_t) end > a->size) {
+					GDKfree(buf);
+					return arr_error(b, c, fname, i, "corrupt string offsets");
+				}
+				if ((size_t) (end - start) >= buflen) {
+					char *nbuf;
+
+					buflen = (size_t) (end - start) + 1024;
+					if ((nbuf = GDKrealloc(buf, buflen)) == NULL) {
+						GDKfree(buf);
+						throw(SQL, "arrow.copy_from", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+					}
+					buf = nbuf;
+				}
+				memcpy(buf, (const char *) a->values + start, (size_t) (end - start));
+				buf[end - start] = 0;
+				v = buf;
+				if (c->type.digits > 0 && (size_t) (end - start) > c->type.digits) {
+					STRLength(&len, (const str *) &v);
+					if (len > (int) c->type.digits) {
+						GDKfree(buf);
+						return arr_error(b, c, fname, i, "value too long for type");
+					}
+				}
+			}
+			if (BUNappend(b, v, FALSE) != GDK_SUCCEED) {
+				GDKfree(buf);
+				throw(SQL, "arrow.copy_from", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+			}
+		}
+		GDKfree(buf);
+		return MAL_SUCCEED;
+	} else {
+		return arr_error(b, c, fname, BUN_NONE, "column type not supported");
+	}
+
+	BATsetcount(b, cnt + a->count);
+	if (BATcount(b) > 1) {
+		b->tsorted = b->trevsorted = 0;
+		b->tkey = 0;
+		b->tnosorted = b->tnorevsorted = 0;
+		b->tnokey[0] = b->tnokey[1] = 0;
+	}
+	b->tnonil = (cnt == 0 || b->tnonil) && nonil;
+	b->tnil = (cnt > 0 && b->tnil) || !nonil;
+	return MAL_SUCCEED;
+}
+
+/* Append the rows of array a starting at row first, where a->count
+ * counts the rows from first onwards. */
+str
+arrow_append_range(BAT *b, sql_column *c, const arr_array *a, BUN first, const char *fname)
+{
+	arr_array s = *a;
+	uint8_t *valid = NULL, *bits = NULL;
+	BUN j;
+	str msg;
+
+	if (first == 0)
+		return arrow_append(b, c, a, fname);
+	/* realign the bitmaps of the rows that are left */
+	if (a->valid || a->kind == ARR_BOOL) {
+		if ((valid = GDKzalloc((a->count + 7) / 8 * 2)) == NULL)
+			throw(SQL, "arrow.copy_from", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		bits = valid + (a->count + 7) / 8;
+		for (j = 0; j < a->count; j++) {
+			if (a->valid && arr_isvalid(a, j + first))
+				valid[j >> 3] |= 1 << (j & 7);
+			if (a->kind == ARR_BOOL && ((((const uint8_t *) a->values)[(j + first) >> 3] >> ((j + first) & 7)) & 1))
+				bits[j >> 3] |= 1 << (j & 7);
+		}
+		if (a->valid)
+			s.valid = valid;
+	}
+	if (a->kind == ARR_BOOL)
+		s.values = bits;
+	else if (a->kind == ARR_STRING)
+		s.offsets = (const char *) a->offsets + first * a->width;
+	else
+		s.values = (const char *) a->values + first * a->width;
+	msg = arrow_append(b, c, &s, fname);
+	GDKfree(valid);
+	return msg;
+}
+
+/*
+ * FlatBuffers
+ * A table starts with the signed offset back to its vtable, which
+ * lists the offsets of the fields within the table (0 if absent).
+ * Offsets to other tables, vectors and strings are unsigned and
+ * relative to where they are stored.  All positions are checked
+ * against the size of the buffer.
+ */
+typedef struct {
+	const uint8_t *p;
+	size_t len;
+	int err;
+} fbuf;
+
+static inline uint64_t
+fb_uint(fbuf *f, size_t pos, int size)
+{
+	uint64_t v = 0;
+
+	if (pos + size > f->len || pos + size < pos) {
+		f->err = 1;
+		return 0;
+	}
+	memcpy(&v, f->p + pos, size);
+	return v;
+}
+
+/* the position of field id of the table at tbl, 0 if absent */
+static size_t
+fb_field(fbuf *f, size_t tbl, int id)
+{
+	size_t vt;
+	uint16_t vtsize, off;
+
+	if (tbl == 0)
+		return 0;
+	vt = tbl - (size_t) (int32_t) fb_uint(f, tbl, 4);
+	vtsize = (uint16_t) fb_uint(f, vt, 2);
+	if (f->err || 4 + 2 * (size_t) id >= vtsize)
+		return 0;
+	off = (uint16_t) fb_uint(f, vt + 4 + 2 * id, 2);
+	return off ? tbl + off : 0;
+}
+
+/* the target of the offset stored in field id */
+static size_t
+fb_ref(fbuf *f, size_t tbl, int id)
+{
+	size_t pos = fb_field(f, tbl, id);
+	size_t ref;
+
+	if (pos == 0)
+		return 0;
+	ref = pos + (size_t) fb_uint(f, pos, 4);
+	if (ref >= f->len) {
+		f->err = 1;
+		return 0;
+	}
+	return ref;
+}
+
+static int64_t
+fb_scalar(fbuf *f, size_t tbl, int id, int size, int64_t dflt)
+{
+	size_t pos = fb_field(f, tbl, id);
+	uint64_t v;
+
+	if (pos == 0)
+		return dflt;
+	v = fb_uint(f, pos, size);
+	switch (size) {
+	case 1:
+		return (int8_t) v;
+	case 2:
+		return (int16_t) v;
+	case 4:
+		return (int32_t) v;
+	}
+	return (int64_t) v;
+}
+
+/* length of the vector (or string) at vec */
+static size_t
+fb_veclen(fbuf *f, size_t vec)
+{
+	return vec ? (size_t) fb_uint(f, vec, 4) : 0;
+}
+
+/* element i of a vector of tables */
+static size_t
+fb_vectable(fbuf *f, size_t vec, size_t i)
+{
+	size_t pos = vec + 4 + 4 * i;
+
+	return pos + (size_t) fb_uint(f, pos, 4);
+}
+
+/* Arrow Schema.fbs */
+#define AT_INT			2
+#define AT_FLOAT		3
+#define AT_BINARY		4
+#define AT_UTF8			5
+#define AT_BOOL			6
+#define AT_DECIMAL		7
+#define AT_DATE			8
+#define AT_TIME			9
+#define AT_TIMESTAMP	10
+#define AT_LARGEBINARY	19
+#define AT_LARGEUTF8	20
+
+/* Arrow Message.fbs */
+#define AM_SCHEMA		1
+#define AM_DICTIONARY	2
+#define AM_RECORDBATCH	3
+
+static const lng arr_units[4] = { 1, 1000, 1000000, 1000000000 };
+
+/* derive the array layout of an Arrow field */
+static str
+arrow_field(fbuf *f, size_t field, arr_array *a, int *nbufs, const char *fname)
+{
+	int type = (int) fb_scalar(f, field, 2, 1, 0);
+	size_t tp = fb_ref(f, field, 3);
+	size_t name = fb_ref(f, field, 0);
+	int unit;
+
+	memset(a, 0, sizeof(*a));
+	*nbufs = 2;
+	if (fb_ref(f, field, 4) || fb_veclen(f, fb_ref(f, field, 5)) > 0)
+		throw(SQL, "arrow.copy_from", SQLSTATE(42000) "file '%s': nested and dictionary encoded fields are not supported", fname);
+	switch (type) {
+	case AT_INT:
+		a->kind = ARR_INT;
+		a->width = (int) fb_scalar(f, tp, 0, 4, 0) / 8;
+		a->is_signed = (int) fb_scalar(f, tp, 1, 1, 0);
+		if (a->width != 1 && a->width != 2 && a->width != 4 && a->width != 8)
+			break;
+		return MAL_SUCCEED;
+	case AT_FLOAT:
+		a->kind = ARR_FLOAT;
+		switch (fb_scalar(f, tp, 0, 2, 0)) {
+		case 1:
+			a->width = 4;
+			return MAL_SUCCEED;
+		case 2:
+			a->width = 8;
+			return MAL_SUCCEED;
+		}
+		break;
+	case AT_DECIMAL:
+		a->kind = ARR_INT;
+		a->is_signed = 1;
+		a->scale = (int) fb_scalar(f, tp, 1, 4, 0);
+		a->width = (int) fb_scalar(f, tp, 2, 4, 128) / 8;
+		if (a->width != 16 || a->scale < 0 || a->scale > ARR_MAXDIGITS)
+			break;
+		return MAL_SUCCEED;
+	case AT_BOOL:
+		a->kind = ARR_BOOL;
+		return MAL_SUCCEED;
+	case AT_DATE:
+		a->kind = ARR_DATE;
+		a->is_signed = 1;
+		if (fb_scalar(f, tp, 0, 2, 1) == 0) {
+			a->width = 4;
+			a->unit = 1;
+		} else {
+			a->width = 8;
+			a->unit = 24 * 60 * 60 * 1000;
+		}
+		return MAL_SUCCEED;
+	case AT_TIME:
+	case AT_TIMESTAMP:
+		a->kind = type == AT_TIME ? ARR_TIME : ARR_TIMESTAMP;
+		a->is_signed = 1;
+		unit = (int) fb_scalar(f, tp, 0, 2, type == AT_TIME ? 1 : 0);
+		if (unit < 0 || unit > 3)
+			break;
+		a->unit = arr_units[unit];
+		a->width = type == AT_TIME ? (int) fb_scalar(f, tp, 1, 4, 32) / 8 : 8;
+		a->utc = type == AT_TIMESTAMP && fb_ref(f, tp, 1) != 0;
+		return MAL_SUCCEED;
+	case AT_UTF8:
+	case AT_BINARY:
+		a->kind = ARR_STRING;
+		a->width = 4;
+		*nbufs = 3;
+		return MAL_SUCCEED;
+	case AT_LARGEUTF8:
+	case AT_LARGEBINARY:
+		a->kind = ARR_STRING;
+		a->width = 8;
+		*nbufs = 3;
+		return MAL_SUCCEED;
+	}
+	throw(SQL, "arrow.copy_from", SQLSTATE(42000) "file '%s': type of field '%.*s' is not supported",
+		  fname, (int) fb_veclen(f, name), name ? (const char *) f->p + name + 4 : "");
+}
+
+/* the body buffer i of a record batch, checked to hold len bytes */
+static const void *
+arrow_buffer(fbuf *f, size_t buffers, size_t body, size_t i, size_t len)
+{
+	size_t pos = buffers + 4 + 16 * i;
+	uint64_t off = fb_uint(f, pos, 8);
+	uint64_t blen = fb_uint(f, pos + 8, 8);
+
+	if (f->err || i >= fb_veclen(f, buffers) || blen < len ||
+		off > f->len || body + off + len > f->len || body + off + len < body) {
+		f->err = 1;
+		return NULL;
+	}
+	return f->p + body + off;
+}
+
+static str
+arrow_batch(fbuf *f, size_t batch, size_t body, arr_array *fields, int *nbufs, BAT **bats, sql_table *t, BUN *skip, BUN *todo, const char *fname)
+{
+	size_t nodes = fb_ref(f, batch, 1);
+	size_t buffers = fb_ref(f, batch, 2);
+	BUN length = (BUN) fb_scalar(f, batch, 0, 8, 0);
+	BUN first, count;
+	size_t bufno = 0;
+	node *n;
+	int i;
+	str msg = MAL_SUCCEED;
+
+	if (fb_ref(f, batch, 3))
+		throw(SQL, "arrow.copy_from", SQLSTATE(42000) "file '%s': compressed record batches are not supported", fname);
+	if (fb_veclen(f, nodes) != (size_t) list_length(t->columns.set))
+		throw(SQL, "arrow.copy_from", SQLSTATE(42000) "file '%s': record batch does not match the schema", fname);
+	first = *skip < length ? *skip : length;
+	*skip -= first;
+	count = length - first;
+	if (count > *todo)
+		count = *todo;
+	*todo -= count;
+	for (n = t->columns.set->h, i = 0; n; n = n->next, i++) {
+		arr_array a = fields[i];
+		size_t fn = nodes + 4 + 16 * i;
+		BUN nulls = (BUN) fb_uint(f, fn + 8, 8);
+		size_t vlen;
+
+		if ((BUN) fb_uint(f, fn, 8) != length)
+			f->err = 1;
+		if (count == 0) {
+			bufno += nbufs[i];
+			continue;
+		}
+		a.count = count;
+		a.valid = nulls ? arrow_buffer(f, buffers, body, bufno, (first + count + 7) / 8) : NULL;
+		bufno++;
+		if (a.kind == ARR_BOOL) {
+			vlen = (first + count + 7) / 8;
+		} else if (a.kind == ARR_STRING) {
+			a.offsets = arrow_buffer(f, buffers, body, bufno++, (length + 1) * a.width);
+			if (a.offsets == NULL)
+				break;
+			vlen = (size_t) (a.width == 4 ? ((const int *) a.offsets)[length] : ((const lng *) a.offsets)[length]);
+			a.size = vlen;
+		} else {
+			vlen = length * a.width;
+		}
+		a.values = arrow_buffer(f, buffers, body, bufno++, vlen);
+		if (f->err)
+			break;
+		msg = arrow_append_range(bats[i], n->data, &a, first, fname);
+		if (msg)
+			return msg;
+	}
+	if (f->err)
+		throw(SQL, "arrow.copy_from", SQLSTATE(42000) "file '%s': corrupt record batch", fname);
+	return MAL_SUCCEED;
+}
+
+/*
+ * An Arrow IPC stream is a sequence of messages, each a FlatBuffer
+ * with the metadata followed by a body with the buffers.  The file
+ * variant wraps the stream between "ARROW1" magic and adds a footer,
+ * which we do not need since the messages are read in order.
+ */
+str
+ARROWload(BAT **bats, sql_table *t, const char *fname, lng nr, lng offset)
+{
+	struct stat st;
+	void *map;
+	fbuf f;
+	size_t pos = 0;
+	int ncols = list_length(t->columns.set), i;
+	arr_array *fields = NULL;
+	int *nbufs = NULL;
+	BUN skip = offset > 0 ? (BUN) offset - 1 : 0;
+	BUN todo = nr < 0 ? BUN_MAX : (BUN) nr;
+	str msg = MAL_SUCCEED;
+
+	if (stat(fname, &st) < 0 || st.st_size == 0)
+		throw(SQL, "arrow.copy_from", SQLSTATE(42000) "Cannot open file '%s'", fname);
+	if ((map = MT_mmap(fname, MMAP_READ | MMAP_SEQUENTIAL, (size_t) st.st_size)) == NULL)
+		throw(SQL, "arrow.copy_from", SQLSTATE(42000) "Cannot map file '%s'", fname);
+	f.p = map;
+	f.len = (size_t) st.st_size;
+	f.err = 0;
+	if (f.len >= 8 && memcmp(f.p, "ARROW1", 6) == 0)
+		pos = 8;
+
+	while (todo > 0 && msg == MAL_SUCCEED) {
+		size_t meta, body, len, root;
+		lng bodylen;
+
+		len = (size_t) fb_uint(&f, pos, 4);
+		if (f.err)
+			break;
+		if (len == 0xFFFFFFFF) {
+			/* continuation marker of the current format */
+			len = (size_t) fb_uint(&f, pos + 4, 4);
+			pos += 8;
+		} else {
+			pos += 4;
+		}
+		if (len == 0 || f.err)
+			break;
+		meta = pos;
+		body = pos + len;
+		root = meta + (size_t) fb_uint(&f, meta, 4);
+		bodylen = fb_scalar(&f, root, 3, 8, 0);
+		if (f.err || body > f.len || bodylen < 0 || (uint64_t) bodylen > f.len - body) {
+			f.err = 1;
+			break;
+		}
+		switch (fb_scalar(&f, root, 1, 1, 0)) {
+		case AM_SCHEMA: {
+			size_t schema = fb_ref(&f, root, 2);
+			size_t vec = fb_ref(&f, schema, 1);
+
+			if (fields)
+				break;
+			if (fb_veclen(&f, vec) != (size_t) ncols) {
+				msg = createException(SQL, "arrow.copy_from", SQLSTATE(42000) "file '%s' has %zu columns, table '%s' has %d",
+									  fname, fb_veclen(&f, vec), t->base.name, ncols);
+				break;
+			}
+			fields = GDKzalloc(ncols * sizeof(arr_array));
+			nbufs = GDKzalloc(ncols * sizeof(int));
+			if (fields == NULL || nbufs == NULL) {
+				msg = createException(SQL, "arrow.copy_from", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+				break;
+			}
+			for (i = 0; i < ncols && msg == MAL_SUCCEED; i++)
+				msg = arrow_field(&f, fb_vectable(&f, vec, i), &fields[i], &nbufs[i], fname);
+			break;
+		}
+		case AM_DICTIONARY:
+			msg = createException(SQL, "arrow.copy_from", SQLSTATE(42000) "file '%s': dictionary batches are not supported", fname);
+			break;
+		case AM_RECORDBATCH:
+			if (fields == NULL) {
+				f.err = 1;
+				break;
+			}
+			msg = arrow_batch(&f, fb_ref(&f, root, 2), body, fields, nbufs, bats, t, &skip, &todo, fname);
+			break;
+		}
+		if (f.err)
+			break;
+		pos = body + (size_t) bodylen;
+	}
+	if (msg == MAL_SUCCEED && (f.err || fields == NULL))
+		msg = createException(SQL, "arrow.copy_from", SQLSTATE(42000) "file '%s' is not a valid Arrow file", fname);
+	GDKfree(fields);
+	GDKfree(nbufs);
+	MT_munmap(map, (size_t) st.st_size);
+	return msg;
+}
+
+str
+ARROWcopy_from(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
+{
+	sql_table *t = *(sql_table **) getArgReference(stk, pci, pci->retc + 0);
+	const char *fname = *getArgReference_str(stk, pci, pci->retc + 1);
+	lng nr = *getArgReference_lng(stk, pci, pci->retc + 2);
+	lng offset = *getArgReference_lng(stk, pci, pci->retc + 3);
+	int ncols = list_length(t->columns.set), i;
+	char magic[4];
+	BAT **bats;
+	node *n;
+	FILE *fp;
+	str msg;
+
+	(void) mb;
+	if ((msg = checkSQLContext(cntxt)) != NULL)
+		return msg;
+	if (pci->retc != ncols)
+		throw(SQL, "arrow.copy_from", SQLSTATE(42000) "Wrong number of result columns");
+#ifdef WORDS_BIGENDIAN
+	throw(SQL, "arrow.copy_from", SQLSTATE(42000) "Arrow and Parquet files are only supported on little-endian machines");
+#endif
+	if ((fp = fopen(fname, "rb")) == NULL)
+		throw(SQL, "arrow.copy_from", SQLSTATE(42000) "Cannot open file '%s': %s", fname, strerror(errno));
+	if (fread(magic, 1, sizeof(magic), fp) != sizeof(magic))
+		memset(magic, 0, sizeof(magic));
+	fclose(fp);
+
+	if ((bats = GDKzalloc(ncols * sizeof(BAT *))) == NULL)
+		throw(SQL, "arrow.copy_from", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	for (n = t->columns.set->h, i = 0; n; n = n->next, i++) {
+		if ((bats[i] = arrow_column(n->data, 0)) == NULL) {
+			msg = createException(SQL, "arrow.copy_from", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+			break;
+		}
+	}
+	if (msg == MAL_SUCCEED) {
+		if (memcmp(magic, "PAR1", 4) == 0)
+			msg = PARQUETload(bats, t, fname, nr, offset);
+		else
+			msg = ARROWload(bats, t, fname, nr, offset);
+	}
+	for (i = 0; i < ncols; i++) {
+		if (bats[i] == NULL)
+			continue;
+		if (msg == MAL_SUCCEED) {
+			BATsettrivprop(bats[i]);
+			*getArgReference_bat(stk, pci, i) = bats[i]->batCacheid;
+			BBPkeepref(bats[i]->batCacheid);
+		} else {
+			BBPunfix(bats[i]->batCacheid);
+		}
+	}
+	GDKfree(bats);
+	return msg;
+}
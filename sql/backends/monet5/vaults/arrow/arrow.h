@@ -0,0 +1,63 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+#ifndef _ARROW_H_
+#define _ARROW_H_
+#include "sql.h"
+#include "mal_exception.h"
+
+#ifdef WIN32
+#ifndef LIBARROW
+#define arrow_export extern __declspec(dllimport)
+#else
+#define arrow_export extern __declspec(dllexport)
+#endif
+#else
+#define arrow_export extern
+#endif
+
+arrow_export str ARROWcopy_from(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci);
+
+/*
+ * Both file formats are decoded into arrays in the Arrow in-memory
+ * layout, which are then appended to the BATs of the table columns.
+ * An array holds count values of one of the kinds below; row i is
+ * NULL when bit i of the validity bitmap is not set.
+ */
+typedef enum {
+	ARR_INT,		/* integers of width bytes, with scale decimals */
+	ARR_FLOAT,		/* IEEE floats of width bytes */
+	ARR_BOOL,		/* bitmap */
+	ARR_DATE,		/* integers, unit per day since 1970-01-01 */
+	ARR_TIME,		/* integers, unit per second since midnight */
+	ARR_TIMESTAMP,	/* integers, unit per second since 1970-01-01 */
+	ARR_STRING,		/* offsets of width bytes into data */
+} arr_kind;
+
+typedef struct {
+	arr_kind kind;
+	int width;
+	int is_signed;
+	int scale;
+	lng unit;
+	int utc;				/* timestamps are instants, not wall clock times */
+	const void *values;
+	const void *offsets;
+	size_t size;			/* bytes of string data */
+	const uint8_t *valid;
+	BUN count;
+} arr_array;
+
+extern str arrow_append(BAT *b, sql_column *c, const arr_array *a, const char *fname);
+extern str arrow_append_range(BAT *b, sql_column *c, const arr_array *a, BUN first, const char *fname);
+extern BAT *arrow_column(sql_column *c, BUN cap);
+
+extern str ARROWload(BAT **bats, sql_table *t, const char *fname, lng nr, lng offset);
+extern str PARQUETload(BAT **bats, sql_table *t, const char *fname, lng nr, lng offset);
+
+#endif /* _ARROW_H_ */
@@ -0,0 +1,1338 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+/*
+ * Parquet reader
+ * A Parquet file ends in a footer with the schema and the location of
+ * the column chunks of each row group, encoded with the Thrift compact
+ * protocol.  The leaf columns of a flat schema are decoded row group
+ * by row group into arrays in the Arrow layout, which are appended to
+ * the BATs of the table like the Arrow record batches.  A wave of row
+ * groups is decoded in parallel, one thread per row group, before
+ * they are appended in file order.
+ *
+ * Supported are the PLAIN and dictionary encodings, optional (but not
+ * repeated) columns, and uncompressed, Snappy and (when MonetDB is
+ * built with zlib) gzip compressed pages.
+ */
+#include "monetdb_config.h"
+#include "arrow.h"
+#include "gdk_posix.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+/* parquet.thrift */
+#define PT_BOOLEAN		0
+#define PT_INT32		1
+#define PT_INT64		2
+#define PT_INT96		3
+#define PT_FLOAT		4
+#define PT_DOUBLE		5
+#define PT_BYTE_ARRAY	6
+#define PT_FIXED		7
+
+#define PC_UTF8				0
+#define PC_DECIMAL			5
+#define PC_DATE				6
+#define PC_TIME_MILLIS		7
+#define PC_TIME_MICROS		8
+#define PC_TIMESTAMP_MILLIS	9
+#define PC_TIMESTAMP_MICROS	10
+#define PC_UINT_8			11
+#define PC_UINT_64			14
+#define PC_INT_8			15
+#define PC_INT_64			18
+
+#define PL_STRING		1
+#define PL_DECIMAL		5
+#define PL_DATE			6
+#define PL_TIME			7
+#define PL_TIMESTAMP	8
+#define PL_INTEGER		10
+
+#define PE_PLAIN			0
+#define PE_PLAIN_DICTIONARY	2
+#define PE_RLE				3
+#define PE_RLE_DICTIONARY	8
+
+#define PP_DATA			0
+#define PP_DICTIONARY	2
+#define PP_DATA_V2		3
+
+#define PZ_UNCOMPRESSED	0
+#define PZ_SNAPPY		1
+#define PZ_GZIP			2
+
+/*
+ * Thrift compact protocol
+ * Integers are zigzag encoded varints, a field header holds the delta
+ * to the previous field id and the type, booleans are stored in the
+ * type of their field header.
+ */
+#define TC_TRUE		1
+#define TC_FALSE	2
+#define TC_BYTE		3
+#define TC_I16		4
+#define TC_I32		5
+#define TC_I64		6
+#define TC_DOUBLE	7
+#define TC_BINARY	8
+#define TC_LIST		9
+#define TC_SET		10
+#define TC_MAP		11
+#define TC_STRUCT	12
+
+typedef struct {
+	const uint8_t *p, *end;
+	int depth;
+	int err;
+} tcbuf;
+
+static uint64_t
+tc_varint(tcbuf *t)
+{
+	uint64_t v = 0;
+	int shift = 0;
+
+	while (t->p < t->end && shift < 64) {
+		uint8_t b = *t->p++;
+
+		v |= (uint64_t) (b & 0x7F) << shift;
+		if ((b & 0x80) == 0)
+			return v;
+		shift += 7;
+	}
+	t->err = 1;
+	return 0;
+}
+
+static int64_t
+tc_int(tcbuf *t)
+{
+	uint64_t v = tc_varint(t);
+
+	return (int64_t) (v >> 1) ^ -(int64_t) (v & 1);
+}
+
+/* the id of the next field of a struct, 0 at its end */
+static int
+tc_field(tcbuf *t, int *last, int *type)
+{
+	uint8_t b;
+
+	if (t->p >= t->end) {
+		t->err = 1;
+		return 0;
+	}
+	b = *t->p++;
+	if (b == 0)
+		return 0;
+	*type = b & 0x0F;
+	if (b >> 4)
+		*last += b >> 4;
+	else
+		*last = (int) tc_int(t);
+	return t->err ? 0 : *last;
+}
+
+static size_t
+tc_list(tcbuf *t, int *etype)
+{
+	uint8_t b;
+	size_t n;
+
+	if (t->p >= t->end) {
+		t->err = 1;
+		return 0;
+	}
+	b = *t->p++;
+	*etype = b & 0x0F;
+	n = b >> 4;
+	if (n == 15)
+		n = (size_t) tc_varint(t);
+	if (n > (size_t) (t->end - t->p)) {
+		/* every element takes at least a byte */
+		t->err = 1;
+		return 0;
+	}
+	return n;
+}
+
+static const uint8_t *
+tc_binary(tcbuf *t, size_t *len)
+{
+	const uint8_t *p;
+
+	*len = (size_t) tc_varint(t);
+	if (t->err || *len > (size_t) (t->end - t->p)) {
+		t->err = 1;
+		return NULL;
+	}
+	p = t->p;
+	t->p += *len;
+	return p;
+}
+
+static void tc_skip(tcbuf *t, int type, int inlist);
+
+static void
+tc_skipstruct(tcbuf *t)
+{
+	int last = 0, type;
+
+	if (++t->depth > 64) {
+		t->err = 1;
+		return;
+	}
+	while (!t->err && tc_field(t, &last, &type) != 0)
+		tc_skip(t, type, 0);
+	t->depth--;
+}
+
+static void
+tc_skip(tcbuf *t, int type, int inlist)
+{
+	size_t n, len;
+	int etype;
+
+	switch (type) {
+	case TC_TRUE:
+	case TC_FALSE:
+		/* in a list, booleans take a byte */
+		if (inlist)
+			t->p++;
+		break;
+	case TC_BYTE:
+		t->p++;
+		break;
+	case TC_I16:
+	case TC_I32:
+	case TC_I64:
+		(void) tc_varint(t);
+		break;
+	case TC_DOUBLE:
+		t->p += 8;
+		break;
+	case TC_BINARY:
+		(void) tc_binary(t, &len);
+		break;
+	case TC_LIST:
+	case TC_SET:
+		n = tc_list(t, &etype);
+		while (n-- > 0 && !t->err)
+			tc_skip(t, etype, 1);
+		break;
+	case TC_MAP:
+		n = (size_t) tc_varint(t);
+		if (n > 0 && t->p < t->end) {
+			uint8_t kv = *t->p++;
+
+			while (n-- > 0 && !t->err) {
+				tc_skip(t, kv >> 4, 1);
+				tc_skip(t, kv & 0x0F, 1);
+			}
+		}
+		break;
+	case TC_STRUCT:
+		tc_skipstruct(t);
+		break;
+	default:
+		t->err = 1;
+	}
+	if (t->p > t->end)
+		t->err = 1;
+}
+
+typedef struct {
+	int type;
+	int type_length;
+	int repetition;
+	int num_children;
+	int converted;
+	int scale;
+	int logical;
+	int unit;					/* of TIME and TIMESTAMP, 1 millis, 2 micros, 3 nanos */
+	int utc;
+	int width;					/* of INTEGER */
+	int is_signed;
+	const uint8_t *name;
+	size_t namelen;
+} pq_schema;
+
+typedef struct {
+	int type;
+	int codec;
+	lng num_values;
+	lng data_page_offset;
+	lng dictionary_page_offset;
+	int external;
+} pq_chunk;
+
+typedef struct {
+	lng num_rows;
+	pq_chunk *chunks;
+	int nchunks;
+} pq_rowgroup;
+
+typedef struct {
+	pq_schema *schema;
+	int nschema;
+	lng num_rows;
+	pq_rowgroup *rowgroups;
+	int nrowgroups;
+} pq_meta;
+
+static void
+pq_timeunit(tcbuf *t, pq_schema *s)
+{
+	int last = 0, type, id;
+
+	while ((id = tc_field(t, &last, &type)) != 0) {
+		if (type == TC_STRUCT && id >= 1 && id <= 3)
+			s->unit = id;
+		tc_skip(t, type, 0);
+	}
+}
+
+static void
+pq_logical(tcbuf *t, pq_schema *s)
+{
+	int last = 0, type, id, l, ltype;
+
+	while ((id = tc_field(t, &last, &type)) != 0) {
+		if (type != TC_STRUCT) {
+			tc_skip(t, type, 0);
+			continue;
+		}
+		s->logical = id;
+		l = 0;
+		while ((id = tc_field(t, &l, &ltype)) != 0) {
+			if (s->logical == PL_DECIMAL && id == 1 && ltype == TC_I32)
+				s->scale = (int) tc_int(t);
+			else if ((s->logical == PL_TIME || s->logical == PL_TIMESTAMP) && id == 1 && (ltype == TC_TRUE || ltype == TC_FALSE))
+				s->utc = ltype == TC_TRUE;
+			else if ((s->logical == PL_TIME || s->logical == PL_TIMESTAMP) && id == 2 && ltype == TC_STRUCT)
+				pq_timeunit(t, s);
+			else if (s->logical == PL_INTEGER && id == 1 && ltype == TC_BYTE && t->p < t->end)
+				s->width = (int8_t) *t->p++ / 8;
+			else if (s->logical == PL_INTEGER && id == 2 && (ltype == TC_TRUE || ltype == TC_FALSE))
+				s->is_signed = ltype == TC_TRUE;
+			else
+				tc_skip(t, ltype, 0);
+		}
+	}
+}
+
+static void
+pq_schemaelement(tcbuf *t, pq_schema *s)
+{
+	int last = 0, type, id;
+
+	memset(s, 0, sizeof(*s));
+	s->type = -1;
+	s->converted = -1;
+	while ((id = tc_field(t, &last, &type)) != 0) {
+		if (id == 1 && type == TC_I32)
+			s->type = (int) tc_int(t);
+		else if (id == 2 && type == TC_I32)
+			s->type_length = (int) tc_int(t);
+		else if (id == 3 && type == TC_I32)
+			s->repetition = (int) tc_int(t);
+		else if (id == 4 && type == TC_BINARY)
+			s->name = tc_binary(t, &s->namelen);
+		else if (id == 5 && type == TC_I32)
+			s->num_children = (int) tc_int(t);
+		else if (id == 6 && type == TC_I32)
+			s->converted = (int) tc_int(t);
+		else if (id == 7 && type == TC_I32)
+			s->scale = (int) tc_int(t);
+		else if (id == 10 && type == TC_STRUCT)
+			pq_logical(t, s);
+		else
+			tc_skip(t, type, 0);
+	}
+}
+
+static void
+pq_columnchunk(tcbuf *t, pq_chunk *c)
+{
+	int last = 0, type, id, l, ltype;
+
+	memset(c, 0, sizeof(*c));
+	while ((id = tc_field(t, &last, &type)) != 0) {
+		if (id == 1 && type == TC_BINARY) {
+			c->external = 1;
+			tc_skip(t, type, 0);
+		} else if (id == 3 && type == TC_STRUCT) {
+			l = 0;
+			while ((id = tc_field(t, &l, &ltype)) != 0) {
+				if (id == 1 && ltype == TC_I32)
+					c->type = (int) tc_int(t);
+				else if (id == 4 && ltype == TC_I32)
+					c->codec = (int) tc_int(t);
+				else if (id == 5 && ltype == TC_I64)
+					c->num_values = tc_int(t);
+				else if (id == 9 && ltype == TC_I64)
+					c->data_page_offset = tc_int(t);
+				else if (id == 11 && ltype == TC_I64)
+					c->dictionary_page_offset = tc_int(t);
+				else
+					tc_skip(t, ltype, 0);
+			}
+		} else {
+			tc_skip(t, type, 0);
+		}
+	}
+}
+
+static void
+pq_rowgroupmeta(tcbuf *t, pq_rowgroup *g)
+{
+	int last = 0, type, id, etype, i;
+	size_t n;
+
+	while ((id = tc_field(t, &last, &type)) != 0) {
+		if (id == 1 && type == TC_LIST && g->chunks == NULL) {
+			n = tc_list(t, &etype);
+			if (etype != TC_STRUCT || (g->chunks = GDKzalloc((n + 1) * sizeof(pq_chunk))) == NULL) {
+				t->err = 1;
+				return;
+			}
+			g->nchunks = (int) n;
+			for (i = 0; i < g->nchunks && !t->err; i++)
+				pq_columnchunk(t, &g->chunks[i]);
+		} else if (id == 3 && type == TC_I64) {
+			g->num_rows = tc_int(t);
+		} else {
+			tc_skip(t, type, 0);
+		}
+	}
+}
+
+static void
+pq_filemeta(tcbuf *t, pq_meta *m)
+{
+	int last = 0, type, id, etype, i;
+	size_t n;
+
+	while (!t->err && (id = tc_field(t, &last, &type)) != 0) {
+		if (id == 2 && type == TC_LIST && m->schema == NULL) {
+			n = tc_list(t, &etype);
+			if (etype != TC_STRUCT || (m->schema = GDKzalloc((n + 1) * sizeof(pq_schema))) == NULL) {
+				t->err = 1;
+				return;
+			}
+			m->nschema = (int) n;
+			for (i = 0; i < m->nschema && !t->err; i++)
+				pq_schemaelement(t, &m->schema[i]);
+		} else if (id == 3 && type == TC_I64) {
+			m->num_rows = tc_int(t);
+		} else if (id == 4 && type == TC_LIST && m->rowgroups == NULL) {
+			n = tc_list(t, &etype);
+			if (etype != TC_STRUCT || (m->rowgroups = GDKzalloc((n + 1) * sizeof(pq_rowgroup))) == NULL) {
+				t->err = 1;
+				return;
+			}
+			m->nrowgroups = (int) n;
+			for (i = 0; i < m->nrowgroups && !t->err; i++)
+				pq_rowgroupmeta(t, &m->rowgroups[i]);
+		} else {
+			tc_skip(t, type, 0);
+		}
+	}
+}
+
+static void
+pq_freemeta(pq_meta *m)
+{
+	int i;
+
+	for (i = 0; i < m->nrowgroups; i++)
+		GDKfree(m->rowgroups[i].chunks);
+	GDKfree(m->rowgroups);
+	GDKfree(m->schema);
+}
+
+typedef struct {
+	int type;
+	int compressed_size;
+	int uncompressed_size;
+	int num_values;
+	int encoding;
+	int def_length;				/* of DATA_PAGE_V2 */
+	int rep_length;
+	int is_compressed;
+} pq_page;
+
+static void
+pq_pageheader(tcbuf *t, pq_page *p)
+{
+	int last = 0, type, id, l, ltype;
+
+	memset(p, 0, sizeof(*p));
+	p->type = -1;
+	p->is_compressed = 1;
+	while ((id = tc_field(t, &last, &type)) != 0) {
+		if (id == 1 && type == TC_I32) {
+			p->type = (int) tc_int(t);
+		} else if (id == 2 && type == TC_I32) {
+			p->uncompressed_size = (int) tc_int(t);
+		} else if (id == 3 && type == TC_I32) {
+			p->compressed_size = (int) tc_int(t);
+		} else if ((id == 5 || id == 7 || id == 8) && type == TC_STRUCT) {
+			/* DataPageHeader, DictionaryPageHeader, DataPageHeaderV2 */
+			int v2 = id == 8;
+
+			l = 0;
+			while ((id = tc_field(t, &l, &ltype)) != 0) {
+				if (id == 1 && ltype == TC_I32)
+					p->num_values = (int) tc_int(t);
+				else if (!v2 && id == 2 && ltype == TC_I32)
+					p->encoding = (int) tc_int(t);
+				else if (v2 && id == 4 && ltype == TC_I32)
+					p->encoding = (int) tc_int(t);
+				else if (v2 && id == 5 && ltype == TC_I32)
+					p->def_length = (int) tc_int(t);
+				else if (v2 && id == 6 && ltype == TC_I32)
+					p->rep_length = (int) tc_int(t);
+				else if (v2 && id == 7 && (ltype == TC_TRUE || ltype == TC_FALSE))
+					p->is_compressed = ltype == TC_TRUE;
+				else
+					tc_skip(t, ltype, 0);
+			}
+		} else {
+			tc_skip(t, type, 0);
+		}
+	}
+}
+
+/* raw Snappy decompression */
+static int
+pq_snappy(const uint8_t *src, size_t slen, uint8_t *dst, size_t dlen)
+{
+	const uint8_t *end = src + slen;
+	size_t len = 0, pos = 0, off;
+	int shift = 0;
+
+	/* the uncompressed length */
+	while (src < end && shift < 35) {
+		len |= (size_t) (*src & 0x7F) << shift;
+		shift += 7;
+		if ((*src++ & 0x80) == 0)
+			break;
+	}
+	if (len != dlen)
+		return -1;
+	while (src < end) {
+		uint8_t tag = *src++;
+		size_t n = tag >> 2;
+
+		switch (tag & 3) {
+		case 0:
+			if (n >= 60) {
+				int bytes = (int) n - 59, i;
+
+				if ((size_t) (end - src) < (size_t) bytes)
+					return -1;
+				for (n = 0, i = 0; i < bytes; i++)
+					n |= (size_t) *src++ << (8 * i);
+			}
+			n++;
+			if ((size_t) (end - src) < n || dlen - pos < n)
+				return -1;
+			memcpy(dst + pos, src, n);
+			src += n;
+			pos += n;
+			continue;
+		case 1:
+			if (src >= end)
+				return -1;
+			off = ((size_t) (tag >> 5) << 8) | *src++;
+			n = ((tag >> 2) & 7) + 4;
+			break;
+		case 2:
+			if (end - src < 2)
+				return -1;
+			off = (size_t) src[0] | ((size_t) src[1] << 8);
+			src += 2;
+			n++;
+			break;
+		default:
+			if (end - src < 4)
+				return -1;
+			off = (size_t) src[0] | ((size_t) src[1] << 8) | ((size_t) src[2] << 16) | ((size_t) src[3] << 24);
+			src += 4;
+			n++;
+			break;
+		}
+		if (off == 0 || off > pos || dlen - pos < n)
+			return -1;
+		/* the copy may overlap with its own output */
+		while (n-- > 0) {
+			dst[pos] = dst[pos - off];
+			pos++;
+		}
+	}
+	return pos == dlen ? 0 : -1;
+}
+
+static int
+pq_decompress(int codec, const uint8_t *src, size_t slen, uint8_t *dst, size_t dlen)
+{
+	switch (codec) {
+	case PZ_SNAPPY:
+		return pq_snappy(src, slen, dst, dlen);
+#ifdef HAVE_LIBZ
+	case PZ_GZIP: {
+		z_stream z;
+		int ret;
+
+		memset(&z, 0, sizeof(z));
+		if (inflateInit2(&z, 15 + 32) != Z_OK)
+			return -1;
+		z.next_in = (Bytef *) src;
+		z.avail_in = (uInt) slen;
+		z.next_out = dst;
+		z.avail_out = (uInt) dlen;
+		ret = inflate(&z, Z_FINISH);
+		inflateEnd(&z);
+		return ret == Z_STREAM_END && z.total_out == dlen ? 0 : -1;
+	}
+#endif
+	}
+	return -1;
+}
+
+/* Decode n values of the RLE/bit-packed hybrid encoding of width
+ * bits at p. */
+static int
+pq_rle(const uint8_t *p, const uint8_t *end, int width, uint32_t *out, BUN n)
+{
+	BUN i = 0, j, cnt;
+	int bytes = (width + 7) / 8, k;
+	uint32_t mask = width == 32 ? ~(uint32_t) 0 : ((uint32_t) 1 << width) - 1;
+
+	if (width < 0 || width > 32)
+		return -1;
+	while (i < n) {
+		uint64_t h = 0;
+		int shift = 0;
+
+		do {
+			if (p >= end || shift > 35)
+				return -1;
+			h |= (uint64_t) (*p & 0x7F) << shift;
+			shift += 7;
+		} while (*p++ & 0x80);
+		if (h & 1) {
+			/* bit-packed groups of 8 values, least significant bit first */
+			size_t nbytes = (size_t) (h >> 1) * width;
+
+			if ((size_t) (end - p) < nbytes)
+				return -1;
+			cnt = (BUN) (h >> 1) * 8;
+			for (j = 0; j < cnt && i < n; j++, i++) {
+				size_t bit = (size_t) j * width;
+				const uint8_t *q = p + (bit >> 3);
+				uint64_t w = 0;
+
+				if ((size_t) (end - q) >= 8)
+					memcpy(&w, q, 8);
+				else
+					memcpy(&w, q, (size_t) (end - q));
+				out[i] = (uint32_t) (w >> (bit & 7)) & mask;
+			}
+			p += nbytes;
+		} else {
+			uint32_t v = 0;
+
+			if (end - p < bytes)
+				return -1;
+			for (k = 0; k < bytes; k++)
+				v |= (uint32_t) *p++ << (8 * k);
+			cnt = (BUN) (h >> 1);
+			for (j = 0; j < cnt && i < n; j++)
+				out[i++] = v;
+		}
+	}
+	return 0;
+}
+
+/* the state of decoding one column chunk of a row group */
+typedef struct {
+	const pq_schema *se;
+	const pq_chunk *ch;
+	const uint8_t *file;
+	size_t filelen;
+	arr_array a;				/* the result */
+	int pwidth;					/* physical width of a value */
+	BUN rows, row;
+	uint8_t *values;
+	uint8_t *valid;
+	lng *offsets;
+	char *data;
+	size_t datalen, datacap;
+	/* the dictionary */
+	uint8_t *dict;				/* fixed width values, converted */
+	const uint8_t **dptr;		/* strings */
+	uint32_t *dlen;
+	BUN dcount;
+	uint8_t *dictpage;
+	/* page buffers */
+	uint8_t *buf;
+	size_t buflen;
+	uint32_t *levels;
+	uint32_t *idx;
+	BUN lcap;
+	const char *err;
+} pq_column;
+
+/* convert physical value v into the array value at dst */
+static int
+pq_convert(pq_column *c, const uint8_t *v, size_t len, uint8_t *dst)
+{
+	switch (c->se->type) {
+	case PT_INT96: {
+		/* nanoseconds of the day and the Julian day */
+		int64_t ns;
+		int32_t jd;
+
+		memcpy(&ns, v, 8);
+		memcpy(&jd, v + 8, 4);
+		ns += ((int64_t) jd - 2440588) * 24 * 60 * 60 * LL_CONSTANT(1000000000);
+		memcpy(dst, &ns, 8);
+		return 0;
+	}
+	case PT_BYTE_ARRAY:
+	case PT_FIXED: {
+		/* big-endian two's complement decimals */
+		uint8_t x[16];
+		size_t i;
+
+		if (len == 0 || len > 16)
+			return -1;
+		memset(x, (v[0] & 0x80) ? 0xFF : 0, sizeof(x));
+		for (i = 0; i < len; i++)
+			x[i] = v[len - 1 - i];
+		memcpy(dst, x, 16);
+		return 0;
+	}
+	}
+	memcpy(dst, v, c->pwidth);
+	return 0;
+}
+
+/* the PLAIN encoded value at p; returns its length or -1 */
+static ssize_t
+pq_plain(pq_column *c, const uint8_t *p, const uint8_t *end, const uint8_t **v, size_t *len)
+{
+	if (c->se->type == PT_BYTE_ARRAY) {
+		uint32_t l;
+
+		if (end - p < 4)
+			return -1;
+		memcpy(&l, p, 4);
+		if ((size_t) (end - p) - 4 < l)
+			return -1;
+		*v = p + 4;
+		*len = l;
+		return 4 + (ssize_t) l;
+	}
+	if (end - p < c->pwidth)
+		return -1;
+	*v = p;
+	*len = (size_t) c->pwidth;
+	return c->pwidth;
+}
+
+static int
+pq_addstring(pq_column *c, const uint8_t *v, size_t len)
+{
+	if (c->datacap - c->datalen < len) {
+		size_t cap = c->datacap * 2 + len + 4096;
+		char *d = GDKrealloc(c->data, cap);
+
+		if (d == NULL)
+			return -1;
+		c->data = d;
+		c->datacap = cap;
+	}
+	memcpy(c->data + c->datalen, v, len);
+	c->datalen += len;
+	return 0;
+}
+
+static int
+pq_dictionary(pq_column *c, const uint8_t *p, const uint8_t *end, BUN n)
+{
+	BUN i;
+	const uint8_t *v;
+	size_t len;
+	ssize_t l;
+
+	if (c->a.kind == ARR_STRING) {
+		c->dptr = GDKmalloc(n * sizeof(const uint8_t *) + 1);
+		c->dlen = GDKmalloc(n * sizeof(uint32_t) + 1);
+		if (c->dptr == NULL || c->dlen == NULL)
+			return -1;
+	} else if (c->a.kind == ARR_BOOL || (c->dict = GDKmalloc(n * c->a.width + 1)) == NULL) {
+		return -1;
+	}
+	for (i = 0; i < n; i++) {
+		if ((l = pq_plain(c, p, end, &v, &len)) < 0)
+			return -1;
+		p += l;
+		if (c->a.kind == ARR_STRING) {
+			c->dptr[i] = v;
+			c->dlen[i] = (uint32_t) len;
+		} else if (pq_convert(c, v, len, c->dict + i * c->a.width) < 0) {
+			return -1;
+		}
+	}
+	c->dcount = n;
+	return 0;
+}
+
+/* Decode the n values of a data page starting at p, with def the
+ * definition levels (NULL if the column is required). */
+static int
+pq_values(pq_column *c, const pq_page *pg, const uint8_t *p, const uint8_t *end, const uint32_t *def, BUN n)
+{
+	BUN i, k = 0, nvalues = 0;
+	const uint32_t *idx = NULL;
+	int dict = pg->encoding == PE_PLAIN_DICTIONARY || pg->encoding == PE_RLE_DICTIONARY;
+	int bitpos = 0;
+
+	if (c->row + n > c->rows)
+		return -1;
+	for (i = 0; i < n; i++)
+		nvalues += def == NULL || def[i] != 0;
+	if (dict) {
+		if (c->dcount == 0 && nvalues > 0)
+			return -1;
+		if (p >= end)
+			return nvalues == 0 ? 0 : -1;
+		if (pq_rle(p + 1, end, *p, c->idx, nvalues) < 0)
+			return -1;
+		idx = c->idx;
+		for (i = 0; i < nvalues; i++)
+			if (idx[i] >= c->dcount)
+				return -1;
+	} else if (pg->encoding == PE_RLE && c->a.kind == ARR_BOOL) {
+		/* booleans: the length and a bit width of 1 */
+		if (end - p < 4 || pq_rle(p + 4, end, 1, c->idx, nvalues) < 0)
+			return -1;
+		idx = c->idx;
+	} else if (pg->encoding != PE_PLAIN) {
+		c->err = "encoding not supported";
+		return -1;
+	}
+	if (def == NULL && idx == NULL &&
+		(c->se->type == PT_INT32 || c->se->type == PT_INT64 ||
+		 c->se->type == PT_FLOAT || c->se->type == PT_DOUBLE)) {
+		/* the values can be copied as they are */
+		if ((size_t) (end - p) < n * c->pwidth)
+			return -1;
+		memcpy(c->values + c->row * c->a.width, p, n * c->pwidth);
+		c->row += n;
+		return 0;
+	}
+	for (i = 0; i < n; i++, c->row++) {
+		BUN r = c->row;
+
+		if (def && def[i] == 0) {
+			if (c->a.kind == ARR_STRING)
+				c->offsets[r + 1] = (lng) c->datalen;
+			continue;
+		}
+		if (c->valid)
+			c->valid[r >> 3] |= 1 << (r & 7);
+		if (c->a.kind == ARR_BOOL) {
+			int b;
+
+			if (idx) {
+				b = idx[k++] & 1;
+			} else {
+				if (p >= end)
+					return -1;
+				b = (*p >> bitpos) & 1;
+				if (++bitpos == 8) {
+					bitpos = 0;
+					p++;
+				}
+			}
+			if (b)
+				c->values[r >> 3] |= 1 << (r & 7);
+		} else if (c->a.kind == ARR_STRING) {
+			const uint8_t *v;
+			size_t len;
+
+			if (idx) {
+				v = c->dptr[idx[k]];
+				len = c->dlen[idx[k]];
+				k++;
+			} else {
+				ssize_t l = pq_plain(c, p, end, &v, &len);
+
+				if (l < 0)
+					return -1;
+				p += l;
+			}
+			if (pq_addstring(c, v, len) < 0)
+				return -1;
+			c->offsets[r + 1] = (lng) c->datalen;
+		} else if (idx) {
+			memcpy(c->values + r * c->a.width, c->dict + idx[k++] * c->a.width, c->a.width);
+		} else {
+			const uint8_t *v;
+			size_t len;
+			ssize_t l = pq_plain(c, p, end, &v, &len);
+
+			if (l < 0 || pq_convert(c, v, len, c->values + r * c->a.width) < 0)
+				return -1;
+			p += l;
+		}
+	}
+	return 0;
+}
+
+static int
+pq_levels(pq_column *c, BUN n)
+{
+	if (n > c->lcap) {
+		GDKfree(c->levels);
+		GDKfree(c->idx);
+		c->lcap = n;
+		c->levels = GDKmalloc(n * sizeof(uint32_t));
+		c->idx = GDKmalloc(n * sizeof(uint32_t));
+		if (c->levels == NULL || c->idx == NULL)
+			return -1;
+	}
+	return 0;
+}
+
+/* make sure the page buffer holds len bytes */
+static uint8_t *
+pq_buffer(pq_column *c, size_t len)
+{
+	if (len > c->buflen) {
+		GDKfree(c->buf);
+		c->buflen = len;
+		c->buf = GDKmalloc(len + 1);
+	}
+	return c->buf;
+}
+
+/* Decode all pages of the column chunk. */
+static int
+pq_chunkdecode(pq_column *c)
+{
+	const pq_chunk *ch = c->ch;
+	size_t pos = (size_t) (ch->dictionary_page_offset > 0 && ch->dictionary_page_offset < ch->data_page_offset ? ch->dictionary_page_offset : ch->data_page_offset);
+	lng values = 0;
+	int optional = c->se->repetition == 1;
+
+	while (values < ch->num_values) {
+		tcbuf t;
+		pq_page pg;
+		const uint8_t *p, *end;
+		uint32_t *def = NULL;
+
+		if (pos >= c->filelen)
+			return -1;
+		t.p = c->file + pos;
+		t.end = c->file + c->filelen;
+		t.depth = 0;
+		t.err = 0;
+		pq_pageheader(&t, &pg);
+		if (t.err || pg.compressed_size < 0 || pg.uncompressed_size < 0 ||
+			(size_t) (t.end - t.p) < (size_t) pg.compressed_size || pg.num_values < 0)
+			return -1;
+		p = t.p;
+		end = p + pg.compressed_size;
+		pos = (size_t) (end - c->file);
+
+		if (pg.type == PP_DICTIONARY) {
+			if (c->dcount > 0 || c->dictpage)
+				return -1;
+			if (ch->codec != PZ_UNCOMPRESSED) {
+				if ((c->dictpage = GDKmalloc(pg.uncompressed_size + 1)) == NULL ||
+					pq_decompress(ch->codec, p, (size_t) pg.compressed_size, c->dictpage, (size_t) pg.uncompressed_size) < 0)
+					return -1;
+				p = c->dictpage;
+				end = p + pg.uncompressed_size;
+			}
+			if (pq_dictionary(c, p, end, (BUN) pg.num_values) < 0)
+				return -1;
+			continue;
+		}
+		if (pg.type != PP_DATA && pg.type != PP_DATA_V2)
+			continue;
+		if (pq_levels(c, (BUN) pg.num_values) < 0)
+			return -1;
+		if (pg.type == PP_DATA_V2) {
+			/* the levels are not compressed */
+			size_t lvl = (size_t) pg.def_length + (size_t) pg.rep_length;
+
+			if (pg.rep_length != 0 || pg.def_length < 0 || lvl > (size_t) (end - p))
+				return -1;
+			if (optional) {
+				if (pq_rle(p, p + pg.def_length, 1, c->levels, (BUN) pg.num_values) < 0)
+					return -1;
+				def = c->levels;
+			}
+			p += lvl;
+			if (pg.is_compressed && ch->codec != PZ_UNCOMPRESSED) {
+				uint8_t *buf = pq_buffer(c, (size_t) pg.uncompressed_size - lvl);
+
+				if (buf == NULL || (size_t) pg.uncompressed_size < lvl ||
+					pq_decompress(ch->codec, p, (size_t) (end - p), buf, (size_t) pg.uncompressed_size - lvl) < 0)
+					return -1;
+				p = buf;
+				end = buf + pg.uncompressed_size - lvl;
+			}
+		} else {
+			if (ch->codec != PZ_UNCOMPRESSED) {
+				uint8_t *buf = pq_buffer(c, (size_t) pg.uncompressed_size);
+
+				if (buf == NULL ||
+					pq_decompress(ch->codec, p, (size_t) pg.compressed_size, buf, (size_t) pg.uncompressed_size) < 0)
+					return -1;
+				p = buf;
+				end = buf + pg.uncompressed_size;
+			}
+			if (optional) {
+				uint32_t len;
+
+				if (end - p < 4)
+					return -1;
+				memcpy(&len, p, 4);
+				if ((size_t) (end - p) - 4 < len ||
+					pq_rle(p + 4, p + 4 + len, 1, c->levels, (BUN) pg.num_values) < 0)
+					return -1;
+				def = c->levels;
+				p += 4 + len;
+			}
+		}
+		if (pq_values(c, &pg, p, end, def, (BUN) pg.num_values) < 0)
+			return -1;
+		values += pg.num_values;
+	}
+	return c->row == c->rows ? 0 : -1;
+}
+
+/* the array layout of a leaf column */
+static int
+pq_layout(const pq_schema *s, arr_array *a, int *pwidth)
+{
+	static const lng units[4] = { 1, 1000, 1000000, 1000000000 };
+
+	memset(a, 0, sizeof(*a));
+	a->kind = ARR_INT;
+	a->is_signed = 1;
+	switch (s->type) {
+	case PT_BOOLEAN:
+		a->kind = ARR_BOOL;
+		*pwidth = 0;
+		return 0;
+	case PT_INT32:
+	case PT_INT64:
+		a->width = *pwidth = s->type == PT_INT32 ? 4 : 8;
+		if (s->logical == PL_INTEGER) {
+			a->is_signed = s->is_signed;
+		} else if (s->converted >= PC_UINT_8 && s->converted < PC_INT_8) {
+			a->is_signed = 0;
+		} else if (s->logical == PL_DECIMAL || s->converted == PC_DECIMAL) {
+			a->scale = s->scale;
+		} else if (s->logical == PL_DATE || s->converted == PC_DATE) {
+			a->kind = ARR_DATE;
+			a->unit = 1;
+		} else if (s->logical == PL_TIME || s->converted == PC_TIME_MILLIS || s->converted == PC_TIME_MICROS) {
+			a->kind = ARR_TIME;
+			a->unit = units[s->logical == PL_TIME ? s->unit : s->converted == PC_TIME_MILLIS ? 1 : 2];
+		} else if (s->logical == PL_TIMESTAMP || s->converted == PC_TIMESTAMP_MILLIS || s->converted == PC_TIMESTAMP_MICROS) {
+			a->kind = ARR_TIMESTAMP;
+			a->unit = units[s->logical == PL_TIMESTAMP ? s->unit : s->converted == PC_TIMESTAMP_MILLIS ? 1 : 2];
+			a->utc = s->logical == PL_TIMESTAMP ? s->utc : 1;
+		}
+		return a->unit >= 0 ? 0 : -1;
+	case PT_INT96:
+		a->kind = ARR_TIMESTAMP;
+		a->width = 8;
+		*pwidth = 12;
+		a->unit = units[3];
+		a->utc = 1;
+		return 0;
+	case PT_FLOAT:
+	case PT_DOUBLE:
+		a->kind = ARR_FLOAT;
+		a->width = *pwidth = s->type == PT_FLOAT ? 4 : 8;
+		return 0;
+	case PT_BYTE_ARRAY:
+	case PT_FIXED:
+		*pwidth = s->type == PT_FIXED ? s->type_length : 0;
+		if (s->logical == PL_DECIMAL || s->converted == PC_DECIMAL) {
+			a->width = 16;
+			a->scale = s->scale;
+			return 0;
+		}
+		if (s->type == PT_FIXED)
+			return -1;
+		a->kind = ARR_STRING;
+		a->width = 8;
+		return 0;
+	}
+	return -1;
+}
+
+static void
+pq_columnfree(pq_column *c, int all)
+{
+	GDKfree(c->dict);
+	GDKfree(c->dptr);
+	GDKfree(c->dlen);
+	GDKfree(c->dictpage);
+	GDKfree(c->buf);
+	GDKfree(c->levels);
+	GDKfree(c->idx);
+	c->dict = NULL;
+	c->dptr = NULL;
+	c->dlen = NULL;
+	c->dictpage = NULL;
+	c->buf = NULL;
+	c->levels = c->idx = NULL;
+	c->lcap = c->buflen = 0;
+	if (all) {
+		GDKfree(c->values);
+		GDKfree(c->valid);
+		GDKfree(c->offsets);
+		GDKfree(c->data);
+		c->values = c->valid = NULL;
+		c->offsets = NULL;
+		c->data = NULL;
+	}
+}
+
+/* a row group decoded by a worker thread */
+typedef struct {
+	pq_meta *meta;
+	int rowgroup;
+	BUN first;					/* rows of the row group to skip */
+	int ncols;
+	const uint8_t *file;
+	size_t filelen;
+	pq_column *cols;
+	int failed;
+	const char *err;
+} pq_task;
+
+static void
+pq_worker(void *arg)
+{
+	pq_task *task = arg;
+	pq_rowgroup *g = &task->meta->rowgroups[task->rowgroup];
+	BUN rows = (BUN) g->num_rows;
+	int i;
+
+	for (i = 0; i < task->ncols && !task->failed; i++) {
+		pq_column *c = &task->cols[i];
+
+		memset(c, 0, sizeof(*c));
+		c->se = &task->meta->schema[i + 1];
+		c->ch = &g->chunks[i];
+		c->file = task->file;
+		c->filelen = task->filelen;
+		c->rows = rows;
+		if (c->ch->external || c->ch->type != c->se->type) {
+			task->failed = 1;
+			break;
+		}
+		if (c->ch->codec != PZ_UNCOMPRESSED && c->ch->codec != PZ_SNAPPY
+#ifdef HAVE_LIBZ
+			&& c->ch->codec != PZ_GZIP
+#endif
+			) {
+			task->err = "compression codec not supported";
+			task->failed = 1;
+			break;
+		}
+		pq_layout(c->se, &c->a, &c->pwidth);
+		if (c->a.kind == ARR_BOOL)
+			c->values = GDKzalloc((rows + 7) / 8 + 1);
+		else if (c->a.kind == ARR_STRING)
+			c->values = (c->offsets = GDKzalloc((rows + 1) * sizeof(lng))) ? (uint8_t *) c->offsets : NULL;
+		else
+			c->values = GDKmalloc(rows * c->a.width + 1);
+		if (c->se->repetition == 1)
+			c->valid = GDKzalloc((rows + 7) / 8 + 1);
+		if (c->values == NULL || (c->se->repetition == 1 && c->valid == NULL) ||
+			pq_chunkdecode(c) < 0) {
+			if (c->err)
+				task->err = c->err;
+			task->failed = 1;
+		}
+		if (c->a.kind == ARR_STRING)
+			c->values = NULL;
+		c->a.values = c->a.kind == ARR_STRING ? (const void *) c->data : c->values;
+		c->a.offsets = c->offsets;
+		c->a.size = c->datalen;
+		c->a.valid = c->valid;
+		c->a.count = rows;
+		pq_columnfree(c, 0);
+	}
+}
+
+str
+PARQUETload(BAT **bats, sql_table *t, const char *fname, lng nr, lng offset)
+{
+	struct stat st;
+	uint8_t *map;
+	size_t len;
+	uint32_t metalen;
+	tcbuf tb;
+	pq_meta meta;
+	pq_task *tasks = NULL;
+	MT_Id *tids = NULL;
+	int ncols = list_length(t->columns.set), nthreads, i, g, k;
+	BUN skip = offset > 0 ? (BUN) offset - 1 : 0;
+	BUN todo = nr < 0 ? BUN_MAX : (BUN) nr;
+	str msg = MAL_SUCCEED;
+	node *n;
+
+	if (stat(fname, &st) < 0 || st.st_size < 12)
+		throw(SQL, "arrow.copy_from", SQLSTATE(42000) "Cannot open file '%s'", fname);
+	len = (size_t) st.st_size;
+	if ((map = MT_mmap(fname, MMAP_READ, len)) == NULL)
+		throw(SQL, "arrow.copy_from", SQLSTATE(42000) "Cannot map file '%s'", fname);
+	memset(&meta, 0, sizeof(meta));
+	memcpy(&metalen, map + len - 8, 4);
+	if (memcmp(map + len - 4, "PAR1", 4) != 0 || (size_t) metalen > len - 12) {
+		MT_munmap(map, len);
+		throw(SQL, "arrow.copy_from", SQLSTATE(42000) "file '%s' is not a valid Parquet file", fname);
+	}
+	tb.p = map + len - 8 - metalen;
+	tb.end = map + len - 8;
+	tb.depth = 0;
+	tb.err = 0;
+	pq_filemeta(&tb, &meta);
+	if (tb.err || meta.nschema < 1) {
+		msg = createException(SQL, "arrow.copy_from", SQLSTATE(42000) "file '%s' has corrupt metadata", fname);
+		goto bailout;
+	}
+	/* only flat schemas: a root with leaves */
+	if (meta.schema[0].num_children != meta.nschema - 1) {
+		msg = createException(SQL, "arrow.copy_from", SQLSTATE(42000) "file '%s': nested columns are not supported", fname);
+		goto bailout;
+	}
+	if (meta.nschema - 1 != ncols) {
+		msg = createException(SQL, "arrow.copy_from", SQLSTATE(42000) "file '%s' has %d columns, table '%s' has %d",
+							  fname, meta.nschema - 1, t->base.name, ncols);
+		goto bailout;
+	}
+	for (i = 1; i < meta.nschema; i++) {
+		arr_array a;
+		int pwidth;
+
+		if (meta.schema[i].num_children != 0 || meta.schema[i].repetition == 2 ||
+			pq_layout(&meta.schema[i], &a, &pwidth) < 0) {
+			msg = createException(SQL, "arrow.copy_from", SQLSTATE(42000) "file '%s': type of column '%.*s' is not supported",
+								  fname, (int) meta.schema[i].namelen, meta.schema[i].name ? (const char *) meta.schema[i].name : "");
+			goto bailout;
+		}
+	}
+	for (g = 0; g < meta.nrowgroups; g++) {
+		if (meta.rowgroups[g].nchunks != ncols || meta.rowgroups[g].num_rows < 0) {
+			msg = createException(SQL, "arrow.copy_from", SQLSTATE(42000) "file '%s' has corrupt metadata", fname);
+			goto bailout;
+		}
+	}
+
+	nthreads = GDKnr_threads > 1 ? GDKnr_threads : 1;
+	if (nthreads > meta.nrowgroups)
+		nthreads = meta.nrowgroups;
+	tasks = GDKzalloc((nthreads + 1) * sizeof(pq_task));
+	tids = GDKzalloc((nthreads + 1) * sizeof(MT_Id));
+	if (tasks == NULL || tids == NULL) {
+		msg = createException(SQL, "arrow.copy_from", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		goto bailout;
+	}
+
+	for (g = 0; g < meta.nrowgroups && todo > 0 && msg == MAL_SUCCEED; ) {
+		int wave = 0;
+		BUN want = todo;
+
+		/* row groups before the offset are not decoded at all, nor
+		 * are those after the rows asked for */
+		while (wave < nthreads && g < meta.nrowgroups && want > 0) {
+			BUN rows = (BUN) meta.rowgroups[g].num_rows;
+			pq_task *task = &tasks[wave];
+
+			if (skip >= rows) {
+				skip -= rows;
+				g++;
+				continue;
+			}
+			task->meta = &meta;
+			task->rowgroup = g++;
+			task->first = skip;
+			task->ncols = ncols;
+			task->file = map;
+			task->filelen = len;
+			task->failed = 0;
+			task->err = NULL;
+			if ((task->cols = GDKzalloc(ncols * sizeof(pq_column))) == NULL) {
+				msg = createException(SQL, "arrow.copy_from", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+				break;
+			}
+			want -= rows - skip < want ? rows - skip : want;
+			skip = 0;
+			wave++;
+		}
+		for (k = 0; k < wave; k++) {
+			/* the last one is decoded by this thread */
+			if (k == wave - 1 ||
+				MT_create_thread(&tids[k], pq_worker, &tasks[k], MT_THR_JOINABLE) < 0) {
+				tids[k] = 0;
+				pq_worker(&tasks[k]);
+			}
+		}
+		for (k = 0; k < wave; k++) {
+			pq_task *task = &tasks[k];
+			BUN count = (BUN) meta.rowgroups[task->rowgroup].num_rows - task->first;
+
+			if (tids[k])
+				MT_join_thread(tids[k]);
+			tids[k] = 0;
+			if (msg == MAL_SUCCEED && task->failed)
+				msg = createException(SQL, "arrow.copy_from", SQLSTATE(42000) "file '%s', row group %d: %s",
+									  fname, task->rowgroup, task->err ? task->err : "corrupt column chunk");
+			if (count > todo)
+				count = todo;
+			for (n = t->columns.set->h, i = 0; n && msg == MAL_SUCCEED && count > 0; n = n->next, i++) {
+				task->cols[i].a.count = count;
+				msg = arrow_append_range(bats[i], n->data, &task->cols[i].a, task->first, fname);
+			}
+			if (msg == MAL_SUCCEED)
+				todo -= count;
+			for (i = 0; i < ncols; i++)
+				pq_columnfree(&task->cols[i], 1);
+			GDKfree(task->cols);
+			task->cols = NULL;
+		}
+	}
+
+  bailout:
+	GDKfree(tasks);
+	GDKfree(tids);
+	pq_freemeta(&meta);
+	MT_munmap(map, len);
+	return msg;
+}
@@ -42,6 +42,36 @@ backend_freecode(int clientid, backend_code code, backend_stack stk, int nr, cha
 		be_funcs.fcode(clientid, code, stk, nr, name);
 }
 
+backend_code
+backend_sharecode(int clientid, backend_code code)
+{
+	if (be_funcs.fsharecode != NULL)
+		return be_funcs.fsharecode(clientid, code);
+	return NULL;
+}
+
+backend_code
+backend_importcode(int clientid, backend_code code, char *name)
+{
+	if (be_funcs.fimportcode != NULL)
+		return be_funcs.fimportcode(clientid, code, name);
+	return NULL;
+}
+
+void
+backend_freesharedcode(backend_code code)
+{
+	if (be_funcs.ffreesharedcode != NULL)
+		be_funcs.ffreesharedcode(code);
+}
+
+void
+backend_commit(sql_trans *tr)
+{
+	if (be_funcs.fcommit != NULL)
+		be_funcs.fcommit(tr);
+}
+
 char *
 backend_create_user(ptr mvc, char *user, char *passwd, char enc, char *fullname, sqlid defschemid, sqlid grantor)
 {
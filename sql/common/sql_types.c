@@ -468,7 +468,7 @@ _dup_subaggr(sql_allocator *sa, sql_func *a, sql_subtype *member)
 			scale = member->scale;
 		}
 		/* same type as the input */
-		if (r->type->eclass == EC_ANY) 
+		if (r->type->eclass == EC_ANY && member)
 			r = member;
 		res = sql_create_subtype(sa, r->type, digits, scale);
 		list_append(ares->res, res);
@@ -1246,6 +1246,20 @@ sql_create_analytic(sql_allocator *sa, const char *name, const char *mod, const
 	return sql_create_func_(sa, name, mod, imp, l, sres, FALSE, F_ANALYTIC, fix_scale);
 }
 
+/* NULL terminated list of argument types */
+static list *
+sql_window_args(sql_allocator *sa, sql_type *tpe, ...)
+{
+	list *l = sa_list(sa);
+	va_list ap;
+
+	va_start(ap, tpe);
+	for (; tpe; tpe = va_arg(ap, sql_type *))
+		list_append(l, create_arg(sa, NULL, sql_create_subtype(sa, tpe, 0, 0), ARG_IN));
+	va_end(ap);
+	return l;
+}
+
 sql_func *
 sql_create_func4(sql_allocator *sa, const char *name, const char *mod, const char *imp, sql_type *tpe1, sql_type *tpe2, sql_type *tpe3, sql_type *tpe4, sql_type *res, int fix_scale)
 {
@@ -1575,6 +1589,11 @@ sqltypeinit( sql_allocator *sa)
 	sql_create_aggr(sa, "count_no_nil", "aggr", "count_no_nil", NULL, LNG);
 	sql_create_aggr(sa, "count", "aggr", "count", NULL, LNG);
 
+	/* approximate aggregates, computed from a sketch of the values */
+	sql_create_aggr(sa, "approx_count_distinct", "aggr", "approx_count_distinct", ANY, LNG);
+	sql_create_aggr(sa, "approx_median", "aggr", "approx_median", ANY, ANY);
+	sql_create_aggr2(sa, "approx_quantile", "aggr", "approx_quantile", ANY, DBL, ANY);
+
 	/* order based operators */
 	sql_create_analytic(sa, "diff", "sql", "diff", ANY, NULL, NULL, BIT, SCALE_NONE);
 	sql_create_analytic(sa, "diff", "sql", "diff", BIT, ANY,  NULL, BIT, SCALE_NONE);
@@ -1585,15 +1604,30 @@ sqltypeinit( sql_allocator *sa)
 
 	//sql_create_analytic(sa, "percent_rank", "sql", "precent_rank", ANY, BIT, BIT, INT, SCALE_NONE);
 	//sql_create_analytic(sa, "cume_dist", "sql", "cume_dist", ANY, BIT, BIT, ANY, SCALE_NONE);
-	//sql_create_analytic(sa, "lag", "sql", "lag", ANY, BIT, BIT, ANY, SCALE_NONE);
-	//sql_create_analytic(sa, "lead", "sql", "lead", ANY, BIT, BIT, ANY, SCALE_NONE);
-	//sql_create_analytic(sa, "first_value", "sql", "first_value", ANY, BIT, BIT, ANY, SCALE_NONE);
-	//sql_create_analytic(sa, "last_value", "sql", "last_value", ANY, BIT, BIT, ANY, SCALE_NONE);
-	//sql_create_analytic(sa, "sum", "sql", "sum", ANY, BIT, BIT, ANY, SCALE_NONE);
-	//sql_create_analytic(sa, "min", "sql", "min", ANY, BIT, BIT, ANY, SCALE_NONE);
-	//sql_create_analytic(sa, "max", "sql", "max", ANY, BIT, BIT, ANY, SCALE_NONE);
-	//sql_create_analytic(sa, "avg", "sql", "avg", ANY, BIT, BIT, ANY, SCALE_NONE);
-	//sql_create_analytic(sa, "count", "sql", "count", ANY, BIT, BIT, ANY, SCALE_NONE);
+
+	/* window frames: the bounds of the frame of each row (ordering
+	 * values, partitions, peers, unit, kind, end, descending,
+	 * offset), offsets are counted in rows or, for RANGE frames,
+	 * in the type of the ordering values */
+	sql_create_func_(sa, "window_bound", "sql", "window_bound", sql_window_args(sa, ANY, BIT, BIT, INT, INT, BIT, BIT, LNG, NULL),
+			 create_arg(sa, NULL, sql_create_subtype(sa, LNG, 0, 0), ARG_OUT), FALSE, F_ANALYTIC, SCALE_NONE);
+	sql_create_func_(sa, "window_bound", "sql", "window_bound", sql_window_args(sa, ANY, BIT, BIT, INT, INT, BIT, BIT, ANY, NULL),
+			 create_arg(sa, NULL, sql_create_subtype(sa, LNG, 0, 0), ARG_OUT), FALSE, F_ANALYTIC, SCALE_NONE);
+
+	/* aggregates over the frames given by their start and end */
+	sql_create_analytic(sa, "sum", "sql", "sum", ANY, LNG, LNG, ANY, SCALE_NONE);
+	sql_create_analytic(sa, "avg", "sql", "avg", ANY, LNG, LNG, DBL, SCALE_NONE);
+	sql_create_analytic(sa, "count", "sql", "count", ANY, LNG, LNG, LNG, SCALE_NONE);
+	sql_create_analytic(sa, "min", "sql", "min", ANY, LNG, LNG, ANY, SCALE_NONE);
+	sql_create_analytic(sa, "max", "sql", "max", ANY, LNG, LNG, ANY, SCALE_NONE);
+	sql_create_analytic(sa, "first_value", "sql", "first_value", ANY, LNG, LNG, ANY, SCALE_NONE);
+	sql_create_analytic(sa, "last_value", "sql", "last_value", ANY, LNG, LNG, ANY, SCALE_NONE);
+
+	/* value, offset, default, partitions */
+	sql_create_func_(sa, "lag", "sql", "lag", sql_window_args(sa, ANY, LNG, ANY, BIT, NULL),
+			 create_arg(sa, NULL, sql_create_subtype(sa, ANY, 0, 0), ARG_OUT), FALSE, F_ANALYTIC, SCALE_NONE);
+	sql_create_func_(sa, "lead", "sql", "lead", sql_window_args(sa, ANY, LNG, ANY, BIT, NULL),
+			 create_arg(sa, NULL, sql_create_subtype(sa, ANY, 0, 0), ARG_OUT), FALSE, F_ANALYTIC, SCALE_NONE);
 
 	sql_create_func(sa, "and", "calc", "and", BIT, BIT, BIT, SCALE_FIX);
 	sql_create_func(sa, "or",  "calc",  "or", BIT, BIT, BIT, SCALE_FIX);
@@ -1886,6 +1920,15 @@ sqltypeinit( sql_allocator *sa)
 			create_arg(sa, NULL, sql_create_subtype(sa, STR, 0, 0), ARG_IN)), sres, FALSE, F_UNION, SCALE_FIX);
 	f->varres = 1;
 
+	/* copyfrom Arrow/Parquet file */
+	f = sql_create_func_(sa, "copyfrom", "arrow", "copy_from",
+	 	list_append(list_append(list_append(list_append(sa_list(sa),
+			create_arg(sa, NULL, sql_create_subtype(sa, STR, 0, 0), ARG_IN)),
+			create_arg(sa, NULL, sql_create_subtype(sa, STR, 0, 0), ARG_IN)),
+			create_arg(sa, NULL, sql_create_subtype(sa, LNG, 0, 0), ARG_IN)),
+			create_arg(sa, NULL, sql_create_subtype(sa, LNG, 0, 0), ARG_IN)), sres, FALSE, F_UNION, SCALE_FIX);
+	f->varres = 1;
+
 	/* sys_update_schemas, sys_update_tables */
 	f = sql_create_func_(sa, "sys_update_schemas", "sql", "update_schemas", NULL, NULL, FALSE, F_PROC, SCALE_NONE);
 	f = sql_create_func_(sa, "sys_update_tables", "sql", "update_tables", NULL, NULL, FALSE, F_PROC, SCALE_NONE);
@@ -210,6 +210,7 @@ typedef struct sql_trans {
 	int wtime;
 	int schema_number;	/* schema timestamp */
 	int schema_updates;	/* set on schema changes */
+	int commit_number;	/* latest commit seen, the own one after commit */
 	int status;		/* status of the last query */
 	list *dropped;  	/* protection against recursive cascade action*/
 
@@ -489,6 +490,8 @@ typedef enum table_types {
 #define isReplicaTable(x) (x->type==tt_replica_table)
 #define isKindOfTable(x)  (isTable(x) || isMergeTable(x) || isRemote(x) || isReplicaTable(x))
 #define isPartition(x)    (isTable(x) && x->p)
+/* a materialized view is a table which keeps its defining query */
+#define isMatView(x)      (isTable(x) && x->query)
 
 #define TABLE_WRITABLE	0
 #define TABLE_READONLY	1
@@ -499,6 +502,10 @@ typedef struct sql_part {
 	struct sql_table *t; /* cached value */
 } sql_part;
 
+/* kinds of declared partitioning of a merge table */
+#define PARTITION_RANGE		1
+#define PARTITION_VALUES	2
+
 typedef struct sql_table {
 	sql_base base;
 	sht type;		/* table, view, etc */
@@ -529,6 +536,7 @@ typedef struct res_col {
 	char *name;
 	sql_subtype type;
 	bat b;
+	bat cand;	/* if set, the column is the projection of b over cand */
 	int mtype;
 	ptr *p;
 } res_col;
@@ -73,6 +73,7 @@ typedef struct expression {
 #define UPD_NO_CONSTRAINT	4
 
 #define REL_PARTITION	8
+#define REL_MERGE_TARGET	16	/* merge table to insert into, not to expand */
 
 /* We need bit wise exclusive numbers as we merge the level also in the flag */
 #define PSM_SET 1
@@ -136,6 +137,9 @@ typedef struct expression {
 
 #define DDL_COMMENT_ON			66
 
+#define DDL_ALTER_TABLE_SET_PARTITION	67
+#define DDL_ALTER_TABLE_ADD_PARTITION	68
+
 #define DDL_EMPTY 100
 
 #define MAXOPS 22
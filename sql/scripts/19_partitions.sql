@@ -0,0 +1,25 @@
+-- This Source Code Form is subject to the terms of the Mozilla Public
+-- License, v. 2.0.  If a copy of the MPL was not distributed with this
+-- file, You can obtain one at http://mozilla.org/MPL/2.0/.
+--
+-- Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+
+-- The declared partitioning of merge tables.  The "type" is 1 for
+-- range and 2 for value (list) partitioning.  Bounds and values are in
+-- the storage format of the partition column, a null bound is
+-- unbounded.  The minimum is inclusive, the maximum exclusive.
+CREATE TABLE sys.table_partitions(
+	"table_id" integer,
+	"column_id" integer,
+	"type" integer);
+
+CREATE TABLE sys.range_partitions(
+	"table_id" integer,
+	"partition_id" integer,
+	minimum string,
+	maximum string);
+
+CREATE TABLE sys.value_partitions(
+	"table_id" integer,
+	"partition_id" integer,
+	"value" string);
@@ -21,7 +21,28 @@ CREATE TABLE sys.statistics(
 	minval string,
 	maxval string,
 	sorted boolean,
-	revsorted boolean);
+	revsorted boolean,
+	sketch string);
+
+-- Equi-depth histogram and most common values per column, built by
+-- a full analyze and maintained by an incremental one.
+CREATE TABLE sys.statistics_histogram(
+	"column_id" integer,
+	"bucket" integer,
+	lowval string,
+	highval string,
+	"count" bigint,
+	"unique" bigint);
+
+CREATE TABLE sys.statistics_mcv(
+	"column_id" integer,
+	"value" string,
+	"count" bigint);
+
+-- The minmax argument is a bit mask: 1 skips the exact (sampled)
+-- distinct count and the histogram, using the sketch estimate
+-- instead; 2 only folds the rows appended since the previous analyze
+-- into the existing statistics.
 
 create procedure sys.analyze(minmax int, "sample" bigint)
 external name sql.analyze;
@@ -0,0 +1,576 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+/*
+ * Materialized views are tables which keep the statement defining them.
+ * They are kept up to date by the statements changing the tables they
+ * are defined over: appended rows are propagated through the definition
+ * of select-project-join views and merged into the groups of views
+ * aggregating with count, sum, min and max; deletes and updates, and
+ * appends to other definitions, recompute the view.  A query whose parse
+ * tree equals the definition of a materialized view is answered from it.
+ */
+
+#include "monetdb_config.h"
+#include "rel_matview.h"
+#include "rel_semantic.h"
+#include "rel_select.h"
+#include "rel_updates.h"
+#include "rel_schema.h"
+#include "rel_rel.h"
+#include "rel_exp.h"
+#include "sql_parser.h"
+#include "sql_privileges.h"
+
+static sql_table *
+find_table_id(sql_trans *tr, int id)
+{
+	node *n;
+
+	for (n = tr->schemas.set->h; n; n = n->next) {
+		sql_table *t = find_sql_table_id(n->data, id);
+
+		if (t)
+			return t;
+	}
+	return NULL;
+}
+
+/* collect the materialized views depending on object id, also through views */
+static int
+matview_dependents(mvc *sql, int id, list *mvs)
+{
+	list *deps = sql_trans_get_dependencies(sql->session->tr, id, VIEW_DEPENDENCY, NULL);
+	node *n;
+
+	if (!deps)
+		return -1;
+	for (n = deps->h; n && n->next; n = n->next->next) {
+		sql_table *v;
+
+		if (*(sht *) n->next->data != VIEW_DEPENDENCY ||
+		    (v = find_table_id(sql->session->tr, *(int *) n->data)) == NULL)
+			continue;
+		if (isMatView(v)) {
+			if (!list_find(mvs, v, NULL))
+				list_append(mvs, v);
+		} else if (isView(v) && matview_dependents(sql, v->base.id, mvs) < 0) {
+			list_destroy(deps);
+			return -1;
+		}
+	}
+	list_destroy(deps);
+	return 0;
+}
+
+list *
+rel_matview_dependents(mvc *sql, sql_table *t)
+{
+	list *mvs = sa_list(sql->sa);
+
+	if (isDeclaredTable(t))
+		return mvs;
+	/* rows of a partition are rows of its merge table */
+	if (matview_dependents(sql, t->base.id, mvs) < 0 ||
+	    (t->p && matview_dependents(sql, t->p->base.id, mvs) < 0))
+		return sql_error(sql, 02, SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	return mvs;
+}
+
+static sql_rel *
+matview_parse(mvc *sql, sql_table *mv)
+{
+	int user_id = sql->user_id;
+	sql_rel *rel;
+
+	/* the view is maintained on behalf of its owner */
+	sql->user_id = USER_MONETDB;
+	rel = rel_parse(sql, mv->s, mv->query, m_instantiate);
+	sql->user_id = user_id;
+	return rel;
+}
+
+/* project the result of the definition on the columns of the view */
+static sql_rel *
+matview_project(mvc *sql, sql_table *mv, sql_rel *rel)
+{
+	list *exps = rel_projections(sql, rel, NULL, 1, 0);
+	node *n, *m;
+
+	for (n = mv->columns.set->h, m = exps->h; n && m; n = n->next, m = m->next) {
+		sql_column *c = n->data;
+		sql_exp *e = rel_check_type(sql, &c->type, m->data, type_equal);
+
+		if (!e)
+			return NULL;
+		exp_setname(sql->sa, e, mv->base.name, c->base.name);
+		m->data = e;
+	}
+	if (n || m)
+		return sql_error(sql, 02, SQLSTATE(42000) "MATERIALIZED VIEW: the definition of '%s' no longer matches its columns", mv->base.name);
+	return rel_project(sql->sa, rel, exps);
+}
+
+sql_rel *
+rel_matview_recompute(mvc *sql, sql_table *mv)
+{
+	sql_rel *def = matview_parse(sql, mv), *del, *ins;
+
+	if (!def || (def = matview_project(sql, mv, def)) == NULL)
+		return NULL;
+	del = rel_delete(sql->sa, rel_basetable(sql, mv, mv->base.name), NULL);
+	ins = rel_insert(sql, rel_basetable(sql, mv, mv->base.name), def);
+	return rel_list(sql->sa, del, ins);
+}
+
+/* Replace the scans of t in rel by a projection of the appended rows.
+ * Returns the number of scans replaced; *linear is cleared when one of
+ * them sits below an operator the appended rows do not pass through
+ * unchanged, ie one whose result over the new rows is not simply added
+ * to its result over the old rows. */
+static int
+matview_delta(mvc *sql, sql_rel *rel, sql_table *t, sql_rel *delta, int *linear)
+{
+	int l = 0, r = 0;
+
+	if (!rel)
+		return 0;
+	switch (rel->op) {
+	case op_basetable: {
+		sql_table *bt = rel->l;
+		const char *dname = exp_relname(delta->exps->h->data);
+		list *exps = new_exp_list(sql->sa);
+		sql_rel *d;
+		node *n;
+
+		if (!bt || (bt->base.id != t->base.id && (!t->p || bt->base.id != t->p->base.id)))
+			return 0;
+		d = rel_copy(sql->sa, delta);
+		d->exps = exps_copy(sql->sa, delta->exps);
+		d->nrcols = delta->nrcols;
+		for (n = rel->exps->h; n; n = n->next) {
+			sql_exp *e = n->data, *ne;
+
+			if (is_intern(e))
+				continue;
+			ne = exp_column(sql->sa, dname, e->r, exp_subtype(e), CARD_MULTI, has_nil(e), 0);
+			exp_setname(sql->sa, ne, exp_relname(e), exp_name(e));
+			append(exps, ne);
+		}
+		rel_inplace_project(sql->sa, rel, d, exps);
+		return 1;
+	}
+	case op_table:
+		/* the input of a table producing function */
+		if (rel->flag != 2 && rel->l && matview_delta(sql, rel->l, t, delta, linear) > 0) {
+			*linear = 0;
+			return 1;
+		}
+		return 0;
+	case op_project:
+	case op_select:
+		l = matview_delta(sql, rel->l, t, delta, linear);
+		if (l && need_distinct(rel))
+			*linear = 0;
+		return l;
+	case op_join:
+	case op_union:
+		l = matview_delta(sql, rel->l, t, delta, linear);
+		r = matview_delta(sql, rel->r, t, delta, linear);
+		if ((l || r) && need_distinct(rel))
+			*linear = 0;
+		return l + r;
+	case op_left:
+	case op_semi:
+	case op_anti:
+		l = matview_delta(sql, rel->l, t, delta, linear);
+		r = matview_delta(sql, rel->r, t, delta, linear);
+		if (r)
+			*linear = 0;
+		return l + r;
+	default:
+		l = matview_delta(sql, rel->l, t, delta, linear);
+		if (is_joinop(rel->op) || is_apply(rel->op) || is_set(rel->op))
+			r = matview_delta(sql, rel->r, t, delta, linear);
+		if (l || r)
+			*linear = 0;
+		return l + r;
+	}
+}
+
+/* How each column of an aggregating view merges the groups of appended
+ * rows into its own: 'k' for a group key, 's' for counts and sums, 'n'
+ * for minima and 'x' for maxima.  NULL when the definition is not a
+ * group by whose keys and plain count, sum, min and max aggregates are
+ * all columns of the view. */
+static char *
+matview_aggr_kinds(mvc *sql, sql_table *mv, sql_rel *rel)
+{
+	sql_rel *g = rel->l;
+	int nr = list_length(mv->columns.set), i = 0;
+	char *kinds;
+	node *n, *m;
+
+	if (rel->op != op_project || need_distinct(rel) || rel->r || !g || g->op != op_groupby)
+		return NULL;
+	kinds = sa_zalloc(sql->sa, nr + 1);
+	for (n = rel->exps->h; n; n = n->next) {
+		sql_exp *e = n->data, *ge;
+
+		if (is_intern(e))
+			continue;
+		if (i >= nr || e->type != e_column)
+			return NULL;
+		ge = e->l ? exps_bind_column2(g->exps, e->l, e->r) : exps_bind_column(g->exps, e->r, NULL);
+		if (!ge)
+			return NULL;
+		if (ge->type == e_aggr) {
+			const char *aname = ((sql_subaggr *) ge->f)->aggr->base.name;
+
+			if (need_distinct(ge))
+				return NULL;
+			if (strcmp(aname, "count") == 0 || strcmp(aname, "sum") == 0)
+				kinds[i] = 's';
+			else if (strcmp(aname, "min") == 0)
+				kinds[i] = 'n';
+			else if (strcmp(aname, "max") == 0)
+				kinds[i] = 'x';
+			else
+				return NULL;
+		} else {
+			kinds[i] = 'k';
+		}
+		i++;
+	}
+	if (i != nr)
+		return NULL;
+	/* the groups have to be told apart by the columns of the view */
+	for (m = g->exps->h; m; m = m->next) {
+		sql_exp *ge = m->data;
+
+		if (ge->type == e_aggr)
+			continue;
+		for (n = rel->exps->h; n; n = n->next) {
+			sql_exp *e = n->data;
+
+			if (e->type == e_column && strcmp(e->r, exp_name(ge)) == 0 &&
+			    (!e->l || !exp_relname(ge) || strcmp(e->l, exp_relname(ge)) == 0))
+				break;
+		}
+		if (!n)
+			return NULL;
+	}
+	return kinds;
+}
+
+static sql_exp *
+exp_colref(sql_allocator *sa, sql_exp *e)
+{
+	return exp_column(sa, exp_relname(e), exp_name(e), exp_subtype(e), exp_card(e), has_nil(e), 0);
+}
+
+static sql_exp *
+exp_named(sql_allocator *sa, sql_exp *e, sql_exp *as)
+{
+	exp_setname(sa, e, exp_relname(as), exp_name(as));
+	return e;
+}
+
+/* Merge the groups of the appended rows (drel) into the view: the union
+ * of the rows of the view and those groups is grouped again, the groups
+ * holding appended rows either update the row of the view they came with
+ * or, when it has none, are inserted. */
+static sql_rel *
+matview_merge(mvc *sql, sql_table *mv, sql_rel *drel, char *kinds, int insert)
+{
+	sql_allocator *sa = sql->sa;
+	sql_subtype *oidt = sql_bind_localtype("oid");
+	sql_rel *cur = rel_basetable(sql, mv, mv->base.name), *u, *g, *s;
+	list *ls = new_exp_list(sa), *rs = new_exp_list(sa), *keys = new_exp_list(sa), *vals = new_exp_list(sa);
+	list *dexps = rel_projections(sql, drel, NULL, 1, 0);
+	sql_exp *tid, *isd, *e;
+	node *n, *m;
+	int i, nr = list_length(mv->columns.set);
+
+	for (n = mv->columns.set->h, m = dexps->h; n && m; n = n->next, m = m->next) {
+		sql_column *c = n->data;
+		sql_exp *le = exp_column(sa, mv->base.name, c->base.name, &c->type, CARD_MULTI, c->null, 0);
+		sql_exp *re = rel_check_type(sql, &c->type, m->data, type_equal);
+
+		if (!re)
+			return NULL;
+		exp_label(sa, le, ++sql->label);
+		exp_setname(sa, re, exp_relname(le), exp_name(le));
+		append(ls, le);
+		append(rs, re);
+	}
+	/* the row of the view a group comes with, and whether it has appended rows */
+	tid = exp_label(sa, exp_column(sa, mv->base.name, TID, oidt, CARD_MULTI, 0, 1), ++sql->label);
+	append(ls, tid);
+	append(rs, exp_named(sa, exp_atom(sa, atom_general(sa, oidt, NULL)), tid));
+	isd = exp_label(sa, exp_atom_bool(sa, 0), ++sql->label);
+	append(ls, isd);
+	append(rs, exp_named(sa, exp_atom_bool(sa, 1), isd));
+
+	u = rel_setop(sa, rel_project(sa, cur, ls), rel_project(sa, drel, rs), op_union);
+	u->exps = rel_projections(sql, u, NULL, 0, 1);
+	set_processed(u);
+
+	for (i = 0, n = u->exps->h; i < nr; i++, n = n->next)
+		if (kinds[i] == 'k')
+			append(keys, exp_colref(sa, n->data));
+	g = rel_groupby(sql, u, list_empty(keys) ? NULL : keys);
+	/* the row of the view and the appended flag are maxima */
+	for (i = 0, n = u->exps->h; n; i++, n = n->next) {
+		sql_exp *ue = exp_colref(sa, n->data);
+		char k = i < nr ? kinds[i] : 'x';
+		const char *aname = k == 's' ? "sum" : k == 'n' ? "min" : "max";
+
+		if (k == 'k') {
+			e = exp_colref(sa, exps_bind_column2(g->exps, exp_relname(ue), exp_name(ue)));
+		} else {
+			e = exp_aggr1(sa, ue, sql_bind_aggr(sa, sql->session->schema, aname, exp_subtype(ue)), 0, 1, CARD_AGGR, has_nil(ue));
+			e = rel_groupby_add_aggr(sql, g, e);
+		}
+		if (i == nr)
+			tid = e;
+		else if (i == nr + 1)
+			isd = e;
+		else
+			append(vals, e);
+	}
+
+	s = rel_select(sa, g, exp_compare(sa, exp_colref(sa, isd), exp_atom_bool(sa, 1), cmp_equal));
+	e = exp_unop(sa, exp_colref(sa, tid), sql_bind_func(sa, sql->session->schema, "isnull", oidt, NULL, F_FUNC));
+	s = rel_select(sa, s, exp_compare(sa, e, exp_atom_bool(sa, insert), cmp_equal));
+
+	if (insert) {
+		list *exps = new_exp_list(sa);
+
+		for (n = mv->columns.set->h, m = vals->h; n; n = n->next, m = m->next) {
+			sql_column *c = n->data;
+
+			if ((e = rel_check_type(sql, &c->type, exp_colref(sa, m->data), type_equal)) == NULL)
+				return NULL;
+			append(exps, e);
+		}
+		return rel_insert(sql, rel_basetable(sql, mv, mv->base.name), rel_project(sa, s, exps));
+	} else {
+		sql_exp **updates = sa_zalloc(sa, list_length(mv->columns.set) * sizeof(sql_exp *));
+		list *exps = new_exp_list(sa);
+		sql_rel *up = rel_project(sa, s, append(new_exp_list(sa), exp_colref(sa, tid)));
+
+		for (i = 0, n = mv->columns.set->h, m = vals->h; n; i++, n = n->next, m = m->next) {
+			sql_column *c = n->data;
+
+			if (kinds[i] == 'k')
+				continue;
+			if ((e = rel_check_type(sql, &c->type, exp_colref(sa, m->data), type_equal)) == NULL)
+				return NULL;
+			exp_setname(sa, e, mv->base.name, c->base.name);
+			updates[c->colnr] = e;
+			append(exps, exp_column(sa, mv->base.name, c->base.name, &c->type, CARD_MULTI, 0, 0));
+		}
+		return rel_update(sql, rel_basetable(sql, mv, mv->base.name), up, updates, exps);
+	}
+}
+
+/* the definition of mv over the appended rows, NULL when they cannot be propagated */
+static sql_rel *
+matview_delta_def(mvc *sql, sql_table *mv, sql_table *t, sql_rel *delta, char **kinds)
+{
+	sql_rel *def = matview_parse(sql, mv), *in;
+	int linear = 1;
+
+	if (!def)
+		return NULL;
+	*kinds = matview_aggr_kinds(sql, mv, def);
+	in = *kinds ? ((sql_rel *) def->l)->l : def;
+	if (matview_delta(sql, in, t, delta, &linear) != 1 || !linear)
+		return NULL;
+	return matview_project(sql, mv, def);
+}
+
+list *
+rel_matview_append(mvc *sql, sql_table *mv, sql_table *t, sql_rel *delta)
+{
+	list *res = sa_list(sql->sa);
+	sql_rel *def, *r;
+	char *kinds = NULL;
+
+	if ((def = matview_delta_def(sql, mv, t, delta, &kinds)) == NULL) {
+		if (sql->session->status || sql->errstr[0])
+			return NULL;
+		/* appends to this definition are not propagated */
+		if ((r = rel_matview_recompute(sql, mv)) == NULL)
+			return NULL;
+		append(res, r);
+	} else if (!kinds) {
+		if ((r = rel_insert(sql, rel_basetable(sql, mv, mv->base.name), def)) == NULL)
+			return NULL;
+		append(res, r);
+	} else {
+		/* the groups already in the view are updated first, which
+		 * leaves the new ones to be inserted from a second instance
+		 * of the definition */
+		if (strspn(kinds, "k") < strlen(kinds)) {
+			if ((r = matview_merge(sql, mv, def, kinds, 0)) == NULL)
+				return NULL;
+			append(res, r);
+			if ((def = matview_delta_def(sql, mv, t, delta, &kinds)) == NULL)
+				return NULL;
+		}
+		if ((r = matview_merge(sql, mv, def, kinds, 1)) == NULL)
+			return NULL;
+		append(res, r);
+	}
+	return res;
+}
+
+sql_rel *
+rel_refresh_matview(mvc *sql, dlist *qname)
+{
+	char *sname = qname_schema(qname);
+	char *tname = qname_table(qname);
+	sql_schema *s = cur_schema(sql);
+	sql_table *mv;
+
+	if (sname && !(s = mvc_bind_schema(sql, sname)))
+		return sql_error(sql, 02, SQLSTATE(3F000) "REFRESH MATERIALIZED VIEW: no such schema '%s'", sname);
+	if ((mv = mvc_bind_table(sql, s, tname)) == NULL || !isMatView(mv))
+		return sql_error(sql, 02, SQLSTATE(42S02) "REFRESH MATERIALIZED VIEW: no such materialized view '%s'", tname);
+	if (!mvc_schema_privs(sql, s))
+		return sql_error(sql, 02, SQLSTATE(42000) "REFRESH MATERIALIZED VIEW: insufficient privileges for user '%s' in schema '%s'", stack_get_string(sql, "current_user"), s->base.name);
+	if (STORE_READONLY)
+		return sql_error(sql, 02, SQLSTATE(42000) "REFRESH MATERIALIZED VIEW: '%s' not allowed in readonly mode", tname);
+	return rel_matview_recompute(sql, mv);
+}
+
+/* The parse tree of the query defining mv, parsed like the current
+ * statement: when its literals became arguments those of the definition
+ * do too, they are returned in *args. */
+static symbol *
+matview_symbol(mvc *m, sql_table *mv, atom ***args, int *argc)
+{
+	mvc o = *m;
+	int status = m->session->status;
+	symbol *sym = NULL;
+	buffer *b;
+	bstream *bs;
+	stream *buf;
+	char *q;
+	size_t len = strlen(mv->query);
+
+	*args = NULL;
+	*argc = 0;
+	if ((b = (buffer *) GDKmalloc(sizeof(buffer))) == NULL)
+		return NULL;
+	if ((q = GDKmalloc(len + 2)) == NULL) {
+		GDKfree(b);
+		return NULL;
+	}
+	strcpy(q, mv->query);
+	q[len] = '\n';
+	q[len + 1] = 0;
+	buffer_init(b, q, len + 1);
+	if ((buf = buffer_rastream(b, "sqlstatement")) == NULL || (bs = bstream_create(buf, b->len)) == NULL) {
+		if (buf)
+			close_stream(buf);
+		GDKfree(q);
+		GDKfree(b);
+		return NULL;
+	}
+	m->qc = NULL;
+	m->argmax = 8;
+	if ((m->args = NEW_ARRAY(atom *, m->argmax)) == NULL) {
+		bstream_destroy(bs);
+		GDKfree(q);
+		GDKfree(b);
+		*m = o;
+		return NULL;
+	}
+	m->argc = 0;
+	m->params = NULL;
+	m->sym = NULL;
+	m->errstr[0] = '\0';
+	scanner_init(&m->scanner, bs, NULL);
+	m->scanner.mode = LINE_1;
+	bstream_next(m->scanner.rs);
+
+	if (sqlparse(m) == 0 && m->sym && m->sym->token == SQL_CREATE_MATVIEW)
+		sym = m->sym->data.lval->h->next->next->data.sym;
+	*args = m->args;
+	*argc = m->argc;
+
+	GDKfree(q);
+	GDKfree(b);
+	bstream_destroy(m->scanner.rs);
+	*m = o;
+	m->session->status = status;
+	return sym;
+}
+
+static int
+matview_matches(mvc *sql, sql_table *mv, symbol *query)
+{
+	atom **args;
+	int argc, i, res;
+	symbol *def = matview_symbol(sql, mv, &args, &argc);
+
+	res = def && symbol_cmp(def, query) == 0 && argc == sql->argc;
+	for (i = 0; res && i < argc; i++) {
+		atom *a = args[i], *b = sql->args[i];
+
+		res = (a->isnull && b->isnull) ||
+			(!a->isnull && !b->isnull && subtype_cmp(&a->tpe, &b->tpe) == 0 && atom_cmp(a, b) == 0);
+	}
+	if (args)
+		_DELETE(args);
+	return res;
+}
+
+/* Answer a query from a materialized view of the current schema defined
+ * by the same query, the view being kept up to date. */
+sql_rel *
+rel_matview_answer(mvc *sql, symbol *query, sql_rel *rel)
+{
+	SelectNode *sn = (SelectNode *) query;
+	sql_schema *s = cur_schema(sql);
+	node *n, *m, *k;
+
+	if ((sql->emode != m_normal && sql->emode != m_plan) || !rel || !s || !s->tables.set ||
+	    query->token != SQL_SELECT || sn->orderby || sn->limit || sn->offset || sn->sample)
+		return rel;
+	for (n = s->tables.set->h; n; n = n->next) {
+		sql_table *mv = n->data;
+		list *qexps, *exps;
+
+		if (!isMatView(mv) || !matview_matches(sql, mv, query))
+			continue;
+		qexps = rel_projections(sql, rel, NULL, 1, 0);
+		exps = new_exp_list(sql->sa);
+		for (k = mv->columns.set->h, m = qexps->h; k && m; k = k->next, m = m->next) {
+			sql_column *c = k->data;
+			sql_exp *qe = m->data, *e;
+
+			if (subtype_cmp(&c->type, exp_subtype(qe)) != 0)
+				break;
+			e = exp_column(sql->sa, mv->base.name, c->base.name, &c->type, CARD_MULTI, c->null, 0);
+			exp_setname(sql->sa, e, exp_relname(qe), exp_name(qe));
+			append(exps, e);
+		}
+		if (k || m)
+			continue;
+		/* the answer does not depend on the literals, so the plan
+		 * cannot be reused for other values */
+		if (sql->argc)
+			sql->caching = 0;
+		return rel_project(sql->sa, rel_basetable(sql, mv, mv->base.name), exps);
+	}
+	return rel;
+}
@@ -0,0 +1,24 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+#ifndef _REL_MATVIEW_H_
+#define _REL_MATVIEW_H_
+
+#include "sql_list.h"
+#include "sql_symbol.h"
+#include "sql_mvc.h"
+#include "sql_relation.h"
+
+extern list *rel_matview_dependents(mvc *sql, sql_table *t);
+extern sql_rel *rel_matview_recompute(mvc *sql, sql_table *mv);
+extern list *rel_matview_append(mvc *sql, sql_table *mv, sql_table *t, sql_rel *delta);
+
+extern sql_rel *rel_refresh_matview(mvc *sql, dlist *qname);
+extern sql_rel *rel_matview_answer(mvc *sql, symbol *query, sql_rel *rel);
+
+#endif /*_REL_MATVIEW_H_*/
@@ -611,6 +611,27 @@ exps_count(list *exps)
 	return cnt;
 }
 
+/* extra weight for selections known (from the histograms kept by
+ * ANALYZE) to be very selective: 10 per factor of 10 reduction */
+static int
+exps_histogram_weight(mvc *sql, sql_rel *rel)
+{
+	node *n;
+	dbl sel = 1.0;
+
+	for (n = rel->exps->h; n; n = n->next) {
+		sql_exp *e = n->data;
+		dbl esel;
+
+		if (e->type == e_cmp && !is_complex_exp(e->flag) &&
+		    (esel = exp_histogram_selectivity(sql, rel, e)) >= 0)
+			sel *= esel;
+	}
+	if (sel <= 0.0000000001)
+		return 100;
+	return (int) (-log10(sel) * 10);
+}
+
 static list *
 order_join_expressions(mvc *sql, list *dje, list *rels)
 {
@@ -644,9 +665,9 @@ order_join_expressions(mvc *sql, list *dje, list *rels)
 			sql_rel *r = find_rel(rels, e->r);
 
 			if (l && is_select(l->op) && l->exps)
-				keys[i] += list_length(l->exps)*10 + exps_count(l->exps)*debug;
+				keys[i] += list_length(l->exps)*10 + exps_count(l->exps)*debug + exps_histogram_weight(sql, l);
 			if (r && is_select(r->op) && r->exps)
-				keys[i] += list_length(r->exps)*10 + exps_count(r->exps)*debug;
+				keys[i] += list_length(r->exps)*10 + exps_count(r->exps)*debug + exps_histogram_weight(sql, r);
 		}
 		pos[i] = i;
 	}
@@ -3714,6 +3735,42 @@ exp_uses_exp( list *exps, sql_exp *e)
 	return NULL;
 }
 
+/* whether all base tables below the union rel are members of merge table mt */
+static int
+rel_union_of_members(sql_rel *rel, sql_table *mt)
+{
+	if (!rel)
+		return 0;
+	if (is_union(rel->op) && !need_distinct(rel))
+		return rel_union_of_members(rel->l, mt) && rel_union_of_members(rel->r, mt);
+	if (rel->op == op_project || is_select(rel->op))
+		return rel_union_of_members(rel->l, mt);
+	if (is_basetable(rel->op) && rel->l)
+		return ((sql_table*)rel->l)->p == mt;
+	return 0;
+}
+
+/* whether groupby rel over union u groups on the declared partition
+ * column of the partitioned merge table the union is made of, ie every
+ * group falls within a single member */
+static int
+rel_groupby_on_partition(mvc *sql, sql_rel *rel, sql_rel *u)
+{
+	node *n;
+
+	if (!rel->r)
+		return 0;
+	for (n = ((list*)rel->r)->h; n; n = n->next) {
+		sql_column *c = exp_find_column(rel->l, n->data, -2), *pc;
+		int tpe = 0;
+
+		if (c && c->t->p && (pc = sql_trans_partition_column(sql->session->tr, c->t->p, &tpe)) != NULL &&
+		    strcmp(pc->base.name, c->base.name) == 0 && rel_union_of_members(u, c->t->p))
+			return 1;
+	}
+	return 0;
+}
+
 /*
  * Rewrite aggregations over union all.
  *	groupby ([ union all (a, b) ], [gbe], [ count, sum ] )
@@ -3731,6 +3788,7 @@ rel_push_aggr_down(int *changes, mvc *sql, sql_rel *rel)
 		sql_rel *ur = u->r;
 		node *n, *m;
 		list *lgbe = NULL, *rgbe = NULL, *gbe = NULL, *exps = NULL;
+		int partkey;
 
 		if (u->op == op_project)
 			u = u->l;
@@ -3746,8 +3804,11 @@ rel_push_aggr_down(int *changes, mvc *sql, sql_rel *rel)
 			return rel;
 
 		rel->subquery = 0;
+		/* groups on the partition column need no finalizing group by,
+		 * hence allow any aggregate */
+		partkey = rel_groupby_on_partition(sql, rel, u);
 		/* distinct should be done over the full result */
-		for (n = g->exps->h; n; n = n->next) {
+		for (n = g->exps->h; n && !partkey; n = n->next) {
 			sql_exp *e = n->data;
 			sql_subaggr *af = e->f;
 
@@ -3799,6 +3860,12 @@ rel_push_aggr_down(int *changes, mvc *sql, sql_rel *rel)
 		ur->card = g->card;
 		ur->exps = exps_copy(sql->sa, g->exps);
 
+		if (partkey) {
+			(*changes)++;
+			return rel_inplace_setop(rel, ul, ur, op_union,
+						 rel_projections(sql, rel, NULL, 1, 1));
+		}
+
 		/* group by on primary keys which define the partioning scheme 
 		 * don't need a finalizing group by */
 		/* how to check if a partion is based on some primary key ? 
@@ -8011,6 +8078,115 @@ rel_rename_part(mvc *sql, sql_rel *p, char *tname, sql_table *mt)
 }
 
 
+/* Whether the partition column values [lo, hi) (or [lo, hi] if hi_incl)
+ * can satisfy 'column cmp v'; a NULL bound is unbounded. */
+static int
+part_bounds_cmp(atom *lo, atom *hi, int hi_incl, int cmp, atom *v)
+{
+	switch (cmp) {
+	case cmp_equal:
+		return (!lo || atom_cmp(v, lo) >= 0) &&
+		       (!hi || atom_cmp(v, hi) < 0 || (hi_incl && atom_cmp(v, hi) == 0));
+	case cmp_gt:
+		return !hi || atom_cmp(hi, v) > 0;
+	case cmp_gte:
+		return !hi || atom_cmp(hi, v) > 0 || (hi_incl && atom_cmp(hi, v) == 0);
+	case cmp_lt:
+		return !lo || atom_cmp(lo, v) < 0;
+	case cmp_lte:
+		return !lo || atom_cmp(lo, v) <= 0;
+	}
+	return 1;
+}
+
+/* constant value of a selection on the partition column, NULL if unknown */
+static atom *
+part_exp_value(mvc *sql, sql_exp *e, sql_column *pc)
+{
+	atom *a = exp_flatten(sql, e);
+
+	if (!a || a->isnull || a->tpe.type->localtype != pc->type.type->localtype)
+		return NULL;
+	return a;
+}
+
+/* Whether the selections exps on rel leave rows with partition column
+ * pc values in [lo, hi) (or [lo, hi] if hi_incl). */
+static int
+part_bounds_match(mvc *sql, sql_rel *rel, list *exps, sql_column *pc, atom *lo, atom *hi, int hi_incl)
+{
+	node *n;
+
+	for (n = exps->h; n; n = n->next) {
+		sql_exp *e = n->data, *c = e->l;
+		atom *v;
+
+		if (e->type != e_cmp || is_anti(e) || c->type != e_column)
+			continue;
+		c = rel_find_exp(rel, c);
+		if (!c || c->type != e_column || !c->r || strcmp(c->r, pc->base.name) != 0)
+			continue;
+		if (get_cmp(e) == cmp_in) {
+			list *vals = e->r;
+			node *m;
+			int match = 0;
+
+			for (m = vals->h; m && !match; m = m->next) {
+				if (!(v = part_exp_value(sql, m->data, pc)))
+					break;
+				match = part_bounds_cmp(lo, hi, hi_incl, cmp_equal, v);
+			}
+			if (!m && !match)
+				return 0;
+		} else if (e->f) {
+			if ((v = part_exp_value(sql, e->r, pc)) != NULL &&
+			    !part_bounds_cmp(lo, hi, hi_incl, range2lcompare(e->flag), v))
+				return 0;
+			if ((v = part_exp_value(sql, e->f, pc)) != NULL &&
+			    !part_bounds_cmp(lo, hi, hi_incl, range2rcompare(e->flag), v))
+				return 0;
+		} else if (is_theta_exp(get_cmp(e)) && get_cmp(e) != cmp_notequal) {
+			if ((v = part_exp_value(sql, e->r, pc)) != NULL &&
+			    !part_bounds_cmp(lo, hi, hi_incl, get_cmp(e), v))
+				return 0;
+		}
+	}
+	return 1;
+}
+
+/* Whether member pt of merge table mt, partitioned on column pc, can
+ * hold rows passing the selections exps, judged by its declared bounds */
+static int
+rel_partition_matches(mvc *sql, sql_rel *rel, list *exps, sql_table *mt, sql_table *pt, sql_column *pc, int tpe)
+{
+	sql_trans *tr = sql->session->tr;
+
+	if (tpe == PARTITION_RANGE) {
+		char *min = NULL, *max = NULL;
+		atom *lo = NULL, *hi = NULL;
+
+		if (!sql_trans_range_partition(tr, sql->sa, mt, pt, &min, &max))
+			return 1;
+		if ((min && !(lo = atom_general(sql->sa, &pc->type, min))) ||
+		    (max && !(hi = atom_general(sql->sa, &pc->type, max))))
+			return 1;
+		return part_bounds_match(sql, rel, exps, pc, lo, hi, 0);
+	} else {
+		list *values = sql_trans_value_partition(tr, sql->sa, mt, pt);
+		node *n;
+
+		if (!values)
+			return 1;
+		for (n = values->h; n; n = n->next) {
+			atom *v = atom_general(sql->sa, &pc->type, n->data);
+
+			if (!v || part_bounds_match(sql, rel, exps, pc, v, v, 1))
+				return 1;
+		}
+		return 0;
+	}
+}
+
 /* rewrite merge tables into union of base tables and call optimizer again */
 static sql_rel *
 rel_merge_table_rewrite(int *changes, mvc *sql, sql_rel *rel)
@@ -8021,7 +8197,7 @@ rel_merge_table_rewrite(int *changes, mvc *sql, sql_rel *rel)
 		sel = rel;
 		rel = rel->l;
 	}
-	if (is_basetable(rel->op) && rel->l) {
+	if (is_basetable(rel->op) && rel->l && rel->flag != REL_MERGE_TARGET) {
 		sql_table *t = rel->l;
 
 		if (isMergeTable(t)) {
@@ -8029,6 +8205,8 @@ rel_merge_table_rewrite(int *changes, mvc *sql, sql_rel *rel)
 			sql_rel *nrel = NULL;
 			char *tname = t->base.name;
 			list *cols = NULL, *low = NULL, *high = NULL;
+			sql_column *pc = NULL;
+			int ptpe = 0;
 
 			if (list_empty(t->members.set)) 
 				return rel;
@@ -8039,6 +8217,7 @@ rel_merge_table_rewrite(int *changes, mvc *sql, sql_rel *rel)
 				if (list_length(t->members.set) <= 1) 
 					return sel;
 
+				pc = sql_trans_partition_column(sql->session->tr, t, &ptpe);
 				cols = sa_list(sql->sa);
 				low = sa_list(sql->sa);
 				high = sa_list(sql->sa);
@@ -8168,6 +8347,10 @@ rel_merge_table_rewrite(int *changes, mvc *sql, sql_rel *rel)
 					}
 					prel->exps = exps;
 					first = 0;
+					/* skip members whose declared partition excludes the selection */
+					if (!skip && pc && pt && (nrel || nt->next) &&
+					    !rel_partition_matches(sql, rel, sel->exps, t, pt, pc, ptpe))
+						skip = 1;
 					if (!skip) {
 						append(tables, prel);
 						nrel = prel;
@@ -8213,6 +8396,187 @@ rel_merge_table_rewrite(int *changes, mvc *sql, sql_rel *rel)
 	return rel;
 }
 
+/* basetable of a partitioned merge table, possibly below a selection */
+static sql_rel *
+rel_partitioned_merge_table(mvc *sql, sql_rel *rel, sql_rel **sel, sql_column **pc, int *tpe)
+{
+	*sel = NULL;
+	if (!rel || rel_is_ref(rel))
+		return NULL;
+	if (is_select(rel->op) && rel->l) {
+		*sel = rel;
+		rel = rel->l;
+		if (rel_is_ref(rel))
+			return NULL;
+	}
+	if (is_basetable(rel->op) && rel->l && rel->flag != REL_MERGE_TARGET) {
+		sql_table *t = rel->l;
+
+		if (isMergeTable(t) && !list_empty(t->members.set) &&
+		    (*pc = sql_trans_partition_column(sql->session->tr, t, tpe)) != NULL)
+			return rel;
+	}
+	return NULL;
+}
+
+/* whether members lt of lmt and rt of rmt declare the same partition */
+static int
+rel_partitions_equal(mvc *sql, int tpe, sql_table *lmt, sql_table *lt, sql_table *rmt, sql_table *rt)
+{
+	sql_trans *tr = sql->session->tr;
+
+	if (tpe == PARTITION_RANGE) {
+		char *lmin = NULL, *lmax = NULL, *rmin = NULL, *rmax = NULL;
+
+		if (!sql_trans_range_partition(tr, sql->sa, lmt, lt, &lmin, &lmax) ||
+		    !sql_trans_range_partition(tr, sql->sa, rmt, rt, &rmin, &rmax))
+			return 0;
+		return (lmin ? rmin && strcmp(lmin, rmin) == 0 : !rmin) &&
+		       (lmax ? rmax && strcmp(lmax, rmax) == 0 : !rmax);
+	} else {
+		list *lv = sql_trans_value_partition(tr, sql->sa, lmt, lt);
+		list *rv = sql_trans_value_partition(tr, sql->sa, rmt, rt);
+		node *n;
+
+		if (!lv || !rv || list_length(lv) != list_length(rv))
+			return 0;
+		for (n = lv->h; n; n = n->next)
+			if (!list_find(rv, n->data, (fcmp) &strcmp))
+				return 0;
+		return 1;
+	}
+}
+
+/* member pt of merge table relation rel, with the names of rel */
+static sql_rel *
+rel_merge_member(mvc *sql, sql_rel *rel, sql_table *pt)
+{
+	sql_table *mt = rel->l;
+	sql_rel *prel = rel_basetable(sql, pt, mt->base.name);
+	list *exps = sa_list(sql->sa);
+	node *n;
+
+	prel = rel_rename_part(sql, prel, mt->base.name, mt);
+	MT_lock_set(&prel->exps->ht_lock);
+	prel->exps->ht = NULL;
+	MT_lock_unset(&prel->exps->ht_lock);
+	for (n = rel->exps->h; n; n = n->next) {
+		sql_exp *e = n->data, *ne = exps_bind_column2(prel->exps, e->l, e->r);
+
+		if (!ne)
+			return NULL;
+		exp_setname(sql->sa, ne, e->l, e->r);
+		append(exps, ne);
+	}
+	prel->exps = exps;
+	return rel_project(sql->sa, prel, exps_copy(sql->sa, rel->exps));
+}
+
+/*
+ * Partition-wise join: a join on the partition columns of two merge tables
+ * with the same declared partitions only joins matching members
+ *	join(A, B) -> union(join(A1, B1), join(A2, B2), ..)
+ */
+static sql_rel *
+rel_merge_table_join(int *changes, mvc *sql, sql_rel *rel)
+{
+	sql_rel *l, *r, *lsel, *rsel;
+	sql_column *lpc = NULL, *rpc = NULL;
+	sql_table *lmt, *rmt;
+	int ltpe = 0, rtpe = 0, aligned = 0;
+	list *tables, *joins;
+	node *n, *m;
+
+	if (rel->op != op_join || rel_is_ref(rel) || list_empty(rel->exps) ||
+	    !(l = rel_partitioned_merge_table(sql, rel->l, &lsel, &lpc, &ltpe)) ||
+	    !(r = rel_partitioned_merge_table(sql, rel->r, &rsel, &rpc, &rtpe)))
+		return rel;
+	lmt = l->l;
+	rmt = r->l;
+	if (lmt == rmt || ltpe != rtpe || subtype_cmp(&lpc->type, &rpc->type) != 0 ||
+	    list_length(lmt->members.set) != list_length(rmt->members.set))
+		return rel;
+
+	/* the join needs an equality on both partition columns */
+	for (n = rel->exps->h; n && !aligned; n = n->next) {
+		sql_exp *e = n->data;
+		sql_column *lc, *rc;
+
+		if (e->type != e_cmp || e->flag != cmp_equal)
+			continue;
+		lc = exp_find_column(rel->l, e->l, -2);
+		rc = exp_find_column(rel->r, e->r, -2);
+		if (lc != lpc || rc != rpc) {
+			lc = exp_find_column(rel->l, e->r, -2);
+			rc = exp_find_column(rel->r, e->l, -2);
+		}
+		aligned = (lc == lpc && rc == rpc);
+	}
+	if (!aligned)
+		return rel;
+
+	/* pair the members */
+	tables = sa_list(sql->sa);
+	for (n = lmt->members.set->h; n; n = n->next) {
+		sql_part *lpd = n->data;
+		sql_table *lt = find_sql_table(lmt->s, lpd->base.name), *rt = NULL;
+
+		for (m = rmt->members.set->h; m && !rt; m = m->next) {
+			sql_part *rpd = m->data;
+			sql_table *t = find_sql_table(rmt->s, rpd->base.name);
+
+			if (lt && t && rel_partitions_equal(sql, ltpe, lmt, lt, rmt, t))
+				rt = t;
+		}
+		if (!rt)
+			return rel;
+		append(tables, lt);
+		append(tables, rt);
+	}
+
+	joins = sa_list(sql->sa);
+	for (n = tables->h; n; n = n->next->next) {
+		sql_table *lt = n->data, *rt = n->next->data;
+		sql_rel *nl, *nr, *j;
+
+		/* an inner join, so skip pairs where either member fails its
+		 * selection (keep at least one pair) */
+		if ((!list_empty(joins) || n->next->next) &&
+		    ((lsel && !rel_partition_matches(sql, l, lsel->exps, lmt, lt, lpc, ltpe)) ||
+		     (rsel && !rel_partition_matches(sql, r, rsel->exps, rmt, rt, rpc, rtpe)))) {
+			sql->caching = 0;
+			continue;
+		}
+		if (!(nl = rel_merge_member(sql, l, lt)) || !(nr = rel_merge_member(sql, r, rt)))
+			return rel;
+		if (lsel)
+			nl = rel_select_copy(sql->sa, nl, exps_copy(sql->sa, lsel->exps));
+		if (rsel)
+			nr = rel_select_copy(sql->sa, nr, exps_copy(sql->sa, rsel->exps));
+		j = rel_crossproduct(sql->sa, nl, nr, op_join);
+		j->exps = exps_copy(sql->sa, rel->exps);
+		append(joins, rel_project(sql->sa, j, rel_projections(sql, j, NULL, 1, 1)));
+	}
+	while (list_length(joins) > 1) {
+		list *njoins = sa_list(sql->sa);
+
+		for (n = joins->h; n && n->next; n = n->next->next) {
+			sql_rel *u = rel_setop(sql->sa, n->data, n->next->data, op_union);
+
+			u->exps = rel_projections(sql, rel, NULL, 1, 1);
+			set_processed(u);
+			append(njoins, u);
+		}
+		if (n)
+			append(njoins, n->data);
+		joins = njoins;
+	}
+	(*changes)++;
+	l = joins->h->data;
+	rel_destroy(rel);
+	return l;
+}
+
 /* TODO move all apply related stuff in to rel_apply.c/h */
 static int exps_uses_exps(list *users, list *exps);
 
@@ -9341,6 +9705,8 @@ optimize_rel(mvc *sql, sql_rel *rel, int *g_changes, int level)
 		changes = 0;
 	}
 
+	if (gp.cnt[op_join])
+		rel = rewrite_topdown(sql, rel, &rel_merge_table_join, &changes);
 	rel = rewrite_topdown(sql, rel, &rel_merge_table_rewrite, &changes);
 	if (level <= 0 && mvc_debug_on(sql,8))
 		rel = rewrite_topdown(sql, rel, &rel_add_dicts, &changes);
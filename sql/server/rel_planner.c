@@ -294,6 +294,68 @@ exp_getrange_sel( mvc *sql, sql_rel *r, sql_exp *e, void *min, void *max)
 	return sel;
 }
 
+/* selectivity of a comparison against constants, based on the
+ * histogram and most common values of the column (if analyzed),
+ * negative if unknown */
+dbl
+exp_histogram_selectivity( mvc *sql, sql_rel *r, sql_exp *e)
+{
+	sql_rel *bt = NULL;
+	sql_exp *le = e->l;
+	sql_column *c;
+	atom *lo = NULL, *hi = NULL;
+	int li = 1, hi_incl = 1;
+
+	if (le->type != e_column || is_anti(e) ||
+	    (c = name_find_column(r, le->l, le->r, -1, &bt)) == NULL)
+		return -1;
+	if (e->f) {
+		lo = exp_getatom(sql, e->r, NULL);
+		hi = exp_getatom(sql, e->f, NULL);
+		li = range2lcompare(e->flag) == cmp_gte;
+		hi_incl = range2rcompare(e->flag) == cmp_lte;
+		if (!lo || !hi)
+			return -1;
+	} else {
+		atom *a = exp_getatom(sql, e->r, NULL);
+
+		if (!a)
+			return -1;
+		switch (get_cmp(e)) {
+		case cmp_equal:
+			lo = hi = a;
+			break;
+		case cmp_gt:
+			li = 0;
+			/* fall through */
+		case cmp_gte:
+			lo = a;
+			break;
+		case cmp_lt:
+			hi_incl = 0;
+			/* fall through */
+		case cmp_lte:
+			hi = a;
+			break;
+		default:
+			return -1;
+		}
+	}
+	/* cast copies, the atoms may be part of the plan */
+	if (lo && (lo->isnull || (lo = atom_dup(sql->sa, lo)) == NULL ||
+		   !atom_cast(sql->sa, lo, &c->type)))
+		return -1;
+	if (get_cmp(e) == cmp_equal && !e->f)
+		hi = lo;
+	else if (hi && (hi->isnull || (hi = atom_dup(sql->sa, hi)) == NULL ||
+			!atom_cast(sql->sa, hi, &c->type)))
+		return -1;
+	return sql_trans_selectivity(sql->session->tr, c,
+				     lo ? VALptr(&lo->data) : NULL,
+				     hi ? VALptr(&hi->data) : NULL,
+				     li, hi_incl);
+}
+
 static dbl
 rel_exp_selectivity(mvc *sql, sql_rel *r, sql_exp *e, lng count)
 {
@@ -305,6 +367,14 @@ rel_exp_selectivity(mvc *sql, sql_rel *r, sql_exp *e, lng count)
 	case e_cmp: {
 		lng dcount = exp_getdcount( sql, r, e->l, count);
 
+		if (get_cmp(e) == cmp_equal || get_cmp(e) == cmp_gt ||
+		    get_cmp(e) == cmp_gte || get_cmp(e) == cmp_lt ||
+		    get_cmp(e) == cmp_lte) {
+			sel = exp_histogram_selectivity(sql, r, e);
+			if (sel >= 0)
+				return sel > 0.000001 ? sel : 0.000001;
+			sel = 1.0;
+		}
 		switch (get_cmp(e)) {
 		case cmp_equal: {
 			sel = 1.0/dcount;
@@ -13,5 +13,6 @@
 #include "sql_mvc.h"
 
 extern sql_rel * rel_planner(mvc *sql, list *rels, list *djes, list *ojes);
+extern dbl exp_histogram_selectivity(mvc *sql, sql_rel *r, sql_exp *e);
 
 #endif /*_REL_PLANNER_H_ */
@@ -1109,6 +1109,53 @@ rel_create_view(mvc *sql, sql_schema *ss, dlist *qname, dlist *column_spec, symb
 	return NULL;
 }
 
+static sql_rel *
+rel_create_matview(mvc *sql, dlist *qname, dlist *column_spec, symbol *query)
+{
+	char *name = qname_table(qname);
+	char *sname = qname_schema(qname);
+	sql_schema *s = NULL;
+	sql_table *t = NULL;
+	sql_rel *sq = NULL, *res = NULL;
+	int create = (sql->emode != m_instantiate && sql->emode != m_deps);
+	char *q = QUERY(sql->scanner);
+
+	if (sname && !(s = mvc_bind_schema(sql, sname))) 
+		return sql_error(sql, 02, SQLSTATE(3F000) "CREATE MATERIALIZED VIEW: no such schema '%s'", sname);
+	if (s == NULL)
+		s = cur_schema(sql);
+
+	if (create && !mvc_schema_privs(sql, s))
+		return sql_error(sql, 02, SQLSTATE(42000) "CREATE MATERIALIZED VIEW: access denied for %s to schema ;'%s'", stack_get_string(sql, "current_user"), s->base.name);
+	if (create && mvc_bind_table(sql, s, name) != NULL)
+		return sql_error(sql, 02, SQLSTATE(42S01) "CREATE MATERIALIZED VIEW: name '%s' already in use", name);
+	if (query->token == SQL_SELECT && ((SelectNode *) query)->limit)
+		return sql_error(sql, 01, SQLSTATE(42000) "CREATE MATERIALIZED VIEW: LIMIT not supported");
+
+	sq = schema_selects(sql, s, query);
+	if (!sq)
+		return NULL;
+	if (!create) {
+		/* the definition is instantiated to (re)compute its contents */
+		if (sq->op == op_project && sq->l && sq->exps && sq->card == CARD_AGGR) {
+			exps_setcard(sq->exps, CARD_MULTI);
+			sq->card = CARD_MULTI;
+		}
+		return sq;
+	}
+
+	/* a materialized view is a table which keeps its defining query */
+	if ((t = mvc_create_table_as_subquery(sql, sq, s, name, column_spec, SQL_PERSIST, CA_COMMIT)) == NULL) {
+		rel_destroy(sq);
+		return NULL;
+	}
+	q = query_cleaned(q);
+	t->query = sa_strdup(sql->sa, q);
+	GDKfree(q);
+	res = rel_table(sql, DDL_CREATE_TABLE, s->base.name, t, SQL_PERSIST);
+	return rel_insert(sql, res, sq);
+}
+
 static sql_rel *
 rel_schema2(sql_allocator *sa, int cat_type, char *sname, char *auth, int nr)
 {
@@ -1313,6 +1360,48 @@ get_schema_name( mvc *sql, char *sname, char *tname)
 	return sname;
 }
 
+/* A partition bound or value as a string in the storage format of
+ * the partition column c. */
+static char *
+partition_value(mvc *sql, sql_column *c, symbol *s, char *tname)
+{
+	int is_last = 0;
+	exp_kind ek = {type_value, card_value, FALSE};
+	sql_exp *e = rel_value_exp2(sql, NULL, s, sql_sel, ek, &is_last);
+	atom *a = NULL;
+
+	if (!e || !(e = rel_check_type(sql, &c->type, e, type_equal)))
+		return NULL;
+	if (!(a = exp_flatten(sql, e)))
+		return sql_error(sql, 02, SQLSTATE(42000) "ALTER TABLE: the partition bounds and values of '%s' must be constants", tname);
+	if (a->isnull)
+		return sql_error(sql, 02, SQLSTATE(42000) "ALTER TABLE: the partition bounds and values of '%s' cannot be NULL", tname);
+	return atom2string(sql->sa, a);
+}
+
+static sql_rel *
+rel_alter_table_add_partition(mvc *sql, sql_table *mt, char *sname, char *tname, char *psname, char *ptname, symbol *ps)
+{
+	int tpe = 0, values = ps->token == SQL_PARTITION_VALUES;
+	sql_column *c = sql_trans_partition_column(sql->session->tr, mt, &tpe);
+	sql_rel *rel;
+	dnode *n;
+
+	if (!c)
+		return sql_error(sql, 02, SQLSTATE(42000) "ALTER TABLE: merge table '%s' is not partitioned", tname);
+	if (values != (tpe == PARTITION_VALUES))
+		return sql_error(sql, 02, SQLSTATE(42000) "ALTER TABLE: merge table '%s' is partitioned by %s", tname, values ? "range" : "values");
+	rel = rel_alter_table(sql->sa, DDL_ALTER_TABLE_ADD_PARTITION, sname, tname, psname, ptname, tpe);
+	for (n = ps->data.lval->h; n; n = n->next) {
+		char *v = NULL;
+
+		if (n->data.sym && !(v = partition_value(sql, c, n->data.sym, ptname)))
+			return NULL;
+		append(rel->exps, exp_atom_clob(sql->sa, v));
+	}
+	return rel;
+}
+
 static sql_rel *
 sql_alter_table(mvc *sql, dlist *qname, symbol *te)
 {
@@ -1332,6 +1421,8 @@ sql_alter_table(mvc *sql, dlist *qname, symbol *te)
 		if (mvc_bind_table(sql, mvc_bind_schema(sql, "tmp"), tname) != NULL) 
 			return sql_error(sql, 02, SQLSTATE(42S02) "ALTER TABLE: not supported on TEMPORARY table '%s'", tname);
 		return sql_error(sql, 02, SQLSTATE(42S02) "ALTER TABLE: no such table '%s' in schema '%s'", tname, s->base.name);
+	} else if (isMatView(t)) {
+		return sql_error(sql, 02, SQLSTATE(42000) "ALTER TABLE: cannot alter MATERIALIZED VIEW '%s'", tname);
 	} else {
 		node *n;
 		sql_rel *res = NULL, *r;
@@ -1360,6 +1451,13 @@ sql_alter_table(mvc *sql, dlist *qname, symbol *te)
 			if (!nsname)
 				nsname = sname;
 			if (te->token == SQL_TABLE) {
+				symbol *ps = te->data.lval->h->next ? te->data.lval->h->next->data.sym : NULL;
+				int tpe = 0;
+
+				if (ps)
+					return rel_alter_table_add_partition(sql, t, sname, tname, nsname, ntname, ps);
+				if (sql_trans_partition_column(sql->session->tr, t, &tpe))
+					return sql_error(sql, 02, SQLSTATE(42000) "ALTER TABLE: a table added to partitioned merge table '%s' needs its partition bounds or values (AS PARTITION)", tname);
 				return rel_alter_table(sql->sa, DDL_ALTER_TABLE_ADD_TABLE, sname, tname, nsname, ntname, 0);
 			} else {
 				int drop_action = te->data.lval->h->next->data.i_val;
@@ -1368,6 +1466,21 @@ sql_alter_table(mvc *sql, dlist *qname, symbol *te)
 			}
 		}
 
+		/* compact is done by the vacuum procedure */
+		if (te && te->token == SQL_COMPACT) {
+			sql_exp *se = exp_atom_clob(sql->sa, sname), *tbe = exp_atom_clob(sql->sa, tname);
+			sql_subfunc *f = sql_bind_func(sql->sa, mvc_bind_schema(sql, "sys"), "vacuum", exp_subtype(se), exp_subtype(tbe), F_PROC);
+			list *args = sa_list(sql->sa);
+
+			if (!f)
+				return sql_error(sql, 02, SQLSTATE(42000) "ALTER TABLE: COMPACT needs the procedure sys.vacuum");
+			if (!isTable(t))
+				return sql_error(sql, 02, SQLSTATE(42000) "ALTER TABLE: cannot compact '%s', it is not a table", tname);
+			append(args, se);
+			append(args, tbe);
+			return rel_psm_stmt(sql->sa, exp_op(sql->sa, args, f));
+		}
+
 		/* read only or read write */
 		if (te && te->token == SQL_ALTER_TABLE) {
 			int state = te->data.i_val;
@@ -2295,6 +2408,24 @@ rel_schemas(mvc *sql, symbol *s)
 							   l->h->next->next->next->data.i_val,
 							   l->h->next->next->next->next->data.sval,
 							   l->h->next->next->next->next->next->data.i_val); /* if not exists */
+		/* the declared partitioning of a merge table */
+		if (ret && temp == SQL_MERGE_TABLE && l->h->next->next->next->next->next->next &&
+		    l->h->next->next->next->next->next->next->data.lval) {
+			dlist *p = l->h->next->next->next->next->next->next->data.lval;
+			int tpe = p->h->data.i_val;
+			char *cname = p->h->next->data.sval;
+			sql_rel *cr = ret->flag == DDL_LIST ? ret->l : ret;
+			sql_table *t = rel_ddl_table_get(cr);
+			sql_rel *pr;
+
+			if (!t) /* the table already existed */
+				break;
+			if (!find_sql_column(t, cname))
+				return sql_error(sql, 02, SQLSTATE(42S22) "CREATE MERGE TABLE: no such column '%s' to partition '%s' on", cname, name);
+			pr = rel_alter_table(sql->sa, DDL_ALTER_TABLE_SET_PARTITION, t->s ? t->s->base.name : cur_schema(sql)->base.name, name, NULL, NULL, tpe);
+			append(pr->exps, exp_atom_clob(sql->sa, cname));
+			ret = rel_list(sql->sa, ret, pr);
+		}
 	} 	break;
 	case SQL_CREATE_VIEW:
 	{
@@ -2309,14 +2440,42 @@ rel_schemas(mvc *sql, symbol *s)
 							  l->h->next->next->next->next->data.i_val,
 							  l->h->next->next->next->next->next->data.i_val); /* or replace */
 	} 	break;
+	case SQL_CREATE_MATVIEW:
+	{
+		dlist *l = s->data.lval;
+
+		ret = rel_create_matview(sql, l->h->data.lval,
+							  l->h->next->data.lval,
+							  l->h->next->next->data.sym);
+	} 	break;
 	case SQL_DROP_TABLE:
 	{
 		dlist *l = s->data.lval;
 		char *sname = qname_schema(l->h->data.lval);
 		char *tname = qname_table(l->h->data.lval);
+		sql_table *t;
+
+		assert(l->h->next->type == type_int);
+		sname = get_schema_name(sql, sname, tname);
+		if ((t = mvc_bind_table(sql, mvc_bind_schema(sql, sname), tname)) != NULL && isMatView(t))
+			return sql_error(sql, 02, SQLSTATE(42000) "DROP TABLE: cannot drop MATERIALIZED VIEW '%s'", tname);
+		ret = rel_drop(sql->sa, DDL_DROP_TABLE, sname, tname,
+						 l->h->next->data.i_val,
+						 l->h->next->next->data.i_val); /* if exists */
+	} 	break;
+	case SQL_DROP_MATVIEW:
+	{
+		dlist *l = s->data.lval;
+		char *sname = qname_schema(l->h->data.lval);
+		char *tname = qname_table(l->h->data.lval);
+		sql_table *t;
 
 		assert(l->h->next->type == type_int);
 		sname = get_schema_name(sql, sname, tname);
+		if ((t = mvc_bind_table(sql, mvc_bind_schema(sql, sname), tname)) != NULL && !isMatView(t))
+			return sql_error(sql, 02, SQLSTATE(42000) "DROP MATERIALIZED VIEW: '%s' is not a materialized view", tname);
+		if (!t && !l->h->next->next->data.i_val)
+			return sql_error(sql, 02, SQLSTATE(42S02) "DROP MATERIALIZED VIEW: unknown materialized view '%s'", tname);
 		ret = rel_drop(sql->sa, DDL_DROP_TABLE, sname, tname,
 						 l->h->next->data.i_val,
 						 l->h->next->next->data.i_val); /* if exists */
@@ -2326,9 +2485,12 @@ rel_schemas(mvc *sql, symbol *s)
 		dlist *l = s->data.lval;
 		char *sname = qname_schema(l->h->data.lval);
 		char *tname = qname_table(l->h->data.lval);
+		sql_table *t;
 
 		assert(l->h->next->type == type_int);
 		sname = get_schema_name(sql, sname, tname);
+		if ((t = mvc_bind_table(sql, mvc_bind_schema(sql, sname), tname)) != NULL && isMatView(t))
+			return sql_error(sql, 02, SQLSTATE(42000) "DROP VIEW: '%s' is a materialized view, use DROP MATERIALIZED VIEW", tname);
 		ret = rel_drop(sql->sa, DDL_DROP_VIEW, sname, tname,
 						 l->h->next->data.i_val,
 						 l->h->next->next->data.i_val); /* if exists */
@@ -21,6 +21,7 @@
 #include "rel_schema.h"
 #include "rel_remote.h"
 #include "rel_sequence.h"
+#include "rel_matview.h"
 #ifdef HAVE_HGE
 #include "mal.h"		/* for have_hge */
 #endif
@@ -3506,6 +3507,15 @@ rel_nop(mvc *sql, sql_rel **rel, symbol *se, int fs, exp_kind ek)
 
 }
 
+/* the result type of a is the type of its first argument */
+static int
+aggr_any_res(sql_subaggr *a)
+{
+	sql_arg *r = a->aggr->res && a->aggr->res->h ? a->aggr->res->h->data : NULL;
+
+	return r && r->type.type->eclass == EC_ANY;
+}
+
 static sql_exp *
 _rel_aggr(mvc *sql, sql_rel **rel, int distinct, sql_schema *s, char *aname, dnode *args, int f)
 {
@@ -3629,13 +3639,18 @@ _rel_aggr(mvc *sql, sql_rel **rel, int distinct, sql_schema *s, char *aname, dno
 					sql_arg *arg = op->data;
 					sql_exp *e = n->data;
 
-					e = rel_check_type(sql, &arg->type, e, type_equal);
+					if (arg->type.type->eclass != EC_ANY)
+						e = rel_check_type(sql, &arg->type, e, type_equal);
 					if (!e)
 						a = NULL;
 					list_append(nexps, e);
 				}
 				if (a && list_length(nexps))  /* count(col) has |exps| != |nexps| */
 					exps = nexps;
+				/* bind again to get the result type of
+				 * aggregates with an ANY result */
+				if (a && list_length(nexps) && aggr_any_res(a))
+					a = sql_bind_aggr_(sql->sa, s, aname, exp_types(sql->sa, exps));
 				}
 		} else {
 			sql_exp *l = exps->h->data, *ol = l;
@@ -3693,13 +3708,16 @@ _rel_aggr(mvc *sql, sql_rel **rel, int distinct, sql_schema *s, char *aname, dno
 					sql_arg *arg = op->data;
 					sql_exp *e = n->data;
 
-					e = rel_check_type(sql, &arg->type, e, type_equal);
+					if (arg->type.type->eclass != EC_ANY)
+						e = rel_check_type(sql, &arg->type, e, type_equal);
 					if (!e)
 						a = NULL;
 					list_append(nexps, e);
 				}
 				if (a && list_length(nexps))  /* count(col) has |exps| != |nexps| */
 					exps = nexps;
+				if (a && list_length(nexps) && aggr_any_res(a))
+					a = sql_bind_aggr_(sql->sa, s, aname, exp_types(sql->sa, exps));
 			}
 		}
 	}
@@ -4380,22 +4398,49 @@ rel_order_by(mvc *sql, sql_rel **R, symbol *orderby, int f )
 	return exps;
 }
 
-static list *
-rel_frame(mvc *sql, symbol *frame, list *exps)
+/* a bound of a window frame: its kind and, if the bound is an offset
+ * from the current row, the offset cast to type t */
+static sql_exp *
+rel_frame_bound(mvc *sql, symbol *bound, sql_subtype *t, int *kind)
+{
+	exp_kind ek = {type_value, card_value, FALSE};
+	sql_exp *e;
+
+	if (bound->token == SQL_FRAME) {
+		*kind = bound->data.i_val < 0 ? WINDOW_UNBOUNDED : WINDOW_CURRENT;
+		return exp_atom_lng(sql->sa, 0);
+	}
+	*kind = bound->token == SQL_FOLLOWING ? WINDOW_FOLLOWING : WINDOW_PRECEDING;
+	if (!t)
+		return sql_error(sql, 02, SQLSTATE(42000) "OVER: RANGE frames with an offset need a single numeric ORDER BY column");
+	if ((e = rel_value_exp(sql, NULL, bound->data.sym, sql_sel, ek)) == NULL)
+		return NULL;
+	if (exp_card(e) > CARD_ATOM)
+		return sql_error(sql, 02, SQLSTATE(42000) "OVER: the offset of a frame must be a constant");
+	return rel_check_type(sql, t, e, type_equal);
+}
+
+/* the unit and the kinds and offsets of the start and end of a window
+ * frame, ROWS offsets are counted in rows, RANGE offsets in the type
+ * of the ordering column ot */
+static int
+rel_frame(mvc *sql, symbol *frame, sql_subtype *ot, int *unit, int *kinds, sql_exp **offsets)
 {
-	/* units, extent, exclusion */
+	/* start, end, units, exclusion */
 	dnode *d = frame->data.lval->h;
+	int excl = d->next->next->next->data.i_val;
 
-	/* RANGE vs UNITS */
-	sql_exp *units = exp_atom_int(sql->sa, d->next->next->data.i_val);
-	sql_exp *start = exp_atom_int(sql->sa, d->data.i_val);
-	sql_exp *end   = exp_atom_int(sql->sa, d->next->data.i_val);
-	sql_exp *excl  = exp_atom_int(sql->sa, d->next->next->next->data.i_val);
-	append(exps, units);
-	append(exps, start);
-	append(exps, end);
-	append(exps, excl);
-	return exps;
+	*unit = d->next->next->data.i_val == FRAME_ROWS ? WINDOW_ROWS : WINDOW_RANGE;
+	if (excl != EXCLUDE_NONE && excl != EXCLUDE_NO_OTHERS) {
+		(void) sql_error(sql, 02, SQLSTATE(42000) "OVER: frame exclusion is not supported");
+		return -1;
+	}
+	if (*unit == WINDOW_ROWS)
+		ot = sql_bind_localtype("lng");
+	if ((offsets[0] = rel_frame_bound(sql, d->data.sym, ot, &kinds[0])) == NULL ||
+	    (offsets[1] = rel_frame_bound(sql, d->next->data.sym, ot, &kinds[1])) == NULL)
+		return -1;
+	return 0;
 }
 
 /* window functions */
@@ -4427,9 +4472,10 @@ rel_rankop(mvc *sql, sql_rel **rel, symbol *se, int f)
 	sql_subfunc *wf = NULL;
 	sql_exp *e = NULL, *pe = NULL, *oe = NULL;
 	sql_rel *r = *rel, *p;
-	list *gbe = NULL, *obe = NULL, *fbe = NULL, *args, *types;
+	sql_exp *ob = NULL, *shift = NULL, *dflt = NULL, *offsets[2];
+	list *gbe = NULL, *obe = NULL, *args;
 	sql_schema *s = sql->session->schema;
-	int distinct = 0, project_added = 0;
+	int project_added = 0, unit = WINDOW_ROWS, kinds[2];
 	
 	if (window_function->token == SQL_RANK) {
 		aname = qname_fname(window_function->data.lval);
@@ -4490,29 +4536,84 @@ rel_rankop(mvc *sql, sql_rel **rel, symbol *se, int f)
 			p->r = obe;
 		}
 	}
-	/* Frame */
-	if (window_specification->h->next->next->data.sym) {
-		fbe = new_exp_list(sql->sa);
-		fbe = rel_frame(sql, window_specification->h->next->next->data.sym, fbe);
-		if (!fbe)
-			return NULL;
-	}
-
 	if (window_function->token == SQL_RANK) {
 		e = p->exps->h->data; 
 		e = exp_column(sql->sa, exp_relname(e), exp_name(e), exp_subtype(e), exp_card(e), has_nil(e), is_intern(e));
 	} else {
 		dnode *n = window_function->data.lval->h->next;
+		int is_last = 0;
+		exp_kind ek = {type_value, card_column, FALSE};
+
+		if (n->data.i_val)
+			return sql_error(sql, 02, SQLSTATE(42000) "OVER: DISTINCT is not supported in window functions");
+		n = n->next;
+		if (n->data.sym) {
+			e = rel_value_exp2(sql, &p, n->data.sym, f, ek, &is_last);
+		} else { /* count(*) counts the rows of the frame */
+			e = exp_atom_bool(sql->sa, 1);
+		}
+		if (e && strcmp(aname, "avg") == 0 && exp_subtype(e)->type->eclass == EC_DEC)
+			e = rel_check_type(sql, sql_bind_localtype("dbl"), e, type_equal);
+		if (!e)
+			return NULL;
+		/* the aggregates need the values as a column */
+		if (e->type != e_column) {
+			exp_label(sql->sa, e, ++sql->label);
+			append(p->exps, e);
+			e = exp_column(sql->sa, exp_relname(e), exp_name(e), exp_subtype(e), CARD_MULTI, has_nil(e), is_intern(e));
+		}
+		if (strcmp(aname, "lag") == 0 || strcmp(aname, "lead") == 0) {
+			/* offset (default 1) and default value */
+			exp_kind vk = {type_value, card_value, FALSE};
 
-		if (n) {
-			int is_last = 0;
-			exp_kind ek = {type_value, card_column, FALSE};
-
-			distinct = n->data.i_val;
-			e = rel_value_exp2(sql, &p, n->next->data.sym, f, ek, &is_last);
+			if (n->next) {
+				if ((shift = rel_value_exp(sql, NULL, n->next->data.sym, sql_sel, vk)) == NULL)
+					return NULL;
+				shift = rel_check_type(sql, sql_bind_localtype("lng"), shift, type_equal);
+			} else {
+				shift = exp_atom_lng(sql->sa, 1);
+			}
+			if (n->next && n->next->next) {
+				if ((dflt = rel_value_exp(sql, NULL, n->next->next->data.sym, sql_sel, vk)) == NULL)
+					return NULL;
+				dflt = rel_check_type(sql, exp_subtype(e), dflt, type_equal);
+			} else {
+				dflt = exp_atom(sql->sa, atom_general(sql->sa, exp_subtype(e), NULL));
+			}
+			if (!shift || !dflt)
+				return NULL;
+			if (exp_card(shift) > CARD_ATOM || exp_card(dflt) > CARD_ATOM)
+				return sql_error(sql, 02, SQLSTATE(42000) "OVER: the offset and default of %s must be constants", aname);
+		} else if (n->next) {
+			return sql_error(sql, 02, SQLSTATE(42000) "SELECT: function '%s' not found", aname);
+		} else if (window_specification->h->next->next->data.sym) {
+			/* Frame, RANGE offsets need a single numeric
+			 * ordering column */
+			sql_subtype *ot = NULL;
+
+			if (obe && list_length(obe) == 1) {
+				sql_exp *oc = obe->h->data;
+				int ec = exp_subtype(oc)->type->eclass;
+
+				if (ec == EC_NUM || ec == EC_DEC || ec == EC_FLT) {
+					ot = exp_subtype(oc);
+					ob = oc;
+				}
+			}
+			if (rel_frame(sql, window_specification->h->next->next->data.sym, ot, &unit, kinds, offsets) < 0)
+				return NULL;
+			if (unit == WINDOW_ROWS || (kinds[0] < WINDOW_PRECEDING && kinds[1] < WINDOW_PRECEDING))
+				ob = NULL;
+		} else {
+			/* by default the frame runs from the start of the
+			 * partition up to the last peer of the current row,
+			 * or to the end of the partition if unordered */
+			unit = WINDOW_RANGE;
+			kinds[0] = WINDOW_UNBOUNDED;
+			kinds[1] = obe ? WINDOW_CURRENT : WINDOW_UNBOUNDED;
+			offsets[0] = offsets[1] = exp_atom_lng(sql->sa, 0);
 		}
 	}
-	(void)distinct;
 
 	/* diff for partitions */
 	if (gbe) {
@@ -4563,17 +4664,50 @@ rel_rankop(mvc *sql, sql_rel **rel, symbol *se, int f)
 
 	if (!e || !pe || !oe)
 		return NULL;
-	types = sa_list(sql->sa);
-	append(types, exp_subtype(e));
-	append(types, exp_subtype(pe));
-	append(types, exp_subtype(oe));
-	wf = bind_func_(sql, s, aname, types, F_ANALYTIC);
-	if (!wf)
-		return sql_error(sql, 02, SQLSTATE(42000) "SELECT: function '%s' not found", aname );
 	args = sa_list(sql->sa);
 	append(args, e);
-	append(args, pe);
-	append(args, oe);
+	if (window_function->token == SQL_RANK) {
+		append(args, pe);
+		append(args, oe);
+	} else if (shift) {
+		append(args, shift);
+		append(args, dflt);
+		append(args, pe);
+	} else {
+		/* the aggregates get the start and end of the frame of
+		 * each row */
+		int i;
+
+		for (i = 0; i < 2; i++) {
+			list *bargs = sa_list(sql->sa);
+			sql_subfunc *bf;
+
+			append(bargs, ob ? ob : e);
+			append(bargs, pe);
+			append(bargs, oe);
+			append(bargs, exp_atom_int(sql->sa, unit));
+			append(bargs, exp_atom_int(sql->sa, kinds[i]));
+			append(bargs, exp_atom_bool(sql->sa, i));
+			append(bargs, exp_atom_bool(sql->sa, ob && !is_ascending(ob)));
+			append(bargs, offsets[i]);
+			bf = bind_func_(sql, s, "window_bound", exp_types(sql->sa, bargs), F_ANALYTIC);
+			if (!bf)
+				return sql_error(sql, 02, SQLSTATE(42000) "SELECT: function '%s' not found", "window_bound");
+			append(args, exp_op(sql->sa, bargs, bf));
+		}
+	}
+	wf = bind_func_(sql, s, aname, exp_types(sql->sa, args), F_ANALYTIC);
+	if (!wf)
+		return sql_error(sql, 02, SQLSTATE(42000) "SELECT: function '%s' not found", aname );
+	if (window_function->token != SQL_RANK &&
+	    (strcmp(aname, "sum") == 0 || strcmp(aname, "avg") == 0)) {
+		/* the types of the plain aggregates apply */
+		sql_subaggr *a = sql_bind_aggr(sql->sa, s, aname, exp_subtype(e));
+
+		if (!a)
+			return sql_error(sql, 02, SQLSTATE(42000) "SELECT: function '%s' not found", aname );
+		wf->res = a->res;
+	}
 	e = exp_op(sql->sa, args, wf);
 
 	r->l = p = rel_project(sql->sa, p, rel_projections(sql, p, NULL, 1, 1));
@@ -5689,6 +5823,7 @@ rel_selects(mvc *sql, symbol *s)
 			return rel_select_with_into(sql, s);
 		}
 		ret = rel_subquery(sql, NULL, s, ek, APPLY_JOIN);
+		ret = rel_matview_answer(sql, s, ret);
 		sql->type = Q_TABLE;
 	}	break;
 	case SQL_JOIN:
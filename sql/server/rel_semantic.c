@@ -133,8 +133,10 @@ rel_semantic(mvc *sql, symbol *s)
 
 	case SQL_CREATE_TABLE:
 	case SQL_CREATE_VIEW:
+	case SQL_CREATE_MATVIEW:
 	case SQL_DROP_TABLE:
 	case SQL_DROP_VIEW:
+	case SQL_DROP_MATVIEW:
 	case SQL_ALTER_TABLE:
 
 	case SQL_COMMENT:
@@ -182,6 +184,7 @@ rel_semantic(mvc *sql, symbol *s)
 	case SQL_UPDATE:
 	case SQL_DELETE:
 	case SQL_TRUNCATE:
+	case SQL_REFRESH_MATVIEW:
 	case SQL_COPYFROM:
 	case SQL_BINCOPYFROM:
 	case SQL_COPYLOADER:
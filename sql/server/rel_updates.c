@@ -16,6 +16,8 @@
 #include "rel_optimizer.h"
 #include "rel_dump.h"
 #include "rel_psm.h"
+#include "rel_schema.h"
+#include "rel_matview.h"
 #include "sql_symbol.h"
 
 static sql_exp *
@@ -391,11 +393,15 @@ rel_inserts(mvc *sql, sql_table *t, sql_rel *r, list *collist, size_t rowcount,
 static sql_table *
 insert_allowed(mvc *sql, sql_table *t, char *tname, char *op, char *opname)
 {
+	int tpe = 0;
+
 	if (!t) {
 		return sql_error(sql, 02, SQLSTATE(42S02) "%s: no such table '%s'", op, tname);
 	} else if (isView(t)) {
 		return sql_error(sql, 02, SQLSTATE(42000) "%s: cannot %s view '%s'", op, opname, tname);
-	} else if (isMergeTable(t)) {
+	} else if (isMatView(t)) {
+		return sql_error(sql, 02, SQLSTATE(42000) "%s: cannot %s materialized view '%s'", op, opname, tname);
+	} else if (isMergeTable(t) && !(strcmp(op, "INSERT INTO") == 0 && sql_trans_partition_column(sql->session->tr, t, &tpe))) {
 		return sql_error(sql, 02, SQLSTATE(42000) "%s: cannot %s merge table '%s'", op, opname, tname);
 	} else if (isStream(t)) {
 		return sql_error(sql, 02, SQLSTATE(42000) "%s: cannot %s stream '%s'", op, opname, tname);
@@ -411,6 +417,117 @@ insert_allowed(mvc *sql, sql_table *t, char *tname, char *op, char *opname)
 	return t;
 }
 
+static sql_exp *
+exp_ref(sql_allocator *sa, sql_exp *e)
+{
+	return exp_column(sa, exp_relname(e), exp_name(e), exp_subtype(e), e->card, has_nil(e), is_intern(e));
+}
+
+/* The rows of inserts that belong to member pt of the partitioned merge
+ * table mt, or NULL if pt has no bounds or values. */
+static sql_rel *
+rel_partition_rows(mvc *sql, sql_table *mt, sql_table *pt, sql_column *pc, sql_exp *key, sql_rel *inserts, sql_exp **cond)
+{
+	sql_trans *tr = sql->session->tr;
+	list *exps = new_exp_list(sql->sa);
+	sql_exp *c = NULL;
+	char *lo = NULL, *hi = NULL;
+	list *values;
+
+	if (sql_trans_range_partition(tr, sql->sa, mt, pt, &lo, &hi)) {
+		if (lo) {
+			sql_exp *l = exp_atom(sql->sa, atom_general(sql->sa, &pc->type, lo));
+
+			append(exps, exp_compare(sql->sa, exp_ref(sql->sa, key), l, cmp_gte));
+			c = rel_binop_(sql, exp_ref(sql->sa, key), exp_copy(sql->sa, l), NULL, ">=", card_value);
+		}
+		if (hi) {
+			sql_exp *h = exp_atom(sql->sa, atom_general(sql->sa, &pc->type, hi));
+			sql_exp *hc = rel_binop_(sql, exp_ref(sql->sa, key), exp_copy(sql->sa, h), NULL, "<", card_value);
+
+			append(exps, exp_compare(sql->sa, exp_ref(sql->sa, key), h, cmp_lt));
+			c = c ? rel_binop_(sql, c, hc, NULL, "and", card_value) : hc;
+		}
+		if (!c) /* unbounded on both sides */
+			c = rel_unop_(sql, rel_unop_(sql, exp_ref(sql->sa, key), NULL, "isnull", card_value), NULL, "not", card_value);
+	} else if ((values = sql_trans_value_partition(tr, sql->sa, mt, pt)) != NULL) {
+		list *vals = new_exp_list(sql->sa);
+		node *n;
+
+		for (n = values->h; n; n = n->next) {
+			sql_exp *v = exp_atom(sql->sa, atom_general(sql->sa, &pc->type, n->data));
+			sql_exp *vc = rel_binop_(sql, exp_ref(sql->sa, key), exp_copy(sql->sa, v), NULL, "=", card_value);
+
+			append(vals, v);
+			c = c ? rel_binop_(sql, c, vc, NULL, "or", card_value) : vc;
+		}
+		append(exps, exp_in(sql->sa, exp_ref(sql->sa, key), vals, cmp_in));
+	} else {
+		return NULL;
+	}
+	if (!c)
+		return NULL;
+	*cond = *cond ? rel_binop_(sql, *cond, c, NULL, "or", card_value) : c;
+	inserts = rel_select_copy(sql->sa, rel_dup(inserts), exps);
+	return rel_project(sql->sa, inserts, rel_projections(sql, inserts, NULL, 1, 1));
+}
+
+/* An insert into a partitioned merge table is a list of inserts into
+ * its members, each of the rows with a partition key within the bounds
+ * or values of the member.  The list ends with an insert of the rows
+ * that fit no member into the merge table itself, which fails if there
+ * are any. */
+static sql_rel *
+rel_insert_partitions(mvc *sql, sql_table *mt, sql_rel *inserts)
+{
+	int tpe = 0;
+	sql_column *pc = sql_trans_partition_column(sql->session->tr, mt, &tpe);
+	sql_exp *key = NULL, *cond = NULL, *nokey;
+	sql_rel *res, *rest;
+	list *ins = sa_list(sql->sa);
+	node *n;
+
+	for (n = inserts->exps->h; n; n = n->next) {
+		sql_exp *e = n->data;
+
+		if (!e->name)
+			exp_label(sql->sa, e, ++sql->label);
+	}
+	key = list_fetch(inserts->exps, pc->colnr);
+
+	if (mt->members.set) {
+		for (n = mt->members.set->h; n; n = n->next) {
+			sql_part *p = n->data;
+			sql_table *pt = find_sql_table(mt->s, p->base.name);
+			sql_rel *rows;
+
+			if (!pt || !(rows = rel_partition_rows(sql, mt, pt, pc, key, inserts, &cond)))
+				continue;
+			if (insert_allowed(sql, pt, pt->base.name, "INSERT INTO", "insert into") == NULL)
+				return NULL;
+			list_prepend(ins, rel_insert_table(sql, pt, pt->base.name, rows));
+		}
+	}
+
+	/* the rows with a NULL key or outside all members */
+	nokey = rel_unop_(sql, exp_ref(sql->sa, key), NULL, "isnull", card_value);
+	if (cond)
+		nokey = rel_binop_(sql, nokey, rel_unop_(sql, cond, NULL, "not", card_value), NULL, "or", card_value);
+	rest = rel_select_copy(sql->sa, rel_dup(inserts), append(new_exp_list(sql->sa), exp_compare(sql->sa, nokey, exp_atom_bool(sql->sa, 1), cmp_equal)));
+	rest = rel_project(sql->sa, rest, rel_projections(sql, rest, NULL, 1, 1));
+	res = rel_create(sql->sa);
+	if (!res)
+		return NULL;
+	res->op = op_insert;
+	res->l = rel_basetable(sql, mt, mt->base.name);
+	res->r = rest;
+	((sql_rel*)res->l)->flag = REL_MERGE_TARGET;
+
+	for (n = ins->h; n; n = n->next) /* in reverse order */
+		res = rel_list(sql->sa, n->data, res);
+	return res;
+}
+
 static int 
 copy_allowed(mvc *sql, int from)
 {
@@ -426,6 +543,8 @@ update_allowed(mvc *sql, sql_table *t, char *tname, char *op, char *opname, int
 		return sql_error(sql, 02, SQLSTATE(42S02) "%s: no such table '%s'", op, tname);
 	} else if (isView(t)) {
 		return sql_error(sql, 02, SQLSTATE(42000) "%s: cannot %s view '%s'", op, opname, tname);
+	} else if (isMatView(t)) {
+		return sql_error(sql, 02, SQLSTATE(42000) "%s: cannot %s materialized view '%s'", op, opname, tname);
 	} else if (isMergeTable(t)) {
 		return sql_error(sql, 02, SQLSTATE(42000) "%s: cannot %s merge table '%s'", op, opname, tname);
 	} else if (isStream(t)) {
@@ -558,6 +677,8 @@ insert_into(mvc *sql, dlist *qname, dlist *columns, symbol *val_or_q)
 		return sql_error(sql, 02, SQLSTATE(21S01) "INSERT INTO: query result doesn't match number of columns in table '%s'", tname);
 
 	r->exps = rel_inserts(sql, t, r, collist, rowcount, 0);
+	if (isMergeTable(t))
+		return rel_insert_partitions(sql, t, r);
 	return rel_insert_table(sql, t, tname, r);
 }
 
@@ -1315,6 +1436,53 @@ rel_import(mvc *sql, sql_table *t, char *tsep, char *rsep, char *ssep, char *ns,
 	return res;
 }
 
+/* Arrow IPC and Parquet files are recognized by their extension */
+static int
+is_columnar_file(const char *fname)
+{
+	static const char *exts[] = { ".parquet", ".arrow", ".arrows", ".feather", NULL };
+	size_t len = fname ? strlen(fname) : 0;
+	int i;
+
+	for (i = 0; exts[i]; i++) {
+		size_t l = strlen(exts[i]);
+
+		if (len > l && strcasecmp(fname + len - l, exts[i]) == 0)
+			return 1;
+	}
+	return 0;
+}
+
+static sql_rel *
+rel_import_columnar(mvc *sql, sql_table *t, char *filename, lng nr, lng offset)
+{
+	list *exps, *args;
+	node *n;
+	sql_subtype tpe;
+	sql_exp *import;
+	sql_schema *sys = mvc_bind_schema(sql, "sys");
+	sql_subfunc *f = sql_find_func(sql->sa, sys, "copyfrom", 4, F_UNION, NULL);
+
+	if (!f)
+		return sql_error(sql, 02, SQLSTATE(42000) "COPY INTO: Arrow and Parquet files are not supported");
+	f->res = table_column_types(sql->sa, t);
+ 	sql_find_subtype(&tpe, "varchar", 0, 0);
+	args = append(append(append(append(new_exp_list(sql->sa),
+		exp_atom_ptr(sql->sa, t)),
+		exp_atom_str(sql->sa, filename, &tpe)),
+		exp_atom_lng(sql->sa, nr)),
+		exp_atom_lng(sql->sa, offset));
+	import = exp_op(sql->sa, args, f);
+
+	exps = new_exp_list(sql->sa);
+	for (n = t->columns.set->h; n; n = n->next) {
+		sql_column *c = n->data;
+		if (c->base.name[0] != '%')
+			append(exps, exp_column(sql->sa, t->base.name, c->base.name, &c->type, CARD_MULTI, c->null, 0));
+	}
+	return rel_table_func(sql->sa, NULL, import, exps, 1);
+}
+
 static sql_rel *
 copyfrom(mvc *sql, dlist *qname, dlist *columns, dlist *files, dlist *headers, dlist *seps, dlist *nr_offset, str null_string, int locked, int best_effort, int constraint, dlist *fwf_widths)
 {
@@ -1438,7 +1606,16 @@ copyfrom(mvc *sql, dlist *qname, dlist *columns, dlist *files, dlist *headers, d
 				return sql_error(sql, 02, SQLSTATE(42000) "COPY INTO: filename must "
 						"have absolute path: %s", fname);
 
-			nrel = rel_import(sql, nt, tsep, rsep, ssep, ns, fname, nr, offset, locked, best_effort, fwf_widths);
+			if (is_columnar_file(fname)) {
+				/* LOCKED appends the text files directly to the table */
+				if (locked)
+					return sql_error(sql, 02, SQLSTATE(42000) "COPY INTO .. LOCKED: not allowed for Arrow and Parquet files");
+				if (fwf_widths && dlist_length(fwf_widths) > 0)
+					return sql_error(sql, 02, SQLSTATE(42000) "COPY INTO: fixed width import not allowed for Arrow and Parquet files");
+				nrel = rel_import_columnar(sql, nt, fname, nr, offset);
+			} else {
+				nrel = rel_import(sql, nt, tsep, rsep, ssep, ns, fname, nr, offset, locked, best_effort, fwf_widths);
+			}
 
 			if (!rel)
 				rel = nrel;
@@ -1509,6 +1686,138 @@ copyfrom(mvc *sql, dlist *qname, dlist *columns, dlist *files, dlist *headers, d
 	return rel;
 }
 
+/* replace the parameters by the imported parameter columns */
+static sql_exp *
+exp_import_param(mvc *sql, sql_exp *e, list *params, int *nr)
+{
+	sql_exp *ne;
+	node *n;
+
+	switch (e->type) {
+	case e_atom:
+		if (e->l || e->r || e->f)
+			return e;
+		ne = list_fetch(params, e->flag);
+		ne = exp_column(sql->sa, exp_relname(ne), exp_name(ne), exp_subtype(ne), CARD_MULTI, has_nil(ne), 0);
+		if (e->name)
+			exp_setname(sql->sa, ne, exp_relname(e), exp_name(e));
+		(*nr)++;
+		return ne;
+	case e_convert:
+		e->l = exp_import_param(sql, e->l, params, nr);
+		e->card = ((sql_exp *) e->l)->card;
+		return e;
+	case e_func:
+	case e_aggr:
+		if (e->l) for (n = ((list *) e->l)->h; n; n = n->next) {
+			n->data = exp_import_param(sql, n->data, params, nr);
+			if (((sql_exp *) n->data)->card > e->card)
+				e->card = ((sql_exp *) n->data)->card;
+		}
+		return e;
+	default:
+		return e;
+	}
+}
+
+/* put the imported parameter rows underneath the values list, returns
+ * whether the relation depends on them or -1 for a parameter used
+ * elsewhere.  The values list may be shared, e.g. for the join index of
+ * a foreign key, hence the relations are visited once. */
+static int
+rel_import_param(mvc *sql, sql_rel *rel, sql_rel *params, list *done, list *uses)
+{
+	int use = 0, luse, ruse = 0, nr = 0;
+	node *n;
+
+	if (!rel || rel == params)
+		return 0;
+	if (list_find(done, rel, NULL))
+		return list_find(uses, rel, NULL) != NULL;
+	append(done, rel);
+
+	switch (rel->op) {
+	case op_basetable:
+	case op_table:
+		break;
+	case op_project:
+	case op_select:
+	case op_groupby:
+	case op_topn:
+	case op_sample:
+		use = rel_import_param(sql, rel->l, params, done, uses);
+		break;
+	default:
+		luse = rel_import_param(sql, rel->l, params, done, uses);
+		if (luse >= 0)
+			ruse = rel_import_param(sql, rel->r, params, done, uses);
+		use = (luse < 0 || ruse < 0) ? -1 : (luse || ruse);
+		break;
+	}
+	if (use < 0)
+		return use;
+	if (rel->exps) for (n = rel->exps->h; n; n = n->next)
+		n->data = exp_import_param(sql, n->data, params->exps, &nr);
+	if (nr) {
+		if (!is_simple_project(rel->op) || rel->l || rel->r)
+			return -1;
+		rel->l = params;
+		use = 1;
+	}
+	if (use && !is_modify(rel->op) && !is_ddl(rel->op) && rel->op != op_groupby) {
+		rel->card = CARD_MULTI;
+		for (n = rel->exps->h; n; n = n->next) {
+			sql_exp *e = n->data;
+
+			if (e->type == e_column && e->card == CARD_ATOM)
+				e->card = CARD_MULTI;
+		}
+	}
+	if (use)
+		append(uses, rel);
+	return use;
+}
+
+/* EXECUTE .. FROM STDIN runs a prepared INSERT INTO .. VALUES once for
+ * all parameter rows that follow the statement.  The rows are imported
+ * as with COPY INTO .. FROM STDIN and the parameters of the (single row)
+ * values list are replaced by the imported columns, hence the rows are
+ * appended to the table one column at a time. */
+sql_rel *
+rel_import_params(mvc *sql, sql_rel *rel, dlist *seps, dlist *nr_offset, str null_string, int best_effort)
+{
+	char *tsep = seps->h->data.sval;
+	char *rsep = seps->h->next->data.sval;
+	char *ssep = (seps->h->next->next)?seps->h->next->next->data.sval:NULL;
+	char *ns = (null_string)?null_string:"null";
+	lng nr = (nr_offset)?nr_offset->h->data.l_val:-1;
+	lng offset = (nr_offset)?nr_offset->h->next->data.l_val:0;
+	sql_rel *params;
+	sql_table *t;
+	node *n;
+	int i = 0;
+
+	if (!rel || rel->op != op_insert || list_empty(sql->params))
+		return sql_error(sql, 02, SQLSTATE(42000) "EXECUTE FROM STDIN: only allowed for INSERT INTO .. VALUES statements with parameters");
+
+	t = mvc_create_table(sql, cur_schema(sql), "params", tt_table, 0, SQL_DECLARED_TABLE, CA_COMMIT, -1);
+	for (n = sql->params->h; n; n = n->next) {
+		sql_arg *a = n->data;
+		char name[16];
+
+		if (!a->type.type)
+			return sql_error(sql, 02, SQLSTATE(42000) "EXECUTE FROM STDIN: could not determine the type of parameter %d", i + 1);
+		snprintf(name, sizeof(name), "p%d", i++);
+		mvc_create_column(sql, t, sa_strdup(sql->sa, name), &a->type);
+	}
+	params = rel_import(sql, t, tsep, rsep, ssep, ns, NULL, nr, offset, 0, best_effort, NULL);
+	if (!params)
+		return NULL;
+	if (rel_import_param(sql, rel, params, sa_list(sql->sa), sa_list(sql->sa)) <= 0)
+		return sql_error(sql, 02, SQLSTATE(42000) "EXECUTE FROM STDIN: only allowed for INSERT INTO .. VALUES statements with parameters");
+	return rel;
+}
+
 static sql_rel *
 bincopyfrom(mvc *sql, dlist *qname, dlist *columns, dlist *files, int constraint)
 {
@@ -1880,6 +2189,10 @@ rel_updates(mvc *sql, symbol *s)
 		sql->type = Q_UPDATE;
 	}
 		break;
+	case SQL_REFRESH_MATVIEW:
+		ret = rel_refresh_matview(sql, s->data.lval);
+		sql->type = Q_UPDATE;
+		break;
 	default:
 		sql->use_views = old;
 		return sql_error(sql, 01, SQLSTATE(42000) "Updates statement unknown Symbol(%p)->token = %s", s, token2string(s->token));
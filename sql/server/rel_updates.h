@@ -24,5 +24,6 @@ extern sql_rel *rel_truncate(sql_allocator *sa, sql_rel *t, int drop_action, int
 extern sql_exp * rel_parse_val(mvc *m, char *query, char emode);
 
 extern sql_rel *rel_updates(mvc *sql, symbol *sym);
+extern sql_rel *rel_import_params(mvc *sql, sql_rel *rel, dlist *seps, dlist *nr_offset, str null_string, int best_effort);
 
 #endif /*_REL_UPDATES_H_*/
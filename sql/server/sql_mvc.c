@@ -73,6 +73,7 @@ mvc_init(int debug, store_type store, int ro, int su, backend_stack stk)
 		fprintf(stderr, "#mvc_init shared_drift_threshold %d\n", log_settings.shared_drift_threshold);
 	}
 	keyword_init();
+	qc_shared_init();
 	if(scanner_init_keywords() != 0) {
 		fprintf(stderr, "!mvc_init: malloc failure\n");
 		return -1;
@@ -200,6 +201,7 @@ mvc_exit(void)
 	if (mvc_debug)
 		fprintf(stderr, "#mvc_exit\n");
 
+	qc_shared_exit();
 	store_exit();
 	keyword_exit();
 }
@@ -330,11 +332,21 @@ sql_trans_deref( sql_trans *tr )
 	return tr->parent;
 }
 
+static void
+mvc_commit_sync(int lognr)
+{
+	if (store_sync(lognr) != LOG_OK) {
+		char *msg = sql_message(SQLSTATE(40000) "COMMIT: transaction commit failed (perhaps your disk is full?) exiting (kernel error: %s)", GDKerrbuf);
+		GDKfatal("%s", msg);
+		_DELETE(msg);
+	}
+}
+
 int
 mvc_commit(mvc *m, int chain, const char *name)
 {
 	sql_trans *cur, *tr = m->session->tr, *ctr;
-	int ok = SQL_OK;//, wait = 0;
+	int ok = SQL_OK, lognr = 0;//, wait = 0;
 	str msg;
 
 	assert(tr);
@@ -430,7 +442,11 @@ build up the hash (not copied in the trans dup)) */
 	 * */
 	/* validation phase */
 	if (sql_trans_validate(tr)) {
-		if ((ok = sql_trans_commit(tr)) != SQL_OK) {
+		/* let the backend drop what depends on the old state */
+		backend_commit(tr);
+		/* the log is synced after releasing the store lock, such
+		 * that concurrent commits share a single sync */
+		if ((ok = sql_trans_commit_nowait(tr, &lognr)) != SQL_OK) {
 			char *msg = sql_message(SQLSTATE(40000) "COMMIT: transaction commit failed (perhaps your disk is full?) exiting (kernel error: %s)", GDKerrbuf);
 			GDKfatal("%s", msg);
 			_DELETE(msg);
@@ -444,6 +460,7 @@ build up the hash (not copied in the trans dup)) */
 	msg = WLCcommit(m->clientid);
 	if(msg != MAL_SUCCEED) {
 		store_unlock();
+		mvc_commit_sync(lognr);
 		(void) sql_error(m, 02, "%s\n", msg);
 		mvc_rollback(m, chain, name);
 		return -1;
@@ -452,6 +469,7 @@ build up the hash (not copied in the trans dup)) */
 	if (chain) 
 		sql_trans_begin(m->session);
 	store_unlock();
+	mvc_commit_sync(lognr);
 	m->type = Q_TRANS;
 	if (mvc_debug)
 		fprintf(stderr, "#mvc_commit %s done\n", (name) ? name : "");
@@ -22,6 +22,7 @@ typedef enum tokens {
 	SQL_CREATE_SCHEMA,
 	SQL_CREATE_TABLE,
 	SQL_CREATE_VIEW,
+	SQL_CREATE_MATVIEW,
 	SQL_CREATE_INDEX,
 	SQL_CREATE_ROLE,
 	SQL_CREATE_USER,
@@ -33,6 +34,7 @@ typedef enum tokens {
 	SQL_DROP_SCHEMA,
 	SQL_DROP_TABLE,
 	SQL_DROP_VIEW,
+	SQL_DROP_MATVIEW,
 	SQL_DROP_INDEX,
 	SQL_DROP_ROLE,
 	SQL_DROP_USER,
@@ -47,6 +49,10 @@ typedef enum tokens {
 	SQL_DROP_COLUMN,
 	SQL_DROP_CONSTRAINT,
 	SQL_DROP_DEFAULT,
+	SQL_COMPACT,
+	SQL_REFRESH_MATVIEW,
+	SQL_PARTITION_RANGE,
+	SQL_PARTITION_VALUES,
 	SQL_ANALYZE,
 	SQL_DECLARE,
 	SQL_COMMENT,
@@ -145,6 +151,8 @@ typedef enum tokens {
 	SQL_AGGR,
 	SQL_RANK,
 	SQL_FRAME,
+	SQL_PRECEDING,
+	SQL_FOLLOWING,
 	SQL_COMPARE,
 	SQL_FILTER,
 	SQL_ROUTINE,
@@ -143,9 +143,11 @@ int yydebug=1;
 	schema_element
 	delete_stmt
 	truncate_stmt
+	refresh_stmt
 	copyfrom_stmt
 	table_def
 	view_def
+	matview_def
 	query_expression_def
 	query_expression
 	with_query_expression
@@ -229,6 +231,8 @@ int yydebug=1;
 	scalar_exp
 	pred_exp
 	simple_scalar_exp
+	partition_spec
+	partition_bound
 	value_exp
 	column_exp
 	atom
@@ -381,6 +385,7 @@ int yydebug=1;
 	table_ref_commalist
 	table_element_list
 	table_opt_storage
+	opt_partition_by
 	as_subquery_clause
 	column_exp_commalist
 	column_option_list
@@ -596,7 +601,7 @@ SQLCODE SQLERROR UNDER WHENEVER
 %token CHECK CONSTRAINT CREATE COMMENT
 %token TYPE PROCEDURE FUNCTION sqlLOADER AGGREGATE RETURNS EXTERNAL sqlNAME DECLARE
 %token CALL LANGUAGE
-%token ANALYZE MINMAX SQL_EXPLAIN SQL_PLAN SQL_DEBUG SQL_TRACE PREP PREPARE EXEC EXECUTE
+%token ANALYZE COMPACT MATERIALIZED REFRESH MINMAX SQL_EXPLAIN SQL_PLAN SQL_DEBUG SQL_TRACE PREP PREPARE EXEC EXECUTE
 %token DEFAULT DISTINCT DROP TRUNCATE
 %token FOREIGN
 %token RENAME ENCRYPTED UNENCRYPTED PASSWORD GRANT REVOKE ROLE ADMIN INTO
@@ -1057,6 +1062,11 @@ alter_statement:
 	  append_list(l, $3);
 	  append_symbol(l, _symbol_create_list( SQL_TABLE, append_list(L(),$6)));
 	  $$ = _symbol_create_list( SQL_ALTER_TABLE, l ); }
+ | ALTER TABLE qname ADD TABLE qname AS PARTITION partition_spec
+	{ dlist *l = L();
+	  append_list(l, $3);
+	  append_symbol(l, _symbol_create_list( SQL_TABLE, append_symbol(append_list(L(),$6), $9)));
+	  $$ = _symbol_create_list( SQL_ALTER_TABLE, l ); }
  | ALTER TABLE qname ALTER alter_table_element
 	{ dlist *l = L();
 	  append_list(l, $3);
@@ -1082,6 +1092,11 @@ alter_statement:
 	  append_list(l, $3);
 	  append_symbol(l, _symbol_create_int(SQL_ALTER_TABLE, tr_writable));
 	  $$ = _symbol_create_list( SQL_ALTER_TABLE, l ); }
+ | ALTER TABLE qname COMPACT
+	{ dlist *l = L();
+	  append_list(l, $3);
+	  append_symbol(l, _symbol_create(SQL_COMPACT, NULL));
+	  $$ = _symbol_create_list( SQL_ALTER_TABLE, l ); }
  | ALTER USER ident passwd_schema
 	{ dlist *l = L();
 	  append_string(l, $3);
@@ -1186,6 +1201,7 @@ create_statement:
    create role_def 	{ $$ = $2; }
  | create table_def 	{ $$ = $2; }
  | view_def 	{ $$ = $1; }
+ | matview_def
  | type_def
  | func_def
  | index_def
@@ -1341,6 +1357,28 @@ table_opt_storage:
  |  STORAGE ident STRING { $$ = append_string(append_string(L(), $2), $3); } 
  ;
 
+opt_partition_by:
+    /* empty */			{ $$ = NULL; }
+ |  PARTITION BY RANGE ON '(' ident ')'
+				{ $$ = append_string(append_int(L(), PARTITION_RANGE), $6); }
+ |  PARTITION BY VALUES ON '(' ident ')'
+				{ $$ = append_string(append_int(L(), PARTITION_VALUES), $6); }
+ ;
+
+/* the minimum of a range partition is inclusive, the maximum exclusive */
+partition_spec:
+    FROM partition_bound TO partition_bound
+		{ $$ = _symbol_create_list( SQL_PARTITION_RANGE, append_symbol(append_symbol(L(), $2), $4)); }
+ |  sqlIN '(' value_commalist ')'
+		{ $$ = _symbol_create_list( SQL_PARTITION_VALUES, $3); }
+ ;
+
+partition_bound:
+    simple_scalar_exp
+ |  RANGE MINVALUE		{ $$ = NULL; }
+ |  RANGE MAXVALUE		{ $$ = NULL; }
+ ;
+
 table_def:
     TABLE if_not_exists qname table_content_source  table_opt_storage
 	{ int commit_action = CA_COMMIT;
@@ -1372,7 +1410,7 @@ table_def:
 	  append_string(l, NULL);
 	  append_int(l, $3);
 	  $$ = _symbol_create_list( SQL_CREATE_TABLE, l ); }
- |  MERGE TABLE if_not_exists qname table_content_source 
+ |  MERGE TABLE if_not_exists qname table_content_source opt_partition_by
 	{ int commit_action = CA_COMMIT, tpe = SQL_MERGE_TABLE;
 	  dlist *l = L();
 
@@ -1382,6 +1420,7 @@ table_def:
 	  append_int(l, commit_action);
 	  append_string(l, NULL);
 	  append_int(l, $3);
+	  append_list(l, $6);
 	  $$ = _symbol_create_list( SQL_CREATE_TABLE, l ); }
  |  REPLICA TABLE if_not_exists qname table_content_source 
 	{ int commit_action = CA_COMMIT, tpe = SQL_REPLICA_TABLE;
@@ -1773,6 +1812,16 @@ view_def:
 	}
   ;
 
+matview_def:
+    create MATERIALIZED VIEW qname opt_column_list AS query_expression_def
+	{  dlist *l = L();
+	  append_list(l, $4);
+	  append_list(l, $5);
+	  append_symbol(l, $7);
+	  $$ = _symbol_create_list( SQL_CREATE_MATVIEW, l ); 
+	}
+  ;
+
 query_expression_def:
 	query_expression
   |	'(' query_expression_def ')'	{ $$ = $2; }
@@ -2559,6 +2608,12 @@ drop_statement:
 	  append_int(l, $5 );
 	  append_int(l, $3 );
 	  $$ = _symbol_create_list( SQL_DROP_VIEW, l ); }
+ |  drop MATERIALIZED VIEW if_exists qname drop_action
+	{ dlist *l = L();
+	  append_list(l, $5 );
+	  append_int(l, $6 );
+	  append_int(l, $4 );
+	  $$ = _symbol_create_list( SQL_DROP_MATVIEW, l ); }
  |  drop TYPE qname drop_action
 	{ dlist *l = L();
 	  append_list(l, $3 );
@@ -2605,6 +2660,7 @@ update_statement:
 /* todo merge statement */
    delete_stmt
  | truncate_stmt
+ | refresh_stmt
  | insert_stmt
  | update_stmt
  | copyfrom_stmt
@@ -2877,6 +2933,11 @@ truncate_stmt:
 	  $$ = _symbol_create_list( SQL_TRUNCATE, l ); }
  ;
 
+refresh_stmt:
+   REFRESH MATERIALIZED VIEW qname
+	{ $$ = _symbol_create_list( SQL_REFRESH_MATVIEW, $4 ); }
+ ;
+
 update_stmt:
     UPDATE qname SET assignment_commalist opt_from_clause opt_where_clause
 
@@ -3999,6 +4060,21 @@ window_function:
 window_function_type:
 	qrank '(' ')' 	{ $$ = _symbol_create_list( SQL_RANK, $1 ); }
   |	aggr_ref
+  /* lag and lead with their default offset resp. with a default value */
+  |	qaggr2 '(' case_scalar_exp ')'
+		{ dlist *l = L();
+  		  append_list(l, $1);
+  		  append_int(l, FALSE);
+  		  append_symbol(l, $3);
+		  $$ = _symbol_create_list( SQL_AGGR, l ); }
+  |	qaggr2 '(' case_scalar_exp ',' case_scalar_exp ',' case_scalar_exp ')'
+		{ dlist *l = L();
+  		  append_list(l, $1);
+  		  append_int(l, FALSE);
+  		  append_symbol(l, $3);
+  		  append_symbol(l, $5);
+  		  append_symbol(l, $7);
+		  $$ = _symbol_create_list( SQL_AGGR, l ); }
   ;
 
 window_specification:
@@ -4030,18 +4106,19 @@ window_frame_units:
   ;
 
 window_frame_extent:
-	window_frame_start	{ $$ = append_symbol(append_symbol(L(), $1), _symbol_create_int(SQL_FRAME, -1)); }
+	window_frame_start	{ $$ = append_symbol(append_symbol(L(), $1), _symbol_create_int(SQL_FRAME, 0)); }
   |	window_frame_between	{ $$ = $1; }
   ;
 
 window_frame_start:
 	UNBOUNDED PRECEDING	{ $$ = _symbol_create_int(SQL_FRAME, -1); }
   |	window_frame_preceding  { $$ = $1; }
+  | 	window_frame_following	{ $$ = $1; }
   |	CURRENT ROW		{ $$ = _symbol_create_int(SQL_FRAME, 0); }
   ;
 
 window_frame_preceding:
-	value_exp PRECEDING	{ $$ = $1; }
+	value_exp PRECEDING	{ $$ = _symbol_create_symbol(SQL_PRECEDING, $1); }
   ;
 	
 window_frame_between:
@@ -4051,12 +4128,13 @@ window_frame_between:
 
 window_frame_end:
 	UNBOUNDED FOLLOWING	{ $$ = _symbol_create_int(SQL_FRAME, -1); }
+  |	window_frame_preceding  { $$ = $1; }
   | 	window_frame_following	{ $$ = $1; }
   |	CURRENT ROW		{ $$ = _symbol_create_int(SQL_FRAME, 0); }
   ;
 
 window_frame_following:
-	value_exp FOLLOWING	{ $$ = $1; }
+	value_exp FOLLOWING	{ $$ = _symbol_create_symbol(SQL_FOLLOWING, $1); }
   ;
 
 window_frame_exclusion:
@@ -5421,6 +5499,9 @@ non_reserved_word:
 |  TEMPORARY	{ $$ = sa_strdup(SA, "temporary"); }
 |  TEMP		{ $$ = sa_strdup(SA, "temp"); }
 |  ANALYZE	{ $$ = sa_strdup(SA, "analyze"); }
+|  COMPACT	{ $$ = sa_strdup(SA, "compact"); }
+|  MATERIALIZED	{ $$ = sa_strdup(SA, "materialized"); }
+|  REFRESH	{ $$ = sa_strdup(SA, "refresh"); }
 |  MINMAX	{ $$ = sa_strdup(SA, "MinMax"); }
 |  STORAGE	{ $$ = sa_strdup(SA, "storage"); }
 |  GEOMETRY	{ $$ = sa_strdup(SA, "geometry"); }
@@ -5525,6 +5606,17 @@ exec:
 		{
 		  m->emode = m_execute;
 		  $$ = $2; }
+ |   execute intval FROM STDIN opt_nr opt_seps opt_null_string opt_best_effort
+		/* the parameter rows follow the statement, as with COPY INTO */
+		{ dlist *l = L();
+		  m->emode = m_execute;
+		  append_int(l, $2);
+		  append_list(l, NULL);
+		  append_list(l, $5);
+		  append_list(l, $6);
+		  append_string(l, $7);
+		  append_int(l, $8);
+		  $$ = _symbol_create_list( SQL_NOP, l ); }
  ;
 
 exec_ref:
@@ -6152,6 +6244,7 @@ char *token2string(int token)
 	SQL(CREATE_SCHEMA);
 	SQL(CREATE_TABLE);
 	SQL(CREATE_VIEW);
+	SQL(CREATE_MATVIEW);
 	SQL(CREATE_INDEX);
 	SQL(CREATE_ROLE);
 	SQL(CREATE_USER);
@@ -6162,6 +6255,7 @@ char *token2string(int token)
 	SQL(DROP_SCHEMA);
 	SQL(DROP_TABLE);
 	SQL(DROP_VIEW);
+	SQL(DROP_MATVIEW);
 	SQL(DROP_INDEX);
 	SQL(DROP_ROLE);
 	SQL(DROP_USER);
@@ -6175,6 +6269,10 @@ char *token2string(int token)
 	SQL(DROP_COLUMN);
 	SQL(DROP_CONSTRAINT);
 	SQL(DROP_DEFAULT);
+	SQL(COMPACT);
+	SQL(REFRESH_MATVIEW);
+	SQL(PARTITION_RANGE);
+	SQL(PARTITION_VALUES);
 	SQL(DECLARE);
 	SQL(COMMENT);
 	SQL(SET);
@@ -34,6 +34,15 @@
  *
  * The optimization/processing cost should be kept around and the re-use of
  * a cache entry.
+ *
+ * Next to the client caches, a server-wide table of shared templates is
+ * maintained. A template compiled by one client is handed to the others
+ * when they issue a text-identical query, saving the parse and code
+ * generation for every new connection. Since privileges are checked and
+ * names are resolved during compilation, the shared templates are keyed
+ * by the user, role and current schema as well as the catalog version
+ * they were compiled against. The backend decides which code may be
+ * shared; the client still receives a private copy of it.
  */
 
 #include "monetdb_config.h"
@@ -56,6 +65,8 @@ qc_create(int clientid, int seqnr)
 	return r;
 }
 
+static void sq_release(sq *t);
+
 static void
 cq_delete(int clientid, cq *q)
 {
@@ -69,6 +80,8 @@ cq_delete(int clientid, cq *q)
 	/* params and name are allocated using sa, ie need to be delete last */
 	if (q->sa) 
 		sa_destroy(q->sa);
+	if (q->shared)
+		sq_release(q->shared);
 	_DELETE(q);
 }
 
@@ -273,6 +286,7 @@ qc_insert(qc *cache, sql_allocator *sa, sql_rel *r, char *qname,  symbol *s, ato
 	n->key = key;
 	n->codestring = cmd;
 	n->count = 1;
+	n->shared = NULL;
 	namelen = 5 + ((n->id+7)>>3) + ((cache->clientid+7)>>3);
 	n->name = sa_alloc(sa, namelen);
 	n->no_mitosis = no_mitosis;
@@ -303,3 +317,275 @@ qc_size(qc *cache)
 {
 	return cache->nr;
 }
+
+/*
+ * Shared query templates
+ * ----------------------
+ * The shared templates are kept in a hash table on the query key.
+ * The lock only protects the table and the reference counts; the
+ * templates themselves are never changed once they are shared.
+ */
+static MT_Lock qc_lock MT_LOCK_INITIALIZER("qc_lock");
+static sq *qc_shared[SHARED_HASHSIZE];
+static int qc_shared_nr = 0;
+static int qc_shared_snr = 0;	/* latest catalog version seen */
+
+static void
+sq_destroy(sq *t)
+{
+	if (t->code)
+		backend_freesharedcode(t->code);
+	if (t->codestring)
+		_DELETE(t->codestring);
+	if (t->sa)
+		sa_destroy(t->sa);
+	_DELETE(t);
+}
+
+static void
+sq_destroy_list(sq *t)
+{
+	sq *n;
+
+	for (; t; t = n) {
+		n = t->next;
+		sq_destroy(t);
+	}
+}
+
+/* Remove the template *p from the hash table, the caller holds
+ * qc_lock. Templates no longer used by any client are moved to the
+ * dead list, to be destroyed after the lock is released. */
+static void
+sq_unhash(sq **p, sq **dead)
+{
+	sq *t = *p;
+
+	*p = t->next;
+	t->next = NULL;
+	qc_shared_nr--;
+	if (--t->refs == 0) {
+		t->next = *dead;
+		*dead = t;
+	}
+}
+
+/* A committed schema change invalidates all templates compiled
+ * against an older catalog. */
+static void
+sq_purge(int schema_number, sq **dead)
+{
+	sq **p;
+	int i;
+
+	if (schema_number <= qc_shared_snr)
+		return;
+	qc_shared_snr = schema_number;
+	for (i = 0; i < SHARED_HASHSIZE; i++) {
+		for (p = &qc_shared[i]; *p; ) {
+			if ((*p)->schema_number < schema_number)
+				sq_unhash(p, dead);
+			else
+				p = &(*p)->next;
+		}
+	}
+}
+
+static void
+sq_release(sq *t)
+{
+	int unused;
+
+	MT_lock_set(&qc_lock);
+	unused = --t->refs == 0;
+	MT_lock_unset(&qc_lock);
+	if (unused)
+		sq_destroy(t);
+}
+
+static int
+sq_match(sq *t, int key, int schema_id, int user_id, int role_id, int schema_number, int plen)
+{
+	return t->key == key && t->schema_id == schema_id &&
+		t->user_id == user_id && t->role_id == role_id &&
+		t->schema_number == schema_number && t->paramlen == plen;
+}
+
+cq *
+qc_import(qc *cache, char *qname, symbol *s, atom **params, int plen, int key, int schema_id, int user_id, int role_id, int schema_number)
+{
+	sq *t, *dead = NULL;
+	cq *n;
+
+	MT_lock_set(&qc_lock);
+	sq_purge(schema_number, &dead);
+	for (t = qc_shared[key & (SHARED_HASHSIZE - 1)]; t; t = t->next) {
+		if (sq_match(t, key, schema_id, user_id, role_id, schema_number, plen) &&
+		    param_list_cmp(t->params, params, plen, t->type) == 0 &&
+		    symbol_cmp(t->s, s) == 0) {
+			t->refs++;
+			t->count++;
+			break;
+		}
+	}
+	MT_lock_unset(&qc_lock);
+	sq_destroy_list(dead);
+	if (!t)
+		return NULL;
+
+	n = MNEW(cq);
+	if (!n) {
+		sq_release(t);
+		return NULL;
+	}
+	n->codestring = NULL;
+	if (t->codestring && (n->codestring = _STRDUP(t->codestring)) == NULL) {
+		_DELETE(n);
+		sq_release(t);
+		return NULL;
+	}
+	/* the client gets a private copy of the code */
+	n->code = backend_importcode(cache->clientid, t->code, qname);
+	if (!n->code) {
+		if (n->codestring)
+			_DELETE(n->codestring);
+		_DELETE(n);
+		sq_release(t);
+		return NULL;
+	}
+	n->id = cache->id++;
+	cache->nr++;
+
+	n->sa = NULL;
+	n->rel = NULL;
+	n->s = t->s;
+	n->params = t->params;
+	n->paramlen = t->paramlen;
+	n->stk = 0;
+	n->type = t->type;
+	n->key = key;
+	n->count = 1;
+	n->name = qname;
+	n->no_mitosis = t->no_mitosis;
+	n->shared = t;
+	n->next = cache->q;
+	cache->q = n;
+	return n;
+}
+
+void
+qc_share(qc *cache, cq *q, int schema_id, int user_id, int role_id, int schema_number)
+{
+	sq *t, *n, **p, **victim = NULL, *dead = NULL;
+	int i, h = q->key & (SHARED_HASHSIZE - 1);
+
+	if (q->shared || !q->sa || !q->code)
+		return;
+	n = MNEW(sq);
+	if (!n)
+		return;
+	n->codestring = NULL;
+	if (q->codestring && (n->codestring = _STRDUP(q->codestring)) == NULL) {
+		_DELETE(n);
+		return;
+	}
+	/* the backend refuses code that depends on the client */
+	n->code = backend_sharecode(cache->clientid, q->code);
+	if (!n->code) {
+		if (n->codestring)
+			_DELETE(n->codestring);
+		_DELETE(n);
+		return;
+	}
+	n->sa = NULL;
+	n->type = q->type;
+	n->s = q->s;
+	n->params = q->params;
+	n->paramlen = q->paramlen;
+	n->key = q->key;
+	n->schema_id = schema_id;
+	n->user_id = user_id;
+	n->role_id = role_id;
+	n->schema_number = schema_number;
+	n->no_mitosis = q->no_mitosis;
+	n->refs = 2;
+	n->count = 1;
+
+	MT_lock_set(&qc_lock);
+	sq_purge(schema_number, &dead);
+	for (t = qc_shared[h]; t; t = t->next) {
+		if (sq_match(t, n->key, schema_id, user_id, role_id, schema_number, n->paramlen) &&
+		    symbol_cmp(t->s, n->s) == 0) {
+			for (i = 0; i < n->paramlen; i++)
+				if (subtype_cmp(t->params + i, n->params + i) != 0)
+					break;
+			if (i == n->paramlen)
+				break;
+		}
+	}
+	if (t || schema_number < qc_shared_snr) {
+		/* another client was first, or the catalog has changed */
+		MT_lock_unset(&qc_lock);
+		sq_destroy_list(dead);
+		sq_destroy(n);
+		return;
+	}
+	if (qc_shared_nr >= SHARED_CACHESIZE) {
+		/* make room by dropping the least used template */
+		for (i = 0; i < SHARED_HASHSIZE; i++)
+			for (p = &qc_shared[i]; *p; p = &(*p)->next)
+				if (!victim || (*p)->count < (*victim)->count)
+					victim = p;
+		if (victim)
+			sq_unhash(victim, &dead);
+	}
+	n->sa = q->sa;
+	n->next = qc_shared[h];
+	qc_shared[h] = n;
+	qc_shared_nr++;
+	MT_lock_unset(&qc_lock);
+	sq_destroy_list(dead);
+
+	/* the symbols are owned by the shared template from now on */
+	q->sa = NULL;
+	q->shared = n;
+}
+
+void
+qc_unshare(cq *q)
+{
+	sq **p, *dead = NULL;
+
+	if (!q->shared)
+		return;
+	MT_lock_set(&qc_lock);
+	for (p = &qc_shared[q->shared->key & (SHARED_HASHSIZE - 1)]; *p; p = &(*p)->next) {
+		if (*p == q->shared) {
+			sq_unhash(p, &dead);
+			break;
+		}
+	}
+	MT_lock_unset(&qc_lock);
+	/* the template is still referenced by q */
+	assert(dead == NULL);
+}
+
+void
+qc_shared_init(void)
+{
+	MT_lock_init(&qc_lock, "qc_lock");
+}
+
+void
+qc_shared_exit(void)
+{
+	sq **p, *dead = NULL;
+	int i;
+
+	MT_lock_set(&qc_lock);
+	for (i = 0; i < SHARED_HASHSIZE; i++)
+		for (p = &qc_shared[i]; *p; )
+			sq_unhash(p, &dead);
+	MT_lock_unset(&qc_lock);
+	sq_destroy_list(dead);
+}
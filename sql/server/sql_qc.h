@@ -15,6 +15,31 @@
 #include "sql_backend.h"
 
 #define DEFAULT_CACHESIZE 100
+#define SHARED_CACHESIZE 1000	/* templates kept for all clients */
+#define SHARED_HASHSIZE 256	/* must be a power of two */
+
+/* A query template shared between the client caches. It owns the
+ * symbol tree and parameter types of the client that compiled it and a
+ * backend copy of its code. */
+typedef struct sq {
+	struct sq *next;	/* hash bucket chain */
+	int type;		/* sql_query_t: Q_TABLE or Q_UPDATE */
+	sql_allocator *sa;	/* the symbols are allocated from this sa */
+	symbol *s;		/* the SQL parse tree */
+	sql_subtype *params;	/* parameter types */
+	int paramlen;		/* number of parameters */
+	backend_code code;	/* backend copy of the template */
+	int key;		/* the hash key for the query text */
+	int schema_id;		/* the current schema when compiled */
+	int user_id;		/* privileges are checked at compile time */
+	int role_id;
+	int schema_number;	/* catalog version the code was made for */
+	char *codestring;	/* keep code in string form to aid debugging */
+	int no_mitosis;		/* run query without mitosis */
+	int refs;		/* client entries using it, +1 while hashed */
+	int count;		/* number of times the template is imported */
+} sq;
+
 typedef struct cq {
 	struct cq *next;	/* link them into a queue */
 	int type;		/* sql_query_t: Q_PARSE,Q_SCHEMA,.. */
@@ -31,6 +56,7 @@ typedef struct cq {
 	char *name;		/* name of cache query */
 	int no_mitosis;		/* run query without mitosis */
 	int count;		/* number of times the query is matched */
+	sq *shared;		/* shared template owning sa, if any */
 } cq;
 
 typedef struct qc {
@@ -48,6 +74,11 @@ extern cq *qc_match(qc *cache, symbol *s, atom **params, int plen, int key);
 extern cq *qc_insert(qc *cache, sql_allocator *sa, sql_rel *r, char *qname, symbol *s, atom **params, int paramlen, int key, int type, char *codedstr, int no_mitosis);
 extern void qc_delete(qc *cache, cq *q);
 extern int qc_size(qc *cache);
+extern cq *qc_import(qc *cache, char *qname, symbol *s, atom **params, int plen, int key, int schema_id, int user_id, int role_id, int schema_number);
+extern void qc_share(qc *cache, cq *q, int schema_id, int user_id, int role_id, int schema_number);
+extern void qc_unshare(cq *q);
+extern void qc_shared_init(void);
+extern void qc_shared_exit(void);
 extern int qc_isaquerytemplate(char *nme);
 extern int qc_isapreparedquerytemplate(char *nme);
 
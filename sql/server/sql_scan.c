@@ -100,6 +100,9 @@ scanner_init_keywords(void)
 	failed += keywords_insert("MEDIAN", AGGR);
 	failed += keywords_insert("CORR", AGGR2);
 	failed += keywords_insert("QUANTILE", AGGR2);
+	failed += keywords_insert("APPROX_COUNT_DISTINCT", AGGR);
+	failed += keywords_insert("APPROX_MEDIAN", AGGR);
+	failed += keywords_insert("APPROX_QUANTILE", AGGR2);
 	failed += keywords_insert("AVG", AGGR);
 	failed += keywords_insert("MIN", AGGR);
 	failed += keywords_insert("MAX", AGGR);
@@ -109,6 +112,8 @@ scanner_init_keywords(void)
 
 	failed += keywords_insert("LAG", AGGR2);
 	failed += keywords_insert("LEAD", AGGR2);
+	failed += keywords_insert("FIRST_VALUE", AGGR);
+	failed += keywords_insert("LAST_VALUE", AGGR);
 
 	failed += keywords_insert("RANK", RANK);
 	failed += keywords_insert("DENSE_RANK", RANK);
@@ -356,6 +361,9 @@ scanner_init_keywords(void)
 	failed += keywords_insert("LANGUAGE", LANGUAGE);
 
 	failed += keywords_insert("ANALYZE", ANALYZE);
+	failed += keywords_insert("COMPACT", COMPACT);
+	failed += keywords_insert("MATERIALIZED", MATERIALIZED);
+	failed += keywords_insert("REFRESH", REFRESH);
 	failed += keywords_insert("MINMAX", MINMAX);
 	failed += keywords_insert("EXPLAIN", SQL_EXPLAIN);
 	failed += keywords_insert("PLAN", SQL_PLAN);
@@ -330,6 +330,18 @@ bl_tend(void)
 	return log_tend(bat_logger) == GDK_SUCCEED ? LOG_OK : LOG_ERR;
 }
 
+static int 
+bl_tend_nosync(void)
+{
+	return log_tend_nosync(bat_logger) == GDK_SUCCEED ? LOG_OK : LOG_ERR;
+}
+
+static int 
+bl_sync(void)
+{
+	return log_sync(bat_logger) == GDK_SUCCEED ? LOG_OK : LOG_ERR;
+}
+
 static int 
 bl_sequence(int seq, lng id)
 {
@@ -354,6 +366,8 @@ bat_logger_init( logger_functions *lf )
 	lf->log_isnew = bl_log_isnew;
 	lf->log_tstart = bl_tstart;
 	lf->log_tend = bl_tend;
+	lf->log_tend_nosync = bl_tend_nosync;
+	lf->log_sync = bl_sync;
 	lf->log_sequence = bl_sequence;
 }
 
@@ -583,6 +583,67 @@ dup_bat(sql_trans *tr, sql_table *t, sql_delta *obat, sql_delta *bat, int type,
 	return dup_delta( tr, obat, bat, type, oc_isnew, c_isnew, isTempTable(t), t->sz);
 }
 
+static int
+dup_dbat( sql_trans *tr, sql_dbat *obat, sql_dbat *bat, int is_new, int temp)
+{
+	bat->dbid = obat->dbid;
+	bat->cnt = obat->cnt;
+	bat->dname = _STRDUP(obat->dname);
+	bat->wtime = bat->stime = obat->wtime;
+	if(!bat->dname)
+		return LOG_ERR;
+	if (bat->dbid) {
+		if (is_new) {
+			obat->dbid = temp_copy(bat->dbid, temp);
+		} else {
+			bat->dbid = ebat_copy(bat->dbid, 0, temp);
+		}
+		if (bat->dbid == BID_NIL) 
+			return LOG_ERR;
+	}
+	(void)tr;
+	return LOG_OK;
+}
+
+/* keep the tids updated or deleted by the transaction, such that the
+ * validation can tell apart concurrent changes to other rows */
+static int
+written_tids(sql_trans *tr, sql_table *t, void *tids, int tpe)
+{
+	sql_dbat *bat;
+	BAT *w;
+
+	if (isTempTable(t) || isNew(t))
+		return LOG_OK;
+	if (!t->data || !t->base.allocated) {
+		sql_table *ot = tr_find_table(tr->parent, t);
+		sql_dbat *bat = ZNEW(sql_dbat), *obat;
+		if (!bat)
+			return LOG_ERR;
+		t->data = bat;
+		obat = timestamp_dbat(ot->data, tr->stime);
+		if (dup_dbat(tr, obat, bat, isNew(ot), isTempTable(t)) != LOG_OK)
+			return LOG_ERR;
+		t->base.allocated = 1;
+	}
+	bat = t->data;
+	bat->wtime = tr->wstime;
+	if (!bat->wbid) {
+		if ((w = COLnew(0, TYPE_oid, 0, TRANSIENT)) == NULL)
+			return LOG_ERR;
+		bat->wbid = temp_create(w);
+	} else if ((w = temp_descriptor(bat->wbid)) == NULL) {
+		return LOG_ERR;
+	}
+	if ((tpe == TYPE_bat && BATappend(w, tids, NULL, TRUE) != GDK_SUCCEED) ||
+	    (tpe != TYPE_bat && BUNappend(w, tids, TRUE) != GDK_SUCCEED)) {
+		bat_destroy(w);
+		return LOG_ERR;
+	}
+	bat_destroy(w);
+	return LOG_OK;
+}
+
 static int
 update_col(sql_trans *tr, sql_column *c, void *tids, void *upd, int tpe)
 {
@@ -607,6 +668,8 @@ update_col(sql_trans *tr, sql_column *c, void *tids, void *upd, int tpe)
 	bat = c->data;
 	bat->wtime = c->base.wtime = c->t->base.wtime = c->t->s->base.wtime = tr->wtime = tr->wstime;
 	c->base.rtime = c->t->base.rtime = c->t->s->base.rtime = tr->rtime = tr->stime;
+	if (written_tids(tr, c->t, tids, tpe) != LOG_OK)
+		return LOG_ERR;
 	if (tpe == TYPE_bat)
 		return delta_update_bat(bat, tids, upd, isNew(c));
 	else 
@@ -781,28 +844,6 @@ dup_idx(sql_trans *tr, sql_idx *i, sql_idx *ni )
 	return ok;
 }
 
-static int
-dup_dbat( sql_trans *tr, sql_dbat *obat, sql_dbat *bat, int is_new, int temp)
-{
-	bat->dbid = obat->dbid;
-	bat->cnt = obat->cnt;
-	bat->dname = _STRDUP(obat->dname);
-	bat->wtime = obat->wtime;
-	if(!bat->dname)
-		return LOG_ERR;
-	if (bat->dbid) {
-		if (is_new) {
-			obat->dbid = temp_copy(bat->dbid, temp);
-		} else {
-			bat->dbid = ebat_copy(bat->dbid, 0, temp);
-		}
-		if (bat->dbid == BID_NIL) 
-			return LOG_ERR;
-	}
-	(void)tr;
-	return LOG_OK;
-}
-
 static int
 dup_del(sql_trans *tr, sql_table *ot, sql_table *t)
 {
@@ -812,6 +853,10 @@ dup_del(sql_trans *tr, sql_table *ot, sql_table *t)
 		return LOG_ERR;
 	t->data = bat;
 	ok = dup_dbat( tr, obat, bat, isNew(t), isTempTable(t));
+	/* the inserts of the parent are no longer told apart from the
+	 * snapshot of the savepoint */
+	if (tr->parent != gtrans)
+		bat->stime = -1;
 	assert(t->base.allocated == 0);
 	t->base.allocated = 1;
 	return ok;
@@ -865,6 +910,7 @@ append_col(sql_trans *tr, sql_column *c, void *i, int tpe)
 		dup_dbat(tr, obat, bat, isNew(ot), isTempTable(c->t));
 		c->t->base.allocated = 1;
 	}
+	((sql_dbat*)c->t->data)->wtime = tr->wstime;
 	if (c->t && c->t->data && ((sql_dbat*)c->t->data)->cached) {
 		sql_dbat *bat = c->t->data;
 
@@ -921,6 +967,8 @@ append_idx(sql_trans *tr, sql_idx * i, void *ib, int tpe)
 			i->t->base.allocated = 1;
 		}
 	}
+	if (ok == LOG_OK)
+		((sql_dbat*)i->t->data)->wtime = tr->wstime;
 
 	if(ok == LOG_ERR)
 		return ok;
@@ -1054,6 +1102,8 @@ delete_tab(sql_trans *tr, sql_table * t, void *ib, int tpe)
 
 	/* deletes only write */
 	bat->wtime = t->base.wtime = t->s->base.wtime = tr->wtime = tr->wstime;
+	if (written_tids(tr, t, ib, tpe) != LOG_OK)
+		return LOG_ERR;
 	if (tpe == TYPE_bat)
 		ok = delta_delete_bat(bat, ib);
 	else
@@ -1797,11 +1847,13 @@ destroy_dbat(sql_trans *tr, sql_dbat *bat)
 		_DELETE(bat->dname);
 	if (bat->dbid)
 		temp_destroy(bat->dbid);
+	if (bat->wbid)
+		temp_destroy(bat->wbid);
 	if (bat->cached) {
 		bat_destroy(bat->cached);
 		bat->cached = NULL;
 	}
-	bat->dbid = 0;
+	bat->dbid = bat->wbid = 0;
 	bat->dname = NULL;
 	_DELETE(bat);
 	if (n)
@@ -2129,10 +2181,21 @@ BATcleanProps( BAT *b )
 	}
 }
 
+/* A (persisted) hash of a column is maintained by the appends and
+ * updates, unless the column has to grow, in which case it is
+ * dropped.  Rebuild it then, such that the queries don't have to;
+ * failures only cost performance. */
+static void
+keep_hash(BAT *b, int hash)
+{
+	if (hash && !b->thash && BAThash(b, 0) != GDK_SUCCEED)
+		GDKclrerr();
+}
+
 static int 
 gtr_update_delta( sql_trans *tr, sql_delta *cbat, int *changes)
 {
-	int ok = LOG_OK;
+	int ok = LOG_OK, hash;
 	BAT *ins, *cur;
 
 	(void)tr;
@@ -2146,6 +2209,7 @@ gtr_update_delta( sql_trans *tr, sql_delta *cbat, int *changes)
 		bat_destroy(cur);
 		return LOG_ERR;
 	}
+	hash = BATcheckhash(cur);
 	/* any inserts */
 	if (BUNlast(ins) > 0) {
 		(*changes)++;
@@ -2191,6 +2255,7 @@ gtr_update_delta( sql_trans *tr, sql_delta *cbat, int *changes)
 		bat_destroy(ui);
 		bat_destroy(uv);
 	}
+	keep_hash(cur, hash);
 	bat_destroy(cur);
 	if (cbat->next) { 
 		ok = destroy_bat(tr, cbat->next);
@@ -2366,10 +2431,118 @@ gtr_minmax( sql_trans *tr )
 	return _gtr_update(tr, &gtr_minmax_table);
 }
 
+/* deltas of at least 1/DELTA_MERGE_FRACTION of the column are merged in
+ * the background */
+#define DELTA_MERGE_FRACTION 16
+
+static int
+delta_needs_merge(sql_delta *d)
+{
+	size_t n;
+
+	if (!d || !d->bid)
+		return 0;
+	n = (d->cnt > d->ibase ? d->cnt - d->ibase : 0) + d->ucnt;
+	return n > 0 && n * DELTA_MERGE_FRACTION >= d->ibase;
+}
+
+static int
+gtr_merge_delta( sql_trans *tr, sql_delta *cbat, int *changes)
+{
+	int ok, imprints, orderidx;
+	BAT *b = temp_descriptor(cbat->bid);
+
+	if (b == NULL)
+		return LOG_ERR;
+	imprints = b->timprints != NULL;
+	orderidx = b->torderidx != NULL;
+	bat_destroy(b);
+
+	ok = gtr_update_delta(tr, cbat, changes);
+	if (ok != LOG_OK || !(imprints || orderidx))
+		return ok;
+
+	/* rebuild the indices dropped by the merge, such that the queries
+	 * don't have to; failures only cost performance (the hash is
+	 * taken care of by gtr_update_delta) */
+	if ((b = temp_descriptor(cbat->bid)) == NULL)
+		return LOG_ERR;
+	if ((imprints && !b->timprints && BATimprints(b) != GDK_SUCCEED) ||
+	    (orderidx && !b->torderidx && BATorderidx(b, 1) != GDK_SUCCEED))
+		GDKclrerr();
+	bat_destroy(b);
+	return ok;
+}
+
+static int
+gtr_merge_table(sql_trans *tr, sql_table *t, int *changes)
+{
+	int ok = LOG_OK;
+	node *n;
+
+	for (n = t->columns.set->h; ok == LOG_OK && n; n = n->next) {
+		sql_column *c = n->data;
+
+		if (!c->base.wtime || c->base.wtime <= c->base.allocated ||
+		    !delta_needs_merge(c->data))
+			continue;
+		ok = gtr_merge_delta(tr, c->data, changes);
+		c->base.allocated = c->base.wtime = tr->wstime;
+	}
+	if (ok == LOG_OK && t->idxs.set) {
+		for (n = t->idxs.set->h; ok == LOG_OK && n; n = n->next) {
+			sql_idx *ci = n->data;
+
+			/* some indices have no bats */
+			if (!isTable(ci->t) || !idx_has_column(ci->type)) 
+				continue;
+			if (!ci->base.wtime || ci->base.wtime <= ci->base.allocated ||
+			    !delta_needs_merge(ci->data))
+				continue;
+			ok = gtr_merge_delta(tr, ci->data, changes);
+			ci->base.allocated = ci->base.wtime = tr->wstime;
+		}
+	}
+	return ok;
+}
+
+/* merge the large column deltas of (at most) one table, such that the
+ * queries no longer combine them with the columns on every access.
+ * Unlike gtr_update, the table and the deletes are left for the next
+ * flush of the log. */
+static int
+gtr_merge( sql_trans *tr, int *merged)
+{
+	node *sn, *n;
+
+	assert(store_nr_active==0);
+	*merged = 0;
+	for (sn = tr->schemas.set->h; sn && !*merged; sn = sn->next) {
+		sql_schema *s = sn->data;
+
+		if (!s->base.wtime || s->base.wtime <= s->base.allocated ||
+		    isTempSchema(s) || !s->tables.set)
+			continue;
+		for (n = s->tables.set->h; n && !*merged; n = n->next) {
+			sql_table *t = n->data;
+
+			if (!isTable(t) || !isGlobal(t) ||
+			    t->base.wtime <= t->base.allocated)
+				continue;
+			if (gtr_merge_table(tr, t, merged) != LOG_OK)
+				return LOG_ERR;
+			/* let the transactions pick up the merged columns */
+			if (*merged)
+				s->base.wtime = t->base.wtime = tr->wtime = tr->wstime;
+		}
+	}
+	return LOG_OK;
+}
+
 static int 
 tr_update_delta( sql_trans *tr, sql_delta *obat, sql_delta *cbat, int unique)
 {
-	int ok = LOG_OK;
+	int ok = LOG_OK, hash = 0;
 	BAT *ins, *cur = NULL;
 	int cleared = 0;
 
@@ -2396,6 +2569,7 @@ tr_update_delta( sql_trans *tr, sql_delta *obat, sql_delta *cbat, int unique)
 		cur = temp_descriptor(obat->bid);
 		if(!cur)
 			return LOG_ERR;
+		hash = BATcheckhash(cur);
 	}
 	if (!obat->bid && tr != gtrans) {
 		//if (obat->name)
@@ -2493,6 +2667,8 @@ tr_update_delta( sql_trans *tr, sql_delta *obat, sql_delta *cbat, int unique)
 		bat_destroy(ui);
 		bat_destroy(uv);
 	}
+	if (cur)
+		keep_hash(cur, hash);
 	bat_destroy(cur);
 	if (obat->next) { 
 		ok = destroy_bat(tr, obat->next);
@@ -2504,7 +2680,7 @@ tr_update_delta( sql_trans *tr, sql_delta *obat, sql_delta *cbat, int unique)
 static int 
 tr_merge_delta( sql_trans *tr, sql_delta *obat, int unique)
 {
-	int ok = LOG_OK;
+	int ok = LOG_OK, hash = 0;
 	BAT *ins, *cur = NULL;
 	int cleared = 0;
 
@@ -2520,6 +2696,7 @@ tr_merge_delta( sql_trans *tr, sql_delta *obat, int unique)
 		cur = temp_descriptor(obat->bid);
 		if(!cur)
 			return LOG_ERR;
+		hash = BATcheckhash(cur);
 	}
 	ins = temp_descriptor(obat->ibid);
 	if(!ins) {
@@ -2589,6 +2766,8 @@ tr_merge_delta( sql_trans *tr, sql_delta *obat, int unique)
 		bat_destroy(ui);
 		bat_destroy(uv);
 	}
+	if (cur)
+		keep_hash(cur, hash);
 	bat_destroy(cur);
 	if (obat->next) { 
 		ok = destroy_bat(tr, obat->next);
@@ -2702,6 +2881,424 @@ tr_merge_dbat(sql_trans *tr, sql_dbat *tdb)
 	return ok;
 }
 
+/* the tids written by the versions of the deletes committed after the
+ * version bat was copied from, NULL if that version is no longer known */
+static BAT *
+dbat_written_tids(sql_dbat *h, sql_dbat *bat)
+{
+	BAT *r = COLnew(0, TYPE_oid, 0, TRANSIENT);
+
+	if (r == NULL)
+		return NULL;
+	for (; h && h->wtime != bat->stime; h = h->next) {
+		BAT *w;
+
+		if (!h->wbid)
+			continue;
+		if ((w = temp_descriptor(h->wbid)) == NULL ||
+		    BATappend(r, w, NULL, TRUE) != GDK_SUCCEED) {
+			bat_destroy(w);
+			bat_destroy(r);
+			return NULL;
+		}
+		bat_destroy(w);
+	}
+	if (!h) {
+		bat_destroy(r);
+		return NULL;
+	}
+	return r;
+}
+
+/* the values delta d got beyond the first sins inserts and sui updates,
+ * including the (in place) updated inserts at the tids in w */
+static BAT *
+delta_new_values(sql_delta *d, BUN sins, BUN sui, BAT *w)
+{
+	BAT *ins = temp_descriptor(d->ibid), *r = NULL, *v = NULL;
+
+	if (ins == NULL)
+		return NULL;
+	if ((r = COLnew(0, ins->ttype, 0, TRANSIENT)) == NULL)
+		goto bailout;
+	if (BATcount(ins) > sins) {
+		if ((v = BATslice(ins, sins, BATcount(ins))) == NULL ||
+		    BATappend(r, v, NULL, TRUE) != GDK_SUCCEED)
+			goto bailout;
+		bat_destroy(v);
+		v = NULL;
+	}
+	if (sins && BATcount(w)) {
+		oid lo = ins->hseqbase, hi = ins->hseqbase + sins;
+		BAT *s = BATselect(w, NULL, &lo, &hi, 1, 0, 0), *tids;
+
+		if (s == NULL)
+			goto bailout;
+		tids = BATproject(s, w);
+		bat_destroy(s);
+		if (tids == NULL)
+			goto bailout;
+		v = BATproject(tids, ins);
+		bat_destroy(tids);
+		if (v == NULL || BATappend(r, v, NULL, TRUE) != GDK_SUCCEED)
+			goto bailout;
+		bat_destroy(v);
+		v = NULL;
+	}
+	bat_destroy(ins);
+	ins = NULL;
+	if (d->uvbid) {
+		BAT *uv = temp_descriptor(d->uvbid);
+
+		if (uv == NULL)
+			goto bailout;
+		if (BATcount(uv) > sui) {
+			v = BATslice(uv, sui, BATcount(uv));
+			if (v == NULL || BATappend(r, v, NULL, TRUE) != GDK_SUCCEED) {
+				bat_destroy(uv);
+				goto bailout;
+			}
+			bat_destroy(v);
+		}
+		bat_destroy(uv);
+	}
+	return r;
+  bailout:
+	bat_destroy(ins);
+	bat_destroy(v);
+	bat_destroy(r);
+	return NULL;
+}
+
+/* check if the new values of the local delta l and the concurrently
+ * committed delta h overlap, ie would violate a unique key */
+static int
+delta_new_values_overlap(sql_delta *l, sql_delta *h, BAT *wl, BAT *wh)
+{
+	BAT *ins = temp_descriptor(l->ibid), *ui = temp_descriptor(l->uibid);
+	BAT *lv = NULL, *hv = NULL, *o = NULL;
+	BUN sins, sui;
+	int res = 1;
+
+	if (ins == NULL || ui == NULL) {
+		bat_destroy(ins);
+		bat_destroy(ui);
+		return 1;
+	}
+	sins = ins->batInserted;
+	sui = ui->batInserted;
+	bat_destroy(ins);
+	bat_destroy(ui);
+	if ((lv = delta_new_values(l, sins, sui, wl)) != NULL &&
+	    (hv = delta_new_values(h, sins, sui, wh)) != NULL &&
+	    (o = BATintersect(lv, hv, NULL, NULL, 0, BUN_NONE)) != NULL)
+		res = BATcount(o) > 0;
+	bat_destroy(lv);
+	bat_destroy(hv);
+	bat_destroy(o);
+	return res;
+}
+
+static int
+validate_keys(sql_table *ft, sql_table *tt, BAT *wl, BAT *wh)
+{
+	node *n;
+
+	if (!ft->keys.set)
+		return LOG_OK;
+	for (n = ft->keys.set->h; n; n = n->next) {
+		sql_key *k = n->data;
+		sql_delta *l = NULL, *h = NULL;
+
+		if (k->type == fkey)
+			continue;
+		if (list_length(k->columns) == 1) {
+			sql_kc *kc = k->columns->h->data;
+			sql_column *oc = find_sql_column(tt, kc->c->base.name);
+
+			if (kc->c->base.allocated && oc) {
+				l = kc->c->data;
+				h = oc->data;
+			}
+		} else if (k->idx) {
+			/* the hash values of the columns, equal hashes
+			 * are taken as a conflict */
+			sql_idx *oi = find_sql_idx(tt, k->idx->base.name);
+
+			if (k->idx->base.allocated && oi) {
+				l = k->idx->data;
+				h = oi->data;
+			}
+		}
+		/* no new values from this transaction */
+		if (!l || !h)
+			continue;
+		if (delta_new_values_overlap(l, h, wl, wh))
+			return LOG_ERR;
+	}
+	return LOG_OK;
+}
+
+/* redo the changes of the local delta on top of the concurrently
+ * committed delta h, ie as if the transaction started from h */
+static int
+rebase_delta(sql_trans *tr, sql_table *t, sql_delta **d, sql_delta *h, BAT *w)
+{
+	sql_delta *l = *d, *bat;
+	BAT *ins, *hins, *ui, *uv;
+	BUN sins, sui;
+	int ok = LOG_OK;
+
+	if (l->ibase != h->ibase || l->bid != h->bid || !l->uibid || !h->uibid)
+		return LOG_ERR;
+	ins = temp_descriptor(l->ibid);
+	hins = temp_descriptor(h->ibid);
+	ui = temp_descriptor(l->uibid);
+	uv = temp_descriptor(l->uvbid);
+	if (ins == NULL || hins == NULL || ui == NULL || uv == NULL ||
+	    BATcount(hins) < ins->batInserted) {
+		ok = LOG_ERR;
+		goto cleanup;
+	}
+	sins = ins->batInserted;
+	sui = ui->batInserted;
+	{
+		BAT *hui = temp_descriptor(h->uibid);
+
+		if (hui == NULL || BATcount(hui) < sui)
+			ok = LOG_ERR;
+		bat_destroy(hui);
+		if (ok != LOG_OK)
+			goto cleanup;
+	}
+
+	if ((bat = ZNEW(sql_delta)) == NULL) {
+		ok = LOG_ERR;
+		goto cleanup;
+	}
+	if (dup_bat(tr, t, h, bat, ins->ttype, 0, 0) != LOG_OK) {
+		destroy_bat(tr, bat);
+		ok = LOG_ERR;
+		goto cleanup;
+	}
+	bat->wtime = l->wtime;
+
+	/* the updated inserts */
+	if (sins && BATcount(w)) {
+		oid lo = ins->hseqbase, hi = ins->hseqbase + sins;
+		BAT *s = BATselect(w, NULL, &lo, &hi, 1, 0, 0), *tids = NULL, *v = NULL;
+
+		if (s == NULL ||
+		    (tids = BATproject(s, w)) == NULL ||
+		    (v = BATproject(tids, ins)) == NULL ||
+		    (BATcount(tids) && delta_update_bat(bat, tids, v, 0) != LOG_OK))
+			ok = LOG_ERR;
+		bat_destroy(s);
+		bat_destroy(tids);
+		bat_destroy(v);
+	}
+	/* the updates */
+	if (ok == LOG_OK && BATcount(ui) > sui) {
+		BAT *tids = BATslice(ui, sui, BATcount(ui));
+		BAT *v = BATslice(uv, sui, BATcount(uv));
+
+		if (tids == NULL || v == NULL ||
+		    delta_update_bat(bat, tids, v, 0) != LOG_OK)
+			ok = LOG_ERR;
+		bat_destroy(tids);
+		bat_destroy(v);
+	}
+	/* the inserts */
+	if (ok == LOG_OK && BATcount(ins) > sins) {
+		BAT *v = BATslice(ins, sins, BATcount(ins));
+
+		if (v == NULL || delta_append_bat(bat, v) != LOG_OK)
+			ok = LOG_ERR;
+		bat_destroy(v);
+	}
+	if (ok == LOG_OK) {
+		destroy_bat(tr, l);
+		*d = bat;
+	} else {
+		destroy_bat(tr, bat);
+	}
+  cleanup:
+	bat_destroy(ins);
+	bat_destroy(hins);
+	bat_destroy(ui);
+	bat_destroy(uv);
+	return ok;
+}
+
+/* redo the deletes on top of the concurrently committed deletes h, the
+ * tids of the rows inserted by the transaction move by shift */
+static int
+rebase_dbat(sql_trans *tr, sql_dbat **d, sql_dbat *h, oid send, oid shift, BAT *w)
+{
+	sql_dbat *l = *d, *bat;
+	BAT *db = temp_descriptor(l->dbid), *hdb = temp_descriptor(h->dbid), *v = NULL;
+	int ok = LOG_OK;
+
+	if (db == NULL || hdb == NULL || BATcount(hdb) < db->batInserted ||
+	    (bat = ZNEW(sql_dbat)) == NULL) {
+		bat_destroy(db);
+		bat_destroy(hdb);
+		return LOG_ERR;
+	}
+	bat_destroy(hdb);
+	if (dup_dbat(tr, h, bat, 0, 0) != LOG_OK)
+		ok = LOG_ERR;
+	bat->wtime = l->wtime;
+	if (ok == LOG_OK && BATcount(db) > db->batInserted) {
+		BAT *s = BATslice(db, db->batInserted, BATcount(db));
+
+		if (s == NULL || (v = COLcopy(s, TYPE_oid, TRUE, TRANSIENT)) == NULL) {
+			ok = LOG_ERR;
+		} else {
+			oid *o = (oid *) Tloc(v, 0);
+			BUN p, q = BATcount(v);
+
+			if (shift) {
+				for (p = 0; p < q; p++)
+					if (o[p] >= send)
+						o[p] += shift;
+				v->tsorted = v->trevsorted = false;
+				v->tnosorted = v->tnorevsorted = 0;
+			}
+			if (delta_delete_bat(bat, v) != LOG_OK)
+				ok = LOG_ERR;
+		}
+		bat_destroy(s);
+		bat_destroy(v);
+	}
+	/* only the tids of rows other transactions could see are kept */
+	if (ok == LOG_OK && BATcount(w)) {
+		oid lo = 0;
+		BAT *s = BATselect(w, NULL, &lo, &send, 1, 0, 0);
+
+		if (s == NULL || (v = BATproject(s, w)) == NULL)
+			ok = LOG_ERR;
+		else
+			bat->wbid = temp_create(v);
+		bat_destroy(s);
+		bat_destroy(v);
+	}
+	bat_destroy(db);
+	if (ok == LOG_OK) {
+		destroy_dbat(tr, l);
+		*d = bat;
+	} else {
+		destroy_dbat(tr, bat);
+	}
+	return ok;
+}
+
+/* Check the changes of ft against the changes committed (to tt) since
+ * the transaction started. Only changes to the same rows (or values
+ * of unique keys) conflict, otherwise the changes of ft are rebased
+ * onto the committed ones. */
+static int
+validate_table(sql_trans *tr, sql_table *ft, sql_table *tt)
+{
+	sql_dbat *fdb = ft->data;
+	BAT *wl = NULL, *wh = NULL;
+	oid send = GDK_oid_max, hend = GDK_oid_max;
+	node *n, *m;
+	int ok = LOG_OK;
+
+	if (!fdb || !tt->data || isNew(tt) || isTempTable(ft))
+		return LOG_OK;
+	/* the inserts of savepoints are no longer told apart from the
+	 * snapshot, fall back to table level conflicts */
+	if (fdb->stime < 0) {
+		if (ft->base.wtime < tt->base.rtime || ft->base.wtime < tt->base.wtime ||
+		    (ft->base.rtime && ft->base.rtime < tt->base.wtime))
+			return LOG_ERR;
+		return LOG_OK;
+	}
+	/* nothing committed concurrently */
+	if (((sql_dbat*)tt->data)->wtime == fdb->stime)
+		return LOG_OK;
+	if (ft->cleared)
+		return LOG_ERR;
+
+	/* the number of rows in the snapshot and in the committed state */
+	for (n = ft->columns.set->h, m = tt->columns.set->h; n && m; n = n->next, m = m->next) {
+		sql_column *c = n->data, *oc = m->data;
+		sql_delta *l = c->data, *h = oc->data;
+		BAT *ins, *hins;
+
+		if (!c->base.allocated || !l || !h)
+			continue;
+		ins = temp_descriptor(l->ibid);
+		hins = temp_descriptor(h->ibid);
+		if (ins && hins) {
+			send = l->ibase + ins->batInserted;
+			hend = h->ibase + BATcount(hins);
+		} else {
+			ok = LOG_ERR;
+		}
+		bat_destroy(ins);
+		bat_destroy(hins);
+		break;
+	}
+	if (ok != LOG_OK || hend < send)
+		return LOG_ERR;
+
+	/* overlapping updates and deletes, only the rows in the snapshot
+	 * can be changed by both */
+	if ((wh = dbat_written_tids(tt->data, fdb)) == NULL)
+		return LOG_ERR;
+	if (fdb->wbid) {
+		BAT *w = temp_descriptor(fdb->wbid), *s = NULL, *i = NULL;
+		oid lo = 0;
+
+		if (w == NULL ||
+		    (s = BATselect(w, NULL, &lo, &send, 1, 0, 0)) == NULL ||
+		    (wl = BATproject(s, w)) == NULL ||
+		    (i = BATintersect(wl, wh, NULL, NULL, 0, BUN_NONE)) == NULL ||
+		    BATcount(i))
+			ok = LOG_ERR;
+		bat_destroy(w);
+		bat_destroy(s);
+		bat_destroy(i);
+	} else if ((wl = COLnew(0, TYPE_oid, 0, TRANSIENT)) == NULL) {
+		ok = LOG_ERR;
+	}
+	/* concurrently added equal values of unique keys */
+	if (ok == LOG_OK)
+		ok = validate_keys(ft, tt, wl, wh);
+
+	/* redo the changes on top of the committed ones */
+	for (n = ft->columns.set->h, m = tt->columns.set->h; ok == LOG_OK && n && m; n = n->next, m = m->next) {
+		sql_column *c = n->data, *oc = m->data;
+
+		if (!c->base.allocated || !c->data || !oc->data)
+			continue;
+		if (c->base.flag == TR_NEW)
+			ok = LOG_ERR;
+		else
+			ok = rebase_delta(tr, ft, (sql_delta**)&c->data, oc->data, wl);
+	}
+	if (ft->idxs.set) {
+		for (n = ft->idxs.set->h, m = tt->idxs.set->h; ok == LOG_OK && n && m; n = n->next, m = m->next) {
+			sql_idx *i = n->data, *oi = m->data;
+
+			if (!i->base.allocated || !i->data || !oi->data)
+				continue;
+			if (i->base.flag == TR_NEW)
+				ok = LOG_ERR;
+			else
+				ok = rebase_delta(tr, ft, (sql_delta**)&i->data, oi->data, wl);
+		}
+	}
+	if (ok == LOG_OK)
+		ok = rebase_dbat(tr, (sql_dbat**)&ft->data, tt->data, send, hend - send, wl);
+	bat_destroy(wl);
+	bat_destroy(wh);
+	return ok;
+}
+
 static int
 update_table(sql_trans *tr, sql_table *ft, sql_table *tt)
 {
@@ -2773,7 +3370,6 @@ update_table(sql_trans *tr, sql_table *ft, sql_table *tt)
 		sql_column *oc = m->data;
 
 		if (store_nr_active == 1 || (cc->base.wtime && cc->base.allocated)) {
-			assert(!cc->base.wtime || oc->base.wtime < cc->base.wtime);
 			if (store_nr_active > 1 && cc->data) { /* move delta */
 				sql_delta *b = cc->data;
 
@@ -3100,10 +3696,12 @@ bat_storage_init( store_functions *sf)
 	sf->clear_idx = (clear_idx_fptr)&clear_idx;
 	sf->clear_del = (clear_del_fptr)&clear_del;
 
+	sf->validate_table = (update_table_fptr)&validate_table;
 	sf->update_table = (update_table_fptr)&update_table;
 	sf->log_table = (update_table_fptr)&log_table;
 	sf->snapshot_table = (update_table_fptr)&snapshot_table;
 	sf->gtrans_update = (gtrans_update_fptr)&gtr_update;
 	sf->gtrans_minmax = (gtrans_update_fptr)&gtr_minmax;
+	sf->gtrans_merge = (gtrans_merge_fptr)&gtr_merge;
 }
 
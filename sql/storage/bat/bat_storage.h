@@ -31,7 +31,9 @@ typedef struct sql_dbat {
 	int dbid;		/* bat with deletes */
 	size_t cnt;
 	BAT *cached;		/* cached copy, used for schema bats only */
+	int wbid;		/* tids updated or deleted by the transaction */
 	int wtime;		/* time stamp */
+	int stime;		/* time stamp of the version it was copied from */
 	struct sql_dbat *next;	/* possibly older version of the same deletes */
 } sql_dbat;
 
@@ -71,6 +71,7 @@ res_col_create(sql_trans *tr, res_table *t, const char *tn, const char *name, co
 		return NULL;
 	}
 	c->b = 0;
+	c->cand = 0;
 	c->p = NULL;
 	c->mtype = mtype;
 	if (mtype == TYPE_bat) {
@@ -119,6 +120,8 @@ res_col_destroy(res_col *c)
 	} else {
 		_DELETE(c->p);
 	}
+	if (c->cand)
+		bat_decref(c->cand);
 	_DELETE(c->name);
 	_DELETE(c->tn);
 }
@@ -175,6 +175,8 @@ typedef BUN (*clear_del_fptr) (sql_trans *tr, sql_table *t);
 
 /*
 -- update_table rollforward the changes made from table ft to table tt 
+-- validate_table checks the changes of ft for row level conflicts with
+-- the changes committed to tt since the transaction started
 -- returns LOG_OK, LOG_ERR
 */
 typedef int (*update_table_fptr) (sql_trans *tr, sql_table *ft, sql_table *tt); 
@@ -185,6 +187,13 @@ typedef int (*update_table_fptr) (sql_trans *tr, sql_table *ft, sql_table *tt);
 */
 typedef int (*gtrans_update_fptr) (sql_trans *tr); 
 
+/*
+-- gtrans_merge merge the large deltas of a table into its columns,
+-- merged is set when there was one
+-- returns LOG_OK, LOG_ERR
+*/
+typedef int (*gtrans_merge_fptr) (sql_trans *tr, int *merged); 
+
 /*
 -- handle inserts and updates of columns and indices
 -- returns LOG_OK, LOG_ERR
@@ -254,12 +263,16 @@ typedef struct store_functions {
 	destroy_idx_fptr snapshot_destroy_idx;
 	destroy_del_fptr snapshot_destroy_del;
 
+	/* check the changes against the concurrently committed ones */
+	update_table_fptr validate_table;
+
 	/* rollforward the changes, first snapshot, then log and finaly apply */
 	update_table_fptr snapshot_table;
 	update_table_fptr log_table;
 	update_table_fptr update_table;
 	gtrans_update_fptr gtrans_update;
 	gtrans_update_fptr gtrans_minmax;
+	gtrans_merge_fptr gtrans_merge;
 
 	col_ins_fptr col_ins;
 	col_upd_fptr col_upd;
@@ -289,6 +302,7 @@ typedef int (*logger_reload_fptr) (void);
 typedef int (*log_isnew_fptr)(void);
 typedef int (*log_tstart_fptr) (void);
 typedef int (*log_tend_fptr) (void);
+typedef int (*log_sync_fptr) (void);
 typedef int (*log_sequence_fptr) (int seq, lng id);
 
 typedef struct logger_functions {
@@ -308,6 +322,8 @@ typedef struct logger_functions {
 	log_isnew_fptr log_isnew;
 	log_tstart_fptr log_tstart;
 	log_tend_fptr log_tend;
+	log_tend_fptr log_tend_nosync;	/* log_tend without the sync */
+	log_sync_fptr log_sync;
 	log_sequence_fptr log_sequence;
 } logger_functions;
 
@@ -329,17 +345,20 @@ extern void store_exit(void);
 
 extern void store_apply_deltas(void);
 extern void store_flush_log(void);
+extern int store_sync(int lognr);
 extern void store_manager(void);
 extern void idle_manager(void);
 
 extern void store_lock(void);
 extern void store_unlock(void);
 extern int store_next_oid(void);
+extern int store_next_commit(void);
 
 extern sql_trans *sql_trans_create(backend_stack stk, sql_trans *parent, const char *name);
 extern sql_trans *sql_trans_destroy(sql_trans *tr);
 extern int sql_trans_validate(sql_trans *tr);
 extern int sql_trans_commit(sql_trans *tr);
+extern int sql_trans_commit_nowait(sql_trans *tr, int *lognr);
 
 extern sql_type *sql_trans_create_type(sql_trans *tr, sql_schema * s, const char *sqlname, int digits, int scale, int radix, const char *impl);
 extern int sql_trans_drop_type(sql_trans *tr, sql_schema * s, int id, int drop_action);
@@ -360,6 +379,12 @@ extern int sql_trans_drop_schema(sql_trans *tr, int id, int drop_action);
 extern sql_table *sql_trans_create_table(sql_trans *tr, sql_schema *s, const char *name, const char *sql, int tt, bit system, int persistence, int commit_action, int sz);
 extern sql_table *sql_trans_add_table(sql_trans *tr, sql_table *mt, sql_table *pt);
 extern sql_table *sql_trans_del_table(sql_trans *tr, sql_table *mt, sql_table *pt, int drop_action);
+extern int sql_trans_set_partition(sql_trans *tr, sql_table *mt, sql_column *c, int type);
+extern sql_column *sql_trans_partition_column(sql_trans *tr, sql_table *mt, int *type);
+extern int sql_trans_add_range_partition(sql_trans *tr, sql_table *mt, sql_table *pt, const char *min, const char *max);
+extern int sql_trans_add_value_partition(sql_trans *tr, sql_table *mt, sql_table *pt, const char *value);
+extern int sql_trans_range_partition(sql_trans *tr, sql_allocator *sa, sql_table *mt, sql_table *pt, char **min, char **max);
+extern list *sql_trans_value_partition(sql_trans *tr, sql_allocator *sa, sql_table *mt, sql_table *pt);
 
 extern int sql_trans_drop_table(sql_trans *tr, sql_schema *s, int id, int drop_action);
 extern BUN sql_trans_clear_table(sql_trans *tr, sql_table *t);
@@ -373,6 +398,7 @@ extern sql_column *sql_trans_alter_storage(sql_trans *tr, sql_column *col, char
 extern int sql_trans_is_sorted(sql_trans *tr, sql_column *col);
 extern size_t sql_trans_dist_count(sql_trans *tr, sql_column *col);
 extern int sql_trans_ranges(sql_trans *tr, sql_column *col, void **min, void **max);
+extern dbl sql_trans_selectivity(sql_trans *tr, sql_column *col, const void *low, const void *high, int li, int hi);
 
 extern sql_key *sql_trans_create_ukey(sql_trans *tr, sql_table *t, const char *name, key_type kt);
 extern sql_key * sql_trans_key_done(sql_trans *tr, sql_key *k);
@@ -22,6 +22,13 @@
 int catalog_version = 0;
 
 static MT_Lock bs_lock MT_LOCK_INITIALIZER("bs_lock");
+/* the write-ahead log is synced outside of the bs_lock, the log lock
+ * protects the commit counters, the sync lock serializes the syncs
+ * and the restarts of the log (taken after the bs_lock) */
+static MT_Lock bs_log_lock MT_LOCK_INITIALIZER("bs_log_lock");
+static MT_Lock bs_sync_lock MT_LOCK_INITIALIZER("bs_sync_lock");
+static int log_written = 0;	/* commits written to the log */
+static int log_synced = 0;	/* commits written and synced */
 static int store_oid = 0;
 static int prev_oid = 0;
 static int nr_sessions = 0;
@@ -47,6 +54,8 @@ logger_functions shared_logger_funcs;
 
 static int schema_number = 0; /* each committed schema change triggers a new
 				 schema number (session wise unique number) */
+static int commit_number = 0; /* each commit to the global transaction
+				 triggers a new commit number */
 static int bs_debug = 0;
 static int logger_debug = 0;
 
@@ -1101,6 +1110,13 @@ store_next_oid(void)
 	return next_oid();
 }
 
+/* the number the next commit to the global transaction will get */
+int
+store_next_commit(void)
+{
+	return commit_number + 1;
+}
+
 static void
 insert_schemas(sql_trans *tr)
 {
@@ -1642,6 +1658,8 @@ store_init(int debug, store_type store, int readonly, int singleuser, logger_set
 
 #ifdef NEED_MT_LOCK_INIT
 	MT_lock_init(&bs_lock, "SQL_bs_lock");
+	MT_lock_init(&bs_log_lock, "SQL_bs_log_lock");
+	MT_lock_init(&bs_sync_lock, "SQL_bs_sync_lock");
 #endif
 	MT_lock_set(&bs_lock);
 
@@ -1688,6 +1706,51 @@ store_init(int debug, store_type store, int readonly, int singleuser, logger_set
 
 static int logging = 0;
 
+/* restarting the log makes all commits durable */
+static int
+store_restart_log(void)
+{
+	int res;
+
+	MT_lock_set(&bs_sync_lock);
+	res = logger_funcs.restart();
+	if (res == LOG_OK) {
+		MT_lock_set(&bs_log_lock);
+		log_synced = log_written;
+		MT_lock_unset(&bs_log_lock);
+	}
+	MT_lock_unset(&bs_sync_lock);
+	return res;
+}
+
+/* make the commits up to lognr (see sql_trans_commit_nowait) durable,
+ * a single sync of the log serves all commits waiting for it */
+int
+store_sync(int lognr)
+{
+	int res = LOG_OK, upto;
+
+	if (lognr <= 0)
+		return LOG_OK;
+	MT_lock_set(&bs_sync_lock);
+	MT_lock_set(&bs_log_lock);
+	upto = log_written;
+	if (log_synced >= lognr) {
+		MT_lock_unset(&bs_log_lock);
+		MT_lock_unset(&bs_sync_lock);
+		return LOG_OK;
+	}
+	MT_lock_unset(&bs_log_lock);
+	res = logger_funcs.log_sync();
+	if (res == LOG_OK) {
+		MT_lock_set(&bs_log_lock);
+		log_synced = upto;
+		MT_lock_unset(&bs_log_lock);
+	}
+	MT_lock_unset(&bs_sync_lock);
+	return res;
+}
+
 void
 store_exit(void)
 {
@@ -1711,7 +1774,9 @@ store_exit(void)
 	if (spares > 0)
 		destroy_spare_transactions();
 
+	MT_lock_set(&bs_sync_lock);
 	logger_funcs.destroy();
+	MT_lock_unset(&bs_sync_lock);
 	if (create_shared_logger) {
 		shared_logger_funcs.destroy();
 	}
@@ -1742,7 +1807,7 @@ store_apply_deltas(void)
 	gtrans->wstime = timestamp();
 	if (store_funcs.gtrans_update)
 		store_funcs.gtrans_update(gtrans);
-	res = logger_funcs.restart();
+	res = store_restart_log();
 	if (logging && res == LOG_OK)
 		res = logger_funcs.cleanup(keep_persisted_log_files);
 	logging = 0;
@@ -1876,7 +1941,7 @@ store_manager(void)
 		if (store_funcs.gtrans_update) {
 			store_funcs.gtrans_update(gtrans);
 		}
-		res = logger_funcs.restart();
+		res = store_restart_log();
 
 		MT_lock_unset(&bs_lock);
 		if (logging && res == LOG_OK) {
@@ -1897,18 +1962,32 @@ idle_manager(void)
 {
 	const int sleeptime = GDKdebug & FORCEMITOMASK ? 10 : 50;
 	const int timeout = GDKdebug & FORCEMITOMASK ? 50 : 5000;
+	int merged = 0;
 
 	while (!GDKexiting()) {
 		sql_session *s;
 		int t;
 
-		for (t = timeout; t > 0; t -= sleeptime) {
+		/* continue right away with the next table to merge */
+		for (t = merged ? sleeptime : timeout; t > 0; t -= sleeptime) {
 			MT_sleep_ms(sleeptime);
 			if (GDKexiting())
 				return;
 		}
+		merged = 0;
 		MT_lock_set(&bs_lock);
-		if (store_nr_active || GDKexiting() || !store_needs_vacuum(gtrans)) {
+		if (store_nr_active || GDKexiting()) {
+			MT_lock_unset(&bs_lock);
+			continue;
+		}
+		/* merge the large deltas into the columns, a table at a time
+		 * such that starting transactions don't wait long */
+		if (store_funcs.gtrans_merge) {
+			gtrans->wstime = timestamp();
+			if (store_funcs.gtrans_merge(gtrans, &merged) != LOG_OK)
+				merged = 0;
+		}
+		if (merged || !store_needs_vacuum(gtrans)) {
 			MT_lock_unset(&bs_lock);
 			continue;
 		}
@@ -2624,6 +2703,7 @@ trans_init(sql_trans *t, backend_stack stk, sql_trans *ot)
 		t->schema_updates = ot->schema_updates;
 
 	t->schema_number = store_schema_number();
+	t->commit_number = commit_number;
 	t->parent = ot;
 	t->stk = stk;
 
@@ -3235,6 +3315,7 @@ rollforward_trans(sql_trans *tr, int mode)
 			
 			if (tr->schema_updates) 
 				schema_number++;
+			tr->commit_number = ++commit_number;
 		}
 		//tr->wtime = tr->rtime = 0;
 	//	assert(gtrans->wstime == gtrans->wtime);
@@ -3243,7 +3324,7 @@ rollforward_trans(sql_trans *tr, int mode)
 }
 
 static int
-validate_tables(sql_schema *s, sql_schema *os)
+validate_tables(sql_trans *tr, sql_schema *s, sql_schema *os)
 {
 	node *n, *o, *p;
 
@@ -3257,6 +3338,12 @@ validate_tables(sql_schema *s, sql_schema *os)
 
  			ot = find_sql_table(os, t->base.name);
 			if (ot && isKindOfTable(ot) && isKindOfTable(t)) {
+				/* t wrote, only changes to the same rows conflict */
+				if (t->base.wtime && t->base.allocated && t->data && isTable(t)) {
+					if (store_funcs.validate_table(tr, t, ot) != LOG_OK)
+						return 0;
+					continue;
+				}
 				if ((t->base.wtime && (t->base.wtime < ot->base.rtime || t->base.wtime < ot->base.wtime)) ||
 				    (t->base.rtime && (t->base.rtime < ot->base.wtime))) 
 					return 0;
@@ -3566,7 +3653,7 @@ sql_trans_validate(sql_trans *tr)
 
  			os = find_sql_schema(tr->parent, s->base.name);
 			if (os && (s->base.wtime != 0 || s->base.rtime != 0)) {
-				if (!validate_tables(s, os)) 
+				if (!validate_tables(tr, s, os)) 
 					return 0;
 			}
 		}
@@ -3593,11 +3680,16 @@ catalog_corrupt( sql_trans *tr )
 }
 #endif /*CAT_DEBUG*/
 
+/* commit without waiting for the log to reach the disk, which allows
+ * the caller to release the store lock first; a positive lognr is
+ * returned when store_sync(lognr) is needed to make the commit durable */
 int
-sql_trans_commit(sql_trans *tr)
+sql_trans_commit_nowait(sql_trans *tr, int *lognr)
 {
 	int ok = LOG_OK;
 
+	*lognr = 0;
+
 	/* write phase */
 	if (bs_debug)
 		fprintf(stderr, "#forwarding changes %d,%d %d,%d\n", gtrans->stime, tr->stime, gtrans->wstime, tr->wstime);
@@ -3613,7 +3705,12 @@ sql_trans_commit(sql_trans *tr)
 			ok = logger_funcs.log_sequence(OBJ_SID, store_oid);
 		prev_oid = store_oid;
 		if (ok == LOG_OK)
-			ok = logger_funcs.log_tend();
+			ok = logger_funcs.log_tend_nosync();
+		if (ok == LOG_OK) {
+			MT_lock_set(&bs_log_lock);
+			*lognr = ++log_written;
+			MT_lock_unset(&bs_log_lock);
+		}
 		tr->schema_number = store_schema_number();
 	}
 	if (ok == LOG_OK) {
@@ -3626,6 +3723,16 @@ sql_trans_commit(sql_trans *tr)
 	return (ok==LOG_OK)?SQL_OK:SQL_ERR;
 }
 
+int
+sql_trans_commit(sql_trans *tr)
+{
+	int lognr, ok = sql_trans_commit_nowait(tr, &lognr);
+
+	if (ok == SQL_OK && store_sync(lognr) != LOG_OK)
+		ok = SQL_ERR;
+	return ok;
+}
+
 
 static int
 sql_trans_drop_all_dependencies(sql_trans *tr, sql_schema *s, int id, short type)
@@ -3858,6 +3965,7 @@ sys_drop_statistics(sql_trans *tr, sql_column *col)
 	if (isGlobal(col->t)) {
 		sql_schema *syss = find_sql_schema(tr, "sys"); 
 		sql_table *sysstats = find_sql_table(syss, "statistics");
+		const char *dists[] = { "statistics_histogram", "statistics_mcv", NULL }, **d;
 
 		oid rid = table_funcs.column_find_row(tr, find_sql_column(sysstats, "column_id"), &col->base.id, NULL);
 
@@ -3865,6 +3973,19 @@ sys_drop_statistics(sql_trans *tr, sql_column *col)
 			return ;
 
 		table_funcs.table_delete(tr, sysstats, rid);
+
+		/* the value distribution, if any */
+		for (d = dists; *d; d++) {
+			sql_table *sysdist = find_sql_table(syss, *d);
+			rids *rs;
+
+			if (sysdist == NULL)
+				continue;
+			rs = table_funcs.rids_select(tr, find_sql_column(sysdist, "column_id"), &col->base.id, &col->base.id, NULL);
+			for (rid = table_funcs.rids_next(rs); !is_oid_nil(rid); rid = table_funcs.rids_next(rs))
+				table_funcs.table_delete(tr, sysdist, rid);
+			table_funcs.rids_destroy(rs);
+		}
 	}
 }
 
@@ -3948,6 +4069,50 @@ sys_drop_columns(sql_trans *tr, sql_table *t, int drop_action)
 		}
 }
 
+/* The partitioning of merge tables is kept in sys.table_partitions
+ * (the partition column and kind per merge table) and in
+ * sys.range_partitions and sys.value_partitions (the bounds or the
+ * values of each member).  Bounds and values are kept as strings in
+ * the storage format of the partition column, a nil bound is unbounded.
+ * All of these tables are absent in databases created before
+ * partitioning existed, until they are upgraded. */
+static void
+sys_drop_partition_values(sql_trans *tr, const char *tname, int mt_id, int pt_id)
+{
+	sql_schema *syss = find_sql_schema(tr, "sys");
+	sql_table *parts = find_sql_table(syss, tname);
+	rids *rs;
+	oid rid;
+
+	if (!parts)
+		return;
+	rs = table_funcs.rids_select(tr, find_sql_column(parts, "table_id"), &mt_id, &mt_id, NULL);
+	for (rid = table_funcs.rids_next(rs); !is_oid_nil(rid); rid = table_funcs.rids_next(rs)) {
+		int *id = table_funcs.column_find_value(tr, find_sql_column(parts, "partition_id"), rid);
+
+		if (pt_id == 0 || *id == pt_id)
+			table_funcs.table_delete(tr, parts, rid);
+		_DELETE(id);
+	}
+	table_funcs.rids_destroy(rs);
+}
+
+static void
+sys_drop_partitioning(sql_trans *tr, sql_table *mt)
+{
+	sql_schema *syss = find_sql_schema(tr, "sys");
+	sql_table *parts = find_sql_table(syss, "table_partitions");
+	oid rid;
+
+	if (!parts)
+		return;
+	rid = table_funcs.column_find_row(tr, find_sql_column(parts, "table_id"), &mt->base.id, NULL);
+	if (!is_oid_nil(rid))
+		table_funcs.table_delete(tr, parts, rid);
+	sys_drop_partition_values(tr, "range_partitions", mt->base.id, 0);
+	sys_drop_partition_values(tr, "value_partitions", mt->base.id, 0);
+}
+
 static void
 sys_drop_parts(sql_trans *tr, sql_table *t, int drop_action)
 {
@@ -3981,6 +4146,8 @@ sys_drop_table(sql_trans *tr, sql_table *t, int drop_action)
 
 	if (isMergeTable(t) || isReplicaTable(t))
 		sys_drop_parts(tr, t, drop_action);
+	if (isMergeTable(t) && isGlobal(t))
+		sys_drop_partitioning(tr, t);
 
 	sql_trans_drop_any_comment(tr, t->base.id);
 	sql_trans_drop_dependencies(tr, t->base.id);
@@ -4405,6 +4572,8 @@ sql_trans_add_table(sql_trans *tr, sql_table *mt, sql_table *pt)
 	base_init(tr->sa, &p->base, pt->base.id, TR_NEW, pt->base.name);
 	cs_add(&mt->members, p, TR_NEW);
 	mt->s->base.wtime = mt->base.wtime = tr->wtime = tr->wstime;
+	/* plans of the merge table expand into its members */
+	tr->schema_updates ++;
 	table_funcs.table_insert(tr, sysobj, &mt->base.id, p->base.name, &p->base.id);
 	return mt;
 }
@@ -4426,12 +4595,148 @@ sql_trans_del_table(sql_trans *tr, sql_table *mt, sql_table *pt, int drop_action
 	cs_del(&mt->members, n, pt->base.flag);
 	pt->p = NULL;
 	mt->s->base.wtime = mt->base.wtime = tr->wtime = tr->wstime;
+	tr->schema_updates ++;
 	table_funcs.table_delete(tr, sysobj, rid);
+	if (isGlobal(mt)) {
+		sys_drop_partition_values(tr, "range_partitions", mt->base.id, pt->base.id);
+		sys_drop_partition_values(tr, "value_partitions", mt->base.id, pt->base.id);
+	}
 	if (drop_action == DROP_CASCADE) 
 		sql_trans_drop_table(tr, mt->s, pt->base.id, drop_action);
 	return mt;
 }
 
+int
+sql_trans_set_partition(sql_trans *tr, sql_table *mt, sql_column *c, int type)
+{
+	sql_schema *syss = find_sql_schema(tr, "sys");
+	sql_table *parts = find_sql_table(syss, "table_partitions");
+
+	if (!parts || !isGlobal(mt))
+		return -1;
+	sys_drop_partitioning(tr, mt);
+	table_funcs.table_insert(tr, parts, &mt->base.id, &c->base.id, &type);
+	mt->s->base.wtime = mt->base.wtime = tr->wtime = tr->wstime;
+	return 0;
+}
+
+sql_column *
+sql_trans_partition_column(sql_trans *tr, sql_table *mt, int *type)
+{
+	sql_schema *syss = find_sql_schema(tr, "sys");
+	sql_table *parts = find_sql_table(syss, "table_partitions");
+	sql_column *c = NULL;
+	node *n;
+	oid rid;
+	int *v;
+
+	if (!parts || !isMergeTable(mt))
+		return NULL;
+	rid = table_funcs.column_find_row(tr, find_sql_column(parts, "table_id"), &mt->base.id, NULL);
+	if (is_oid_nil(rid))
+		return NULL;
+	v = table_funcs.column_find_value(tr, find_sql_column(parts, "column_id"), rid);
+	for (n = mt->columns.set->h; n && !c; n = n->next) {
+		sql_column *mc = n->data;
+
+		if (mc->base.id == *v)
+			c = mc;
+	}
+	_DELETE(v);
+	v = table_funcs.column_find_value(tr, find_sql_column(parts, "type"), rid);
+	*type = *v;
+	_DELETE(v);
+	return c;
+}
+
+int
+sql_trans_add_range_partition(sql_trans *tr, sql_table *mt, sql_table *pt, const char *min, const char *max)
+{
+	sql_schema *syss = find_sql_schema(tr, "sys");
+	sql_table *parts = find_sql_table(syss, "range_partitions");
+
+	if (!parts)
+		return -1;
+	table_funcs.table_insert(tr, parts, &mt->base.id, &pt->base.id, min ? min : str_nil, max ? max : str_nil);
+	return 0;
+}
+
+int
+sql_trans_add_value_partition(sql_trans *tr, sql_table *mt, sql_table *pt, const char *value)
+{
+	sql_schema *syss = find_sql_schema(tr, "sys");
+	sql_table *parts = find_sql_table(syss, "value_partitions");
+
+	if (!parts)
+		return -1;
+	table_funcs.table_insert(tr, parts, &mt->base.id, &pt->base.id, value);
+	return 0;
+}
+
+/* The bounds of member pt of merge table mt, allocated on sa, NULL
+ * for an unbounded side.  Returns 0 if pt has no range bounds. */
+int
+sql_trans_range_partition(sql_trans *tr, sql_allocator *sa, sql_table *mt, sql_table *pt, char **min, char **max)
+{
+	sql_schema *syss = find_sql_schema(tr, "sys");
+	sql_table *parts = find_sql_table(syss, "range_partitions");
+	int found = 0;
+	rids *rs;
+	oid rid;
+
+	if (!parts)
+		return 0;
+	rs = table_funcs.rids_select(tr, find_sql_column(parts, "partition_id"), &pt->base.id, &pt->base.id, NULL);
+	for (rid = table_funcs.rids_next(rs); !found && !is_oid_nil(rid); rid = table_funcs.rids_next(rs)) {
+		int *id = table_funcs.column_find_value(tr, find_sql_column(parts, "table_id"), rid);
+
+		if (*id == mt->base.id) {
+			char *lo = table_funcs.column_find_value(tr, find_sql_column(parts, "minimum"), rid);
+			char *hi = table_funcs.column_find_value(tr, find_sql_column(parts, "maximum"), rid);
+
+			*min = strcmp(lo, str_nil) ? sa_strdup(sa, lo) : NULL;
+			*max = strcmp(hi, str_nil) ? sa_strdup(sa, hi) : NULL;
+			_DELETE(lo);
+			_DELETE(hi);
+			found = 1;
+		}
+		_DELETE(id);
+	}
+	table_funcs.rids_destroy(rs);
+	return found;
+}
+
+/* The values of list member pt of merge table mt, as strings
+ * allocated on sa, or NULL if pt has no values. */
+list *
+sql_trans_value_partition(sql_trans *tr, sql_allocator *sa, sql_table *mt, sql_table *pt)
+{
+	sql_schema *syss = find_sql_schema(tr, "sys");
+	sql_table *parts = find_sql_table(syss, "value_partitions");
+	list *values = NULL;
+	rids *rs;
+	oid rid;
+
+	if (!parts)
+		return NULL;
+	rs = table_funcs.rids_select(tr, find_sql_column(parts, "partition_id"), &pt->base.id, &pt->base.id, NULL);
+	for (rid = table_funcs.rids_next(rs); !is_oid_nil(rid); rid = table_funcs.rids_next(rs)) {
+		int *id = table_funcs.column_find_value(tr, find_sql_column(parts, "table_id"), rid);
+
+		if (*id == mt->base.id) {
+			char *v = table_funcs.column_find_value(tr, find_sql_column(parts, "value"), rid);
+
+			if (!values)
+				values = sa_list(sa);
+			list_append(values, sa_strdup(sa, v));
+			_DELETE(v);
+		}
+		_DELETE(id);
+	}
+	table_funcs.rids_destroy(rs);
+	return values;
+}
+
 sql_table *
 sql_trans_create_table(sql_trans *tr, sql_schema *s, const char *name, const char *sql, int tt, bit system, int persistence, int commit_action, int sz)
 {
@@ -4929,6 +5234,89 @@ sql_trans_ranges( sql_trans *tr, sql_column *col, void **min, void **max )
 	return 0;
 }
 
+/* Estimate the fraction of the non-nil values of col that lie
+ * between low and high (a NULL bound is unbounded, li/hi tell whether
+ * the bounds are inclusive), using the histogram and most common
+ * values kept by ANALYZE.  An equality test is passed as low == high.
+ * Returns a negative number if no distribution is known. */
+dbl
+sql_trans_selectivity( sql_trans *tr, sql_column *col, const void *low, const void *high, int li, int hi )
+{
+	sql_schema *sys = find_sql_schema(tr, "sys");
+	sql_table *hist = find_sql_table(sys, "statistics_histogram");
+	sql_table *mcv = find_sql_table(sys, "statistics_mcv");
+	int tpe = col->type.type->localtype;
+	int (*cmp)(const void *, const void *) = ATOMcompare(tpe);
+	int equal = low && low == high;
+	dbl total = 0, est = 0;
+	rids *rs;
+	oid rid;
+
+	if (!hist || !mcv || !isTable(col->t))
+		return -1;
+	rs = table_funcs.rids_select(tr, find_sql_column(hist, "column_id"), &col->base.id, &col->base.id, NULL);
+	for (rid = table_funcs.rids_next(rs); !is_oid_nil(rid); rid = table_funcs.rids_next(rs)) {
+		char *lv = table_funcs.column_find_value(tr, find_sql_column(hist, "lowval"), rid);
+		char *hv = table_funcs.column_find_value(tr, find_sql_column(hist, "highval"), rid);
+		lng *cnt = table_funcs.column_find_value(tr, find_sql_column(hist, "count"), rid);
+		lng *uniq = table_funcs.column_find_value(tr, find_sql_column(hist, "unique"), rid);
+		ptr blo = NULL, bhi = NULL;
+		size_t lolen = 0, hilen = 0;
+
+		if (ATOMfromstr(tpe, &blo, &lolen, lv) >= 0 && blo &&
+		    ATOMfromstr(tpe, &bhi, &hilen, hv) >= 0 && bhi) {
+			total += *cnt;
+			if (equal) {
+				/* assume the distinct values in a bucket
+				 * are equally frequent */
+				if ((*cmp)(low, blo) >= 0 && (*cmp)(low, bhi) <= 0 && *uniq > 0)
+					est = *cnt / (dbl) *uniq;
+			} else if ((high && ((*cmp)(blo, high) > 0 || (!hi && (*cmp)(blo, high) == 0))) ||
+				   (low && ((*cmp)(bhi, low) < 0 || (!li && (*cmp)(bhi, low) == 0)))) {
+				/* bucket outside the range */
+			} else if ((!low || (*cmp)(blo, low) > 0 || (li && (*cmp)(blo, low) == 0)) &&
+				   (!high || (*cmp)(bhi, high) < 0 || (hi && (*cmp)(bhi, high) == 0))) {
+				est += *cnt;
+			} else {
+				/* partially overlapping bucket */
+				est += *cnt / 2.0;
+			}
+		} else {
+			total = -1;
+		}
+		GDKfree(blo);
+		GDKfree(bhi);
+		_DELETE(lv);
+		_DELETE(hv);
+		_DELETE(cnt);
+		_DELETE(uniq);
+		if (total < 0)
+			break;
+	}
+	table_funcs.rids_destroy(rs);
+	if (total <= 0)
+		return -1;
+
+	if (equal) {
+		/* the most common values are counted exactly */
+		rs = table_funcs.rids_select(tr, find_sql_column(mcv, "column_id"), &col->base.id, &col->base.id, NULL);
+		for (rid = table_funcs.rids_next(rs); !is_oid_nil(rid); rid = table_funcs.rids_next(rs)) {
+			char *mv = table_funcs.column_find_value(tr, find_sql_column(mcv, "value"), rid);
+			lng *cnt = table_funcs.column_find_value(tr, find_sql_column(mcv, "count"), rid);
+			ptr v = NULL;
+			size_t len = 0;
+
+			if (ATOMfromstr(tpe, &v, &len, mv) >= 0 && v && (*cmp)(low, v) == 0)
+				est = *cnt;
+			GDKfree(v);
+			_DELETE(mv);
+			_DELETE(cnt);
+		}
+		table_funcs.rids_destroy(rs);
+	}
+	return est / total;
+}
+
 
 sql_key *
 sql_trans_create_ukey(sql_trans *tr, sql_table *t, const char *name, key_type kt)
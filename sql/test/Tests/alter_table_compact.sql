@@ -0,0 +1,47 @@
+create table compact_p (id int primary key, s varchar(20));
+create table compact_c (pid int references compact_p(id), v int);
+create table compact_s (id int primary key, par int references compact_s(id), s clob);
+insert into compact_p select value, 'str' || value from generate_series(0, 1000);
+insert into compact_c select value % 1000, value from generate_series(0, 3000);
+insert into compact_s values (1, null, 'a');
+insert into compact_s values (2, 1, 'b');
+insert into compact_s values (3, 1, 'c');
+insert into compact_s values (4, 3, 'd');
+insert into compact_s values (5, 4, 'e');
+
+delete from compact_c where pid < 500;
+delete from compact_p where id < 500;
+update compact_p set s = 'upd' where id = 700;
+insert into compact_p values (2000, 'new');
+delete from compact_s where id = 2;
+select cast(sum(p.id) as bigint), cast(sum(c.v) as bigint) from compact_c c join compact_p p on c.pid = p.id;
+
+alter table compact_p compact;
+alter table compact_c compact;
+alter table compact_s compact;
+
+select "column", count from sys.storage where "table" like 'compact_%' order by "table", "column";
+select count(*), min(id), max(id) from compact_p;
+select id, s from compact_p where id in (500, 700, 999, 2000) order by id;
+select cast(sum(p.id) as bigint), cast(sum(c.v) as bigint) from compact_c c join compact_p p on c.pid = p.id;
+select a.id, b.id, a.s from compact_s a left join compact_s b on a.par = b.id order by a.id;
+
+-- the keys still hold
+insert into compact_c values (499, 1);
+insert into compact_p values (500, 'dup');
+insert into compact_c values (2000, 1);
+delete from compact_p where id = 2000;
+select count(*) from compact_c c join compact_p p on c.pid = p.id;
+
+-- nothing to compact
+alter table compact_c compact;
+select count(*) from compact_c;
+
+-- only tables can be compacted
+create view compact_v as select * from compact_p;
+alter table compact_v compact;
+
+drop view compact_v;
+drop table compact_c;
+drop table compact_s;
+drop table compact_p;
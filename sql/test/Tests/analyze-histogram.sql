@@ -0,0 +1,42 @@
+-- ANALYZE keeps an equi-depth histogram, the most common values and a
+-- distinct value sketch per column
+create table analyze_hist (i int, s varchar(20));
+insert into analyze_hist select value % 100, 'v' || (value % 7) from generate_series(0, 10000);
+insert into analyze_hist select 5, 'v1' from generate_series(0, 3000);
+insert into analyze_hist values (null, null);
+
+create view analyze_hist_cols as
+select c.name, c.id from sys._columns c, sys._tables t
+ where c.table_id = t.id and t.name = 'analyze_hist';
+
+call sys.analyze(0, 0, 'sys', 'analyze_hist');
+select c.name, s."count", s."unique", s.nils, s.minval, s.maxval, length(s.sketch)
+  from sys.statistics s, analyze_hist_cols c where s.column_id = c.id order by c.name;
+select c.name, h.bucket, h.lowval, h.highval, h."count", h."unique"
+  from sys.statistics_histogram h, analyze_hist_cols c where h.column_id = c.id and (h.bucket < 3 or h.bucket > 28) order by c.name, h.bucket;
+select c.name, m.value, m."count"
+  from sys.statistics_mcv m, analyze_hist_cols c where m.column_id = c.id order by c.name, m."count" desc, m.value;
+
+-- minmax only: distinct count from the sketch, no distribution
+call sys.analyze(1, 0, 'sys', 'analyze_hist');
+select c.name, s."count", s."unique", s.nils
+  from sys.statistics s, analyze_hist_cols c where s.column_id = c.id order by c.name;
+select count(*) from sys.statistics_histogram h, analyze_hist_cols c where h.column_id = c.id;
+
+-- incremental: only the appended rows are folded in
+call sys.analyze(0, 0, 'sys', 'analyze_hist');
+insert into analyze_hist select 1000 + value, 'w' from generate_series(0, 500);
+call sys.analyze(2, 0, 'sys', 'analyze_hist');
+select c.name, s."count", s."unique", s.nils, s.minval, s.maxval
+  from sys.statistics s, analyze_hist_cols c where s.column_id = c.id order by c.name;
+select c.name, h.bucket, h.lowval, h.highval, h."count"
+  from sys.statistics_histogram h, analyze_hist_cols c where h.column_id = c.id and h.bucket in (0, 31) order by c.name, h.bucket;
+
+-- dropping a column drops its statistics
+alter table analyze_hist drop column s;
+select count(*) from sys.statistics_histogram h, analyze_hist_cols c where h.column_id = c.id;
+
+drop view analyze_hist_cols;
+drop table analyze_hist;
+select count(*) from sys.statistics_histogram;
+select count(*) from sys.statistics_mcv;
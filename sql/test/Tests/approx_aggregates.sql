@@ -0,0 +1,32 @@
+create table aa (k int, v int, d decimal(6,2), s varchar(10));
+insert into aa values (1, 10, 1.50, 'a'), (1, 20, 2.50, 'b'), (1, 20, null, 'b'),
+	(1, null, 0.50, null), (1, 40, 4.00, 'd'), (2, 5, 1.00, 'x'), (2, 7, 1.00, 'x'),
+	(2, 7, 3.00, 'y'), (3, null, null, null);
+
+-- small groups are counted exactly and their quantiles are exact
+select approx_count_distinct(v), approx_count_distinct(d), approx_count_distinct(s),
+	approx_median(v), approx_median(d), approx_quantile(v, 0.25), approx_quantile(s, 1.0)
+from aa;
+
+select k, approx_count_distinct(v) as cv, approx_count_distinct(s) as cs,
+	count(distinct v) as dv, approx_median(v) as mv, median(v) as ev,
+	approx_quantile(d, 0.75) as qd, quantile(d, 0.75) as ed
+from aa group by k order by k;
+
+select approx_count_distinct(v), approx_median(v) from aa where k = 4;
+
+-- large inputs: the estimates are close to the exact answers
+create table ab as select value as v, value % 1000 as m from sys.generate_series(0, 1000000) with data;
+
+select abs(approx_count_distinct(v) - 1000000) < 30000, approx_count_distinct(m),
+	abs(approx_median(v) - 500000) < 10000, abs(approx_quantile(v, 0.9) - 900000) < 10000
+from ab;
+
+select count(*), sum(case when abs(c - 10000) < 1500 then 1 else 0 end),
+	sum(case when abs(q - 500) < 20 then 1 else 0 end)
+from (select m % 10 as g, approx_count_distinct(v / 100) as c, approx_median(m) as q from ab group by g) as t;
+
+select approx_quantile(v, 1.5) from aa;
+
+drop table ab;
+drop table aa;
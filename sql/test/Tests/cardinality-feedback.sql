@@ -0,0 +1,11 @@
+-- a cached plan compiled for an empty table is replaced once the
+-- table has grown far beyond its compile time size
+create table cardinality_feedback (i int, j int);
+select count(*), cast(sum(j) as bigint) from cardinality_feedback where i > 5;
+insert into cardinality_feedback select value, value % 7 from generate_series(0, 200000);
+select count(*), cast(sum(j) as bigint) from cardinality_feedback where i > 5;
+select count(*), cast(sum(j) as bigint) from cardinality_feedback where i > 5;
+delete from cardinality_feedback where i >= 100;
+select count(*), cast(sum(j) as bigint) from cardinality_feedback where i > 5;
+select count(*), cast(sum(j) as bigint) from cardinality_feedback where i > 5;
+drop table cardinality_feedback;
@@ -0,0 +1,85 @@
+import sys, time
+try:
+    from MonetDBtesting import process
+except ImportError:
+    import process
+
+# the hash of an indexed column is built by CREATE INDEX, maintained on
+# the updates of the column and persisted with it across restarts
+
+def server():
+    return process.server(stdin = process.PIPE,
+                          stdout = process.PIPE,
+                          stderr = process.PIPE)
+
+def client():
+    return process.client('sql', interactive = True,
+                          stdin = process.PIPE,
+                          stdout = process.PIPE,
+                          stderr = process.PIPE)
+
+def query(c, q):
+    # wait for the statement to finish using a marker query
+    c.stdin.write(q + "\nselect 'sync';\n")
+    c.stdin.flush()
+    out = []
+    while True:
+        line = c.stdout.readline()
+        if not line or line.startswith('[ "sync"'):
+            break
+        out.append(line)
+    # drop the echo and the header of the marker query
+    sys.stdout.write(''.join(out[:-5]))
+
+def flush(c):
+    # let the store merge the deltas into the columns and commit them
+    query(c, 'call sys.flush_log();')
+    time.sleep(3)
+
+def done(c):
+    out, err = c.communicate()
+    sys.stdout.write(out)
+    sys.stderr.write(err)
+
+def stop(s):
+    out, err = s.communicate()
+    sys.stdout.write(out)
+    sys.stderr.write(err)
+
+lookups = ['select k, v from hidx where k = 4242;',
+           'select k, v from hidx where k = -1;',
+           "select k, v from hidx where k = 20001 and v = 'new';"]
+persisted = "select \"column\", phash from sys.storage where \"table\" = 'hidx' order by \"column\";"
+
+s = server()
+c = client()
+query(c, 'create table hidx (k int, v varchar(10));')
+query(c, "insert into hidx select (value * 7919) % 20000, 'v' || ((value * 7919) % 20000) from sys.generate_series(0, 20000);")
+flush(c)
+query(c, 'create index hidx_k on hidx (k);')
+flush(c)
+query(c, persisted)
+for q in lookups:
+    query(c, q)
+
+# updates and inserts are applied to the hash once they reach the column
+query(c, 'update hidx set k = -1 where k = 4242;')
+query(c, "insert into hidx values (20001, 'new'), (4242, 'back');")
+flush(c)
+query(c, persisted)
+for q in lookups:
+    query(c, q)
+done(c)
+stop(s)
+
+# the restarted server uses the hash it finds on disk
+s = server()
+c = client()
+query(c, persisted)
+for q in lookups:
+    query(c, q)
+query(c, 'delete from hidx where k = 4242;')
+query(c, 'select k, v from hidx where k = 4242;')
+query(c, 'drop table hidx;')
+done(c)
+stop(s)
@@ -0,0 +1,57 @@
+create table mb (k int, v int);
+create table mc (k int, name varchar(10));
+insert into mb values (1, 10), (1, 20), (2, 5);
+insert into mc values (1, 'one'), (2, 'two');
+
+create materialized view mv_spj as select k, v * 2 as w from mb where v > 6;
+create materialized view mv_agg (k, c, s, mn, mx) as
+	select k, count(*), sum(v), min(v), max(v) from mb group by k;
+create materialized view mv_tot as select count(*) as n, sum(v) as s from mb;
+create materialized view mv_join as select mc.name, mb.v from mb, mc where mb.k = mc.k;
+create materialized view mv_nested as select name, count(*) as cnt from mv_join group by name;
+
+-- appended rows are propagated, single rows as well as sets of rows
+insert into mb values (3, 7);
+insert into mb values (1, 1), (2, 100), (4, 4);
+insert into mb select k, v + 1 from mb where k = 2;
+insert into mc values (3, 'three');
+
+select * from mv_spj order by k, w;
+select * from mv_agg order by k;
+select * from mv_tot;
+select * from mv_join order by name, v;
+select * from mv_nested order by name;
+
+-- deletes and updates recompute the views
+delete from mb where k = 1;
+update mb set v = 0 where k = 2;
+select * from mv_agg order by k;
+select * from mv_nested order by name;
+
+-- a query equal to the definition of a view is answered from it
+plan select k, v * 2 as w from mb where v > 6;
+plan select k, v * 2 as w from mb where v > 7;
+select k, v * 2 as w from mb where v > 6;
+
+-- the views are only changed by the statements defining them
+insert into mv_spj values (1, 1);
+update mv_agg set c = 0;
+delete from mv_tot;
+drop table mv_spj;
+drop view mv_spj;
+alter table mv_spj add column x int;
+drop table mb;
+
+truncate mb;
+select * from mv_spj;
+select * from mv_agg;
+select * from mv_tot;
+
+refresh materialized view mv_tot;
+refresh materialized view mb;
+drop materialized view mb;
+drop materialized view if exists mv_none;
+drop materialized view mv_spj;
+drop table mb cascade;
+drop table mc cascade;
+select name from sys.tables where name like 'mv%';
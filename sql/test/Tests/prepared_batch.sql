@@ -0,0 +1,33 @@
+create table pb (i int primary key, s varchar(20), d decimal(5,2), n int default 7);
+prepare insert into pb (i, s, d) values (?, ?, ?);
+exec ** from stdin 4 records using delimiters '|','\n','"';
+1|"one"|1.5
+2|"two|\"2\""|null
+3|null|3.25
+4|"f\nour"|4
+select * from pb order by i;
+
+-- the batch is inserted all or nothing
+exec ** from stdin 2 records;
+5|five|5
+1|again|1
+select count(*) from pb;
+drop table pb;
+
+start transaction;
+create table pb (i int, s varchar(10));
+prepare insert into pb values (?, upper(?));
+exec ** from stdin 3 records;
+1|a
+2|bc
+3|null
+select * from pb order by i;
+prepare select * from pb where i = ?;
+exec ** from stdin 1 records;
+1
+rollback;
+
+exec 1000 from stdin 2 records;
+1|2
+3|4
+select 1;
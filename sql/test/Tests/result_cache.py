@@ -0,0 +1,85 @@
+import sys
+try:
+    from MonetDBtesting import process
+except ImportError:
+    import process
+
+# the result cache hands out results only while the tables they were
+# computed from are unchanged
+
+def client():
+    return process.client('sql', interactive = True,
+                          stdin = process.PIPE,
+                          stdout = process.PIPE,
+                          stderr = process.PIPE)
+
+def query(c, q):
+    # wait for the statement to finish using a marker query
+    c.stdin.write(q + "\nselect 'sync';\n")
+    c.stdin.flush()
+    out = []
+    while True:
+        line = c.stdout.readline()
+        if not line or line.startswith('[ "sync"'):
+            break
+        out.append(line)
+    # drop the echo and the header of the marker query
+    sys.stdout.write(''.join(out[:-5]))
+
+def done(c):
+    out, err = c.communicate()
+    sys.stdout.write(out)
+    sys.stderr.write(err)
+
+s = process.server(args = ["--set", "sql_result_cache=16"],
+                   stdin = process.PIPE,
+                   stdout = process.PIPE,
+                   stderr = process.PIPE)
+
+c1 = client()
+c2 = client()
+
+q = 'select k, sum(v), count(*) from rcache group by k order by k;'
+
+query(c1, 'create table rcache (k int, v int);')
+query(c1, 'insert into rcache values (1, 10), (1, 11), (2, 20), (3, 30), (3, 31);')
+query(c1, q)
+query(c2, q)
+
+# a commit by another client drops the cached result
+query(c2, 'insert into rcache values (2, 21);')
+query(c1, q)
+query(c2, 'update rcache set v = v + 100 where k = 1;')
+query(c1, q)
+
+# a transaction sees its own changes
+query(c1, 'start transaction;')
+query(c1, 'delete from rcache where k = 2;')
+query(c1, q)
+query(c1, 'rollback;')
+query(c1, q)
+
+# and keeps its snapshot while others commit
+query(c1, 'start transaction;')
+query(c1, q)
+query(c2, 'delete from rcache where k = 3;')
+query(c1, q)
+query(c2, q)
+query(c1, 'commit;')
+query(c1, q)
+
+# volatile functions are evaluated every time
+query(c1, "select count(*) from rcache where now() > timestamp '2000-01-01';")
+query(c1, "select count(*) from rcache where now() > timestamp '2000-01-01';")
+
+# a schema change drops everything
+query(c1, 'drop table rcache;')
+query(c1, 'create table rcache (k int, v int);')
+query(c2, q)
+query(c1, 'drop table rcache;')
+
+done(c1)
+done(c2)
+out, err = s.communicate()
+sys.stdout.write(out)
+sys.stderr.write(err)
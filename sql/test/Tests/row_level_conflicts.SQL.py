@@ -0,0 +1,80 @@
+import sys
+try:
+    from MonetDBtesting import process
+except ImportError:
+    import process
+
+# two concurrent transactions only conflict when they change the same rows
+
+def client():
+    return process.client('sql', interactive = True,
+                          stdin = process.PIPE,
+                          stdout = process.PIPE,
+                          stderr = process.PIPE)
+
+def query(c, q):
+    # wait for the statement to finish using a marker query
+    c.stdin.write(q + "\nselect 'sync';\n")
+    c.stdin.flush()
+    out = []
+    while True:
+        line = c.stdout.readline()
+        if not line or line.startswith('[ "sync"'):
+            break
+        out.append(line)
+    # drop the echo and the header of the marker query
+    sys.stdout.write(''.join(out[:-5]))
+
+def done(c):
+    out, err = c.communicate()
+    sys.stdout.write(out)
+    sys.stderr.write(err)
+
+c1 = client()
+c2 = client()
+
+query(c1, 'create table rlc (id int primary key, v int);')
+query(c1, 'insert into rlc values (1, 10), (2, 20), (3, 30), (4, 40);')
+
+# updates, appends and deletes of different rows both commit
+query(c1, 'start transaction;')
+query(c2, 'start transaction;')
+query(c1, 'update rlc set v = 11 where id = 1;')
+query(c2, 'update rlc set v = 22 where id = 2;')
+query(c1, 'insert into rlc values (5, 50);')
+query(c2, 'insert into rlc values (6, 60);')
+query(c2, 'delete from rlc where id = 3;')
+query(c1, 'commit;')
+query(c2, 'commit;')
+query(c1, 'select * from rlc order by id;')
+
+# updates of the same row conflict
+query(c1, 'start transaction;')
+query(c2, 'start transaction;')
+query(c1, 'update rlc set v = 111 where id = 1;')
+query(c2, 'update rlc set v = 112 where id = 1;')
+query(c1, 'commit;')
+query(c2, 'commit;')
+query(c1, 'select * from rlc order by id;')
+
+# an update of a row deleted concurrently conflicts
+query(c1, 'start transaction;')
+query(c2, 'start transaction;')
+query(c1, 'update rlc set v = 222 where id = 2;')
+query(c2, 'delete from rlc where id = 2;')
+query(c2, 'commit;')
+query(c1, 'commit;')
+query(c1, 'select * from rlc order by id;')
+
+# appends of the same primary key conflict
+query(c1, 'start transaction;')
+query(c2, 'start transaction;')
+query(c1, 'insert into rlc values (7, 70);')
+query(c2, 'insert into rlc values (7, 71);')
+query(c1, 'commit;')
+query(c2, 'commit;')
+query(c1, 'select * from rlc order by id;')
+
+query(c1, 'drop table rlc;')
+done(c1)
+done(c2)
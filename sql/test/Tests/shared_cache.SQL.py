@@ -0,0 +1,51 @@
+import os, sys
+try:
+    from MonetDBtesting import process
+except ImportError:
+    import process
+
+def client(input, user = 'monetdb', passwd = 'monetdb'):
+    c = process.client('sql', user = user, passwd = passwd,
+                       stdin = process.PIPE,
+                       stdout = process.PIPE,
+                       stderr = process.PIPE)
+    out, err = c.communicate(input)
+    sys.stdout.write(out)
+    sys.stderr.write(err)
+
+client('''
+create table shared_cache (a int, b varchar(10));
+insert into shared_cache values (1, 'one'), (2, 'two'), (3, 'three');
+create user "cacheuser" with password 'cacheuser' name 'Cache User' schema "sys";
+''')
+
+# the second client picks up the template of the first one
+client('select b from shared_cache where a = 2;')
+client('select b from shared_cache where a = 3;')
+client("update shared_cache set b = 'deux' where a = 2;")
+client("update shared_cache set b = 'two' where a = 2;")
+
+# privileges are checked for every user
+client('select b from shared_cache where a = 2;', 'cacheuser', 'cacheuser')
+
+# temporary tables are private to the client
+client('''
+create local temporary table shared_tmp (a int) on commit preserve rows;
+insert into shared_tmp values (42);
+select * from shared_tmp;
+''')
+client('''
+create local temporary table shared_tmp (a varchar(10), b int) on commit preserve rows;
+insert into shared_tmp values ('answer', 42);
+select * from shared_tmp;
+''')
+
+# a schema change invalidates the shared templates
+client('select * from shared_cache where a > 1;')
+client('alter table shared_cache add column c int;')
+client('select * from shared_cache where a > 1;')
+
+client('''
+drop user "cacheuser";
+drop table shared_cache;
+''')
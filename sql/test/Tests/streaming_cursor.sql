@@ -0,0 +1,17 @@
+create table streaming (i int, s varchar(10), d decimal(8,2));
+insert into streaming values (1, 'one', 1.5), (2, 'two', null), (3, null, 3.25), (4, 'four', 4), (5, 'five', -5.75);
+
+set optimizer = 'streaming_pipe';
+
+explain select i, s from streaming where i > 2;
+explain select i + 1, s from streaming;
+
+select * from streaming;
+select i, s, d from streaming where i > 2;
+select i + 1, s from streaming where s is not null;
+select s, count(*) from streaming group by s order by s;
+select * from streaming where i > 10;
+
+set optimizer = 'default_pipe';
+
+drop table streaming;
@@ -0,0 +1,50 @@
+create table wf (k int, t int, v int, d decimal(6,2), s varchar(10));
+insert into wf values
+	(1, 1, 10, 1.50, 'b'), (1, 2, 20, 2.50, 'a'), (1, 3, null, null, null),
+	(1, 4, 40, 4.50, 'd'), (1, null, 1, 9.00, 'e'),
+	(2, 1, 5, 0.50, 'x'), (2, 3, 7, 1.00, 'y'), (2, 6, 8, 2.00, 'z');
+
+-- the default frames, up to the peers of the current row if ordered
+select k, t, v, sum(v) over (partition by k order by t) as s,
+	count(*) over (partition by k order by t) as c,
+	count(v) over (partition by k) as cv,
+	avg(d) over (partition by k) as a
+from wf order by k, t, v;
+
+-- ROWS frames
+select k, t, v,
+	sum(v) over (partition by k order by t rows between 1 preceding and 1 following) as s,
+	min(s) over (partition by k order by t rows 1 preceding) as mn,
+	max(v) over (partition by k order by t rows between current row and unbounded following) as mx,
+	first_value(v) over (partition by k order by t rows between 1 following and 2 following) as fv,
+	last_value(s) over (partition by k order by t rows between unbounded preceding and 1 preceding) as lv
+from wf order by k, t, v;
+
+-- RANGE frames, offsets in values of the ordering column
+select k, t, v,
+	sum(v) over (partition by k order by t range between 1 preceding and current row) as s1,
+	sum(v) over (partition by k order by t desc range between 2 preceding and 1 following) as s2,
+	count(*) over (order by d range between 1.00 preceding and 0.50 following) as c,
+	sum(d) over (partition by k order by t range between current row and unbounded following) as sd
+from wf order by k, t, v;
+
+-- lag and lead within the partitions
+select k, t, v, lag(v) over (partition by k order by t) as lg,
+	lead(v, 2) over (partition by k order by t) as ld,
+	lag(s, 1, '-') over (partition by k order by t) as ls,
+	lead(v, 0) over (order by k, t) as l0
+from wf order by k, t, v;
+
+-- constants
+select sum(1) over (), count(*) over (), lag(3) over ();
+
+-- errors
+select sum(v) over (range between 1 preceding and current row) from wf;
+select sum(v) over (order by s range between 1 preceding and current row) from wf;
+select sum(v) over (order by t rows between 1 preceding and current row exclude current row) from wf;
+select sum(distinct v) over () from wf;
+select sum(s) over () from wf;
+select sum(v) over (order by t rows between t preceding and current row) from wf;
+select lag(v, -1) over () from wf;
+
+drop table wf;
@@ -0,0 +1,19 @@
+CREATE TABLE outputzstd (a bigint, b real, c clob);
+CREATE TABLE readzstd (a bigint, b real, c clob);
+
+COPY 4 RECORDS INTO outputzstd (a, b, c) FROM STDIN USING DELIMITERS ',','\n','"' NULL AS '';
+1,2.0,"another"
+2,2.1,"test"
+3,2.2,"to perform"
+,1.0,
+INSERT INTO outputzstd SELECT value, value / 2.0, 'row ' || value FROM generate_series(4, 200000);
+SELECT count(*), cast(sum(a) as bigint), count(c) FROM outputzstd;
+COPY (SELECT a, b, c FROM outputzstd) INTO '/tmp/testing-dump.zst' USING DELIMITERS ',','\n','"' NULL AS '';
+
+COPY INTO readzstd (a, b, c) FROM '/tmp/testing-dump.zst' USING DELIMITERS ',','\n','"' NULL AS '';
+SELECT a, b, c FROM readzstd ORDER BY a LIMIT 5;
+SELECT count(*), cast(sum(a) as bigint), count(c) FROM readzstd;
+SELECT count(*) FROM outputzstd o, readzstd r WHERE o.a = r.a AND o.b = r.b AND o.c = r.c;
+
+DROP TABLE outputzstd;
+DROP TABLE readzstd;
@@ -0,0 +1,30 @@
+-- numbers, decimals, dates and timestamps in their common spelling
+-- are converted in bulk, everything else value by value
+create table bulk_conversion (t tinyint, i int, l bigint, d decimal(12,3), s decimal(4,2), f double, dt date, ts timestamp);
+
+copy 8 records into bulk_conversion from stdin using delimiters ',', '\n';
+127,2147483647,123456789012345678,123456789.125,99.99,0.1,2018-01-31,2018-01-31 23:59:59.999
+-127,-2147483647,-123456789012345678,-123456789.125,-99.99,-1234.5678,0001-01-01,1970-01-01T00:00:00
++1,007,0,.5,5.,123456789012345,9999-12-31,2000-02-29 12:00:00.5
+0,  42,42e2,  1.5  ,0.1,1e300,2018-1-3,2018-01-31 10:00:00.9999
+null,null,null,null,null,null,null,null
+1,1,1,00000000000000001.000,01.50,-0.0,2000-02-29,2018-01-31 10:00:00.12
+2,2,12345678,12345678.1,1.2,12345678.12345678,2016-06-15,2016-06-15 06:15:00
+3,3,87654321,87654321,3,0.000001,2016-06-15,2016-06-15 06:15
+select * from bulk_conversion;
+delete from bulk_conversion;
+
+copy 8 records into bulk_conversion from stdin using delimiters ',', '\n' best effort;
+128,1,1,1,1,1,2018-01-31,2018-01-31 10:00:00
+1,2147483648,1,1,1,1,2018-01-31,2018-01-31 10:00:00
+1,1,1,1234567890.5,1,1,2018-01-31,2018-01-31 10:00:00
+1,1,1,1,100.5,1,2018-01-31,2018-01-31 10:00:00
+1,1,1,1,1.555,1,2018-01-31,2018-01-31 10:00:00
+1,1,1,1,1,1,2018-02-30,2018-01-31 10:00:00
+1,1,1,1,1,1,2018-01-31,2018-01-31 24:00:00
+1,1,1,1,1,1,2018-01-31,2018-01-31 10:00:00
+select * from bulk_conversion;
+select rowid, fldid, message, input from sys.rejects;
+call sys.clearrejects();
+
+drop table bulk_conversion;
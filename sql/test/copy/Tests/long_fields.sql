@@ -0,0 +1,29 @@
+-- fields longer than a machine word, with separators, quotes and
+-- escapes at every position within a word
+create table long_fields (i int, s varchar(100), t varchar(100));
+
+copy 4 records into long_fields from stdin using delimiters '|', '\n';
+1|abcdefghijklmnopqrstuvwxyz|x
+22|abcdefg\|hijklmnop\\qrstuvwxyz|xy
+333|\\\\\\\\\\\\\\\\|0123456789abcdef0123456789
+4444||abcdefgh
+
+select * from long_fields;
+delete from long_fields;
+
+copy 4 records into long_fields from stdin using delimiters ',', '\n', '"';
+1,"abcdefghijklmnopqrstuvwxyz","x"
+22,"abcdefg,hijklmnop""qrstuvwxyz",xy
+333,"ab\"cdef\\ghijklmnopqr
+stuvwxyz","0123456789,abcdef,0123456789"
+4444,"","abcdefgh"
+
+select * from long_fields;
+delete from long_fields;
+
+copy 3 records into long_fields from stdin using delimiters '<>', '##';
+1<>abcdefghijklmnopqrstuvwxyz<>x##22<>abcdefghi<jklmnop>qrstuvwxyz<>xy#3##333<>0123456789abcdef<>0123456789abcdef##
+
+select * from long_fields;
+
+drop table long_fields;
@@ -0,0 +1,81 @@
+create merge table rp (k int, v varchar(10)) partition by range on (k);
+create table rp1 (k int, v varchar(10));
+create table rp2 (k int, v varchar(10));
+create table rp3 (k int, v varchar(10));
+alter table rp add table rp1 as partition from range minvalue to 10;
+alter table rp add table rp2 as partition from 10 to 20;
+alter table rp add table rp3 as partition from 15 to range maxvalue; -- overlaps rp2
+alter table rp add table rp3 as partition in (30); -- not a value partitioned table
+alter table rp add table rp3; -- needs bounds
+alter table rp add table rp3 as partition from 20 to range maxvalue;
+
+select t.name, c.name, p."type" from sys.table_partitions p, sys._tables t, sys._columns c where p.table_id = t.id and p.column_id = c.id;
+select t.name, r.minimum, r.maximum from sys.range_partitions r, sys._tables t where r.partition_id = t.id order by t.name;
+
+-- inserts are routed to the member holding the key
+insert into rp values (1, 'a'), (12, 'b'), (25, 'c'), (-5, 'd'), (10, 'e'), (20, 'f');
+select * from rp1 order by k;
+select * from rp2 order by k;
+select * from rp3 order by k;
+insert into rp values (null, 'x');
+insert into rp values (3, 'y'), (null, 'z');
+select count(*) from rp;
+insert into rp select k + 1, v from rp;
+select count(*) from rp1;
+
+-- selections only scan the matching members
+plan select * from rp where k = 12;
+plan select * from rp where k < 5;
+plan select * from rp where k >= 20;
+plan select * from rp where k between 11 and 14;
+select * from rp where k between 11 and 14 order by k;
+
+-- joins on the partition columns join matching members only
+create merge table rq (k int, w int) partition by range on (k);
+create table rq1 (k int, w int);
+create table rq2 (k int, w int);
+create table rq3 (k int, w int);
+alter table rq add table rq1 as partition from range minvalue to 10;
+alter table rq add table rq2 as partition from 10 to 20;
+alter table rq add table rq3 as partition from 20 to range maxvalue;
+insert into rq values (1, 100), (12, 200), (25, 300), (-5, 400), (2, 500);
+plan select rp.k, rp.v, rq.w from rp join rq on rp.k = rq.k;
+select rp.k, rp.v, rq.w from rp join rq on rp.k = rq.k order by rp.k;
+select x.k, x.v, y.w from rp x join rq y on x.k = y.k where x.k < 10 order by x.k;
+
+-- grouping on the partition column needs no final aggregation
+plan select k, sum(w), avg(w) from rq group by k;
+select k, cast(sum(w) as bigint), avg(w) from rq group by k order by k;
+
+-- value partitions
+create merge table vp (k int, c char(2)) partition by values on (c);
+create table vp1 (k int, c char(2));
+create table vp2 (k int, c char(2));
+alter table vp add table vp1 as partition in ('NL', 'BE');
+alter table vp add table vp2 as partition in ('DE', 'NL'); -- overlaps vp1
+alter table vp add table vp2 as partition in ('DE', 'FR');
+select t.name, p."value" from sys.value_partitions p, sys._tables t where p.partition_id = t.id order by t.name, p."value";
+insert into vp values (1, 'NL'), (2, 'FR'), (3, 'BE');
+insert into vp values (4, 'XX');
+select * from vp1 order by k;
+select * from vp2 order by k;
+plan select * from vp where c = 'FR';
+select * from vp where c in ('BE', 'DE') order by k;
+
+alter table vp drop table vp2;
+select count(*) from sys.value_partitions p, sys._tables t where p.partition_id = t.id and t.name = 'vp2';
+
+drop table vp;
+drop table vp1;
+drop table vp2;
+drop table rq;
+drop table rq1;
+drop table rq2;
+drop table rq3;
+drop table rp;
+drop table rp1;
+drop table rp2;
+drop table rp3;
+select count(*) from sys.table_partitions;
+select count(*) from sys.range_partitions;
+select count(*) from sys.value_partitions;
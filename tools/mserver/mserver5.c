@@ -641,6 +641,9 @@ main(int argc, char **av)
 		msab_registerStop();
 		GDKfatal("%s", err);
 	}
+	/* compression settings for writing .zst files, e.g. with COPY INTO */
+	mnstr_set_zstd_parameters(GDKgetenv_int("zstd_level", 0),
+				  GDKgetenv_int("zstd_workers", GDKnr_threads > 1 ? GDKnr_threads : 0));
 	if (mal_init()) {
 		/* don't show this as a crash */
 		msab_registerStop();